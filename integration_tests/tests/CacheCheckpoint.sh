@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+
+set -eux
+set -o pipefail
+
+# The result cache stores the state of all loaded data at each CacheCheckpoint operation. Check that a second, identical
+# invocation resumes from the checkpoint, and that checkpoints following an operation with side-effects are ignored.
+mkdir -p cache
+
+printf 'Test 1\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  --cache-directory cache \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o NegatePixels:ImageSelection=all \
+  -o CacheCheckpoint \
+  -o DroverDebug |
+  tee -a fullstdout |
+  tee first_stdout
+if grep -i "Resuming from the cache checkpoint" first_stdout ; then
+    exit 1
+fi
+
+printf 'Test 2\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  --cache-directory cache \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o NegatePixels:ImageSelection=all \
+  -o CacheCheckpoint \
+  -o DroverDebug |
+  tee -a fullstdout |
+  grep -i "Resuming from the cache checkpoint at operation 2 of 3" |
+  `# Ensure the output stream is not empty. ` \
+  grep .
+
+printf 'Test 3\n' |
+  tee -a fullstdout
+for i in 1 2 ; do
+    "${DCMA_BIN}" \
+      --cache-directory cache \
+      "${TEST_FILES_ROOT}"/MR_continents.dcm \
+      -o DumpAllOrderedImageMetadataToFile \
+      -o CacheCheckpoint \
+      -o DroverDebug |
+      tee -a fullstdout |
+      tee side_effect_stdout
+    if grep -i "Resuming from the cache checkpoint" side_effect_stdout ; then
+        exit 1
+    fi
+done
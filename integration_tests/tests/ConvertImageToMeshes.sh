@@ -0,0 +1,15 @@
+#!/usr/bin/env bash
+
+set -eux
+set -o pipefail
+
+# Meshes a checkerboard, which the surface intersects at nearly every voxel. In debug builds, marching cubes asserts
+# that the temporaries created for each intersected voxel are drawn only from the thread's arena.
+"${DCMA_BIN}" \
+  -o GenerateSyntheticImages:NumberOfImages=6:NumberOfRows=10:NumberOfColumns=12:VoxelValue=0.0:StipleValue=1.0 \
+  -o ConvertImageToMeshes:Lower=0.5:Upper=inf:MeshLabel=checkerboard \
+  -o DroverDebug |
+  tee -a fullstdout |
+  grep -i "1 Surface_Meshes loaded" |
+  `# Ensure the output stream is not empty. ` \
+  grep .
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+
+set -eux
+set -o pipefail
+
+# Consecutive pointwise operations are fused into a single pass over the voxels. Check that the fused pass produces
+# the same voxel values, bit for bit, as the operations themselves do when they are run one at a time. The NoOp
+# operations are not pointwise, so they prevent fusion.
+mkdir -p fused split
+
+printf 'Test 1\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o LogScale:ImageSelection=all \
+  -o NegatePixels:ImageSelection=all \
+  -o ThresholdImages:Lower=-4.0:Low=-4.5:Upper=-1.0:High=-0.5:Channel=0:ImageSelection=all \
+  -o ConvertNaNsToAir \
+  -o PreFilterEnormousCTValues \
+  -o ConvertNaNsToZeros \
+  -o ExportFITSImages:ImageSelection=all:FilenameBase=fused/out |
+  tee -a fullstdout |
+  grep -i "Performing fused operations 'LogScale', 'NegatePixels', 'ThresholdImages', 'ConvertNaNsToAir', 'PreFilterEnormousCTValues', 'ConvertNaNsToZeros'" |
+  `# Ensure the output stream is not empty. ` \
+  grep .
+
+printf 'Test 2\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o LogScale:ImageSelection=all \
+  -o NoOp \
+  -o NegatePixels:ImageSelection=all \
+  -o NoOp \
+  -o ThresholdImages:Lower=-4.0:Low=-4.5:Upper=-1.0:High=-0.5:Channel=0:ImageSelection=all \
+  -o NoOp \
+  -o ConvertNaNsToAir \
+  -o NoOp \
+  -o PreFilterEnormousCTValues \
+  -o NoOp \
+  -o ConvertNaNsToZeros \
+  -o ExportFITSImages:ImageSelection=all:FilenameBase=split/out |
+  tee -a fullstdout |
+  tee split_stdout
+# Ensure the operations were not fused.
+if grep -i "Performing fused operations" split_stdout ; then
+    exit 1
+fi
+
+ls fused/out_*.fits | grep .
+for f in fused/out_*.fits ; do
+    cmp "${f}" split/"$(basename "${f}")"
+done
+[ "$(ls fused | wc -l)" == "$(ls split | wc -l)" ]
@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+
+set -eux
+set -o pipefail
+
+# Image voxel data can be paged to disk while DICOM files are loaded. Check that the images are spilled, that pointwise
+# operations act on the spilled images without restoring them, and that the outcome is identical, bit for bit, to
+# processing the images entirely in memory.
+mkdir -p spilled resident
+
+printf 'Test 1\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  --spill-budget 0.001 \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o NegatePixels:ImageSelection=all \
+  -o ExportFITSImages:ImageSelection=all:FilenameBase=spilled/out |
+  tee -a fullstdout |
+  tee spilled_stdout
+grep -i "Spilled 1 images to disk while loading" spilled_stdout | grep .
+grep -i "Performing operation 'NegatePixels' on spilled images" spilled_stdout | grep .
+
+printf 'Test 2\n' |
+  tee -a fullstdout
+"${DCMA_BIN}" \
+  "${TEST_FILES_ROOT}"/MR_continents.dcm \
+  -o NegatePixels:ImageSelection=all \
+  -o ExportFITSImages:ImageSelection=all:FilenameBase=resident/out |
+  tee -a fullstdout
+
+ls spilled/out_*.fits | grep .
+for f in spilled/out_*.fits ; do
+    cmp "${f}" resident/"$(basename "${f}")"
+done
+[ "$(ls spilled | wc -l)" == "$(ls resident | wc -l)" ]
@@ -6,13 +6,14 @@
 #include <cmath>
 #include <cstdint>
 #include <exception>
-#include <fstream>
 #include <numeric>
 #include <list>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>    
+#include <string_view>
+#include <vector>
 
 #include <filesystem>
 #include <cstdlib>            //Needed for exit() calls.
@@ -24,6 +25,7 @@
 
 #include "Structs.h"
 #include "Imebra_Shim.h"      //Needed for Collate_Image_Arrays().
+#include "Mapped_File.h"
 
 
 bool Load_From_3ddose_Files( Drover &DICOM_data,
@@ -50,21 +52,6 @@ bool Load_From_3ddose_Files( Drover &DICOM_data,
     //
     if(Filenames.empty()) return true;
 
-    const auto extract_separated_numbers = [](const std::string &in) -> std::vector<double> {
-            // This rountine extracts numerical function parameters.
-            auto split = SplitStringToVector(in, ' ', 'd');
-            split = SplitVector(split, '\t', 'd');
-
-            std::vector<double> numbers;
-            for(const auto &w : split){
-               try{
-                   const auto x = std::stod(w);
-                   numbers.emplace_back(x);
-               }catch(const std::exception &){ }
-            }
-            return numbers;
-    };
-
     size_t i = 0;
     const size_t N = Filenames.size();
 
@@ -77,128 +64,60 @@ bool Load_From_3ddose_Files( Drover &DICOM_data,
         try{
             //////////////////////////////////////////////////////////////
             // Attempt to load the file.
-            std::fstream FI(Filename.c_str(), std::ios::in);
-            if(!FI.good()){
-                throw std::runtime_error("Unable to read file.");
-            }
-
-            bool dims_known = false;
-            long int N_x = -1;
-            long int N_y = -1;
-            long int N_z = -1;
-
-            std::vector<double> spatial_x;
-            std::vector<double> spatial_y;
-            std::vector<double> spatial_z;
-
-            std::vector<double> doses;
+            const mapped_file FI(*bfit);
+            std::string_view remaining = FI.view();
 
-/*
-            try{
-                double shtl;
-                FI >> N_x >> N_y >> N_z;
-                for(long int i = 0; i <= N_x; ++i){ // Intentionally reads N_x+1 values.
-                    FI >> shtl;
-                    spatial_x.emplace_back(shtl);
-                }
-                for(long int i = 0; i <= N_x; ++i){ // Intentionally reads N_y+1 values.
-                    FI >> shtl;
-                    spatial_x.emplace_back(shtl);
-                }
-                for(long int i = 0; i <= N_x; ++i){ // Intentionally reads N_z+1 values.
-                    FI >> shtl;
-                    spatial_x.emplace_back(shtl);
-                }
-                while(!FI.eof()){
-                    FI >> shtl;
-                    doses.emplace_back(shtl);
-                }
-            }catch(const std::exception &){ }
-            FI.close();
-*/            
-            std::string aline;
-            while(!FI.eof()){
-                std::getline(FI, aline);
-
-                // Ignore comments.
-                const auto hash_pos = aline.find_first_of('#');
-                if(hash_pos != std::string::npos){
-                    aline = aline.substr(0, hash_pos);
+            // Extracts the numbers from the next line that contains any.
+            std::vector<double> numbers;
+            const auto next_numbers = [&]() -> bool {
+                numbers.clear();
+                while(!remaining.empty()){
+                    extract_numbers(pop_line(remaining), numbers);
+                    if(!numbers.empty()) return true;
                 }
+                return false;
+            };
 
-                // Extract all numbers separated by whitespace.
-                const auto numbers = extract_separated_numbers(aline);
-                if(numbers.empty()) continue;
-
-                // If the matrix dimensions are not yet known, seek this info before reading any other information.
-                //
-                // Dimensional consistency is the only way to validate 3ddose files, so we use the dimensions to ensure
-                // the correct amount of data has been received at the end.
-                //
-                // Since there is no 3ddose file header or magic numbers we have to ruthlessly reject files that do
-                // not immediately present sane dimensions.
-                if(!dims_known){
-                    if(numbers.size() != 3) throw std::runtime_error("Dimensions not understood.");
-
-                    N_x = static_cast<long int>(numbers.at(0));
-                    N_y = static_cast<long int>(numbers.at(1));
-                    N_z = static_cast<long int>(numbers.at(2));
-                    if((N_x <= 0) || (N_y <= 0) || (N_z <= 0)){
-                        throw std::runtime_error("Dimensions invalid.");
-                    }
-                    dims_known = true;
-                    continue;
-
-                // Attempt to parse spatial information.
-                }else if( dims_known 
-                      && (static_cast<long int>(spatial_x.size()) != (N_x + 1)) ){
-
-                    for(const auto &n : numbers){
-                        if(!std::isfinite(n)) continue;
-                    }
-                    spatial_x.insert( std::end(spatial_x), std::begin(numbers), std::end(numbers) );
-
-                }else if( dims_known 
-                      && (static_cast<long int>(spatial_x.size()) == (N_x + 1))
-                      && (static_cast<long int>(spatial_y.size()) != (N_y + 1)) ){
-
-                    for(const auto &n : numbers){
-                        if(!std::isfinite(n)) continue;
-                    }
-                    spatial_y.insert( std::end(spatial_y), std::begin(numbers), std::end(numbers) );
-
-                }else if( dims_known 
-                      && (static_cast<long int>(spatial_x.size()) == (N_x + 1))
-                      && (static_cast<long int>(spatial_y.size()) == (N_y + 1))
-                      && (static_cast<long int>(spatial_z.size()) != (N_z + 1)) ){
-
-                    for(const auto &n : numbers){
-                        if(!std::isfinite(n)) continue;
-                    }
-                    spatial_z.insert( std::end(spatial_z), std::begin(numbers), std::end(numbers) );
-
-                // Continue reading in all dose and trailing dose uncertainties.
-                //
-                // If the final number of voxels differs from the stated dimensions, then this file is not valid.
-                }else if( dims_known 
-                      && (static_cast<long int>(spatial_x.size()) == (N_x + 1))
-                      && (static_cast<long int>(spatial_y.size()) == (N_y + 1))
-                      && (static_cast<long int>(spatial_z.size()) == (N_z + 1)) ){
-                    for(const auto &n : numbers){
-                        if(!std::isfinite(n)) continue;
-                    }
-
-                    // Append the doses.
-                    doses.insert( std::end(doses), std::begin(numbers), std::end(numbers) );
+            // Seek the matrix dimensions before reading any other information.
+            //
+            // Dimensional consistency is the only way to validate 3ddose files, so we use the dimensions to ensure
+            // the correct amount of data has been received at the end.
+            //
+            // Since there is no 3ddose file header or magic numbers we have to ruthlessly reject files that do
+            // not immediately present sane dimensions.
+            if( !next_numbers()
+            ||  (numbers.size() != 3) ){
+                throw std::runtime_error("Dimensions not understood.");
+            }
+            const auto N_x = static_cast<long int>(numbers.at(0));
+            const auto N_y = static_cast<long int>(numbers.at(1));
+            const auto N_z = static_cast<long int>(numbers.at(2));
+            if((N_x <= 0) || (N_y <= 0) || (N_z <= 0)){
+                throw std::runtime_error("Dimensions invalid.");
+            }
 
-                // Unexpected scenario.
-                }else{
-                    FUNCWARN("Unable to read 3ddose file.");
-                    return false;
+            // Parse spatial information. Each set of voxel boundaries may span multiple lines, but must begin on a new
+            // line.
+            const auto read_boundaries = [&](long int N_boundaries) -> std::vector<double> {
+                std::vector<double> boundaries;
+                while(static_cast<long int>(boundaries.size()) < N_boundaries){
+                    if(!next_numbers()) throw std::runtime_error("Voxel boundaries missing.");
+                    boundaries.insert( std::end(boundaries), std::begin(numbers), std::end(numbers) );
                 }
-
-            }
-            FI.close();
+                if(static_cast<long int>(boundaries.size()) != N_boundaries){
+                    throw std::runtime_error("Voxel boundaries not understood.");
+                }
+                return boundaries;
+            };
+            auto spatial_x = read_boundaries(N_x + 1);
+            auto spatial_y = read_boundaries(N_y + 1);
+            auto spatial_z = read_boundaries(N_z + 1);
+
+            // Read in all dose and trailing dose uncertainties. This is the bulk of the file, so it is parsed
+            // concurrently.
+            //
+            // If the final number of voxels differs from the stated dimensions, then this file is not valid.
+            auto doses = extract_numbers_parallel(remaining);
 
             // Validate that the file has been fully read.
             if( (static_cast<long int>(doses.size()) != (N_x * N_y * N_z))   // Dose data only.
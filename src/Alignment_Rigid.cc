@@ -25,7 +25,7 @@
 #endif
 
 #include "Structs.h"
-#include "Thread_Pool.h"
+#include "Point_KD_Tree.h"
 
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -312,6 +312,9 @@ AlignViaExhaustiveICP( const point_set<double> & moving,
 
     point_set<double> working(moving);
     point_set<double> corresp(moving);
+
+    // The stationary points do not move, so they are indexed once for all correspondence searches.
+    const point_kd_tree stationary_tree(stationary);
     
     // Prime the transformation using a simplistic alignment.
     //
@@ -337,26 +340,16 @@ AlignViaExhaustiveICP( const point_set<double> & moving,
         t.apply_to(working);
         const auto centroid_w = working.Centroid();
 
-        // Exhaustively determine the correspondence between stationary and working points under the current
-        // transformation. Note that multiple working points may correspond to the same stationary point.
+        // Determine the correspondence between stationary and working points under the current transformation.
+        // Note that multiple working points may correspond to the same stationary point.
         const auto N_working_points = working.points.size();
         if(N_working_points != corresp.points.size()) throw std::logic_error("Encountered inconsistent working buffers. Cannot continue.");
         {
-            asio_thread_pool tp;
+            const auto nearest = stationary_tree.nearest(working.points);
             for(size_t i = 0; i < N_working_points; ++i){
-                tp.submit_task([&,i]() -> void {
-                    const auto w_p = working.points[i];
-                    double min_sq_dist = std::numeric_limits<double>::infinity();
-                    for(const auto &s_p : stationary.points){
-                        const auto sq_dist = w_p.sq_dist(s_p);
-                        if(sq_dist < min_sq_dist){
-                            min_sq_dist = sq_dist;
-                            corresp.points[i] = s_p;
-                        }
-                    }
-                }); // thread pool task closure.
+                if(0 <= nearest[i].index) corresp.points[i] = stationary.points[nearest[i].index];
             }
-        } // Wait until all threads are done.
+        }
 
 
         ///////////////////////////////////
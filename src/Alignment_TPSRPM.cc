@@ -27,6 +27,7 @@
 #include "Structs.h"
 #include "Regex_Selectors.h"
 #include "Thread_Pool.h"
+#include "Point_KD_Tree.h"
 
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -345,42 +346,30 @@ AlignViaTPSRPM(AlignViaTPSRPMParams & params,
         FUNCINFO("Locating mean nearest-neighbour separation in moving point cloud");
         Stats::Running_Sum<double> rs;
         {
-            //asio_thread_pool tp;
+            // The nearest neighbour of each point (other than itself) is the second-nearest point in the cloud.
+            const point_kd_tree moving_tree(moving);
+            const auto knn = moving_tree.k_nearest(moving.points, 2);
             for(long int i = 0; i < N_move_points; ++i){
-                //tp.submit_task([&,i](void) -> void {
-                double min_sq_dist = std::numeric_limits<double>::infinity();
-                for(long int j = 0; j < N_move_points; ++j){
-                    if(i == j) continue;
-                    const auto sq_dist = (moving.points[i]).sq_dist( moving.points[j] );
-                    if(sq_dist < min_sq_dist) min_sq_dist = sq_dist;
-                }
-                if(!std::isfinite(min_sq_dist)){
+                if(knn[i].size() != 2){
                     throw std::runtime_error("Unable to estimate nearest neighbour distance.");
                 }
-                rs.Digest(min_sq_dist);
-                //}); // thread pool task closure.
+                rs.Digest(knn[i].back().sq_dist);
             }
         }
         mean_nn_sq_dist = rs.Current_Sum() / static_cast<double>( N_move_points );
 
         FUNCINFO("Locating max square-distance between all points");
         {
-            //asio_thread_pool tp;
-            //std::mutex saver_printer;
-            for(long int i = 0; i < (N_move_points + N_stat_points); ++i){
-                //tp.submit_task([&,i](void) -> void {
-                    for(long int j = 0; j < i; ++j){
-                        const auto A = (i < N_move_points) ? moving.points[i] : stationary.points[i - N_move_points];
-                        const auto B = (j < N_move_points) ? moving.points[j] : stationary.points[j - N_move_points];
-                        const auto sq_dist = A.sq_dist(B);
-                        if(max_sq_dist < sq_dist){
-                            //std::lock_guard<std::mutex> lock(saver_printer);
-                            max_sq_dist = sq_dist;
-                        }
-                    }
-                //}); // thread pool task closure.
+            std::vector<vec3<double>> all_points(moving.points);
+            all_points.insert( std::end(all_points), std::begin(stationary.points), std::end(stationary.points) );
+            const point_kd_tree all_tree(all_points);
+            for(const auto &f : all_tree.farthest(all_points)){
+                if( (0 <= f.index)
+                &&  (max_sq_dist < f.sq_dist) ){
+                    max_sq_dist = f.sq_dist;
+                }
             }
-        } // Wait until all threads are done.
+        }
     }
 
     const double T_start = params.T_start_scale * max_sq_dist;
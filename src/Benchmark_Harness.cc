@@ -0,0 +1,140 @@
+//Benchmark_Harness.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <ios>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Benchmark_Harness.h"
+
+
+benchmark_result run_benchmark(const benchmark_case &bc,
+                               long int repetitions,
+                               long int warmups){
+    if(repetitions < 1){
+        throw std::invalid_argument("At least one repetition is required");
+    }
+    if(!bc.run){
+        throw std::invalid_argument("Benchmark '" + bc.name + "' has nothing to run");
+    }
+
+    benchmark_result r;
+    r.name = bc.name;
+    r.timings.reserve(static_cast<size_t>(repetitions));
+    for(long int i = 0; i < (std::max(0L, warmups) + repetitions); ++i){
+        if(bc.setup) bc.setup();
+
+        const auto t_start = std::chrono::steady_clock::now();
+        bc.run();
+        const auto t_stop = std::chrono::steady_clock::now();
+
+        if(i < warmups) continue;
+        r.timings.push_back( std::chrono::duration<double>(t_stop - t_start).count() );
+    }
+    summarize_timings(r);
+    return r;
+}
+
+void summarize_timings(benchmark_result &r){
+    if(r.timings.empty()){
+        r.min = r.median = r.mean = r.stddev = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+    auto sorted = r.timings;
+    std::sort(std::begin(sorted), std::end(sorted));
+    const auto N = sorted.size();
+
+    r.min = sorted.front();
+    r.median = (N % 2 == 1) ? sorted[N / 2]
+                            : 0.5 * (sorted[N / 2 - 1] + sorted[N / 2]);
+
+    double sum = 0.0;
+    for(const auto &t : sorted) sum += t;
+    r.mean = sum / static_cast<double>(N);
+
+    double sq = 0.0;
+    for(const auto &t : sorted) sq += (t - r.mean) * (t - r.mean);
+    r.stddev = (N < 2) ? 0.0 : std::sqrt(sq / static_cast<double>(N - 1));
+    return;
+}
+
+static
+std::string json_quote(const std::string &s){
+    std::string out = "\"";
+    for(const auto c : s){
+        switch(c){
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20){
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+                    out += buf;
+                }else{
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += "\"";
+    return out;
+}
+
+static
+std::string json_number(double x){
+    if(!std::isfinite(x)) return "null";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", x);
+    return buf;
+}
+
+void write_benchmarks_json(std::ostream &os,
+                           const std::map<std::string, std::string> &context,
+                           const std::vector<benchmark_result> &results){
+    os << "{\n";
+    os << "  \"context\": {";
+    bool first = true;
+    for(const auto &kv : context){
+        os << (first ? "\n" : ",\n") << "    " << json_quote(kv.first) << ": " << json_quote(kv.second);
+        first = false;
+    }
+    os << (first ? "" : "\n  ") << "},\n";
+
+    os << "  \"benchmarks\": [";
+    first = true;
+    for(const auto &r : results){
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "    {\n"
+           << "      \"name\": " << json_quote(r.name) << ",\n"
+           << "      \"repetitions\": " << r.timings.size() << ",\n"
+           << "      \"time_unit\": \"s\",\n"
+           << "      \"real_time\": " << json_number(r.median) << ",\n"
+           << "      \"min_time\": " << json_number(r.min) << ",\n"
+           << "      \"median_time\": " << json_number(r.median) << ",\n"
+           << "      \"mean_time\": " << json_number(r.mean) << ",\n"
+           << "      \"stddev_time\": " << json_number(r.stddev) << ",\n"
+           << "      \"timings\": [";
+        for(size_t i = 0; i < r.timings.size(); ++i){
+            os << ((i == 0) ? "" : ", ") << json_number(r.timings[i]);
+        }
+        os << "]\n"
+           << "    }";
+    }
+    os << (first ? "" : "\n  ") << "]\n";
+    os << "}\n";
+    os.flush();
+    return;
+}
+
@@ -0,0 +1,49 @@
+//Benchmark_Harness.h.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+// A single benchmark.
+//
+// The setup routine is invoked (untimed) before every repetition, so each timed run starts from the same state. Only
+// the run routine is timed.
+struct benchmark_case {
+    std::string name;
+    std::function<void()> setup;
+    std::function<void()> run;
+};
+
+// Wall-clock timings for a benchmark, in seconds.
+struct benchmark_result {
+    std::string name;
+    std::vector<double> timings; // One per timed repetition, in order.
+
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0; // Sample standard deviation. Zero for a single repetition.
+};
+
+// Runs a benchmark, discarding the first 'warmups' runs. Exceptions thrown by the benchmark are propagated.
+benchmark_result run_benchmark(const benchmark_case &bc,
+                               long int repetitions,
+                               long int warmups = 1);
+
+// Computes the summary statistics from the timings.
+void summarize_timings(benchmark_result &r);
+
+// Writes results as a JSON document.
+//
+// The layout loosely follows Google Benchmark's JSON output so that existing tooling for tracking results between
+// commits can be reused: a 'context' object holding the given key-values, and a 'benchmarks' array with one entry per
+// result. Times are reported in seconds.
+void write_benchmarks_json(std::ostream &os,
+                           const std::map<std::string, std::string> &context,
+                           const std::vector<benchmark_result> &results);
+
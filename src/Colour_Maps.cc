@@ -1,7 +1,16 @@
 //Colour_Maps.cc - A part of DICOMautomaton 2017. Written by hal clark.
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <vector>
 
 #include "Colour_Maps.h"
 #include "YgorMath.h"
@@ -17922,5 +17931,86 @@ std::optional<ClampedColourRGB> Colour_from_name(const std::string& n){
 }
 
 
+Colour_Map_LUT::Colour_Map_LUT(const std::function<ClampedColourRGB(double)> &colour_map){
+    if(!colour_map){
+        throw std::invalid_argument("Colour map is not valid");
+    }
+    const auto to_byte = [](double c) -> uint8_t {
+        return static_cast<uint8_t>( std::floor( std::clamp(c, 0.0, 1.0) * 255.0 ) );
+    };
+    this->table.reserve(N_entries);
+    for(long int i = 0; i < N_entries; ++i){
+        const auto y = static_cast<double>(i) / static_cast<double>(N_entries - 1);
+        const auto c = colour_map(y);
+        this->table.push_back( rgb_t{{ to_byte(c.R), to_byte(c.G), to_byte(c.B) }} );
+    }
+}
+
+const Colour_Map_LUT::rgb_t &
+Colour_Map_LUT::operator()(double y) const {
+    if(!std::isfinite(y)) y = 0.0;
+    const auto i = static_cast<long int>( std::clamp(y, 0.0, 1.0) * static_cast<double>(N_entries - 1) + 0.5 );
+    return this->table[i];
+}
+
+ClampedColourRGB
+Colour_Map_LUT::clamped(double y) const {
+    const auto &c = (*this)(y);
+    return { static_cast<double>(c[0]) / 255.0,
+             static_cast<double>(c[1]) / 255.0,
+             static_cast<double>(c[2]) / 255.0 };
+}
+
+void
+Colour_Map_LUT::map_pixels(const float *in,
+                           long int count,
+                           long int stride,
+                           double scale,
+                           double offset,
+                           const rgb_t &nan_colour,
+                           uint8_t *out) const {
 
+    // Pixels are processed in blocks. The first pass (window/level and quantization) is branch-free so that it can be
+    // vectorized, and the second pass gathers colours from the table.
+    constexpr long int block = 256;
+    constexpr long int nan_index = N_entries; // Sentinel.
+    const auto top = static_cast<double>(N_entries - 1);
+    std::array<int32_t, block> indices;
 
+    for(long int b = 0; b < count; b += block){
+        const long int n = std::min(block, count - b);
+        const float *p = in + b * stride;
+        for(long int i = 0; i < n; ++i){
+            const double v = static_cast<double>(p[i * stride]);
+            const double x = std::min(std::max(v * scale + offset, 0.0), 1.0);
+            indices[i] = (std::isfinite(v) && !std::isnan(x)) ? static_cast<int32_t>(x * top + 0.5) : static_cast<int32_t>(nan_index);
+        }
+
+        uint8_t *o = out + b * 3;
+        for(long int i = 0; i < n; ++i){
+            const auto &c = (indices[i] == nan_index) ? nan_colour : this->table[indices[i]];
+            o[3 * i + 0] = c[0];
+            o[3 * i + 1] = c[1];
+            o[3 * i + 2] = c[2];
+        }
+    }
+    return;
+}
+
+std::shared_ptr<const Colour_Map_LUT>
+Get_Colour_Map_LUT(const std::function<ClampedColourRGB(double)> &colour_map){
+    using colour_map_fn_t = ClampedColourRGB (*)(double);
+    const auto *fn = colour_map.target<colour_map_fn_t>();
+    if( (fn == nullptr)
+    ||  (*fn == nullptr) ){
+        return nullptr;
+    }
+
+    static std::mutex m;
+    static std::map<colour_map_fn_t, std::shared_ptr<const Colour_Map_LUT>> luts;
+
+    std::lock_guard<std::mutex> lock(m);
+    auto &lut = luts[*fn];
+    if(lut == nullptr) lut = std::make_shared<const Colour_Map_LUT>(*fn);
+    return lut;
+}
@@ -2,8 +2,13 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 
 struct ClampedColourRGB {
@@ -46,3 +51,44 @@ ClampedColourRGB ColourMap_Composite_50_90_100_107_110(double y);
 //This function takes a named colour and map it to a colour specified in terms of R,G,B all within [0,1].
 std::optional<ClampedColourRGB> Colour_from_name(const std::string& n);
 
+
+// A quantized, precomputed colour map.
+//
+// Evaluating the colour map functions above requires searching and interpolating control points, which is costly when
+// done for every displayed pixel. This table samples a colour map once and thereafter provides constant-time lookups.
+// Colours are stored as 8-bit RGB (i.e., floor(255*c)), which is the precision used for display.
+class Colour_Map_LUT {
+    public:
+        static constexpr long int N_entries = 4096;
+        using rgb_t = std::array<uint8_t, 3>;
+
+    private:
+        std::vector<rgb_t> table;
+
+    public:
+        explicit Colour_Map_LUT(const std::function<ClampedColourRGB(double)> &colour_map);
+
+        // Map an input in [0,1] to an 8-bit colour. Inputs outside [0,1] are clamped and non-finite inputs map to 0.
+        const rgb_t & operator()(double y) const;
+
+        // As above, but expressed as a ClampedColourRGB.
+        ClampedColourRGB clamped(double y) const;
+
+        // Map 'count' pixel values, separated by 'stride' floats, to packed 8-bit RGB triplets.
+        //
+        // Each value v is windowed as x = v * scale + offset, clamped to [0,1], and then looked up. Non-finite values
+        // are mapped to nan_colour. The output must have room for 3*count bytes.
+        void map_pixels(const float *in,
+                        long int count,
+                        long int stride,
+                        double scale,
+                        double offset,
+                        const rgb_t &nan_colour,
+                        uint8_t *out) const;
+};
+
+// Retrieve a shared table for one of the colour map functions declared above, building it on first use.
+//
+// Returns nullptr if the argument does not wrap a plain function (e.g., a lambda), since such colour maps cannot be
+// identified reliably. In that case the colour map should be evaluated directly.
+std::shared_ptr<const Colour_Map_LUT> Get_Colour_Map_LUT(const std::function<ClampedColourRGB(double)> &colour_map);
@@ -24,12 +24,17 @@
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/math/special_functions/nonfinite_num_facets.hpp>
 #include <boost/serialization/nvp.hpp>
+#include <cstdint>
 #include <exception>
 #include <fstream>
+#include <ostream>
+#include <streambuf>
 #include <string>    
 #include <utility>
+#include <vector>
 
 #include "Common_Boost_Serialization.h"
+#include "Image_Fingerprint.h"
 //#include "YgorMathChebyshevIOBoostSerialization.h"
 
 #ifdef DCMA_USE_GNU_GSL
@@ -184,6 +189,56 @@ Common_Boost_Deserialize_Drover(Drover &out,
     return false;
 }
 
+
+// A stream buffer that hashes everything written to it, one block at a time.
+class hashing_streambuf : public std::streambuf {
+    private:
+        std::vector<char> block;
+        uint64_t hash = 0;
+
+        void digest_block(){
+            const auto n = static_cast<size_t>(this->pptr() - this->pbase());
+            if(0 < n) this->hash = XXH64_Hash(this->pbase(), n, this->hash);
+            this->setp(this->block.data(), this->block.data() + this->block.size());
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            this->digest_block();
+            if(!traits_type::eq_int_type(c, traits_type::eof())){
+                *(this->pptr()) = traits_type::to_char_type(c);
+                this->pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync() override {
+            this->digest_block();
+            return 0;
+        }
+
+    public:
+        hashing_streambuf() : block(1UL << 20UL) {
+            this->setp(this->block.data(), this->block.data() + this->block.size());
+        }
+
+        uint64_t get_hash(){
+            this->digest_block();
+            return this->hash;
+        }
+};
+
+uint64_t
+Common_Boost_Hash_Drover(const Drover &in){
+    hashing_streambuf hsb;
+    {
+        std::ostream os(&hsb);
+        boost::archive::binary_oarchive ar(os);
+        ar & boost::serialization::make_nvp("dicom_data", in);
+    }
+    return hsb.get_hash();
+}
+
 //------------------
 
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <boost/filesystem/fstream.hpp>
 #include <string>    
@@ -30,6 +31,11 @@ Common_Boost_Serialize_Drover(const Drover &in, std::filesystem::path Filename);
 bool
 Common_Boost_Deserialize_Drover(Drover &out, const std::filesystem::path& Filename);
 
+// Computes a 64-bit hash of the Drover's binary serialization. The serialized form is hashed as it is generated, so
+// it is never held in memory in its entirety. Identical contents produce identical hashes. Throws on failure.
+uint64_t
+Common_Boost_Hash_Drover(const Drover &in);
+
 
 
 // --- Specific Serialization Routines ---
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <iterator>
 #include <list>
 //#include <utility>
 #include <tuple>
@@ -57,7 +58,15 @@ bool Node::operator<(const Node &rhs) const {
 
 Node *
 Node::emplace_child_node(Node &&n){
-    Node *child_node = &( this->children.emplace_back(std::forward<Node>(n)) ); // Requires C++17.
+    // Insert the node after all siblings that do not sort after it. This keeps the children sorted as per the DICOM
+    // standard (and is equivalent to appending and then stable sorting) without re-sorting on every insertion.
+    // Children are typically added in order, so the search begins at the end.
+    auto pos = std::end(this->children);
+    while( (pos != std::begin(this->children))
+    &&     (n < *std::prev(pos)) ){
+        --pos;
+    }
+    Node *child_node = &( *(this->children.emplace(pos, std::forward<Node>(n))) );
 
     if( (child_node->VR == "MULTI")
     &&  (this->VR != "SQ")
@@ -71,9 +80,7 @@ Node::emplace_child_node(Node &&n){
         // 'peeking' into sibling nodes when nodes are being emitted to a stream.
     }
 
-    this->children.sort(); // Ensure the nodes are sorted as per DICOM standard.
-                           // Note: This enables the DICOM write function to be const.
-
+    // Note: Keeping the children sorted enables the DICOM write function to be const.
     return child_node;
 }
 
@@ -5,10 +5,15 @@
 
 #include <exception>
 #include <fstream>
+#include <deque>
+#include <future>
 #include <list>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>    
+#include <thread>
+#include <vector>
 //#include <cfenv>              //Needed for std::feclearexcept(FE_ALL_EXCEPT).
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -16,13 +21,18 @@
 #include <algorithm>
 #include <cstdlib>            //Needed for exit() calls.
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "Explicator_Cache.h"
+#include "Image_Spill_Store.h"
 #include "Imebra_Shim.h"      //Wrapper for Imebra library. Black-boxed to speed up compilation.
 #include "Structs.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 
+#include "Thread_Pool.h"
+#include "Slice_Sort.h"
+#include "DICOM_File_Loader.h"
+
 
 static
 std::unique_ptr<Contour_Data>
@@ -35,10 +45,100 @@ Concatenate_Contour_Data(std::unique_ptr<Contour_Data> A,
 }
 
 
+struct dicom_file_load_pool::impl {
+    std::deque<std::future<dicom_file_load_result>> results;
+    asio_thread_pool tp; // Declared last so outstanding tasks complete before the results are destroyed.
+
+    explicit impl(size_t num_threads) : tp(num_threads) {}
+};
+
+dicom_file_load_pool::dicom_file_load_pool(size_t num_threads) : pimpl(std::make_unique<impl>(num_threads)) {}
+
+dicom_file_load_pool::~dicom_file_load_pool() = default;
+
+static dicom_file_load_result
+load_dicom_file(const std::string &filename,
+                const std::string &modality_hint,
+                bool load_unrecognized_as_image){
+    dicom_file_load_result out;
+    out.filename = filename;
+    out.modality = modality_hint;
+    if(out.modality.empty()){
+        try{
+            out.modality = get_modality(filename);
+        }catch(const std::exception &e){
+            FUNCWARN("Unable to extract modality ('" << e.what() << "')");
+        }
+    }
+    const auto &Modality = out.modality;
+
+    using kind = dicom_file_load_result::kind;
+    if( boost::iequals(Modality,"RTRECORD")
+    ||  boost::iequals(Modality,"REG") ){
+        out.type = kind::unsupported;
+    }else if(boost::iequals(Modality,"RTPLAN")){
+        out.type = kind::tplan;
+    }else if(boost::iequals(Modality,"RTSTRUCT")){
+        out.type = kind::contours;
+    }else if(boost::iequals(Modality,"RTDOSE")){
+        out.type = kind::dose;
+    }else if(  boost::iequals(Modality,"CT")
+            || boost::iequals(Modality,"OT")
+            || boost::iequals(Modality,"US")
+            || boost::iequals(Modality,"MR")
+            || boost::iequals(Modality,"RTIMAGE")
+            || boost::iequals(Modality,"PT")
+            || load_unrecognized_as_image ){
+        out.type = kind::images;
+    }
+
+    try{
+        if(out.type == kind::tplan){
+            out.tplan_data = Load_TPlan_Config(filename);
+        }else if(out.type == kind::contours){
+            out.contour_data = get_Contour_Data(filename);
+        }else if(out.type == kind::dose){
+            out.image_data = Load_Dose_Array(filename);
+        }else if(out.type == kind::images){
+            out.image_data = Load_Image_Array(filename);
+        }
+    }catch(const std::exception &){
+        out.error = std::current_exception();
+    }
+    return out;
+}
+
+void dicom_file_load_pool::submit(const std::string &filename,
+                                  const std::string &modality,
+                                  bool load_unrecognized_as_image){
+    // Handlers must be copyable, so the promise is shared.
+    auto p = std::make_shared<std::promise<dicom_file_load_result>>();
+    this->pimpl->results.emplace_back( p->get_future() );
+    this->pimpl->tp.submit_task([p, filename, modality, load_unrecognized_as_image]() -> void {
+        p->set_value( load_dicom_file(filename, modality, load_unrecognized_as_image) );
+    });
+    return;
+}
+
+size_t dicom_file_load_pool::pending() const {
+    return this->pimpl->results.size();
+}
+
+dicom_file_load_result dicom_file_load_pool::next(){
+    if(this->pimpl->results.empty()){
+        throw std::logic_error("No outstanding files to retrieve");
+    }
+    auto f = std::move(this->pimpl->results.front());
+    this->pimpl->results.pop_front();
+    return f.get();
+}
+
+
 bool Load_From_DICOM_Files( Drover &DICOM_data,
                             const std::map<std::string,std::string> & /* InvocationMetadata */,
                             const std::string &FilenameLex,
-                            std::list<std::filesystem::path> &Filenames ){
+                            std::list<std::filesystem::path> &Filenames,
+                            const dicom_load_options &options ){
 
     //This routine will attempt to load DICOM files on an individual file basis. Files that are not successfully loaded
     // are not consumed so that they can be passed on to the next loading stage as needed. 
@@ -52,58 +152,73 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
     std::list<loaded_imgs_storage_t> loaded_imgs_storage;
     using loaded_dose_storage_t = decltype(DICOM_data.image_data);
     std::list<loaded_dose_storage_t> loaded_dose_storage;
-    std::shared_ptr<Contour_Data> loaded_contour_data_storage = std::make_shared<Contour_Data>();
+    std::unique_ptr<Contour_Data> loaded_contour_data_storage = std::make_unique<Contour_Data>();
 
     //This routine currently assumes ALL image files are part of the same image set. Same for dose files.
     // (To change this behaviour, it will suffice to emplace_back() the storage lists as needed.)
     loaded_imgs_storage.emplace_back();
     loaded_dose_storage.emplace_back();
 
+    //When spilling, images are collated as they are loaded so each can be handed to the spill store immediately.
+    std::shared_ptr<Image_Array> spilled_imgs;
+    if(0 < options.spill_budget_bytes){
+        spilled_imgs = std::make_shared<Image_Array>();
+        spilled_imgs->spill_store = std::make_shared<Image_Spill_Store>( options.spill_directory,
+                                                                         options.spill_budget_bytes );
+    }
+
     size_t i = 0;
     const size_t N = Filenames.size();
 
+    //Files are parsed concurrently, but consumed in order. Parsed images cannot be spilled until they are consumed, so
+    // when spilling only a few files are parsed ahead.
+    dicom_file_load_pool pool;
+    const size_t read_ahead = (spilled_imgs == nullptr) ? N
+                            : 2 * std::max<size_t>(1, std::thread::hardware_concurrency());
+    auto sfit = Filenames.begin();
+    const auto submit_files = [&](){
+        while( (sfit != Filenames.end())
+        &&     (pool.pending() < read_ahead) ){
+            pool.submit(sfit->string());
+            ++sfit;
+        }
+    };
+    submit_files();
+
+    using kind = dicom_file_load_result::kind;
     auto bfit = Filenames.begin();
     while(bfit != Filenames.end()){
         FUNCINFO("Parsing file #" << i+1 << "/" << N << " = " << 100*(i+1)/N << "% \t" << *bfit);
         ++i;
 
-        const auto Filename = bfit->string();
-        std::string Modality;
-        try{
-            Modality = get_modality(Filename);
-        }catch(const std::exception &e){
-            FUNCWARN("Unable to extract modality ('" << e.what() << "')");
-            Modality = "";
-        };
+        submit_files();
+        auto res = pool.next();
+        const auto &Filename = res.filename;
 
-        if(boost::iequals(Modality,"RTRECORD")){
-            FUNCWARN("RTRECORD file encountered. "
-                     "DICOMautomaton currently is not equipped to read RTRECORD-modality DICOM files. "
+        if(res.type == kind::unsupported){
+            FUNCWARN(res.modality << " file encountered. "
+                     "DICOMautomaton currently is not equipped to read " << res.modality << "-modality DICOM files. "
                      "Disregarding it");
 
             bfit = Filenames.erase( bfit );  // Consume the file; we know what it is, but cannot make use of it.
 
-        }else if(boost::iequals(Modality,"REG")){
-            FUNCWARN("REG file encountered. "
-                     "DICOMautomaton currently is not equipped to read REG-modality DICOM files. "
-                     "Disregarding it");
-
-            bfit = Filenames.erase( bfit );  // Consume the file; we know what it is, but cannot make use of it.
-
-        }else if(boost::iequals(Modality,"RTPLAN")){
+        }else if(res.type == kind::tplan){
             FUNCWARN("RTPLAN file support is experimental");
+            if(res.error) std::rethrow_exception(res.error);
 
-            auto tplan = Load_TPlan_Config(Filename);
-            DICOM_data.tplan_data.emplace_back( std::move(tplan) );
+            DICOM_data.tplan_data.emplace_back( std::move(res.tplan_data) );
 
             bfit = Filenames.erase( bfit ); 
 
-        }else if(boost::iequals(Modality,"RTSTRUCT")){
+        }else if(res.type == kind::contours){
             const auto preloadcount = loaded_contour_data_storage->ccs.size();
             try{
-                auto combined = Concatenate_Contour_Data( loaded_contour_data_storage->Duplicate(),
-                                                          get_Contour_Data(Filename));
-                loaded_contour_data_storage = std::move(combined);
+                if(res.error) std::rethrow_exception(res.error);
+                if(res.contour_data == nullptr) throw std::runtime_error("No contour data was loaded");
+
+                // Contours are moved rather than copied, so loading many structure sets remains linear.
+                loaded_contour_data_storage->ccs.splice( std::end(loaded_contour_data_storage->ccs),
+                                                         res.contour_data->ccs );
 
             }catch(const std::exception &e){
                 FUNCWARN("Difficulty encountered during contour data loading: '" << e.what() << "'. Ignoring file and continuing");
@@ -123,9 +238,10 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
 
             bfit = Filenames.erase( bfit ); 
 
-        }else if(boost::iequals(Modality,"RTDOSE")){
+        }else if(res.type == kind::dose){
             try{
-                loaded_dose_storage.back().push_back( Load_Dose_Array(Filename));
+                if(res.error) std::rethrow_exception(res.error);
+                loaded_dose_storage.back().push_back( std::move(res.image_data) );
             }catch(const std::exception &e){
                 FUNCWARN("Difficulty encountered during dose array loading: '" << e.what() << "'. Ignoring file and continuing");
                 //loaded_dose_storage.back().pop_back();
@@ -135,15 +251,10 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
 
             bfit = Filenames.erase( bfit ); 
 
-        }else if(  boost::iequals(Modality,"CT")
-                || boost::iequals(Modality,"OT")
-                || boost::iequals(Modality,"US")
-                || boost::iequals(Modality,"MR")
-                || boost::iequals(Modality,"RTIMAGE")
-                || boost::iequals(Modality,"PT") ){
-
+        }else if(res.type == kind::images){
             try{
-                loaded_imgs_storage.back().push_back( Load_Image_Array(Filename));
+                if(res.error) std::rethrow_exception(res.error);
+                loaded_imgs_storage.back().push_back( std::move(res.image_data) );
             }catch(const std::exception &e){
                 FUNCWARN("Difficulty encountered during image array loading: '" << e.what() << "'. Ignoring file and continuing");
                 //loaded_imgs_storage.back().pop_back();
@@ -168,6 +279,17 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
             //loaded_imgs_storage.back().back()->imagecoll.images.back().metadata["dt"] = "0.0";
             // ... more metadata operations ...
 
+            if(spilled_imgs != nullptr){
+                const bool GeometricalOverlapOK = true;
+                if(!spilled_imgs->imagecoll.Collate_Images(loaded_imgs_storage.back().back()->imagecoll,
+                                                           GeometricalOverlapOK)){
+                    FUNCWARN("Unable to collate images. It is possible to continue, but only if you are able to handle this case");
+                    return false;
+                }
+                loaded_imgs_storage.back().pop_back();
+                spilled_imgs->spill_store->manage( spilled_imgs->imagecoll.images.back() );
+            }
+
         }else{
             //Skip the file. It might be destined for some other loader.
             ++bfit;
@@ -181,23 +303,39 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
 
     // ----------------------------------------------- Post-processing -----------------------------------------------
 
-    //Attempt contour name normalization using the selected lexicon.
+    //Attempt contour name normalization using the selected lexicon. Distinct names are normalized concurrently and
+    // only once.
     {
-        Explicator X(FilenameLex);
+        std::vector<std::string> ROINames;
         for(auto & cc : loaded_contour_data_storage->ccs){
              for(auto & c : cc.contours){
-                 const auto NormalizedROIName = X(c.metadata["ROIName"]); //Could be cached, externally or internally.
-                 c.metadata["NormalizedROIName"] = NormalizedROIName;
+                 ROINames.push_back(c.metadata["ROIName"]);
+             }
+        }
+        const auto NormalizedROINames = Explicate(FilenameLex, ROINames);
+
+        size_t i = 0;
+        for(auto & cc : loaded_contour_data_storage->ccs){
+             for(auto & c : cc.contours){
+                 c.metadata["NormalizedROIName"] = NormalizedROINames.at(i++);
              }
         }
     }
 
     //Concatenate contour data into the Drover instance.
+    //
+    // Existing contour data may be shared with other Drover instances, in which case it is copied rather than modified.
     {
-        if(DICOM_data.contour_data == nullptr) DICOM_data.contour_data = std::make_shared<Contour_Data>();
-        auto combined = Concatenate_Contour_Data( DICOM_data.contour_data->Duplicate(),
-                                                  loaded_contour_data_storage->Duplicate());
-        DICOM_data.contour_data = std::move(combined);
+        if(DICOM_data.contour_data == nullptr){
+            DICOM_data.contour_data = std::move(loaded_contour_data_storage);
+        }else if(DICOM_data.contour_data.use_count() == 1){
+            DICOM_data.contour_data->ccs.splice( std::end(DICOM_data.contour_data->ccs),
+                                                 loaded_contour_data_storage->ccs );
+        }else{
+            auto combined = Concatenate_Contour_Data( DICOM_data.contour_data->Duplicate(),
+                                                      std::move(loaded_contour_data_storage) );
+            DICOM_data.contour_data = std::move(combined);
+        }
     }
 
     //Collate each group of images into a single set, if possible. Also stuff the correct contour data in the same set.
@@ -213,6 +351,12 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
 
         DICOM_data.image_data.emplace_back(std::move(collated_imgs));
     }
+    if( (spilled_imgs != nullptr)
+    &&  !spilled_imgs->imagecoll.images.empty() ){
+        FUNCINFO("Spilled " << spilled_imgs->spill_store->get_page_out_count() << " images to disk while loading; "
+                 << spilled_imgs->spill_store->get_resident_bytes() << " bytes of voxel data remain resident");
+        DICOM_data.image_data.emplace_back(spilled_imgs);
+    }
     FUNCINFO("Number of image set groups currently loaded = " << DICOM_data.image_data.size());
 
     for(auto &loaded_dose_set : loaded_dose_storage){
@@ -237,14 +381,21 @@ bool Load_From_DICOM_Files( Drover &DICOM_data,
 
 
     //Sort the images in some reasonable way (opposed to the order they were located on disk -- arbitrary).
+    //
+    // Sort keys are extracted once per image and a single composite-key sort is performed. The order is the same as
+    // consecutive stable sorts on InstanceNumber, SliceLocation, Modality, and PatientID.
     if(true){
+        using img_t = planar_image<float,double>;
+        const auto extract_key = [](const img_t &img) -> slice_sort_key {
+            slice_sort_key k;
+            k.patient_id      = img.GetMetadataValueAs<std::string>("PatientID");
+            k.modality        = img.GetMetadataValueAs<std::string>("Modality");
+            k.slice_location  = img.GetMetadataValueAs<double>("SliceLocation");
+            k.instance_number = img.GetMetadataValueAs<long int>("InstanceNumber");
+            return k;
+        };
         for(auto & img_arr_ptr : DICOM_data.image_data){
-            img_arr_ptr->imagecoll.Stable_Sort_on_Metadata_Keys_Value_Numeric<long int>("InstanceNumber");
-            img_arr_ptr->imagecoll.Stable_Sort_on_Metadata_Keys_Value_Numeric<double>("SliceLocation");
-            //img_arr_ptr->imagecoll.Stable_Sort_on_Metadata_Keys_Value_Numeric<double>("dt");
-
-            img_arr_ptr->imagecoll.Stable_Sort_on_Metadata_Keys_Value_Lexicographic("Modality");
-            img_arr_ptr->imagecoll.Stable_Sort_on_Metadata_Keys_Value_Lexicographic("PatientID");
+            stable_sort_by_extracted_key(img_arr_ptr->imagecoll.images, extract_key);
         }
     }
 
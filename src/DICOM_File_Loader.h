@@ -2,15 +2,78 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>    
 #include <map>
 #include <list>
+#include <memory>
+#include <exception>
 
 #include <filesystem>
 
 #include "Structs.h"
 
+// Options controlling how DICOM files are loaded.
+struct dicom_load_options {
+    // If non-zero, image voxel data is paged to disk as images are loaded whenever the voxel data held in memory for an
+    // image array would exceed this budget (in bytes), so series larger than the available memory can be loaded. The
+    // spilled images remain managed by the image array's spill store; see Image_Spill_Store.h.
+    size_t spill_budget_bytes = 0;
+
+    // The directory in which spill files are written. If empty, the system temporary directory is used.
+    std::filesystem::path spill_directory;
+};
+
 bool Load_From_DICOM_Files( Drover &DICOM_data,
                             const std::map<std::string,std::string> &InvocationMetadata,
                             const std::string &FilenameLex,
-                            std::list<std::filesystem::path> &Filenames );
+                            std::list<std::filesystem::path> &Filenames,
+                            const dicom_load_options &options = dicom_load_options() );
+
+
+// The outcome of loading a single DICOM file with a dicom_file_load_pool.
+struct dicom_file_load_result {
+    enum class kind {
+        unrecognized,  // The modality is not handled by this loader. The file was not loaded.
+        unsupported,   // The modality is recognized, but cannot be used (e.g., RTRECORD). The file was not loaded.
+        tplan,
+        contours,
+        dose,
+        images,
+    } type = kind::unrecognized;
+
+    std::string filename;
+    std::string modality;
+
+    std::unique_ptr<TPlan_Config> tplan_data;
+    std::unique_ptr<Contour_Data> contour_data;
+    std::unique_ptr<Image_Array> image_data; // Both dose and images.
+
+    std::exception_ptr error; // Set if the file was recognized, but could not be loaded.
+};
+
+// Loads DICOM files concurrently using a thread pool.
+//
+// Files are loaded as soon as they are submitted, but results are retrieved in submission order so that the (often
+// order-dependent) post-processing performed by the caller is unaffected by the concurrency.
+class dicom_file_load_pool {
+  private:
+    struct impl;
+    std::unique_ptr<impl> pimpl;
+
+  public:
+    explicit dicom_file_load_pool(size_t num_threads = 0); // Zero selects the hardware concurrency.
+    ~dicom_file_load_pool();
+
+    // Enqueue a file for loading. If the modality is not provided it is read from the file. Files with unrecognized
+    // modalities are only loaded if 'load_unrecognized_as_image' is true.
+    void submit(const std::string &filename,
+                const std::string &modality = "",
+                bool load_unrecognized_as_image = false);
+
+    // The number of submitted files whose results have not yet been retrieved.
+    size_t pending() const;
+
+    // Retrieve the result for the earliest-submitted outstanding file, waiting for it if necessary.
+    dicom_file_load_result next();
+};
@@ -0,0 +1,264 @@
+//DICOMautomaton_Bench.cc - A part of DICOMautomaton 2021. Written by hal clark.
+//
+// This program times a collection of core operations on synthetic data so that performance can be tracked between
+// commits. Results are written as JSON.
+//
+
+#include <chrono>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "YgorArguments.h"    //Needed for ArgumentHandler class.
+#include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
+#include "YgorString.h"
+
+#include "Structs.h"
+#include "Lexicon_Loader.h"
+#include "Operation_Dispatcher.h"
+#include "Benchmark_Harness.h"
+#include "DCMA_Version.h"
+
+
+// Runs a sequence of operations, each specified as on the command line (e.g., "SomeOperation:keyA=valueA").
+static
+void run_operations(Drover &DICOM_data,
+                    const std::string &FilenameLex,
+                    const std::vector<std::string> &ops){
+    std::list<OperationArgPkg> Operations;
+    for(const auto &op : ops) Operations.emplace_back(op);
+
+    const std::map<std::string,std::string> InvocationMetadata;
+    if(!Operation_Dispatcher(DICOM_data, InvocationMetadata, FilenameLex, Operations)){
+        throw std::runtime_error("Operation failed");
+    }
+    return;
+}
+
+int main(int argc, char* argv[]){
+    long int Repetitions = 5;
+    long int Warmups = 1;
+    std::string Filter = ".*";
+    std::string OutputFilename = "dcma_bench.json";
+    std::string FilenameLex;
+    bool ListOnly = false;
+
+    class ArgumentHandler arger;
+    arger.examples = { { "--help",
+                         "Show the help screen and some info about the program." },
+                       { "-n 10 -o results.json",
+                         "Run all benchmarks ten times each and write the timings to 'results.json'." },
+                       { "-f 'dicom|serial' -n 3",
+                         "Run only the benchmarks whose names match the given regex." } };
+    arger.description = "A program for timing core DICOMautomaton routines on synthetic data. Version: "_s + DCMA_VERSION_STR;
+
+    arger.default_callback = [](int, const std::string &optarg) -> void {
+      FUNCERR("Unrecognized option with argument: '" << optarg << "'");
+      return;
+    };
+    arger.optionless_callback = [](const std::string &optarg) -> void {
+      FUNCERR("Unrecognized option: '" << optarg << "'");
+      return;
+    };
+
+    arger.push_back( ygor_arg_handlr_t(1, 'n', "repetitions", true, "5",
+      "The number of timed repetitions of each benchmark.",
+      [&](const std::string &optarg) -> void {
+        Repetitions = std::stol(optarg);
+        return;
+      })
+    );
+    arger.push_back( ygor_arg_handlr_t(1, 'w', "warmups", true, "1",
+      "The number of untimed repetitions of each benchmark performed before timing.",
+      [&](const std::string &optarg) -> void {
+        Warmups = std::stol(optarg);
+        return;
+      })
+    );
+    arger.push_back( ygor_arg_handlr_t(1, 'f', "filter", true, ".*",
+      "Only benchmarks with names matching this regex are run.",
+      [&](const std::string &optarg) -> void {
+        Filter = optarg;
+        return;
+      })
+    );
+    arger.push_back( ygor_arg_handlr_t(1, 'o', "output", true, "dcma_bench.json",
+      "The file the JSON results are written to. Use '-' for stdout.",
+      [&](const std::string &optarg) -> void {
+        OutputFilename = optarg;
+        return;
+      })
+    );
+    arger.push_back( ygor_arg_handlr_t(1, 'L', "list", false, "",
+      "List the available benchmarks and quit.",
+      [&](const std::string &) -> void {
+        ListOnly = true;
+        return;
+      })
+    );
+    arger.push_back( ygor_arg_handlr_t(1, 'l', "lexicon", true, "<best guess>",
+      "Lexicon file for normalizing ROI contour names.",
+      [&](const std::string &optarg) -> void {
+        FilenameLex = optarg;
+        return;
+      })
+    );
+    arger.Launch(argc, argv);
+
+    if(FilenameLex.empty()) FilenameLex = Locate_Lexicon_File();
+    if(FilenameLex.empty()) FilenameLex = Create_Default_Lexicon_File();
+
+    const auto work_dir = std::filesystem::temp_directory_path() / "dcma_bench";
+    std::filesystem::create_directories(work_dir);
+
+    // ---------------------------------------------- Fixtures -----------------------------------------------------
+    // Fixtures are generated by operations so they are reproducible across machines and commits.
+    const std::vector<std::string> ct_fixture = {
+        "GenerateSyntheticImages:NumberOfImages=100:NumberOfRows=256:NumberOfColumns=256:VoxelValue=0.0:StipleValue=100.0" };
+    const std::vector<std::string> small_ct_fixture = {
+        "GenerateSyntheticImages:NumberOfImages=20:NumberOfRows=64:NumberOfColumns=64:VoxelValue=0.0:StipleValue=100.0" };
+    const std::vector<std::string> sphere_fixture = {
+        "GenerateVirtualDataImageSphereV1" };
+    const std::vector<std::string> contoured_sphere_fixture = {
+        "GenerateVirtualDataImageSphereV1",
+        "ContourViaThreshold:ImageSelection=last:ROILabel=sphere:Lower=0.5:Method=marching-squares" };
+    const std::vector<std::string> dose_fixture = {
+        "GenerateVirtualDataDoseStairsV1",
+        "GenerateVirtualDataDoseStairsV1" };
+
+    const auto dicom_archive = (work_dir / "bench_CTs.tgz").string();
+    const auto serial_archive = (work_dir / "bench_drover.xml.gz").string();
+
+    // Each benchmark operates on a fresh Drover, populated by the setup routine.
+    Drover DICOM_data;
+    const auto with_fixture = [&](const std::vector<std::string> &fixture) -> std::function<void()> {
+        return [&,fixture]() -> void {
+            DICOM_data = Drover();
+            run_operations(DICOM_data, FilenameLex, fixture);
+        };
+    };
+    const auto timing = [&](const std::vector<std::string> &ops) -> std::function<void()> {
+        return [&,ops]() -> void {
+            run_operations(DICOM_data, FilenameLex, ops);
+        };
+    };
+
+    std::vector<benchmark_case> cases;
+    cases.push_back( { "dicom_load",
+                       [&]() -> void {
+                           if(!std::filesystem::exists(dicom_archive)){
+                               Drover d;
+                               run_operations(d, FilenameLex, ct_fixture);
+                               run_operations(d, FilenameLex, { "DICOMExportImagesAsCT:ImageSelection=last:Filename=" + dicom_archive });
+                           }
+                           DICOM_data = Drover();
+                       },
+                       timing({ "LoadFiles:FileName=" + dicom_archive }) } );
+
+    cases.push_back( { "dvh",
+                       with_fixture(contoured_sphere_fixture),
+                       timing({ "ExtractImageHistograms:ImageSelection=last" }) } );
+
+    cases.push_back( { "bounded_dose_dvh",
+                       with_fixture({ "GenerateVirtualDataDoseStairsV1",
+                                      "ContourWholeImages:ImageSelection=last:ROILabel=everything" }),
+                       [&]() -> void {
+                           const auto dvh = DICOM_data.Get_DVH();
+                           if(dvh.empty()) throw std::runtime_error("DVH was empty");
+                       } } );
+
+    cases.push_back( { "contour_via_threshold",
+                       with_fixture(sphere_fixture),
+                       timing({ "ContourViaThreshold:ImageSelection=last:ROILabel=bench:Lower=0.5:Method=marching-squares" }) } );
+
+#ifdef DCMA_USE_CGAL
+    cases.push_back( { "marching_cubes",
+                       with_fixture(sphere_fixture),
+                       timing({ "ContourViaThreshold:ImageSelection=last:ROILabel=bench:Lower=0.5:Method=marching-cubes" }) } );
+#endif // DCMA_USE_CGAL
+
+    cases.push_back( { "volumetric_neighbourhood_blur",
+                       with_fixture(ct_fixture),
+                       timing({ "VolumetricSpatialBlur:ImageSelection=last:Estimator=Gaussian" }) } );
+
+    cases.push_back( { "pointwise_chain",
+                       with_fixture(ct_fixture),
+                       timing({ "PreFilterEnormousCTValues",
+                                "ConvertNaNsToAir",
+                                "NegatePixels:ImageSelection=all",
+                                "LogScale:ImageSelection=all",
+                                "ConvertNaNsToZeros" }) } );
+
+    cases.push_back( { "compare_images_gamma",
+                       with_fixture({ small_ct_fixture.front(), "CopyImages:ImageSelection=last" }),
+                       timing({ "ComparePixels:ImageSelection=first:ReferenceImageSelection=last:Method=gamma-index" }) } );
+
+    cases.push_back( { "meld_dose",
+                       with_fixture(dose_fixture),
+                       timing({ "MeldDose" }) } );
+
+#ifdef DCMA_USE_EIGEN
+    cases.push_back( { "tps_warp",
+                       with_fixture({ "GenerateSyntheticImages:NumberOfImages=5:NumberOfRows=10:NumberOfColumns=10:VoxelValue=1.0",
+                                      "ConvertPixelsToPoints:ImageSelection=last:Label=moving",
+                                      "ConvertPixelsToPoints:ImageSelection=last:Label=stationary" }),
+                       timing({ "ExtractPointsWarp:MovingPointSelection=first:ReferencePointSelection=last:Method=TPS" }) } );
+#endif // DCMA_USE_EIGEN
+
+    cases.push_back( { "serialization",
+                       with_fixture(ct_fixture),
+                       timing({ "BoostSerializeDrover:Filename=" + serial_archive + ":Components=images" }) } );
+
+    // ---------------------------------------------- Execution ----------------------------------------------------
+    const std::regex filter(Filter, std::regex::icase | std::regex::nosubs | std::regex::extended);
+    if(ListOnly){
+        for(const auto &bc : cases) std::cout << bc.name << std::endl;
+        return 0;
+    }
+
+    std::vector<benchmark_result> results;
+    try{
+        for(const auto &bc : cases){
+            if(!std::regex_search(bc.name, filter)) continue;
+            FUNCINFO("Running benchmark '" << bc.name << "'");
+            results.push_back( run_benchmark(bc, Repetitions, Warmups) );
+            FUNCINFO("Benchmark '" << bc.name << "' median time: " << results.back().median << " s");
+        }
+    }catch(const std::exception &e){
+        FUNCWARN("Benchmark failed: '" << e.what() << "'");
+        return 1;
+    }
+
+    std::map<std::string, std::string> context;
+    context["version"] = DCMA_VERSION_STR;
+    context["date"] = std::to_string( std::chrono::duration_cast<std::chrono::seconds>(
+                                          std::chrono::system_clock::now().time_since_epoch()).count() );
+    context["num_cpus"] = std::to_string(std::thread::hardware_concurrency());
+    context["repetitions"] = std::to_string(Repetitions);
+    context["warmups"] = std::to_string(Warmups);
+
+    if(OutputFilename == "-"){
+        write_benchmarks_json(std::cout, context, results);
+    }else{
+        std::ofstream FO(OutputFilename);
+        write_benchmarks_json(FO, context, results);
+        if(!FO){
+            FUNCWARN("Unable to write results to '" << OutputFilename << "'");
+            return 1;
+        }
+        FUNCINFO("Results written to '" << OutputFilename << "'");
+    }
+
+    std::filesystem::remove_all(work_dir);
+    return 0;
+}
+
@@ -3,6 +3,8 @@
 // This program provides a standard entry-point into some DICOMautomaton analysis routines.
 //
 
+#include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <iostream>
@@ -26,10 +28,12 @@
 
 #include "Documentation.h"
 #include "PACS_Loader.h"
+#include "DICOM_File_Loader.h"
 #include "File_Loader.h"
 #include "Lexicon_Loader.h"
 
 #include "Operation_Dispatcher.h"
+#include "Operation_Result_Cache.h"
 #include "DCMA_Version.h"
 
 //extern const std::string DCMA_VERSION_STR;
@@ -57,6 +61,11 @@ int main(int argc, char* argv[]){
     // loaded DICOM data. Things like volunteer tracking numbers, information from imaging/scanning sessions, etc..
     std::map<std::string,std::string> InvocationMetadata;
 
+    //Directory in which operation results are cached, and the maximum size of the cache (in MiB). Results are only
+    // cached when a directory is provided.
+    std::string ResultCacheDir;
+    long int ResultCacheSizeMiB = 10240;
+
     //Operations to perform on the data.
     std::list<OperationArgPkg> Operations;
     long int OperationDepth = 0;
@@ -64,6 +73,9 @@ int main(int argc, char* argv[]){
     //A explicit declaration that the user will generate data in an operation.
     bool GeneratingVirtualData = false;
 
+    //Options for loading DICOM files, e.g., whether image voxel data should be spilled to disk while loading.
+    dicom_load_options DICOMLoadOptions;
+
     //A Boolean guard variable to ensure loose parameters are only added to valid, active operations.
     bool MostRecentOperationActive = false;
 
@@ -153,6 +165,26 @@ int main(int argc, char* argv[]){
       })
     );
  
+    arger.push_back( ygor_arg_handlr_t(110, 'c', "cache-directory", true, "/tmp/dcma_cache/",
+      "Cache the state of all loaded data at every 'CacheCheckpoint' operation in this directory. When the same data"
+      " are loaded and the same operations are specified again, processing resumes from the latest checkpoint that"
+      " precedes the first altered operation. Operations with side-effects (e.g., writing files or interacting with"
+      " the user), and all operations following them, are always performed. Files and directories that operations"
+      " read are checked for modifications.",
+      [&](const std::string &optarg) -> void {
+        ResultCacheDir = optarg;
+        return;
+      })
+    );
+ 
+    arger.push_back( ygor_arg_handlr_t(111, 'C', "cache-size", true, "10240",
+      "The maximum size of the operation result cache, in MiB. Least-recently-used results are removed as needed.",
+      [&](const std::string &optarg) -> void {
+        ResultCacheSizeMiB = std::stol(optarg);
+        return;
+      })
+    );
+ 
 #ifdef DCMA_USE_POSTGRES
     arger.push_back( ygor_arg_handlr_t(210, 'd', "database-parameters", true, db_connection_params,
       "PostgreSQL database connection settings to use for PACS database.",
@@ -198,6 +230,28 @@ int main(int argc, char* argv[]){
       })
     );
 
+    arger.push_back( ygor_arg_handlr_t(240, 'b', "spill-budget", true, "4096",
+      "Page image voxel data to disk while loading DICOM files whenever the voxel data held in memory for an image"
+      " array would exceed this budget, in MiB. Series larger than the available memory can then be loaded. Operations"
+      " that do not support spilled images restore them to memory before they are performed; see the"
+      " 'SpillImagesToDisk' operation for details. Spilling is disabled by default.",
+      [&](const std::string &optarg) -> void {
+        const auto budget = std::stod(optarg);
+        if(!(0.0 < budget)) FUNCERR("Spill budget must be positive: '" << optarg << "'");
+        DICOMLoadOptions.spill_budget_bytes = static_cast<size_t>(budget * 1024.0 * 1024.0);
+        return;
+      })
+    );
+
+    arger.push_back( ygor_arg_handlr_t(241, 'B', "spill-directory", true, "/tmp/",
+      "The directory in which spill files are written when spilling image voxel data during loading. A unique"
+      " subdirectory is created and removed when no longer needed. The system temporary directory is used by default.",
+      [&](const std::string &optarg) -> void {
+        DICOMLoadOptions.spill_directory = optarg;
+        return;
+      })
+    );
+
     arger.push_back( ygor_arg_handlr_t(300, 'm', "metadata", true, "'Volunteer=01'",
       "Metadata key-value pairs which are tacked onto results destined for a database. "
       "If there is an conflicting key-value pair, the values are concatenated.",
@@ -384,7 +438,8 @@ int main(int argc, char* argv[]){
     //Standalone file loading.
     {
         std::list<OperationArgPkg> l_Operations;
-        if(!Load_Files(DICOM_data, InvocationMetadata, FilenameLex, l_Operations, StandaloneFilesDirsReachable)){
+        if(!Load_Files(DICOM_data, InvocationMetadata, FilenameLex, l_Operations, StandaloneFilesDirsReachable,
+                       DICOMLoadOptions)){
 #ifdef DCMA_FUZZ_TESTING
             // If file loading failed, then the loader successfully rejected bad data. Terminate to indicate this success.
             return 0;
@@ -422,7 +477,13 @@ int main(int argc, char* argv[]){
         FUNCERR("No data was loaded, and virtual data switch was not provided. Refusing to proceed");
     }
 
-    if(!Operation_Dispatcher(DICOM_data, InvocationMetadata, FilenameLex, Operations)){
+    std::unique_ptr<Operation_Result_Cache> result_cache;
+    if(!ResultCacheDir.empty()){
+        const auto max_bytes = static_cast<std::uintmax_t>(std::max(0L, ResultCacheSizeMiB)) * 1024UL * 1024UL;
+        result_cache = std::make_unique<Operation_Result_Cache>(ResultCacheDir, max_bytes);
+    }
+
+    if(!Operation_Dispatcher(DICOM_data, InvocationMetadata, FilenameLex, Operations, result_cache.get())){
         FUNCERR("Analysis failed. Cannot continue");
     }
 
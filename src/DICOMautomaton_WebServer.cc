@@ -30,6 +30,7 @@
 #include <Wt/WWidget.h>
 #include <Wt/WAnimation.h>
 #include <Wt/WComboBox.h>
+#include <Wt/WServer.h>
 
 #include <filesystem>
 
@@ -37,6 +38,7 @@
 //#include <cfenv>              //Needed for std::feclearexcept(FE_ALL_EXCEPT).
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <ctime>
 #include <exception>
 #include <fstream>
@@ -57,8 +59,10 @@
 #include "DICOM_File_Loader.h"
 #include "FITS_File_Loader.h"
 #include "XYZ_File_Loader.h"
+#include "Job_Queue.h"
 #include "Lexicon_Loader.h"
 #include "Operation_Dispatcher.h"
+#include "Operation_Monitor.h"
 #include "Structs.h"
 #include "Regex_Selectors.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
@@ -178,10 +182,55 @@ std::string HumanToCamel(std::string in){
     return in;
 }
 
+// Estimate the memory footprint of the data held by a Drover, in bytes. Only bulk data are considered.
+static
+size_t EstimateDroverFootprint(const Drover &DICOM_data){
+    size_t out = 0;
+    for(const auto &ia : DICOM_data.image_data){
+        if(ia == nullptr) continue;
+        for(const auto &img : ia->imagecoll.images){
+            out += img.data.size() * sizeof(float);
+        }
+    }
+    if(DICOM_data.contour_data != nullptr){
+        for(const auto &cc : DICOM_data.contour_data->ccs){
+            for(const auto &c : cc.contours){
+                out += c.points.size() * sizeof(vec3<double>);
+            }
+        }
+    }
+    for(const auto &pc : DICOM_data.point_data){
+        if(pc == nullptr) continue;
+        out += pc->pset.points.size() * sizeof(vec3<double>);
+    }
+    for(const auto &sm : DICOM_data.smesh_data){
+        if(sm == nullptr) continue;
+        out += sm->meshes.vertices.size() * sizeof(vec3<double>);
+        for(const auto &f : sm->meshes.faces) out += f.size() * sizeof(uint64_t);
+    }
+    return out;
+}
+
+// Operations are executed by a single queue shared by all sessions so that concurrent users cannot overwhelm the
+// server. The concurrency and memory budget can be adjusted via environment variables.
+static
+job_queue& GetSharedJobQueue(){
+    static job_queue jq( []() -> size_t {
+                             const char *c = std::getenv("DCMA_WEBSERVER_MAX_CONCURRENT_JOBS");
+                             return (c == nullptr) ? 2 : std::stoul(c);
+                         }(),
+                         []() -> size_t {
+                             const char *c = std::getenv("DCMA_WEBSERVER_MEMORY_BUDGET_MB");
+                             return (c == nullptr) ? 0 : std::stoul(c) * 1024 * 1024;
+                         }() );
+    return jq;
+}
+
 // This class is instanced for each client. It holds all state for a single session.
 class BaseWebServerApplication : public Wt::WApplication {
   public:
     BaseWebServerApplication(const Wt::WEnvironment& env);
+    ~BaseWebServerApplication() override;
 
   private:
 
@@ -210,6 +259,13 @@ class BaseWebServerApplication : public Wt::WApplication {
     std::regex fnameregex   = Compile_Regex(".*filename.*");
     std::regex roiregex     = Compile_Regex(".*roi.*label.*regex.*");
     std::regex normroiregex = Compile_Regex(".*normalized.*roi.*label.*regex.*");
+
+    //The most recently submitted operation and the data it operates on. The job operates on a shallow copy of
+    // DICOM_data asynchronously, so neither DICOM_data nor the copy may be accessed while the job is unfinished. The
+    // copy is adopted when the job finishes. The job does not refer to this session, so the session can be destroyed
+    // while the job is running.
+    std::shared_ptr<job_status> ComputeJob;
+    std::shared_ptr<Drover> ComputeData;
     
     // --------------------- Web widget shared functors ---------------------
 
@@ -220,12 +276,19 @@ class BaseWebServerApplication : public Wt::WApplication {
     void createOperationParamSelectorGB();
     void appendOperationParamsColumn();
     void createComputeGB();
+    void computeUpdated(); //Job progress event.
+    void computeFinished(const std::string &FailureText,
+                         const std::map<std::string,std::shared_ptr<Wt::WFileResource>> &OutputFiles,
+                         const std::map<std::string,std::string> &OutputMimetype); //Post job completion event.
 
 };
 
 
 BaseWebServerApplication::BaseWebServerApplication(const Wt::WEnvironment &env) : Wt::WApplication(env){
 
+    // Enable server push so that job progress can be reported while operations are executing.
+    this->enableUpdates(true);
+
     // Create a private working directory somewhere.
     this->InstancePrivateDirectory = CreateUniqueDirectoryTimestamped("/home/hal/DICOMautomaton_Webserver_Artifacts/", // timestamp goes here
                                                                       "/");
@@ -270,6 +333,14 @@ BaseWebServerApplication::BaseWebServerApplication(const Wt::WEnvironment &env)
 }
 
 
+BaseWebServerApplication::~BaseWebServerApplication(){
+    // The job holds its own copy of the data, so it need not be waited on. It is cancelled so that it stops as soon as
+    // it notices, freeing its place in the job queue.
+    if(this->ComputeJob != nullptr){
+        this->ComputeJob->request_cancellation();
+    }
+}
+
 void BaseWebServerApplication::createFileUploadGB(){
     // This routine creates a file upload box.
 
@@ -991,7 +1062,10 @@ void BaseWebServerApplication::createOperationParamSelectorGB(){
 void BaseWebServerApplication::createComputeGB(){
     // This routine creates a panel to both launch an operation and pass the output to the client.
     //
-    // The actual computation is performed elsewhere -- this routine merely creates the widgets.
+    // The actual computation is performed elsewhere -- this routine merely creates the widgets and submits the job.
+    if( (this->ComputeJob != nullptr) && !this->ComputeJob->is_finished() ){
+        throw std::logic_error("An operation is already in progress. Refusing to launch another.");
+    }
     (void*) root()->addWidget(std::make_unique<Wt::WBreak>());
 
     auto gb = root()->addWidget(std::make_unique<Wt::WGroupBox>("Computation"));
@@ -1005,6 +1079,7 @@ void BaseWebServerApplication::createComputeGB(){
     feedback->setText("<p>Computing now...</p>");
 
     auto sep_break = root()->addWidget(std::make_unique<Wt::WBreak>());
+    sep_break->setObjectName("compute_gb_sep_break");
     sep_break->setCanReceiveFocus(true);
 
     gb->show();
@@ -1025,9 +1100,9 @@ void BaseWebServerApplication::createComputeGB(){
     std::map<std::string,std::shared_ptr<Wt::WFileResource>> OutputFiles;
     std::map<std::string,std::string> OutputFilenames;
     std::map<std::string,std::string> OutputMimetype;
+    std::list<OperationArgPkg> Passes; // One for each column.
     const auto rows = table->rowCount(); 
     const auto cols = table->columnCount(); 
-    bool AllSuccessful = true;
     for(auto col = 1; col < cols; ++col){
         auto op_doc_l = (Known_Operations()[selected_op].first)(); // Documentation parameter list.
         OperationArgPkg op_args(selected_op); // The list of parameters passed to the operation.
@@ -1172,24 +1247,141 @@ void BaseWebServerApplication::createComputeGB(){
             }
         }
 
-        // ---
+        Passes.push_back(op_args);
+    }
+
+    // ---
+
+    //Submit the operation to the shared job queue. Progress is pushed to the client as each operation begins.
+    auto progress = gb->addWidget(std::make_unique<Wt::WProgressBar>());
+    progress->setObjectName("compute_gb_progress");
+    progress->setRange(0.0, 1.0);
+    progress->setValue(0.0);
+
+    auto cancelbutton = gb->addWidget(std::make_unique<Wt::WPushButton>("Cancel"));
+    cancelbutton->setObjectName("compute_gb_cancel");
+    cancelbutton->clicked().connect(std::bind([=](){
+        cancelbutton->disable();
+        if(this->ComputeJob != nullptr) this->ComputeJob->request_cancellation();
+        return;
+    }));
 
-        //Perform the operation.
-        std::list<OperationArgPkg> PackedOperation = { op_args };
-        try{
-            if(!Operation_Dispatcher( this->DICOM_data, 
-                                      this->InvocationMetadata, 
-                                      this->FilenameLex,
-                                      PackedOperation )){
-                throw std::runtime_error("Return value non-zero (non-descript error condition)");
+    // Operations frequently duplicate data, so the footprint is estimated as twice the current data.
+    const auto EstimatedBytes = 2 * EstimateDroverFootprint(this->DICOM_data);
+
+    auto FailureText = std::make_shared<std::string>();
+    const auto SessionId = this->sessionId();
+    const auto N_passes = Passes.size();
+
+    this->ComputeData = std::make_shared<Drover>(this->DICOM_data);
+
+    auto &jq = GetSharedJobQueue();
+    this->ComputeJob = jq.submit(
+        [ComputeData = this->ComputeData,
+         InvocationMetadata = this->InvocationMetadata,
+         FilenameLex = this->FilenameLex,
+         Passes, FailureText, N_passes](job_status &js) -> void {
+            size_t i = 0;
+            for(const auto &op_args : Passes){
+                const auto pass_desc = "Pass "_s + std::to_string(i + 1) + " of "_s + std::to_string(N_passes);
+
+                //Operations poll the monitor for cancellation, and report progress as each operation begins.
+                operation_monitor monitor;
+                monitor.is_cancel_requested = [&js]() -> bool {
+                    return js.is_cancel_requested();
+                };
+                monitor.set_progress = [&js, i, N_passes, pass_desc](double fraction, const std::string &msg) -> void {
+                    js.set_progress( (static_cast<double>(i) + fraction) / static_cast<double>(N_passes),
+                                     pass_desc + ": "_s + msg );
+                };
+
+                //Perform the operation.
+                std::list<OperationArgPkg> PackedOperation = { op_args };
+                try{
+                    Check_For_Operation_Cancellation(&monitor);
+                    if(!Operation_Dispatcher( *ComputeData, 
+                                              InvocationMetadata, 
+                                              FilenameLex,
+                                              PackedOperation,
+                                              nullptr,
+                                              &monitor )){
+                        throw std::runtime_error("Return value non-zero (non-descript error condition)");
+                    }
+                }catch(const operation_cancelled &){
+                    throw job_cancelled("Cancelled during "_s + pass_desc);
+                }catch(const std::exception &e){
+                    *FailureText = "Operation failed: "_s + e.what() + ".";
+                }
+                ++i;
             }
-        }catch(const std::exception &e){
-            feedback->setText("<p>Operation failed: "_s + e.what() + ".</p>");
-            AllSuccessful = false;
-            //return;
-        }
+            return;
+        },
+        EstimatedBytes,
+        [SessionId, OutputFiles, OutputMimetype, FailureText](const job_status &js) -> void {
+            //Called from a worker thread, so the update is handed off to the session's event loop.
+            const bool finished = js.is_finished();
+            Wt::WServer::instance()->post(SessionId, [=]() -> void {
+                auto app = dynamic_cast<BaseWebServerApplication *>(Wt::WApplication::instance());
+                if(app == nullptr) return;
+                if(finished){
+                    app->computeFinished(*FailureText, OutputFiles, OutputMimetype);
+                }else{
+                    app->computeUpdated();
+                }
+                app->triggerUpdate();
+            });
+        });
+
+    this->computeUpdated();
+    return;
+}
+
+void BaseWebServerApplication::computeUpdated(){
+    // This routine reports the progress of the current job.
+    auto feedback = reinterpret_cast<Wt::WText *>( root()->find("compute_gb_feedback") );
+    auto progress = reinterpret_cast<Wt::WProgressBar *>( root()->find("compute_gb_progress") );
+    if((feedback == nullptr) || (progress == nullptr) || (this->ComputeJob == nullptr)) return;
+
+    const auto state = this->ComputeJob->get_state();
+    if(state == job_status::state::queued){
+        const auto N_ahead = GetSharedJobQueue().jobs_ahead_of(this->ComputeJob);
+        feedback->setText("<p>Waiting for "_s + std::to_string(N_ahead) + " other job(s) to start...</p>");
+    }else if(state == job_status::state::running){
+        feedback->setText("<p>Computing now... "_s + this->ComputeJob->get_message() + "</p>");
     }
-    if(AllSuccessful){
+    progress->setValue(this->ComputeJob->get_progress());
+    return;
+}
+
+void BaseWebServerApplication::computeFinished(const std::string &FailureText,
+                                               const std::map<std::string,std::shared_ptr<Wt::WFileResource>> &OutputFiles,
+                                               const std::map<std::string,std::string> &OutputMimetypeIn){
+    // This routine passes the output of a finished job to the client.
+    auto gb = reinterpret_cast<Wt::WGroupBox *>( root()->find("compute_gb") );
+    auto feedback = reinterpret_cast<Wt::WText *>( root()->find("compute_gb_feedback") );
+    auto sep_break = root()->find("compute_gb_sep_break");
+    if( (gb == nullptr) || (feedback == nullptr) || (sep_break == nullptr)
+    ||  (this->ComputeJob == nullptr) || !this->ComputeJob->is_finished() ) return;
+    auto OutputMimetype = OutputMimetypeIn;
+
+    //The job is released so that stale notifications are disregarded. Its data are adopted, even if the job did not
+    // complete.
+    const auto job = this->ComputeJob;
+    this->ComputeJob.reset();
+    if(this->ComputeData != nullptr) this->DICOM_data = *(this->ComputeData);
+    this->ComputeData.reset();
+
+    if(auto w = root()->find("compute_gb_progress")) w->hide();
+    if(auto w = root()->find("compute_gb_cancel")) w->hide();
+
+    const auto state = job->get_state();
+    if(state == job_status::state::cancelled){
+        feedback->setText("<p>Operation cancelled: "_s + job->get_message() + ". Data may have been partially modified.</p>");
+    }else if(state == job_status::state::failed){
+        feedback->setText("<p>Operation failed: "_s + job->get_message() + ".</p>");
+    }else if(!FailureText.empty()){
+        feedback->setText("<p>"_s + FailureText + "</p>");
+    }else{
         feedback->setText("<p>Operation successful.</p>");
     }
 
@@ -1325,7 +1517,10 @@ void BaseWebServerApplication::createComputeGB(){
                                          "op_paramspec_gb_feedback",
 
                                          "compute_gb",
-                                         "compute_gb_feedback" };
+                                         "compute_gb_feedback",
+                                         "compute_gb_progress",
+                                         "compute_gb_cancel",
+                                         "compute_gb_sep_break" };
 
         for(auto &n : named){
             auto w = root()->find(n);
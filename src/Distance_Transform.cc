@@ -0,0 +1,195 @@
+//Distance_Transform.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Thread_Pool.h"
+#include "FFT_Correlation.h"
+#include "Distance_Transform.h"
+
+
+namespace {
+
+// Scratch buffers for the one-dimensional transform, reused for every line processed by a task.
+struct line_buffers {
+    std::vector<double> f;  // Input squared distances.
+    std::vector<double> d;  // Output squared distances.
+    std::vector<long int> v; // Locations of the parabolas forming the lower envelope.
+    std::vector<double> z;  // Boundaries between adjacent parabolas of the lower envelope.
+
+    explicit line_buffers(long int n) : f(n), d(n), v(n), z(n + 1) {}
+};
+
+// One-dimensional squared distance transform: d(p) = min_q( f(q) + w2 * (p - q)^2 ).
+//
+// This is the lower envelope algorithm of Felzenszwalb and Huttenlocher (2012), with infinite samples omitted from the
+// envelope so that lines without any (finite) samples remain infinite.
+void transform_line(line_buffers &b, long int n, double w2){
+    const auto inf = std::numeric_limits<double>::infinity();
+    const auto &f = b.f;
+
+    long int k = -1;
+    for(long int q = 0; q < n; ++q){
+        if(!std::isfinite(f[q])) continue;
+        if(k < 0){
+            k = 0;
+            b.v[0] = q;
+            b.z[0] = -inf;
+            b.z[1] = inf;
+            continue;
+        }
+
+        // Discard parabolas that are dominated by this one. The first parabola's boundary is -inf, so it is never
+        // discarded.
+        const auto intersection = [&](long int vk) -> double {
+            const auto qd = static_cast<double>(q);
+            const auto vd = static_cast<double>(vk);
+            return ((f[q] + w2 * qd * qd) - (f[vk] + w2 * vd * vd)) / (2.0 * w2 * (qd - vd));
+        };
+        auto s = intersection(b.v[k]);
+        while(s <= b.z[k]){
+            --k;
+            s = intersection(b.v[k]);
+        }
+        ++k;
+        b.v[k] = q;
+        b.z[k] = s;
+        b.z[k + 1] = inf;
+    }
+
+    if(k < 0){
+        for(long int p = 0; p < n; ++p) b.d[p] = inf;
+        return;
+    }
+
+    long int j = 0;
+    for(long int p = 0; p < n; ++p){
+        const auto pd = static_cast<double>(p);
+        while(b.z[j + 1] < pd) ++j;
+        const auto dp = pd - static_cast<double>(b.v[j]);
+        b.d[p] = f[b.v[j]] + w2 * dp * dp;
+    }
+    return;
+}
+
+// Transforms every line along the given axis in place. Volume values are squared distances.
+void transform_axis(dense_volume &vol, long int axis, double spacing){
+    // An infinite spacing means distances never propagate along this axis.
+    if(std::isinf(spacing)) return;
+
+    const auto dims = vol.dimensions();
+    const auto n = dims[axis];
+    if(n <= 1) return;
+
+    const long int stride = (axis == 0) ? (vol.rows * vol.columns)
+                          : (axis == 1) ? vol.columns
+                                        : 1L;
+    const auto w2 = spacing * spacing;
+
+    // Lines starting at the given voxel index.
+    const auto transform_lines = [&vol, n, stride, w2](const std::vector<long int> &starts) -> void {
+        line_buffers b(n);
+        for(const auto &start : starts){
+            for(long int p = 0; p < n; ++p) b.f[p] = static_cast<double>(vol.data[start + p * stride]);
+            transform_line(b, n, w2);
+            for(long int p = 0; p < n; ++p) vol.data[start + p * stride] = static_cast<float>(b.d[p]);
+        }
+        return;
+    };
+
+    // Lines are grouped so that each task touches a contiguous block of the volume, when possible.
+    std::vector<std::vector<long int>> groups;
+    if(axis == 0){
+        for(long int r = 0; r < vol.rows; ++r){
+            groups.emplace_back();
+            for(long int c = 0; c < vol.columns; ++c) groups.back().push_back( vol.index(0, r, c) );
+        }
+    }else{
+        for(long int i = 0; i < vol.images; ++i){
+            groups.emplace_back();
+            if(axis == 1){
+                for(long int c = 0; c < vol.columns; ++c) groups.back().push_back( vol.index(i, 0, c) );
+            }else{
+                for(long int r = 0; r < vol.rows; ++r) groups.back().push_back( vol.index(i, r, 0) );
+            }
+        }
+    }
+
+    // Lines are disjoint, so they can be processed concurrently.
+    {
+        asio_thread_pool tp;
+        for(const auto &g : groups){
+            tp.submit_task([&transform_lines,&g]() -> void {
+                transform_lines(g);
+            });
+        }
+    } // Wait for tasks to complete.
+    return;
+}
+
+dense_volume squared_distance_transform(const dense_volume &mask,
+                                        const std::array<double, 3> &spacing,
+                                        bool features_are_nonzero){
+    for(const auto &s : spacing){
+        if( std::isnan(s) || (s <= 0.0) ){
+            throw std::invalid_argument("Voxel spacing must be positive. Cannot continue.");
+        }
+    }
+    if(static_cast<long int>(mask.data.size()) != (mask.images * mask.rows * mask.columns)){
+        throw std::invalid_argument("Volume dimensions do not match the number of voxels. Cannot continue.");
+    }
+
+    const auto inf = std::numeric_limits<float>::infinity();
+    dense_volume out(mask.images, mask.rows, mask.columns);
+    for(size_t i = 0; i < mask.data.size(); ++i){
+        const bool is_feature = ((mask.data[i] != 0.0f) == features_are_nonzero);
+        out.data[i] = (is_feature) ? 0.0f : inf;
+    }
+
+    // The transform is separable, so each axis is processed in turn.
+    transform_axis(out, 2, spacing[2]);
+    transform_axis(out, 1, spacing[1]);
+    transform_axis(out, 0, spacing[0]);
+    return out;
+}
+
+} // namespace
+
+
+dense_volume Euclidean_Distance_Transform(const dense_volume &mask,
+                                          const std::array<double, 3> &spacing){
+    auto out = squared_distance_transform(mask, spacing, true);
+    for(auto &x : out.data) x = std::sqrt(x);
+    return out;
+}
+
+
+dense_volume Signed_Distance_Transform(const dense_volume &mask,
+                                       const std::array<double, 3> &spacing){
+    auto out = squared_distance_transform(mask, spacing, true);
+    const auto interior = squared_distance_transform(mask, spacing, false);
+    for(size_t i = 0; i < out.data.size(); ++i){
+        // At most one of these is non-zero.
+        out.data[i] = std::sqrt(out.data[i]) - std::sqrt(interior.data[i]);
+    }
+    return out;
+}
+
+
+std::array<double, 3> Margin_Scaled_Spacing(const std::array<double, 3> &margin,
+                                            const std::array<double, 3> &spacing){
+    const auto inf = std::numeric_limits<double>::infinity();
+    std::array<double, 3> out;
+    for(size_t a = 0; a < 3; ++a){
+        if( !std::isfinite(margin[a])
+        ||  std::isnan(spacing[a])
+        ||  (spacing[a] <= 0.0) ){
+            throw std::invalid_argument("Margins must be finite and voxel spacing must be positive. Cannot continue.");
+        }
+        out[a] = (margin[a] == 0.0) ? inf : (spacing[a] / (std::abs(margin[a]) + 0.5 * spacing[a]));
+    }
+    return out;
+}
@@ -0,0 +1,39 @@
+//Distance_Transform.h.
+
+#pragma once
+
+#include <array>
+
+#include "FFT_Correlation.h"  //Needed for dense_volume.
+
+
+// Computes the exact Euclidean distance from every voxel centre to the nearest 'feature' voxel centre, where features
+// are voxels with non-zero values.
+//
+// The spacing between adjacent voxel centres is given separately for each of the (image, row, column) axes, so
+// anisotropic grids are supported. An infinite spacing disables propagation along that axis, which is useful for
+// evaluating distances with a per-axis scaled metric. Voxels that no feature can reach are assigned infinity.
+//
+// The transform is evaluated exactly using the separable lower-envelope algorithm of Felzenszwalb and Huttenlocher,
+// taking O(N) time for N voxels. Lines along each axis are processed in parallel.
+dense_volume Euclidean_Distance_Transform(const dense_volume &mask,
+                                          const std::array<double, 3> &spacing);
+
+// Computes a signed distance map: the distance to the nearest feature voxel for non-feature voxels (positive) and the
+// negated distance to the nearest non-feature voxel for feature voxels (negative).
+//
+// Distances are measured between voxel centres, so the zero crossing lies midway between adjacent feature and
+// non-feature voxels and the level set at distance d approximates the feature boundary displaced outward by d.
+dense_volume Signed_Distance_Transform(const dense_volume &mask,
+                                       const std::array<double, 3> &spacing);
+
+// Computes the voxel spacing of a scaled metric in which a (possibly anisotropic) margin boundary becomes the unit level
+// set of a distance map, e.g., 'Signed_Distance_Transform(mask, Margin_Scaled_Spacing(margin, spacing))'.
+//
+// The margin is measured from the boundary of the feature voxels rather than their centres. Since the feature boundary
+// lies midway between voxel centres, each margin is extended by half the voxel spacing along its axis; otherwise the
+// realized margin would fall short by half a voxel. Only the magnitude of the margin is used, so the same spacing
+// applies to growing (positive distances) and shrinking (negative distances). Axes with a zero margin are assigned an
+// infinite spacing, which disconnects them.
+std::array<double, 3> Margin_Scaled_Spacing(const std::array<double, 3> &margin,
+                                            const std::array<double, 3> &spacing);
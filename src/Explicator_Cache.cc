@@ -0,0 +1,216 @@
+//Explicator_Cache.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <exception>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Explicator.h"       //Needed for Explicator class.
+
+#include "Thread_Pool.h"
+
+#include "Explicator_Cache.h"
+
+
+namespace {
+
+// State shared by all users of a single lexicon file.
+struct lexicon_state {
+    std::string lexicon_filename;
+
+    // Explicator instances are stateful, so each is used by one thread at a time. Instances are created on demand, so
+    // a lexicon is parsed at most once per concurrent user.
+    std::mutex instances_mutex;
+    std::list<std::unique_ptr<Explicator>> idle_instances;
+    explicator_cache_stats stats; // Guarded by instances_mutex.
+
+    std::shared_mutex memo_mutex;
+    std::unordered_map<std::string, std::string> memo;
+
+    std::unique_ptr<Explicator> acquire(){
+        {
+            std::lock_guard<std::mutex> lock(this->instances_mutex);
+            if(!this->idle_instances.empty()){
+                auto X = std::move(this->idle_instances.front());
+                this->idle_instances.pop_front();
+                return X;
+            }
+        }
+        auto X = std::make_unique<Explicator>(this->lexicon_filename);
+        std::lock_guard<std::mutex> lock(this->instances_mutex);
+        ++(this->stats.lexicon_parses);
+        return X;
+    }
+
+    // Takes up to 'N' idle instances. Fewer, or none, may be returned.
+    std::vector<std::unique_ptr<Explicator>> acquire_idle(size_t N){
+        std::vector<std::unique_ptr<Explicator>> out;
+        std::lock_guard<std::mutex> lock(this->instances_mutex);
+        while(!this->idle_instances.empty() && (out.size() < N)){
+            out.emplace_back(std::move(this->idle_instances.front()));
+            this->idle_instances.pop_front();
+        }
+        return out;
+    }
+
+    void count_translations(long int n, bool batch){
+        std::lock_guard<std::mutex> lock(this->instances_mutex);
+        this->stats.translations += n;
+        if(batch) this->stats.batch_translations += n;
+        return;
+    }
+
+    void release(std::unique_ptr<Explicator> X){
+        std::lock_guard<std::mutex> lock(this->instances_mutex);
+        this->idle_instances.emplace_back(std::move(X));
+        return;
+    }
+
+    bool lookup(const std::string &in, std::string &out){
+        std::shared_lock<std::shared_mutex> lock(this->memo_mutex);
+        const auto it = this->memo.find(in);
+        if(it == std::end(this->memo)) return false;
+        out = it->second;
+        return true;
+    }
+
+    void store(const std::string &in, const std::string &out){
+        std::unique_lock<std::shared_mutex> lock(this->memo_mutex);
+        this->memo.emplace(in, out);
+        return;
+    }
+};
+
+lexicon_state &get_lexicon_state(const std::string &lexicon_filename){
+    static std::mutex m;
+    static std::map<std::string, std::unique_ptr<lexicon_state>> states;
+
+    std::lock_guard<std::mutex> lock(m);
+    auto &s = states[lexicon_filename];
+    if(s == nullptr){
+        s = std::make_unique<lexicon_state>();
+        s->lexicon_filename = lexicon_filename;
+    }
+    return *s;
+}
+
+} // namespace
+
+
+std::string Explicate(const std::string &lexicon_filename, const std::string &in){
+    auto &ls = get_lexicon_state(lexicon_filename);
+
+    std::string out;
+    if(ls.lookup(in, out)) return out;
+
+    auto X = ls.acquire();
+    try{
+        out = (*X)(in);
+    }catch(const std::exception &){
+        ls.release(std::move(X));
+        throw;
+    }
+    ls.release(std::move(X));
+    ls.count_translations(1, false);
+
+    ls.store(in, out);
+    return out;
+}
+
+std::vector<std::string> Explicate(const std::string &lexicon_filename, const std::vector<std::string> &in){
+    auto &ls = get_lexicon_state(lexicon_filename);
+
+    std::vector<std::string> out(in.size());
+
+    // Identify the distinct inputs that have not yet been memoized.
+    std::vector<std::string> todo;
+    {
+        std::string dummy;
+        for(const auto &s : in){
+            if(!ls.lookup(s, dummy)) todo.push_back(s);
+        }
+        std::sort(std::begin(todo), std::end(todo));
+        todo.erase( std::unique(std::begin(todo), std::end(todo)), std::end(todo) );
+    }
+
+    if(todo.size() == 1){
+        Explicate(lexicon_filename, todo.front());
+
+    }else if(!todo.empty()){
+        // Each worker uses its own Explicator for a contiguous block of inputs. Idle instances are used whenever
+        // available. Parsing a lexicon is costly, so additional instances are only parsed when the batch is large
+        // enough to amortize the parse, and the parses are performed concurrently by the workers themselves.
+        const size_t inputs_per_parse = 256;
+        const auto N_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        auto instances = ls.acquire_idle( std::min(todo.size(), N_threads) );
+        const auto N_workers = std::max<size_t>({ 1,
+                                                  instances.size(),
+                                                  std::min(todo.size() / inputs_per_parse, N_threads) });
+        instances.resize(N_workers); // Workers without an instance will parse one.
+        const auto per_worker = (todo.size() + N_workers - 1) / N_workers;
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        const auto translate_block = [&](size_t w) -> void {
+            const auto beg = w * per_worker;
+            const auto end = std::min(todo.size(), beg + per_worker);
+            try{
+                if((beg < end) && (instances[w] == nullptr)) instances[w] = ls.acquire();
+                for(size_t i = beg; i < end; ++i){
+                    ls.store(todo[i], (*(instances[w]))(todo[i]));
+                }
+                if(beg < end) ls.count_translations(static_cast<long int>(end - beg), true);
+            }catch(...){
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) error = std::current_exception();
+            }
+        };
+
+        if(N_workers == 1){
+            translate_block(0);
+        }else{
+            asio_thread_pool tp(N_workers);
+            for(size_t w = 0; w < N_workers; ++w){
+                tp.submit_task([&,w]() -> void {
+                    translate_block(w);
+                }); // thread pool task closure.
+            }
+        } // Wait until all threads are done.
+
+        for(auto &X : instances){
+            if(X != nullptr) ls.release(std::move(X));
+        }
+        if(error) std::rethrow_exception(error);
+    }
+
+    for(size_t i = 0; i < in.size(); ++i){
+        out[i] = Explicate(lexicon_filename, in[i]);
+    }
+    return out;
+}
+
+
+explicator_cache_stats Get_Explicator_Cache_Stats(const std::string &lexicon_filename){
+    auto &ls = get_lexicon_state(lexicon_filename);
+    std::lock_guard<std::mutex> lock(ls.instances_mutex);
+    return ls.stats;
+}
+
+
+cached_explicator::cached_explicator(const std::string &lexicon_filename) : lexicon_filename(lexicon_filename) {}
+
+std::string cached_explicator::operator()(const std::string &in) const {
+    return Explicate(this->lexicon_filename, in);
+}
+
+std::vector<std::string> cached_explicator::operator()(const std::vector<std::string> &in) const {
+    return Explicate(this->lexicon_filename, in);
+}
+
@@ -0,0 +1,51 @@
+//Explicator_Cache.h.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+// Process-wide, memoizing string normalization using Explicator lexicons.
+//
+// Lexicon files are parsed lazily, only when a translation is first needed, and parsed Explicator instances are
+// retained for the life of the process. Translations are memoized and keyed on (lexicon filename, input) so each
+// distinct input is matched only once per lexicon. All routines are safe to call concurrently.
+//
+// Note that a lexicon file is assumed not to change while the process is running.
+
+// Translate a single string.
+std::string Explicate(const std::string &lexicon_filename, const std::string &in);
+
+// Translate many strings. Distinct, not-yet-memoized inputs are translated in parallel using idle Explicator
+// instances. Additional instances, up to the hardware concurrency, are parsed concurrently only when the batch is large
+// enough to amortize parsing. The outputs are ordered to match the inputs. Exceptions thrown during translation are
+// rethrown to the caller.
+std::vector<std::string> Explicate(const std::string &lexicon_filename, const std::vector<std::string> &in);
+
+// Running counts for a single lexicon, mostly useful for verifying the cache behaves as intended.
+struct explicator_cache_stats {
+    long int lexicon_parses = 0;     // Explicator instances created.
+    long int translations = 0;       // Inputs translated by an Explicator, i.e., not served from the memo.
+    long int batch_translations = 0; // Of the above, those performed by a batch translation.
+};
+
+explicator_cache_stats Get_Explicator_Cache_Stats(const std::string &lexicon_filename);
+
+
+// A lightweight stand-in for an Explicator that uses the process-wide cache. It is cheap to construct, and is suitable
+// for replacing 'Explicator X(FilenameLex)' wherever only 'X(str)' is needed.
+//
+// Note that features of Explicator that rely on the state of the most recent translation (e.g., 'last_best_score' or
+// 'Get_Last_Results()') are not available; use an Explicator directly for those.
+class cached_explicator {
+  private:
+    std::string lexicon_filename;
+
+  public:
+    explicit cached_explicator(const std::string &lexicon_filename);
+
+    std::string operator()(const std::string &in) const;
+    std::vector<std::string> operator()(const std::vector<std::string> &in) const;
+};
+
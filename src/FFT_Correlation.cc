@@ -0,0 +1,371 @@
+//FFT_Correlation.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Thread_Pool.h"
+#include "FFT_Correlation.h"
+
+
+dense_volume::dense_volume(long int images, long int rows, long int columns, float fill)
+    : images(images), rows(rows), columns(columns), data(images * rows * columns, fill) {}
+
+
+static long int next_power_of_two(long int x){
+    long int p = 1;
+    while(p < x) p *= 2;
+    return p;
+}
+
+
+fft_plan::fft_plan(long int n) : n(n) {
+    if( (n < 1) || (next_power_of_two(n) != n) ){
+        throw std::invalid_argument("FFT length must be a power of two");
+    }
+    long int bits = 0;
+    while((1L << bits) < n) ++bits;
+
+    this->bit_reversed.resize(n);
+    for(long int i = 0; i < n; ++i){
+        long int r = 0;
+        for(long int b = 0; b < bits; ++b){
+            if(i & (1L << b)) r |= (1L << (bits - 1 - b));
+        }
+        this->bit_reversed[i] = r;
+    }
+
+    const double pi = 3.14159265358979323846;
+    this->twiddles.resize(n / 2);
+    for(long int i = 0; i < (n / 2); ++i){
+        const double a = -2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+        this->twiddles[i] = std::complex<double>(std::cos(a), std::sin(a));
+    }
+}
+
+void
+fft_plan::execute(std::complex<double> *x, bool inverse) const {
+    for(long int i = 0; i < this->n; ++i){
+        const auto j = this->bit_reversed[i];
+        if(i < j) std::swap(x[i], x[j]);
+    }
+    for(long int len = 2; len <= this->n; len *= 2){
+        const long int half = len / 2;
+        const long int step = this->n / len;
+        for(long int i = 0; i < this->n; i += len){
+            for(long int j = 0; j < half; ++j){
+                const auto &tw = this->twiddles[j * step];
+                const auto w = inverse ? std::conj(tw) : tw;
+                const auto u = x[i + j];
+                const auto v = x[i + j + half] * w;
+                x[i + j] = u + v;
+                x[i + j + half] = u - v;
+            }
+        }
+    }
+    return;
+}
+
+
+namespace {
+
+using cplx = std::complex<double>;
+using dims_t = std::array<long int, 3>;
+
+// Unnormalized 3D transform of a dense (image, row, column) buffer.
+void fft_3d(std::vector<cplx> &buf, const dims_t &N, const std::array<const fft_plan*, 3> &plans, bool inverse){
+    std::vector<cplx> line;
+
+    // Columns are contiguous.
+    if(1 < N[2]){
+        for(long int i = 0; i < (N[0] * N[1]); ++i){
+            plans[2]->execute(buf.data() + i * N[2], inverse);
+        }
+    }
+
+    // Rows and images are strided, so they are gathered into a contiguous line.
+    if(1 < N[1]){
+        line.resize(N[1]);
+        for(long int i = 0; i < N[0]; ++i){
+            for(long int c = 0; c < N[2]; ++c){
+                const long int base = i * N[1] * N[2] + c;
+                for(long int r = 0; r < N[1]; ++r) line[r] = buf[base + r * N[2]];
+                plans[1]->execute(line.data(), inverse);
+                for(long int r = 0; r < N[1]; ++r) buf[base + r * N[2]] = line[r];
+            }
+        }
+    }
+    if(1 < N[0]){
+        line.resize(N[0]);
+        const long int plane = N[1] * N[2];
+        for(long int p = 0; p < plane; ++p){
+            for(long int i = 0; i < N[0]; ++i) line[i] = buf[p + i * plane];
+            plans[0]->execute(line.data(), inverse);
+            for(long int i = 0; i < N[0]; ++i) buf[p + i * plane] = line[i];
+        }
+    }
+    return;
+}
+
+// Sliding-window sums of extent K along each axis, producing (N - K + 1) outputs per axis.
+std::vector<double> box_sums(const std::vector<double> &in, const dims_t &N, const dims_t &K){
+    const dims_t M = {{ N[0] - K[0] + 1, N[1] - K[1] + 1, N[2] - K[2] + 1 }};
+
+    // Columns.
+    std::vector<double> a(N[0] * N[1] * M[2], 0.0);
+    for(long int l = 0; l < (N[0] * N[1]); ++l){
+        const double *p = in.data() + l * N[2];
+        double *o = a.data() + l * M[2];
+        double s = 0.0;
+        for(long int c = 0; c < K[2]; ++c) s += p[c];
+        o[0] = s;
+        for(long int c = 1; c < M[2]; ++c){
+            s += p[c + K[2] - 1] - p[c - 1];
+            o[c] = s;
+        }
+    }
+
+    // Rows.
+    std::vector<double> b(N[0] * M[1] * M[2], 0.0);
+    for(long int i = 0; i < N[0]; ++i){
+        for(long int c = 0; c < M[2]; ++c){
+            const auto at = [&](long int r){ return a[(i * N[1] + r) * M[2] + c]; };
+            double s = 0.0;
+            for(long int r = 0; r < K[1]; ++r) s += at(r);
+            b[(i * M[1] + 0) * M[2] + c] = s;
+            for(long int r = 1; r < M[1]; ++r){
+                s += at(r + K[1] - 1) - at(r - 1);
+                b[(i * M[1] + r) * M[2] + c] = s;
+            }
+        }
+    }
+
+    // Images.
+    std::vector<double> out(M[0] * M[1] * M[2], 0.0);
+    const long int plane = M[1] * M[2];
+    for(long int p = 0; p < plane; ++p){
+        double s = 0.0;
+        for(long int i = 0; i < K[0]; ++i) s += b[i * plane + p];
+        out[p] = s;
+        for(long int i = 1; i < M[0]; ++i){
+            s += b[(i + K[0] - 1) * plane + p] - b[(i - 1) * plane + p];
+            out[i * plane + p] = s;
+        }
+    }
+    return out;
+}
+
+// Tile transform length along one axis.
+long int choose_tile_length(long int L, long int K, long int tile_size){
+    const long int whole = next_power_of_two(L + K - 1); // No benefit to exceeding the whole (padded) axis.
+    const long int target = (0 < tile_size) ? next_power_of_two(tile_size)
+                                            : next_power_of_two(std::max(2 * K, 16L));
+    return std::max(next_power_of_two(K), std::min(whole, target));
+}
+
+} // namespace
+
+
+dense_volume FFT_Correlate(const dense_volume &vol,
+                           const dense_volume &kernel,
+                           const std::array<long int, 3> &centre,
+                           Correlation_Reduction reduction,
+                           long int tile_size){
+
+    const auto L = vol.dimensions();
+    const auto K = kernel.dimensions();
+    for(long int a = 0; a < 3; ++a){
+        if( (L[a] < 1) || (K[a] < 1) ){
+            throw std::invalid_argument("Volume and kernel must not be empty");
+        }
+        if( (centre[a] < 0) || (K[a] <= centre[a]) ){
+            throw std::invalid_argument("Kernel centre must lie within the kernel");
+        }
+    }
+
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    dense_volume out(L[0], L[1], L[2], nan);
+
+    // Kernel statistics.
+    const double k_count = static_cast<double>(K[0] * K[1] * K[2]);
+    double k_sum = 0.0;
+    for(const auto &k : kernel.data){
+        if(!std::isfinite(k)) return out;
+        k_sum += static_cast<double>(k);
+    }
+    const double k_mean = k_sum / k_count;
+    const bool use_ncc = (reduction == Correlation_Reduction::NormalizedCrossCorrelation);
+    const bool need_s1 = use_ncc;
+    const bool need_s2 = use_ncc || (reduction == Correlation_Reduction::EuclideanDistance);
+
+    // The normalized cross-correlation numerator only requires the zero-mean kernel.
+    std::vector<double> k_vals(kernel.data.size());
+    double k_sq_sum = 0.0;
+    for(size_t i = 0; i < kernel.data.size(); ++i){
+        k_vals[i] = static_cast<double>(kernel.data[i]) - (use_ncc ? k_mean : 0.0);
+        k_sq_sum += k_vals[i] * k_vals[i];
+    }
+
+    // Tile geometry. Each tile yields M = N - K + 1 outputs per axis.
+    const dims_t N = {{ choose_tile_length(L[0], K[0], tile_size),
+                        choose_tile_length(L[1], K[1], tile_size),
+                        choose_tile_length(L[2], K[2], tile_size) }};
+    const dims_t M = {{ N[0] - K[0] + 1, N[1] - K[1] + 1, N[2] - K[2] + 1 }};
+    const long int N_total = N[0] * N[1] * N[2];
+    const fft_plan plan_i(N[0]);
+    const fft_plan plan_r(N[1]);
+    const fft_plan plan_c(N[2]);
+    const std::array<const fft_plan*, 3> plans = {{ &plan_i, &plan_r, &plan_c }};
+
+    // Conjugated kernel spectrum, which transforms the circular convolution into a correlation.
+    std::vector<cplx> k_spec(N_total, cplx(0.0, 0.0));
+    for(long int i = 0; i < K[0]; ++i){
+        for(long int r = 0; r < K[1]; ++r){
+            for(long int c = 0; c < K[2]; ++c){
+                k_spec[(i * N[1] + r) * N[2] + c] = cplx(k_vals[kernel.index(i, r, c)], 0.0);
+            }
+        }
+    }
+    fft_3d(k_spec, N, plans, false);
+    const double scale = 1.0 / static_cast<double>(N_total);
+    for(auto &k : k_spec) k = std::conj(k) * scale;
+
+    // Enumerate the tile origins (in output coordinates).
+    std::vector<dims_t> tiles;
+    for(long int i = 0; i < L[0]; i += M[0]){
+        for(long int r = 0; r < L[1]; r += M[1]){
+            for(long int c = 0; c < L[2]; c += M[2]){
+                tiles.push_back( {{ i, r, c }} );
+            }
+        }
+    }
+
+    const auto process_tiles = [&](const dims_t *tile_a, const dims_t *tile_b) -> void {
+        std::vector<cplx> buf(N_total, cplx(0.0, 0.0));
+        std::vector<double> x(N_total), x_sq, nonfinite;
+
+        // Load a tile's input block, replacing non-finite samples with zero. Samples outside the volume are zero.
+        const auto load = [&](const dims_t &origin){
+            std::fill(std::begin(x), std::end(x), 0.0);
+            nonfinite.assign(N_total, 0.0);
+            for(long int i = 0; i < N[0]; ++i){
+                const long int li = origin[0] - centre[0] + i;
+                if( (li < 0) || (L[0] <= li) ) continue;
+                for(long int r = 0; r < N[1]; ++r){
+                    const long int lr = origin[1] - centre[1] + r;
+                    if( (lr < 0) || (L[1] <= lr) ) continue;
+                    for(long int c = 0; c < N[2]; ++c){
+                        const long int lc = origin[2] - centre[2] + c;
+                        if( (lc < 0) || (L[2] <= lc) ) continue;
+                        const auto v = static_cast<double>(vol.value(li, lr, lc));
+                        const long int n = (i * N[1] + r) * N[2] + c;
+                        if(std::isfinite(v)){
+                            x[n] = v;
+                        }else{
+                            nonfinite[n] = 1.0;
+                        }
+                    }
+                }
+            }
+            return;
+        };
+
+        // Reduce the correlation and box statistics for a tile and emit the outputs.
+        const auto emit = [&](const dims_t &origin, bool imaginary){
+            load(origin); // Reloading is cheaper than retaining a block per tile.
+            const auto n_nonfinite = box_sums(nonfinite, N, K);
+            std::vector<double> s1, s2;
+            if(need_s1) s1 = box_sums(x, N, K);
+            if(need_s2){
+                x_sq.resize(N_total);
+                for(long int n = 0; n < N_total; ++n) x_sq[n] = x[n] * x[n];
+                s2 = box_sums(x_sq, N, K);
+            }
+
+            for(long int i = 0; i < M[0]; ++i){
+                const long int pi = origin[0] + i;
+                if( (L[0] <= pi) || ((pi - centre[0]) < 0) || (L[0] < (pi - centre[0] + K[0])) ) continue;
+                for(long int r = 0; r < M[1]; ++r){
+                    const long int pr = origin[1] + r;
+                    if( (L[1] <= pr) || ((pr - centre[1]) < 0) || (L[1] < (pr - centre[1] + K[1])) ) continue;
+                    for(long int c = 0; c < M[2]; ++c){
+                        const long int pc = origin[2] + c;
+                        if( (L[2] <= pc) || ((pc - centre[2]) < 0) || (L[2] < (pc - centre[2] + K[2])) ) continue;
+
+                        const long int m = (i * M[1] + r) * M[2] + c;
+                        if(0.5 < n_nonfinite[m]) continue;
+
+                        const auto &z = buf[(i * N[1] + r) * N[2] + c];
+                        const double corr = imaginary ? z.imag() : z.real();
+                        double v = corr;
+                        if(reduction == Correlation_Reduction::EuclideanDistance){
+                            v = std::sqrt( std::max(0.0, s2[m] - 2.0 * corr + k_sq_sum) );
+                        }else if(reduction == Correlation_Reduction::NormalizedCrossCorrelation){
+                            const double x_var = s2[m] - s1[m] * s1[m] / k_count;
+                            const double denom = std::sqrt( std::max(0.0, x_var) * k_sq_sum );
+                            v = (0.0 < denom) ? std::clamp(corr / denom, -1.0, 1.0) : 0.0;
+                        }
+                        out.reference(pi, pr, pc) = static_cast<float>(v);
+                    }
+                }
+            }
+            return;
+        };
+
+        load(*tile_a);
+        for(long int n = 0; n < N_total; ++n) buf[n].real(x[n]);
+        if(tile_b != nullptr){
+            load(*tile_b);
+            for(long int n = 0; n < N_total; ++n) buf[n].imag(x[n]);
+        }
+        fft_3d(buf, N, plans, false);
+        for(long int n = 0; n < N_total; ++n) buf[n] *= k_spec[n];
+        fft_3d(buf, N, plans, true);
+
+        emit(*tile_a, false);
+        if(tile_b != nullptr) emit(*tile_b, true);
+        return;
+    };
+
+    // Tiles write to disjoint outputs, so pairs of tiles can be processed concurrently.
+    {
+        asio_thread_pool tp;
+        for(size_t t = 0; t < tiles.size(); t += 2){
+            const dims_t *tile_a = &(tiles[t]);
+            const dims_t *tile_b = ((t + 1) < tiles.size()) ? &(tiles[t + 1]) : nullptr;
+            tp.submit_task([=,&process_tiles]() -> void {
+                process_tiles(tile_a, tile_b);
+            });
+        }
+    } // Wait for tasks to complete.
+
+    return out;
+}
+
+
+bool FFT_Correlation_Is_Favourable(const std::array<long int, 3> &vol_dims,
+                                   const std::array<long int, 3> &kernel_dims){
+    double voxels = 1.0;
+    double kernel_voxels = 1.0;
+    double tile_voxels = 1.0;
+    double tile_outputs = 1.0;
+    for(long int a = 0; a < 3; ++a){
+        const auto n = choose_tile_length(vol_dims[a], kernel_dims[a], 0);
+        voxels *= static_cast<double>(vol_dims[a]);
+        kernel_voxels *= static_cast<double>(kernel_dims[a]);
+        tile_voxels *= static_cast<double>(n);
+        tile_outputs *= static_cast<double>(n - kernel_dims[a] + 1);
+    }
+
+    // Forward and inverse transforms are shared by two tiles. The constant roughly accounts for the cost of a complex
+    // butterfly relative to a multiply-add, and the per-tile loading and box sums.
+    const double fft_cost_per_tile = 3.0 * tile_voxels * std::max(1.0, std::log2(tile_voxels)) + 8.0 * tile_voxels;
+    const double fft_cost = fft_cost_per_tile * (voxels / tile_outputs);
+    const double direct_cost = voxels * kernel_voxels;
+    return (fft_cost < direct_cost);
+}
+
@@ -0,0 +1,81 @@
+//FFT_Correlation.h.
+
+#pragma once
+
+#include <array>
+#include <complex>
+#include <vector>
+
+
+// A dense 3D array of samples ordered (image, row, column), with columns varying fastest.
+struct dense_volume {
+    long int images = 0;
+    long int rows = 0;
+    long int columns = 0;
+    std::vector<float> data;
+
+    dense_volume() = default;
+    dense_volume(long int images, long int rows, long int columns, float fill = 0.0f);
+
+    long int index(long int img, long int row, long int col) const {
+        return (img * this->rows + row) * this->columns + col;
+    }
+    float value(long int img, long int row, long int col) const {
+        return this->data[this->index(img, row, col)];
+    }
+    float & reference(long int img, long int row, long int col){
+        return this->data[this->index(img, row, col)];
+    }
+    std::array<long int, 3> dimensions() const {
+        return {{ this->images, this->rows, this->columns }};
+    }
+};
+
+
+// How the paired kernel and neighbourhood samples are reduced to a single value.
+enum class Correlation_Reduction {
+    InnerProduct,               // sum(x*k).
+    EuclideanDistance,          // sqrt(sum((x-k)^2)).
+    NormalizedCrossCorrelation, // Pearson correlation coefficient of x and k; zero if either is constant.
+};
+
+
+// Correlates a kernel with every voxel's neighbourhood in the frequency domain.
+//
+// For each voxel p, the neighbourhood sample paired with kernel voxel t is vol[p - centre + t] (for each of the image,
+// row, and column axes). Convolution can be performed by spatially flipping the kernel and setting centre to
+// (kernel_dims - 1 - centre).
+//
+// Outputs are NaN if the neighbourhood extends beyond the volume or contains non-finite samples, or if the kernel
+// contains non-finite values, which matches the direct, voxel-by-voxel approach.
+//
+// The volume is processed in overlapping tiles (i.e., overlap-save) so that memory use is bounded and each transform
+// remains small. Tiles are transformed two at a time by packing them into the real and imaginary parts of a single
+// complex transform. A tile_size of zero selects a size automatically.
+dense_volume FFT_Correlate(const dense_volume &vol,
+                           const dense_volume &kernel,
+                           const std::array<long int, 3> &centre,
+                           Correlation_Reduction reduction,
+                           long int tile_size = 0);
+
+// Estimates whether FFT_Correlate() will outperform direct evaluation for the given volume and kernel dimensions.
+bool FFT_Correlation_Is_Favourable(const std::array<long int, 3> &vol_dims,
+                                   const std::array<long int, 3> &kernel_dims);
+
+
+// Radix-2 complex FFT of a fixed length (which must be a power of two).
+class fft_plan {
+    private:
+        long int n;
+        std::vector<long int> bit_reversed;
+        std::vector<std::complex<double>> twiddles;
+
+    public:
+        explicit fft_plan(long int n);
+
+        long int size() const { return this->n; }
+
+        // In-place, unnormalized transform. The inverse transform must be scaled by 1/n by the caller.
+        void execute(std::complex<double> *x, bool inverse) const;
+};
+
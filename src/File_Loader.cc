@@ -49,7 +49,8 @@ Load_Files( Drover &DICOM_data,
             const std::map<std::string,std::string> &InvocationMetadata,
             const std::string &FilenameLex,
             std::list<OperationArgPkg> &Operations,
-            std::list<std::filesystem::path> &Paths ){
+            std::list<std::filesystem::path> &Paths,
+            const dicom_load_options &dicom_options ){
 
     // Generate a priority list of file loaders.
     // Note that some file loaders are extremely generous in what they accept, so feeding them generic files could
@@ -80,7 +81,7 @@ Load_Files( Drover &DICOM_data,
         //Standalone file loading: DICOM files.
         loaders.emplace_back(file_loader_t{{".dcm"}, 3.0, [&](std::list<std::filesystem::path> &p) -> bool {
             if(!p.empty()
-            && !Load_From_DICOM_Files( DICOM_data, InvocationMetadata, FilenameLex, p )){
+            && !Load_From_DICOM_Files( DICOM_data, InvocationMetadata, FilenameLex, p, dicom_options )){
                 FUNCWARN("Failed to load DICOM file");
                 return false;
             }
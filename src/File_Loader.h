@@ -9,11 +9,13 @@
 #include <filesystem>
 
 #include "Structs.h"
+#include "DICOM_File_Loader.h"
 
 bool
 Load_Files( Drover &DICOM_data,
             const std::map<std::string,std::string> &InvocationMetadata,
             const std::string &FilenameLex,
             std::list<OperationArgPkg> &Operations,
-            std::list<std::filesystem::path> &Paths );
+            std::list<std::filesystem::path> &Paths,
+            const dicom_load_options &dicom_options = dicom_load_options() );
 
@@ -0,0 +1,220 @@
+//Image_Fingerprint.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+#include "YgorMisc.h"         //Needed for FUNCINFO macros.
+
+#include "Structs.h"
+#include "Thread_Pool.h"
+
+#include "Image_Fingerprint.h"
+
+
+// XXH64 constants and primitives. See https://github.com/Cyan4973/xxHash for the specification.
+static constexpr uint64_t xxh_p1 = 11400714785074694791ULL;
+static constexpr uint64_t xxh_p2 = 14029467366897019727ULL;
+static constexpr uint64_t xxh_p3 =  1609587929392839161ULL;
+static constexpr uint64_t xxh_p4 =  9650029242287828579ULL;
+static constexpr uint64_t xxh_p5 =  2870177450012600261ULL;
+
+static inline uint64_t xxh_rotl(uint64_t x, int r){
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_read64(const unsigned char *p){
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t xxh_read32(const unsigned char *p){
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input){
+    acc += input * xxh_p2;
+    acc = xxh_rotl(acc, 31);
+    return acc * xxh_p1;
+}
+
+static inline uint64_t xxh_merge_round(uint64_t acc, uint64_t val){
+    acc ^= xxh_round(0, val);
+    return acc * xxh_p1 + xxh_p4;
+}
+
+uint64_t XXH64_Hash(const void *data, size_t len, uint64_t seed){
+    const auto *p = static_cast<const unsigned char *>(data);
+    const auto *end = p + len;
+    uint64_t h;
+
+    if(32 <= len){
+        uint64_t v1 = seed + xxh_p1 + xxh_p2;
+        uint64_t v2 = seed + xxh_p2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - xxh_p1;
+        const auto *limit = end - 32;
+        do{
+            v1 = xxh_round(v1, xxh_read64(p)); p += 8;
+            v2 = xxh_round(v2, xxh_read64(p)); p += 8;
+            v3 = xxh_round(v3, xxh_read64(p)); p += 8;
+            v4 = xxh_round(v4, xxh_read64(p)); p += 8;
+        }while(p <= limit);
+
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h = xxh_merge_round(h, v1);
+        h = xxh_merge_round(h, v2);
+        h = xxh_merge_round(h, v3);
+        h = xxh_merge_round(h, v4);
+    }else{
+        h = seed + xxh_p5;
+    }
+    h += static_cast<uint64_t>(len);
+
+    while(p + 8 <= end){
+        h ^= xxh_round(0, xxh_read64(p));
+        h = xxh_rotl(h, 27) * xxh_p1 + xxh_p4;
+        p += 8;
+    }
+    if(p + 4 <= end){
+        h ^= static_cast<uint64_t>(xxh_read32(p)) * xxh_p1;
+        h = xxh_rotl(h, 23) * xxh_p2 + xxh_p3;
+        p += 4;
+    }
+    while(p < end){
+        h ^= static_cast<uint64_t>(*p) * xxh_p5;
+        h = xxh_rotl(h, 11) * xxh_p1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= xxh_p2;
+    h ^= h >> 29;
+    h *= xxh_p3;
+    h ^= h >> 32;
+    return h;
+}
+
+
+image_fingerprint Fingerprint_Image(const planar_image<float,double> &img){
+    image_fingerprint out;
+
+    {
+        const auto append = [](std::vector<double> &buf, const vec3<double> &v){
+            buf.push_back(v.x);
+            buf.push_back(v.y);
+            buf.push_back(v.z);
+        };
+        std::vector<double> buf;
+        buf.reserve(18);
+        buf.push_back(static_cast<double>(img.rows));
+        buf.push_back(static_cast<double>(img.columns));
+        buf.push_back(static_cast<double>(img.channels));
+        buf.push_back(img.pxl_dx);
+        buf.push_back(img.pxl_dy);
+        buf.push_back(img.pxl_dz);
+        append(buf, img.anchor);
+        append(buf, img.offset);
+        append(buf, img.row_unit);
+        append(buf, img.col_unit);
+        out.geometry = XXH64_Hash(buf.data(), buf.size() * sizeof(double));
+    }
+
+    out.voxels = XXH64_Hash(img.data.data(), img.data.size() * sizeof(float));
+
+    {
+        // Keys and values are delimited with their lengths so that, e.g., {"ab":"c"} and {"a":"bc"} differ.
+        std::string buf;
+        for(const auto &kv : img.metadata){
+            if(kv.first == "Filename") continue;
+            buf += std::to_string(kv.first.size()) + ':' + kv.first;
+            buf += std::to_string(kv.second.size()) + ':' + kv.second;
+        }
+        out.metadata = XXH64_Hash(buf.data(), buf.size());
+    }
+    return out;
+}
+
+
+image_array_fingerprint Fingerprint_Image_Array(const Image_Array &ia){
+    image_array_fingerprint out;
+    std::vector<const planar_image<float,double> *> imgs;
+    for(const auto &img : ia.imagecoll.images) imgs.push_back(&img);
+    out.images.resize(imgs.size());
+
+    {
+        asio_thread_pool tp;
+        for(size_t i = 0; i < imgs.size(); ++i){
+            tp.submit_task([&,i]() -> void {
+                out.images[i] = Fingerprint_Image(*(imgs[i]));
+            }); // thread pool task closure.
+        }
+    } // Wait until all threads are done.
+
+    // Combine in sorted order so that image order within the collection is irrelevant.
+    const auto combine = [&](auto f_member) -> uint64_t {
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        pairs.reserve(out.images.size());
+        for(const auto &f : out.images) pairs.emplace_back(f.geometry, f_member(f));
+        std::sort(std::begin(pairs), std::end(pairs));
+        return XXH64_Hash(pairs.data(), pairs.size() * sizeof(std::pair<uint64_t, uint64_t>));
+    };
+    out.geometry = combine([](const image_fingerprint &){ return static_cast<uint64_t>(0); });
+    out.voxels   = combine([](const image_fingerprint &f){ return f.voxels; });
+    out.metadata = combine([](const image_fingerprint &f){ return f.metadata; });
+    return out;
+}
+
+
+long int Purge_Duplicate_Instances(const Drover &existing, Drover &incoming){
+    std::set<std::string> seen;
+    for(const auto &iap : existing.image_data){
+        if(iap == nullptr) continue;
+        for(const auto &img : iap->imagecoll.images){
+            if(auto o = img.GetMetadataValueAs<std::string>("SOPInstanceUID")){
+                seen.insert(o.value());
+            }
+        }
+    }
+
+    long int removed = 0;
+    for(auto iap_it = std::begin(incoming.image_data); iap_it != std::end(incoming.image_data); ){
+        if(*iap_it == nullptr){
+            ++iap_it;
+            continue;
+        }
+        auto &images = (*iap_it)->imagecoll.images;
+        for(auto img_it = std::begin(images); img_it != std::end(images); ){
+            const auto o = img_it->GetMetadataValueAs<std::string>("SOPInstanceUID");
+            if( o && !seen.insert(o.value()).second ){
+                img_it = images.erase(img_it);
+                ++removed;
+            }else{
+                ++img_it;
+            }
+        }
+        if(images.empty()){
+            iap_it = incoming.image_data.erase(iap_it);
+        }else{
+            ++iap_it;
+        }
+    }
+
+    if(0 < removed){
+        FUNCINFO("Rejected " << removed << " image(s) with previously-loaded SOPInstanceUIDs");
+    }
+    return removed;
+}
+
@@ -0,0 +1,49 @@
+//Image_Fingerprint.h.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "YgorImages.h"
+
+class Drover;
+class Image_Array;
+
+
+// 64-bit xxHash (XXH64) of a byte buffer. Results match the reference implementation on little-endian hosts.
+uint64_t XXH64_Hash(const void *data, size_t len, uint64_t seed = 0);
+
+
+// Fingerprints of a single image. Fields are compared bitwise, so only exact duplicates have identical fingerprints.
+struct image_fingerprint {
+    uint64_t geometry = 0; // Dimensions, voxel spacing, position, and orientation.
+    uint64_t voxels = 0;   // Voxel intensities.
+    uint64_t metadata = 0; // Metadata key-value pairs, excluding the 'Filename' key, which differs between copies.
+};
+
+// Fingerprints of an image array.
+//
+// The per-image fingerprints are combined in sorted order, so arrays that hold the same images in a different order
+// have identical array fingerprints. Each image's voxel and metadata fingerprints are combined together with its
+// geometry fingerprint, so swapping voxel data between images alters the array fingerprint.
+struct image_array_fingerprint {
+    uint64_t geometry = 0;
+    uint64_t voxels = 0;
+    uint64_t metadata = 0;
+    std::vector<image_fingerprint> images; // In collection order.
+};
+
+image_fingerprint Fingerprint_Image(const planar_image<float,double> &img);
+
+// Images are fingerprinted in parallel.
+image_array_fingerprint Fingerprint_Image_Array(const Image_Array &ia);
+
+
+// Removes images from 'incoming' whose SOPInstanceUID is already present in 'existing' or earlier in 'incoming'.
+// Image arrays that become empty are removed. Images lacking a SOPInstanceUID are retained.
+//
+// Returns the number of images removed.
+long int Purge_Duplicate_Instances(const Drover &existing, Drover &incoming);
+
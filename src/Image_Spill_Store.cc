@@ -0,0 +1,253 @@
+//Image_Spill_Store.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMisc.h"         //Needed for FUNCINFO macros.
+#include "YgorString.h"       //Needed for the _s string literal.
+
+#include "Image_Spill_Store.h"
+
+
+Image_Spill_Store::Image_Spill_Store(const std::filesystem::path &dir, size_t budget_bytes) : budget(budget_bytes) {
+    std::filesystem::path base = dir;
+    if(base.empty()) base = std::filesystem::temp_directory_path();
+
+    // Always use a unique subdirectory so that concurrent stores cannot collide and cleanup is unambiguous.
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    for(long int attempt = 0; attempt < 100; ++attempt){
+        std::stringstream ss;
+        ss << "dcma_spill_" << std::hex << std::setw(16) << std::setfill('0') << gen();
+        const auto candidate = base / ss.str();
+        if(std::filesystem::create_directories(candidate)){
+            this->spill_dir = candidate;
+            break;
+        }
+    }
+    if(this->spill_dir.empty()){
+        throw std::runtime_error("Unable to create a spill directory within '"_s + base.string() + "'");
+    }
+}
+
+Image_Spill_Store::~Image_Spill_Store(){
+    // Spilled images are not paged back in. The store is normally destroyed alongside the images it manages, and
+    // restoring them here would require the very memory that spilling avoids. Use restore_all() beforehand to retain
+    // the voxel data.
+    std::error_code ec;
+    std::filesystem::remove_all(this->spill_dir, ec);
+}
+
+void
+Image_Spill_Store::page_out(image_t &img, record_t &r){
+    if(r.dirty || r.file.empty()){
+        if(r.file.empty()){
+            r.file = this->spill_dir / ("image_"_s + std::to_string(this->file_counter++) + ".raw");
+        }
+        std::ofstream ofs(r.file, std::ios::out | std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char *>(img.data.data()), static_cast<std::streamsize>(r.bytes));
+        ofs.flush();
+        if(!ofs){
+            throw std::runtime_error("Unable to write spill file '"_s + r.file.string() + "'");
+        }
+        r.dirty = false;
+    }
+    std::vector<float>().swap(img.data);
+    r.resident = false;
+    this->resident_bytes -= r.bytes;
+    ++(this->page_outs);
+    return;
+}
+
+void
+Image_Spill_Store::page_in(image_t &img, record_t &r){
+    std::vector<float> buf(r.bytes / sizeof(float));
+    std::ifstream ifs(r.file, std::ios::in | std::ios::binary);
+    ifs.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(r.bytes));
+    if(!ifs){
+        throw std::runtime_error("Unable to read spill file '"_s + r.file.string() + "'");
+    }
+    img.data.swap(buf);
+    r.resident = true;
+    this->resident_bytes += r.bytes;
+    ++(this->page_ins);
+    return;
+}
+
+void
+Image_Spill_Store::enforce_budget(){
+    while(this->budget < this->resident_bytes){
+        // Find the least recently used unpinned resident image.
+        image_t *lru_img = nullptr;
+        record_t *lru_r = nullptr;
+        for(auto &p : this->records){
+            auto &r = p.second;
+            if(!r.resident || (0 < r.pins)) continue;
+            if( (lru_r == nullptr)
+            ||  (r.last_use < lru_r->last_use) ){
+                lru_img = const_cast<image_t *>(p.first);
+                lru_r = &r;
+            }
+        }
+        if(lru_r == nullptr) break; // Everything resident is pinned; temporarily exceed the budget.
+        this->page_out(*lru_img, *lru_r);
+    }
+    return;
+}
+
+void
+Image_Spill_Store::manage(image_t &img){
+    std::lock_guard<std::mutex> lock(this->m);
+    if(this->records.count(&img) != 0) return;
+
+    auto &r = this->records[&img];
+    r.bytes = img.data.size() * sizeof(float);
+    r.last_use = ++(this->use_counter);
+    this->resident_bytes += r.bytes;
+    this->enforce_budget();
+    return;
+}
+
+void
+Image_Spill_Store::pin(image_t &img){
+    std::lock_guard<std::mutex> lock(this->m);
+    auto it = this->records.find(&img);
+    if(it == std::end(this->records)) return;
+
+    auto &r = it->second;
+    ++(r.pins);
+    r.last_use = ++(this->use_counter);
+    if(!r.resident){
+        this->page_in(img, r);
+        this->enforce_budget();
+    }
+    return;
+}
+
+void
+Image_Spill_Store::unpin(image_t &img, bool modified){
+    std::lock_guard<std::mutex> lock(this->m);
+    auto it = this->records.find(&img);
+    if(it == std::end(this->records)) return;
+
+    auto &r = it->second;
+    if(r.pins <= 0){
+        throw std::logic_error("Attempted to unpin an image that is not pinned");
+    }
+    --(r.pins);
+    if(modified){
+        r.dirty = true;
+        const auto bytes = img.data.size() * sizeof(float);
+        this->resident_bytes = this->resident_bytes - r.bytes + bytes;
+        r.bytes = bytes;
+    }
+    r.last_use = ++(this->use_counter);
+    this->enforce_budget();
+    return;
+}
+
+void
+Image_Spill_Store::restore_all(){
+    std::lock_guard<std::mutex> lock(this->m);
+    for(auto &p : this->records){
+        auto &r = p.second;
+        if(!r.resident) this->page_in(*const_cast<image_t *>(p.first), r);
+        if(!r.file.empty()){
+            std::error_code ec;
+            std::filesystem::remove(r.file, ec);
+        }
+    }
+    this->records.clear();
+    this->resident_bytes = 0;
+    return;
+}
+
+std::vector<float>
+Image_Spill_Store::copy_voxels(const image_t &img) const {
+    std::lock_guard<std::mutex> lock(this->m);
+    auto it = this->records.find(&img);
+    if( (it == std::end(this->records))
+    ||  it->second.resident ){
+        return img.data;
+    }
+
+    const auto &r = it->second;
+    std::vector<float> buf(r.bytes / sizeof(float));
+    std::ifstream ifs(r.file, std::ios::in | std::ios::binary);
+    ifs.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(r.bytes));
+    if(!ifs){
+        throw std::runtime_error("Unable to read spill file '"_s + r.file.string() + "'");
+    }
+    return buf;
+}
+
+bool
+Image_Spill_Store::is_managed(const image_t &img) const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return (this->records.count(&img) != 0);
+}
+
+bool
+Image_Spill_Store::is_resident(const image_t &img) const {
+    std::lock_guard<std::mutex> lock(this->m);
+    auto it = this->records.find(&img);
+    return (it == std::end(this->records)) || it->second.resident;
+}
+
+size_t
+Image_Spill_Store::get_resident_bytes() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->resident_bytes;
+}
+
+long int
+Image_Spill_Store::get_page_in_count() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->page_ins;
+}
+
+long int
+Image_Spill_Store::get_page_out_count() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->page_outs;
+}
+
+
+pinned_images::pinned_images(Image_Spill_Store *store,
+                             std::list<Image_Spill_Store::image_t *> imgs,
+                             bool modified)
+    : store(store), modified(modified) {
+    if(this->store == nullptr) return;
+    try{
+        for(auto *img : imgs){
+            this->store->pin(*img);
+            this->imgs.push_back(img);
+        }
+    }catch(const std::exception &){
+        // The destructor will not be invoked, so release whatever was pinned.
+        for(auto *img : this->imgs) this->store->unpin(*img, false);
+        throw;
+    }
+}
+
+pinned_images::~pinned_images(){
+    if(this->store == nullptr) return;
+    for(auto *img : this->imgs){
+        try{
+            this->store->unpin(*img, this->modified);
+        }catch(const std::exception &e){
+            FUNCWARN("Unable to unpin image: " << e.what());
+        }
+    }
+}
+
@@ -0,0 +1,100 @@
+//Image_Spill_Store.h.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "YgorImages.h"
+
+
+// Pages image voxel data to disk so that image series larger than the available memory can be processed.
+//
+// Images remain in their planar_image_collection, and all metadata and geometry remain resident; only the voxel data
+// is released when an image is evicted. Images must be pinned before their voxel data is accessed. Unpinned images are
+// evicted in least-recently-used order whenever the resident voxel data exceeds the memory budget.
+//
+// The store refers to images by address, so it must not outlive the images it manages, and managed images must not be
+// removed from their collection while the store is in use. Destroying the store removes the spill files without
+// restoring the images, so any evicted images are left without voxel data; call restore_all() first to retain them.
+class Image_Spill_Store {
+    public:
+        using image_t = planar_image<float,double>;
+
+    private:
+        struct record_t {
+            std::filesystem::path file;
+            size_t bytes = 0;
+            long int pins = 0;
+            uint64_t last_use = 0;
+            bool resident = true;
+            bool dirty = true; // Whether the resident voxel data differs from the file.
+        };
+
+        mutable std::mutex m;
+        std::filesystem::path spill_dir;
+        size_t budget;
+        size_t resident_bytes = 0;
+        uint64_t use_counter = 0;
+        uint64_t file_counter = 0;
+        long int page_ins = 0;
+        long int page_outs = 0;
+        std::map<const image_t *, record_t> records;
+
+        void page_out(image_t &img, record_t &r);
+        void page_in(image_t &img, record_t &r);
+        void enforce_budget();
+
+    public:
+        // If the directory is empty, a unique directory is created within the system temporary directory.
+        Image_Spill_Store(const std::filesystem::path &dir, size_t budget_bytes);
+        ~Image_Spill_Store();
+
+        Image_Spill_Store(const Image_Spill_Store &) = delete;
+        Image_Spill_Store & operator=(const Image_Spill_Store &) = delete;
+
+        // Begin managing a resident image. Other images may be evicted to honour the budget.
+        void manage(image_t &img);
+
+        // Ensure an image's voxel data is resident and prevent it from being evicted until it is unpinned.
+        // Unmanaged images are ignored.
+        void pin(image_t &img);
+
+        // Permit an image to be evicted. If the voxel data was altered while pinned, 'modified' must be true.
+        void unpin(image_t &img, bool modified = false);
+
+        // Page in all images and stop managing them.
+        void restore_all();
+
+        // Retrieve a copy of an image's voxel data without altering residency. Useful for deep copies.
+        std::vector<float> copy_voxels(const image_t &img) const;
+
+        bool is_managed(const image_t &img) const;
+        bool is_resident(const image_t &img) const;
+        size_t get_resident_bytes() const;
+        long int get_page_in_count() const;
+        long int get_page_out_count() const;
+};
+
+
+// Pins a group of images for the lifetime of this object. The store may be null, in which case nothing is done.
+class pinned_images {
+    private:
+        Image_Spill_Store *store;
+        std::list<Image_Spill_Store::image_t *> imgs;
+        bool modified;
+
+    public:
+        pinned_images(Image_Spill_Store *store,
+                      std::list<Image_Spill_Store::image_t *> imgs,
+                      bool modified = false);
+        ~pinned_images();
+
+        pinned_images(const pinned_images &) = delete;
+        pinned_images & operator=(const pinned_images &) = delete;
+};
+
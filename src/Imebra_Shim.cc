@@ -9,21 +9,28 @@
 
 #include <algorithm>      //Needed for std::sort.
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <exception>
 #include <optional>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <list>
 #include <map>
 #include <memory>         //Needed for std::unique_ptr.
+#include <mutex>
 #include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <tuple>
 #include <utility>        //Needed for std::pair.
 #include <vector>
@@ -38,6 +45,8 @@
 #include "Imebra_Shim.h"
 #include "DCMA_DICOM.h"
 #include "Structs.h"
+#include "Mapped_File.h"
+#include "Thread_Pool.h"
 #include "YgorContainers.h" //Needed for 'bimap' class.
 #include "YgorMath.h"       //Needed for 'vec3' class.
 #include "YgorMisc.h"       //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -1406,6 +1415,69 @@ bimap<std::string,long int> get_ROI_tags_and_numbers(const std::string &Filename
 }
 
 
+//Invokes 'f(i)' for i = 0 ... N-1 using the calling thread and a process-wide pool of helper threads.
+//
+// The pool is bounded and shared by all callers, so nested use (e.g., from the DICOM file loader's worker threads) does
+// not multiply the number of threads. The calling thread also performs work and never waits for helper tasks that have
+// not yet started, so progress does not depend on the pool's availability. The first exception thrown is rethrown.
+static void for_each_index_with_shared_pool(size_t N, const std::function<void(size_t)> &f){
+    struct shared_state {
+        std::atomic<size_t> next = 0;
+        size_t N = 0;
+        const std::function<void(size_t)> *f = nullptr;
+
+        std::mutex m;
+        std::condition_variable cv;
+        bool closed = false;    // Guarded by m. Helpers that start after closure do nothing.
+        long int active = 0;    // Guarded by m.
+        std::exception_ptr error; // Guarded by m.
+
+        void work(){
+            size_t i;
+            while((i = this->next.fetch_add(1)) < this->N){
+                try{
+                    (*(this->f))(i);
+                }catch(...){
+                    std::lock_guard<std::mutex> lock(this->m);
+                    if(!this->error) this->error = std::current_exception();
+                }
+            }
+            return;
+        }
+    };
+    static asio_thread_pool tp( std::max<size_t>(1, std::thread::hardware_concurrency()) );
+
+    auto s = std::make_shared<shared_state>();
+    s->N = N;
+    s->f = &f;
+
+    const auto N_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const auto N_helpers = (N < 2) ? 0 : (std::min(N, N_threads) - 1);
+    for(size_t h = 0; h < N_helpers; ++h){
+        tp.submit_task([s]() -> void {
+            {
+                std::lock_guard<std::mutex> lock(s->m);
+                if(s->closed) return;
+                ++(s->active);
+            }
+            s->work();
+            {
+                std::lock_guard<std::mutex> lock(s->m);
+                --(s->active);
+            }
+            s->cv.notify_all();
+        }); // thread pool task closure.
+    }
+
+    s->work();
+
+    std::unique_lock<std::mutex> lock(s->m);
+    s->closed = true;
+    s->cv.wait(lock, [&]{ return (s->active == 0); });
+    if(s->error) std::rethrow_exception(s->error);
+    return;
+}
+
 //Returns contour data from a DICOM RTSTRUCT file sorted into ROI-specific collections.
 std::unique_ptr<Contour_Data> get_Contour_Data(const std::string &filename){
     auto output = std::make_unique<Contour_Data>();
@@ -1420,8 +1492,21 @@ std::unique_ptr<Contour_Data> get_Contour_Data(const std::string &filename){
     ptr<imebra::dataSet> TopDataSet = imebra::codecs::codecFactory::getCodecFactory()->load(reader);
     ptr<imebra::dataSet> SecondDataSet, ThirdDataSet;
 
-    //Collect the data into a container of contours with meta info. It may be unordered (within the file).
-    std::map<std::tuple<std::string,long int>, contour_collection<double>> mapcache;
+    //Gather the raw contour data for each ROI contour sequence item.
+    struct roi_item {
+        long int ROI_number;
+        std::string ROIName;
+
+        struct raw_contour {
+            std::string coordinates; // The raw DS-encoded coordinates, e.g., "1.0\\2.0\\3.0".
+            ptr<imebra::dataSet> data_set; // Only used if the raw coordinates cannot be decoded.
+            size_t buffer = 0;
+            bool decoded = false;
+        };
+        std::vector<raw_contour> raw_contours;
+        std::list<contour_of_points<double>> contours;
+    };
+    std::vector<roi_item> items;
     for(size_t i=0; (SecondDataSet = TopDataSet->getSequenceItem(0x3006, 0, 0x0039, i)) != nullptr; ++i){
         long int Last_ROI_Numb = 0;
         for(size_t j=0; (ThirdDataSet = SecondDataSet->getSequenceItem(0x3006, 0, 0x0040, j)) != nullptr; ++j){
@@ -1436,37 +1521,113 @@ std::unique_ptr<Contour_Data> get_Contour_Data(const std::string &filename){
                 continue;
             }
 
-            ptr<puntoexe::imebra::handlers::dataHandler> the_data_handler;
-            for(size_t k=0; (the_data_handler = ThirdDataSet->getDataHandler(0x3006, 0, 0x0050, k, false)) != nullptr; ++k){
-                contour_of_points<double> shtl;
-                shtl.closed = true;
-
-                //This is the number of coordinates we will get (ie. the number of doubles).
-                const long int numb_of_coordinates = the_data_handler->getSize();
-                for(long int N = 0; N < numb_of_coordinates; N += 3){
-                    const double x = the_data_handler->getDouble(N + 0);
-                    const double y = the_data_handler->getDouble(N + 1);
-                    const double z = the_data_handler->getDouble(N + 2);
-                    shtl.points.emplace_back(x,y,z);
-                }
-                shtl.Reorient_Counter_Clockwise();
-                shtl.metadata = FileMetadata;
-
-                auto ROIName = tags_names_and_numbers[ROI_number];
-                shtl.metadata["ROINumber"] = std::to_string(ROI_number);
-                shtl.metadata["ROIName"] = ROIName;
-                
-                const auto key = std::make_tuple(ROIName, ROI_number);
-                mapcache[key].contours.push_back(std::move(shtl));
+            items.emplace_back();
+            items.back().ROI_number = ROI_number;
+            items.back().ROIName = tags_names_and_numbers[ROI_number];
+
+            // Note: the raw data is requested rather than the string data to avoid Imebra's costly per-element
+            //       string conversions.
+            ptr<puntoexe::imebra::handlers::dataHandlerRaw> raw_handler;
+            for(size_t k=0; (raw_handler = ThirdDataSet->getDataHandlerRaw(0x3006, 0, 0x0050, k, false)) != nullptr; ++k){
+                items.back().raw_contours.emplace_back();
+                auto &rc = items.back().raw_contours.back();
+                rc.data_set = ThirdDataSet;
+                rc.buffer = k;
+                rc.coordinates.assign( reinterpret_cast<const char *>(raw_handler->getMemoryBuffer()),
+                                       static_cast<size_t>(raw_handler->getSize()) );
             }
         }
     }
 
+    //Decode the coordinates and construct contours. Items are independent, so they are processed concurrently.
+    const auto process_item = [&FileMetadata](roi_item &item) -> void {
+        const std::string_view padding(" \t\r\n\0", 5);
+        std::vector<double> coords;
+        for(auto &rc : item.raw_contours){
+            // DS values are decimal strings separated by backslashes and possibly padded with spaces.
+            coords.clear();
+            coords.reserve(rc.coordinates.size() / 6);
+            std::string_view sv(rc.coordinates);
+            bool valid = true;
+            while(valid && !sv.empty()){
+                const auto e = sv.find('\\');
+                auto token = sv.substr(0, e);
+                sv.remove_prefix( (e == std::string_view::npos) ? sv.size() : (e + 1) );
+
+                const auto b = token.find_first_not_of(padding);
+                token.remove_prefix( (b == std::string_view::npos) ? token.size() : b );
+                double x;
+                valid = parse_number(token, x)
+                     && (token.find_first_not_of(padding) == std::string_view::npos);
+                if(valid) coords.push_back(x);
+            }
+            if( !valid
+            ||  ((coords.size() % 3) != 0) ){
+                continue; // Decoded via Imebra later.
+            }
+            rc.decoded = true;
+
+            contour_of_points<double> shtl;
+            shtl.closed = true;
+            for(size_t N = 0; (N + 2) < coords.size(); N += 3){
+                shtl.points.emplace_back(coords[N + 0], coords[N + 1], coords[N + 2]);
+            }
+            item.contours.push_back(std::move(shtl));
+        }
+
+        for(auto &shtl : item.contours){
+            shtl.Reorient_Counter_Clockwise();
+            shtl.metadata = FileMetadata;
+            shtl.metadata["ROINumber"] = std::to_string(item.ROI_number);
+            shtl.metadata["ROIName"] = item.ROIName;
+        }
+        return;
+    };
+    for_each_index_with_shared_pool(items.size(), [&](size_t i) -> void {
+        process_item(items[i]);
+    });
+
+    //Collect the contours into collections keyed on ROI. The items may be unordered (within the file).
+    std::map<std::tuple<std::string,long int>, contour_collection<double>> mapcache;
+    for(auto &item : items){
+        auto &contours = mapcache[ std::make_tuple(item.ROIName, item.ROI_number) ].contours;
+
+        // Fall back to Imebra's decoding for any coordinates that could not be decoded directly. This preserves the
+        // order of the contours within each item.
+        auto c_it = std::begin(item.contours);
+        for(auto &rc : item.raw_contours){
+            if(rc.decoded){
+                contours.splice( std::end(contours), item.contours, c_it++ );
+                continue;
+            }
+            contour_of_points<double> shtl;
+            shtl.closed = true;
+
+            auto the_data_handler = rc.data_set->getDataHandler(0x3006, 0, 0x0050, rc.buffer, false);
+            if(the_data_handler == nullptr){
+                throw std::runtime_error("Unable to access contour data");
+            }
+
+            //This is the number of coordinates we will get (ie. the number of doubles).
+            const long int numb_of_coordinates = the_data_handler->getSize();
+            for(long int N = 0; N < numb_of_coordinates; N += 3){
+                const double x = the_data_handler->getDouble(N + 0);
+                const double y = the_data_handler->getDouble(N + 1);
+                const double z = the_data_handler->getDouble(N + 2);
+                shtl.points.emplace_back(x,y,z);
+            }
+            shtl.Reorient_Counter_Clockwise();
+            shtl.metadata = FileMetadata;
+            shtl.metadata["ROINumber"] = std::to_string(item.ROI_number);
+            shtl.metadata["ROIName"] = item.ROIName;
+            contours.push_back(std::move(shtl));
+        }
+    }
+    items.clear();
 
     //Now sort the contours into contour_with_metas. We sort based on ROI number.
     for(auto & m_it : mapcache){
-        output->ccs.emplace_back( ); //std::move(m_it->second) ) );
-        output->ccs.back() = m_it.second; 
+        output->ccs.emplace_back( std::move(m_it.second) );
     }
 
     //Find the minimum separation between contours (which isn't zero).
@@ -2544,18 +2705,52 @@ void Write_Dose_Array(const std::shared_ptr<Image_Array>& IA, const std::string
     const auto row_count = IA->imagecoll.images.front().rows;
     const auto col_count = IA->imagecoll.images.front().columns;
 
-    auto max_dose = -std::numeric_limits<float>::infinity();
+    // Images are independent, so voxels are scanned (and later converted) concurrently, one image per task.
+    std::vector<const planar_image<float,double> *> imgs;
     for(const auto &p_img : IA->imagecoll.images){
-        const long int channel = 0; // Ignore other channels for now. TODO.
-        for(long int r = 0; r < row_count; r++){
-            for(long int c = 0; c < col_count; c++){
-                const auto val = p_img.value(r, c, channel);
-                if(!std::isfinite(val)) throw std::domain_error("Found non-finite dose. Refusing to export.");
-                if(val < 0.0f ) throw std::domain_error("Found a voxel with negative dose. Refusing to continue.");
-                if(max_dose < val) max_dose = val;
-            }
+        if( (p_img.rows != row_count)
+        ||  (p_img.columns != col_count)
+        ||  (p_img.channels <= 0)
+        ||  (static_cast<long int>(p_img.data.size()) != (row_count * col_count * p_img.channels)) ){
+            throw std::invalid_argument("Images do not share a common, valid voxel grid. Refusing to export.");
         }
+        imgs.push_back( &p_img );
     }
+    const auto for_each_img = [&](const std::function<void(size_t)> &f) -> void {
+        std::vector<std::exception_ptr> errors(imgs.size());
+        {
+            asio_thread_pool tp;
+            for(size_t i = 0; i < imgs.size(); ++i){
+                tp.submit_task([&,i]() -> void {
+                    try{
+                        f(i);
+                    }catch(...){
+                        errors[i] = std::current_exception();
+                    }
+                });
+            }
+        } // Wait until all threads are done.
+
+        // Report the same error that a sequential traversal would have encountered first.
+        for(const auto &e : errors){
+            if(e) std::rethrow_exception(e);
+        }
+        return;
+    };
+
+    std::vector<float> max_doses(imgs.size(), -std::numeric_limits<float>::infinity());
+    for_each_img([&](size_t i) -> void {
+        const auto &p_img = *(imgs[i]);
+        const long int channel = 0; // Ignore other channels for now. TODO.
+        const auto N_chnls = p_img.channels;
+        for(long int v = 0; v < (row_count * col_count); ++v){
+            const auto val = p_img.data[v * N_chnls + channel];
+            if(!std::isfinite(val)) throw std::domain_error("Found non-finite dose. Refusing to export.");
+            if(val < 0.0f ) throw std::domain_error("Found a voxel with negative dose. Refusing to continue.");
+            if(max_doses[i] < val) max_doses[i] = val;
+        }
+    });
+    const auto max_dose = *std::max_element(std::begin(max_doses), std::end(max_doses));
     if( max_dose < 0.0f ) throw std::invalid_argument("No voxels were found to export. Cannot continue.");
     const double full_dose_scaling = max_dose / static_cast<double>(std::numeric_limits<uint32_t>::max());
     const double dose_scaling = std::max(full_dose_scaling, 1.0E-5); //Because excess bits might get truncated!
@@ -2852,21 +3047,25 @@ void Write_Dose_Array(const std::shared_ptr<Image_Array>& IA, const std::string
     }
 
     //Insert the raw pixel data.
-    std::vector<uint32_t> shtl;
-    shtl.reserve(num_of_imgs * col_count * row_count);
-    for(const auto &p_img : IA->imagecoll.images){
+    //
+    // Note: images were re-ordered above, so the image pointers are refreshed.
+    imgs.clear();
+    for(const auto &p_img : IA->imagecoll.images) imgs.push_back( &p_img );
+
+    std::vector<uint32_t> shtl(num_of_imgs * col_count * row_count);
+    for_each_img([&](size_t i) -> void {
+        const auto &p_img = *(imgs[i]);
 
         //Convert each pixel to the required format, scaling by the dose factor as needed.
         const long int channel = 0; // Ignore other channels for now. TODO.
-        for(long int r = 0; r < row_count; r++){
-            for(long int c = 0; c < col_count; c++){
-                const auto val = p_img.value(r, c, channel);
-                const auto scaled = std::round( std::abs(val/dose_scaling) );
-                auto as_uint = static_cast<uint32_t>(scaled);
-                shtl.push_back(as_uint);
-            }
+        const auto N_chnls = p_img.channels;
+        auto *out = shtl.data() + i * (row_count * col_count);
+        for(long int v = 0; v < (row_count * col_count); ++v){
+            const auto val = p_img.data[v * N_chnls + channel];
+            const auto scaled = std::round( std::abs(val/dose_scaling) );
+            out[v] = static_cast<uint32_t>(scaled);
         }
-    }
+    });
     {
         auto tag_ptr = tds->getTag(0x7FE0, 0, 0x0010, true);
         //FUNCINFO("Re-reading the tag.  Type is " << tag_ptr->getDataType() << ",  #_of_buffers = " <<
@@ -2932,89 +3131,37 @@ void Write_CT_Images(const std::shared_ptr<Image_Array>& IA,
     // TODO: Sample any existing UID (ReferencedFrameOfReferenceUID or FrameOfReferenceUID). 
     // Probably OK to use only the first in this case though...
 
-    long int InstanceNumber = -1;
-    for(const auto &animg : IA->imagecoll.images){
-        if( (animg.rows <= 0) || (animg.columns <= 0) || (animg.channels <= 0) ){
-            continue;
-        }
-
-        ++InstanceNumber;
+    // Metadata consulted by the tags that are typically shared by all slices in a series. Slices with identical values
+    // share a single pre-built tag template, so only the per-slice tags need to be generated for each file.
+    //
+    // Note: only these keys are available when building the template, so tags that depend on other metadata must be
+    //       added per-slice.
+    const std::vector<std::string> shared_keys = {{
+        "InstanceCreationDate", "InstanceCreationTime", "InstanceCreatorUID",
+        "PatientsName", "PatientID", "PatientsBirthDate", "PatientsSex",
+        "StudyInstanceUID", "StudyDate", "StudyTime", "ReferringPhysiciansName", "StudyID", "StudyDescription",
+        "SeriesInstanceUID", "SeriesNumber", "SeriesDate", "SeriesTime", "SeriesDescription", "PatientPosition",
+        "Manufacturer",
+        "FrameOfReferenceUID",
+        "KVP" }};
+
+    const DCMA_DICOM::Encoding enc = DCMA_DICOM::Encoding::ELE;
+    std::string TransferSyntaxUID;
+    if(enc == DCMA_DICOM::Encoding::ELE){
+        TransferSyntaxUID = "1.2.840.10008.1.2.1";
+    }else if(enc == DCMA_DICOM::Encoding::ILE){
+        TransferSyntaxUID = "1.2.840.10008.1.2";
+    }else{
+        throw std::runtime_error("Unsupported transfer syntax requested. Cannot continue.");
+    }
 
-        DCMA_DICOM::Encoding enc = DCMA_DICOM::Encoding::ELE;
+    const auto make_template = [&](std::map<std::string, std::string> cm) -> DCMA_DICOM::Node {
         DCMA_DICOM::Node root_node;
 
-        const auto SOPInstanceUID = Generate_Random_UID(60);
-
-        //auto cm = IA->imagecoll.get_common_metadata({});
-        auto cm = animg.metadata;
-
-        //Replace any metadata that might be used to underhandedly link patients, if requested.
-        if((Paranoia == ParanoiaLevel::Medium) || (Paranoia == ParanoiaLevel::High)){
-            //SOP Common Module.
-            cm["InstanceCreationDate"] = "";
-            cm["InstanceCreationTime"] = "";
-            cm["InstanceCreatorUID"] = InstanceCreatorUID;
-
-            //Patient Module.
-            cm["PatientsBirthDate"] = "";
-            cm["PatientsGender"]    = "";
-            cm["PatientsBirthTime"] = "";
-
-            //General Study Module.
-            cm["StudyInstanceUID"] = StudyInstanceUID;
-            cm["StudyDate"] = "";
-            cm["StudyTime"] = "";
-            cm["ReferringPhysiciansName"] = "";
-            cm["StudyID"] = StudyID;
-            cm["AccessionNumber"] = "";
-            cm["StudyDescription"] = "";
-
-            //General Series Module.
-            cm["SeriesInstanceUID"] = SeriesInstanceUID;
-            cm["SeriesNumber"] = "";
-            cm["SeriesDate"] = "";
-            cm["SeriesTime"] = "";
-            cm["SeriesDescription"] = "";
-            cm["RequestedProcedureID"] = "";                          // Appropriate?
-            cm["ScheduledProcedureStepID"] = "";                          // Appropriate?
-            cm["OperatorsName"] = "";                          // Appropriate?
-
-            //Patient Study Module.
-            cm["PatientsWeight"] = "";                          // Appropriate?
-
-            //Frame of Reference Module.
-            cm["PositionReferenceIndicator"] = "";              // Appropriate?
-
-            //General Equipment Module.
-            cm["Manufacturer"] = "";
-            cm["InstitutionName"] = "";             // Appropriate?
-            cm["StationName"] = "";             // Appropriate?
-            cm["InstitutionalDepartmentName"] = "";             // Appropriate?
-            cm["ManufacturersModelName"] = "";
-            cm["SoftwareVersions"] = "";
-        }
-        if(Paranoia == ParanoiaLevel::High){
-            //Patient Module.
-            cm["PatientsName"]      = "";
-            cm["PatientID"]         = PatientID;
-
-            //Frame of Reference Module.
-            cm["FrameOfReferenceUID"] = FrameOfReferenceUID;
-        }
-
         //-------------------------------------------------------------------------------------------------
         //DICOM Header Metadata.
         root_node.emplace_child_node({{0x0002, 0x0001}, "OB", std::string("\x0\x1", 2)}); // FileMetaInformationVersion
         root_node.emplace_child_node({{0x0002, 0x0002}, "UI", "1.2.840.10008.5.1.4.1.1.2"}); // MediaStorageSOPClassUID -- CT Image Storage.
-        root_node.emplace_child_node({{0x0002, 0x0003}, "UI", SOPInstanceUID}); // MediaStorageSOPInstanceUID
-        std::string TransferSyntaxUID;
-        if(enc == DCMA_DICOM::Encoding::ELE){
-            TransferSyntaxUID = "1.2.840.10008.1.2.1";
-        }else if(enc == DCMA_DICOM::Encoding::ILE){
-            TransferSyntaxUID = "1.2.840.10008.1.2";
-        }else{
-            throw std::runtime_error("Unsupported transfer syntax requested. Cannot continue.");
-        }
         root_node.emplace_child_node({{0x0002, 0x0010}, "UI", TransferSyntaxUID}); // TransferSyntaxUID
 
         root_node.emplace_child_node({{0x0002, 0x0012}, "UI", "1.2.513.264.765.1.1.578"}); // ImplementationClassUID
@@ -3023,13 +3170,11 @@ void Write_CT_Images(const std::shared_ptr<Image_Array>& IA,
         //-------------------------------------------------------------------------------------------------
         //SOP Common Module.
         root_node.emplace_child_node({{0x0008, 0x0016}, "UI", "1.2.840.10008.5.1.4.1.1.2"}); // SOPClassUID -- CT Image Storage.
-        root_node.emplace_child_node({{0x0008, 0x0018}, "UI", SOPInstanceUID}); // SOPInstanceUID
         root_node.emplace_child_node({{0x0008, 0x0005}, "CS", "ISO_IR 192"}); // 'ISO_IR 192' = UTF-8.
         root_node.emplace_child_node({{0x0008, 0x0012}, "DA", fne({ cm["InstanceCreationDate"], "19720101" }) });
         root_node.emplace_child_node({{0x0008, 0x0013}, "TM", fne({ cm["InstanceCreationTime"], "010101" }) });
         root_node.emplace_child_node({{0x0008, 0x0014}, "UI", foe({ cm["InstanceCreatorUID"] }) });
         //root_node.emplace_child_node({{0x0008, 0x0114}, "UI", foe({ cm["CodingSchemeExternalUID"] }) });                 // Appropriate?
-        //root_node.emplace_child_node({{0x0020, 0x0013}, "IS", std::to_string(InstanceNumber) });
 
         //-------------------------------------------------------------------------------------------------
         //Patient Module.
@@ -3079,11 +3224,51 @@ void Write_CT_Images(const std::shared_ptr<Image_Array>& IA,
 
         //-------------------------------------------------------------------------------------------------
         //General Image Module.
-        root_node.emplace_child_node({{0x0020, 0x0013}, "IS", std::to_string(InstanceNumber) });
         root_node.emplace_child_node({{0x0020, 0x0020}, "CS", "" }); // PatientOrientation.
+        root_node.emplace_child_node({{0x0008, 0x0008}, "CS", R"***(DERIVED\SECONDARY\AXIAL)***" }); //ImageType, note AXIAL can also mean coronal or transverse.
+
+        //-------------------------------------------------------------------------------------------------
+        //Image Pixel Module.
+        root_node.emplace_child_node({{0x0028, 0x0100}, "US", "16" }); // BitsAllocated, per sample (i.e., per channel).
+        root_node.emplace_child_node({{0x0028, 0x0101}, "US", "16" }); // BitsStored.
+        root_node.emplace_child_node({{0x0028, 0x0102}, "US", "15" }); // HighBit, should be BitsStored-1.
+        root_node.emplace_child_node({{0x0028, 0x0103}, "US", "1" }); // PixelRepresentation, 0 for unsigned, 1 for 2's complement.
+
+        //-------------------------------------------------------------------------------------------------
+        //CT Image Module.
+        //
+        // Note: many elements in this module are duplicated in other modules. Omitted here if they appear above.
+        //
+        root_node.emplace_child_node({{0x0028, 0x1052}, "DS", "0" }); //RescaleIntercept.
+        root_node.emplace_child_node({{0x0028, 0x1053}, "DS", "1" }); //RescaleSlope.
+        root_node.emplace_child_node({{0x0028, 0x1054}, "LO", "HU" }); //RescaleType, 'HU' for Hounsfield units, or 'US' for unspecified.
+        root_node.emplace_child_node({{0x0018, 0x0060}, "DS", foe({ cm["KVP"] }) });
+
+        //-------------------------------------------------------------------------------------------------
+        //VOI LUT Module.
+        //
+        root_node.emplace_child_node({{0x0028, 0x1050}, "DS", "0" }); //WindowCenter.
+        root_node.emplace_child_node({{0x0028, 0x1051}, "DS", "1000" }); //WindowWidth
+
+        return root_node;
+    };
+
+    // Adds the per-slice tags to a copy of the template and serializes the file.
+    const auto emit_slice = [=](const planar_image<float,double> &animg,
+                                std::shared_ptr<const DCMA_DICOM::Node> tmpl,
+                                std::map<std::string, std::string> cm,
+                                const std::string &SOPInstanceUID,
+                                long int InstanceNumber) -> std::unique_ptr<std::stringstream> {
+        DCMA_DICOM::Node root_node = *tmpl;
+
+        root_node.emplace_child_node({{0x0002, 0x0003}, "UI", SOPInstanceUID}); // MediaStorageSOPInstanceUID
+        root_node.emplace_child_node({{0x0008, 0x0018}, "UI", SOPInstanceUID}); // SOPInstanceUID
+
+        //-------------------------------------------------------------------------------------------------
+        //General Image Module.
+        root_node.emplace_child_node({{0x0020, 0x0013}, "IS", std::to_string(InstanceNumber) });
         root_node.emplace_child_node({{0x0008, 0x0023}, "DA", foe({ cm["ContentDate"] }) });
         root_node.emplace_child_node({{0x0008, 0x0033}, "TM", foe({ cm["ContentTime"] }) });
-        root_node.emplace_child_node({{0x0008, 0x0008}, "CS", R"***(DERIVED\SECONDARY\AXIAL)***" }); //ImageType, note AXIAL can also mean coronal or transverse.
         root_node.emplace_child_node({{0x0008, 0x0022}, "DA", foe({ cm["AcquisitionDate"] }) });
         root_node.emplace_child_node({{0x0008, 0x0032}, "TM", foe({ cm["AcquisitionTime"] }) });
         root_node.emplace_child_node({{0x0020, 0x0012}, "IS", foe({ cm["AcquisitionNumber"] }) });
@@ -3119,26 +3304,25 @@ void Write_CT_Images(const std::shared_ptr<Image_Array>& IA,
         root_node.emplace_child_node({{0x0028, 0x0004}, "CS", PhotometricInterpretation });
         root_node.emplace_child_node({{0x0028, 0x0010}, "US", std::to_string(animg.rows) });
         root_node.emplace_child_node({{0x0028, 0x0011}, "US", std::to_string(animg.columns) });
-
-        root_node.emplace_child_node({{0x0028, 0x0100}, "US", "16" }); // BitsAllocated, per sample (i.e., per channel).
-        root_node.emplace_child_node({{0x0028, 0x0101}, "US", "16" }); // BitsStored.
-        root_node.emplace_child_node({{0x0028, 0x0102}, "US", "15" }); // HighBit, should be BitsStored-1.
-        root_node.emplace_child_node({{0x0028, 0x0103}, "US", "1" }); // PixelRepresentation, 0 for unsigned, 1 for 2's complement.
         if(animg.channels != 1){
             root_node.emplace_child_node({{0x0028, 0x0006}, "US", "0" }); // PlanarConfiguration, 0 for R1, G1, B1, R2, G2, ..., and 1 for R1 R2 R3 ....
         }
 
         {
-            std::stringstream ss_pixels;
-            for(long int row = 0; row != animg.rows; ++row){
-                for(long int col = 0; col != animg.columns; ++col){
-                    for(long int chnl = 0; chnl != animg.channels; ++chnl){
-                        auto val = static_cast<int16_t>( std::round( animg.value(row, col, chnl ) ) );
-                        ss_pixels.write( reinterpret_cast<const char *>(&val), sizeof(val) );
-                    }
-                }
+            // Voxels are stored in the same (row, column, channel) order that they are written, so the buffer is
+            // encoded directly rather than voxel-by-voxel through a stream.
+            const auto N_voxels = animg.rows * animg.columns * animg.channels;
+            if(static_cast<long int>(animg.data.size()) != N_voxels){
+                throw std::logic_error("Image voxel buffer does not match image dimensions. Refusing to continue.");
+            }
+            std::string pixels(N_voxels * sizeof(int16_t), '\0');
+            for(long int i = 0; i < N_voxels; ++i){
+                const auto val = static_cast<int16_t>( std::round( animg.data[i] ) );
+                const auto u = static_cast<uint16_t>(val);
+                pixels[2*i + 0] = static_cast<char>(u & 0xFF); // Little-endian.
+                pixels[2*i + 1] = static_cast<char>((u >> 8) & 0xFF);
             }
-            root_node.emplace_child_node({{0x7FE0, 0x0010}, "OB", ss_pixels.str() }); // PixelData.
+            root_node.emplace_child_node({{0x7FE0, 0x0010}, "OB", std::move(pixels) }); // PixelData.
 
             // Note: the standard mentions that:
             //
@@ -3149,33 +3333,127 @@ void Write_CT_Images(const std::shared_ptr<Image_Array>& IA,
             // Could I use a floating-point pixel data in lieu of compressing into 16 bits? It seems to only apply to parametric images module. TODO.
         }
 
-        //-------------------------------------------------------------------------------------------------
-        //CT Image Module.
-        //
-        // Note: many elements in this module are duplicated in other modules. Omitted here if they appear above.
-        //
-        root_node.emplace_child_node({{0x0028, 0x1052}, "DS", "0" }); //RescaleIntercept.
-        root_node.emplace_child_node({{0x0028, 0x1053}, "DS", "1" }); //RescaleSlope.
-        root_node.emplace_child_node({{0x0028, 0x1054}, "LO", "HU" }); //RescaleType, 'HU' for Hounsfield units, or 'US' for unspecified.
-        root_node.emplace_child_node({{0x0018, 0x0060}, "DS", foe({ cm["KVP"] }) });
+        auto ss = std::make_unique<std::stringstream>();
+        const auto bytes_reqd = root_node.emit_DICOM(*ss, enc);
+        if(!(*ss)) throw std::runtime_error("Stream not in good state after emitting DICOM file");
+        if(bytes_reqd <= 0) throw std::runtime_error("Not enough DICOM data available for valid file");
+        return ss;
+    };
 
-        //-------------------------------------------------------------------------------------------------
-        //VOI LUT Module.
-        //
-        root_node.emplace_child_node({{0x0028, 0x1050}, "DS", "0" }); //WindowCenter.
-        root_node.emplace_child_node({{0x0028, 0x1051}, "DS", "1000" }); //WindowWidth
+    // Files are encoded concurrently, but are passed to the user's handler in order from this thread. The number of
+    // encoded files awaiting the handler is bounded to limit memory usage when the handler (e.g., disk I/O or
+    // compression) is the bottleneck.
+    const auto N_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t max_outstanding = 2 * N_threads;
+    std::map<std::vector<std::string>, std::shared_ptr<const DCMA_DICOM::Node>> templates;
+    std::deque<std::future<std::unique_ptr<std::stringstream>>> outstanding;
+
+    const auto handle_next = [&](){
+        auto ss = outstanding.front().get();
+        outstanding.pop_front();
+        const auto fsize = static_cast<long int>(ss->tellp());
+        file_handler(*ss, fsize);
+        return;
+    };
 
-        // Send the file to the user's handler.
-        {
-            std::stringstream ss;
-            const auto bytes_reqd = root_node.emit_DICOM(ss, enc);
-            if(!ss) throw std::runtime_error("Stream not in good state after emitting DICOM file");
-            if(bytes_reqd <= 0) throw std::runtime_error("Not enough DICOM data available for valid file");
+    {
+        asio_thread_pool tp(N_threads);
+
+        long int InstanceNumber = -1;
+        for(const auto &animg : IA->imagecoll.images){
+            if( (animg.rows <= 0) || (animg.columns <= 0) || (animg.channels <= 0) ){
+                continue;
+            }
 
-            const auto fsize = static_cast<long int>(bytes_reqd);
-            file_handler(ss, fsize);
+            ++InstanceNumber;
+
+            const auto SOPInstanceUID = Generate_Random_UID(60);
+
+            //auto cm = IA->imagecoll.get_common_metadata({});
+            auto cm = animg.metadata;
+
+            //Replace any metadata that might be used to underhandedly link patients, if requested.
+            if((Paranoia == ParanoiaLevel::Medium) || (Paranoia == ParanoiaLevel::High)){
+                //SOP Common Module.
+                cm["InstanceCreationDate"] = "";
+                cm["InstanceCreationTime"] = "";
+                cm["InstanceCreatorUID"] = InstanceCreatorUID;
+
+                //Patient Module.
+                cm["PatientsBirthDate"] = "";
+                cm["PatientsGender"]    = "";
+                cm["PatientsBirthTime"] = "";
+
+                //General Study Module.
+                cm["StudyInstanceUID"] = StudyInstanceUID;
+                cm["StudyDate"] = "";
+                cm["StudyTime"] = "";
+                cm["ReferringPhysiciansName"] = "";
+                cm["StudyID"] = StudyID;
+                cm["AccessionNumber"] = "";
+                cm["StudyDescription"] = "";
+
+                //General Series Module.
+                cm["SeriesInstanceUID"] = SeriesInstanceUID;
+                cm["SeriesNumber"] = "";
+                cm["SeriesDate"] = "";
+                cm["SeriesTime"] = "";
+                cm["SeriesDescription"] = "";
+                cm["RequestedProcedureID"] = "";                          // Appropriate?
+                cm["ScheduledProcedureStepID"] = "";                          // Appropriate?
+                cm["OperatorsName"] = "";                          // Appropriate?
+
+                //Patient Study Module.
+                cm["PatientsWeight"] = "";                          // Appropriate?
+
+                //Frame of Reference Module.
+                cm["PositionReferenceIndicator"] = "";              // Appropriate?
+
+                //General Equipment Module.
+                cm["Manufacturer"] = "";
+                cm["InstitutionName"] = "";             // Appropriate?
+                cm["StationName"] = "";             // Appropriate?
+                cm["InstitutionalDepartmentName"] = "";             // Appropriate?
+                cm["ManufacturersModelName"] = "";
+                cm["SoftwareVersions"] = "";
+            }
+            if(Paranoia == ParanoiaLevel::High){
+                //Patient Module.
+                cm["PatientsName"]      = "";
+                cm["PatientID"]         = PatientID;
+
+                //Frame of Reference Module.
+                cm["FrameOfReferenceUID"] = FrameOfReferenceUID;
+            }
+
+            // Locate or build the template for this slice.
+            std::vector<std::string> shared_vals;
+            std::map<std::string, std::string> shared_cm;
+            for(const auto &k : shared_keys){
+                const auto it = cm.find(k);
+                shared_vals.emplace_back( (it == std::end(cm)) ? "" : it->second );
+                shared_cm[k] = shared_vals.back();
+            }
+            auto &tmpl = templates[shared_vals];
+            if(tmpl == nullptr){
+                tmpl = std::make_shared<const DCMA_DICOM::Node>( make_template(shared_cm) );
+            }
+
+            auto p = std::make_shared<std::promise<std::unique_ptr<std::stringstream>>>();
+            outstanding.emplace_back( p->get_future() );
+            tp.submit_task([p, emit_slice, &animg, tmpl, cm, SOPInstanceUID, InstanceNumber]() -> void {
+                try{
+                    p->set_value( emit_slice(animg, tmpl, cm, SOPInstanceUID, InstanceNumber) );
+                }catch(...){
+                    p->set_exception( std::current_exception() );
+                }
+            });
+
+            while(max_outstanding <= outstanding.size()) handle_next();
         }
-    }
+
+        while(!outstanding.empty()) handle_next();
+    } // Wait until all threads are done.
 
     return;
 }
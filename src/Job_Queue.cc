@@ -0,0 +1,199 @@
+//Job_Queue.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "Job_Queue.h"
+
+
+job_cancelled::job_cancelled(const std::string &what) : std::runtime_error(what) {}
+
+
+void job_status::notify() const {
+    if(this->on_update) this->on_update(*this);
+    return;
+}
+
+bool job_status::transition(state from, state to, const std::string &msg){
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        if(this->s != from) return false;
+        this->s = to;
+        this->message = msg;
+        if( (to == state::succeeded) || (to == state::failed) || (to == state::cancelled) ){
+            if(to == state::succeeded) this->progress = 1.0;
+            this->finished_cv.notify_all();
+        }
+    }
+    this->notify();
+    return true;
+}
+
+job_status::state job_status::get_state() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->s;
+}
+
+double job_status::get_progress() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->progress;
+}
+
+std::string job_status::get_message() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->message;
+}
+
+bool job_status::is_finished() const {
+    const auto l_s = this->get_state();
+    return (l_s == state::succeeded) || (l_s == state::failed) || (l_s == state::cancelled);
+}
+
+void job_status::wait() const {
+    std::unique_lock<std::mutex> lock(this->m);
+    this->finished_cv.wait(lock, [&]() -> bool {
+        return (this->s == state::succeeded) || (this->s == state::failed) || (this->s == state::cancelled);
+    });
+    return;
+}
+
+bool job_status::is_cancel_requested() const {
+    return this->cancel_requested.load();
+}
+
+void job_status::set_progress(double fraction, const std::string &msg){
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        this->progress = std::clamp(fraction, 0.0, 1.0);
+        this->message = msg;
+    }
+    this->notify();
+    return;
+}
+
+void job_status::request_cancellation(){
+    this->cancel_requested.store(true);
+
+    // Jobs that have not yet started are cancelled immediately. The queue disregards them when they are reached.
+    this->transition(state::queued, state::cancelled, "Cancelled before starting");
+    return;
+}
+
+
+job_queue::job_queue(size_t max_concurrent, size_t memory_budget) : memory_budget(memory_budget) {
+    auto n = (max_concurrent == 0) ? std::thread::hardware_concurrency()
+                                   : max_concurrent;
+    if(n == 0) n = 2;
+    for(size_t i = 0; i < n; ++i){
+        this->workers.emplace_back([this](){ this->worker_loop(); });
+    }
+}
+
+job_queue::~job_queue(){
+    std::list<entry> l_pending;
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        this->should_quit = true;
+        l_pending.swap(this->pending);
+    }
+    this->cv.notify_all();
+    for(auto &e : l_pending) e.status->request_cancellation();
+    for(auto &w : this->workers) w.join();
+}
+
+std::shared_ptr<job_status> job_queue::submit(job_t job,
+                                              size_t estimated_bytes,
+                                              std::function<void(const job_status &)> on_update){
+    auto status = std::make_shared<job_status>();
+    status->on_update = std::move(on_update);
+    status->message = "Waiting to start";
+    {
+        std::lock_guard<std::mutex> lock(this->m);
+        this->pending.push_back( entry{ status, std::move(job), estimated_bytes } );
+    }
+    this->cv.notify_all();
+    return status;
+}
+
+size_t job_queue::jobs_ahead_of(const std::shared_ptr<job_status> &status) const {
+    std::lock_guard<std::mutex> lock(this->m);
+    size_t n = 0;
+    for(const auto &e : this->pending){
+        if(e.status == status) return n;
+        if(e.status->get_state() == job_status::state::queued) ++n;
+    }
+    return 0;
+}
+
+size_t job_queue::queued_jobs() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return static_cast<size_t>(std::count_if(std::begin(this->pending), std::end(this->pending), [](const entry &e){
+        return (e.status->get_state() == job_status::state::queued);
+    }));
+}
+
+size_t job_queue::active_jobs() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->running_jobs;
+}
+
+void job_queue::worker_loop(){
+    while(true){
+        entry e;
+        {
+            std::unique_lock<std::mutex> lock(this->m);
+            while(true){
+                if(this->should_quit) return;
+
+                // Discard jobs that were cancelled while queued.
+                while( !this->pending.empty()
+                       && (this->pending.front().status->get_state() != job_status::state::queued) ){
+                    this->pending.pop_front();
+                }
+
+                if(!this->pending.empty()){
+                    const auto &head = this->pending.front();
+                    const bool fits = (this->memory_budget == 0)
+                                   || (this->running_jobs == 0)
+                                   || ((this->running_bytes + head.estimated_bytes) <= this->memory_budget);
+                    if(fits) break;
+                }
+                this->cv.wait(lock);
+            }
+
+            e = std::move(this->pending.front());
+            this->pending.pop_front();
+            ++(this->running_jobs);
+            this->running_bytes += e.estimated_bytes;
+        }
+
+        // The job may have been cancelled after it was dequeued, but before it was marked as running.
+        if(e.status->transition(job_status::state::queued, job_status::state::running, "Running")){
+            try{
+                e.job(*(e.status));
+                e.status->transition(job_status::state::running, job_status::state::succeeded, "Completed");
+            }catch(const job_cancelled &ex){
+                e.status->transition(job_status::state::running, job_status::state::cancelled, ex.what());
+            }catch(const std::exception &ex){
+                e.status->transition(job_status::state::running, job_status::state::failed, ex.what());
+            }catch(...){
+                e.status->transition(job_status::state::running, job_status::state::failed, "Unknown failure");
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            --(this->running_jobs);
+            this->running_bytes -= e.estimated_bytes;
+        }
+        this->cv.notify_all();
+    }
+}
+
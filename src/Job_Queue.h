@@ -0,0 +1,126 @@
+//Job_Queue.h.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// The shared state of a single job submitted to a job_queue.
+//
+// Jobs report progress and poll for cancellation through this object. Clients can query it, wait on it, or receive
+// notifications via the update callback provided at submission. Cancellation is cooperative: queued jobs are cancelled
+// immediately, but running jobs are only interrupted when they next check is_cancel_requested(). A running job is only
+// considered cancelled if it stops early by throwing job_cancelled; a job that runs to completion has succeeded, even
+// if cancellation was requested.
+class job_status {
+  public:
+    enum class state {
+        queued,
+        running,
+        succeeded,
+        failed,
+        cancelled,
+    };
+
+  private:
+    mutable std::mutex m;
+    mutable std::condition_variable finished_cv;
+    state s = state::queued;
+    double progress = 0.0; // Fractional, [0:1].
+    std::string message;
+    std::atomic<bool> cancel_requested = false;
+
+    // Invoked whenever the state, progress, or message changes. Called from arbitrary threads, without any locks held.
+    std::function<void(const job_status &)> on_update;
+
+    friend class job_queue;
+    void notify() const;
+    bool transition(state from, state to, const std::string &msg);
+
+  public:
+    state get_state() const;
+    double get_progress() const;
+    std::string get_message() const;
+    bool is_finished() const;
+
+    // Block until the job has finished.
+    void wait() const;
+
+    // Job-facing members.
+    bool is_cancel_requested() const;
+    void set_progress(double fraction, const std::string &msg);
+
+    // Client-facing members.
+    void request_cancellation();
+};
+
+
+// Thrown by jobs to report that they stopped early in response to a cancellation request.
+class job_cancelled : public std::runtime_error {
+  public:
+    explicit job_cancelled(const std::string &what);
+};
+
+
+// A first-in, first-out job queue with bounded concurrency and memory admission control.
+//
+// At most 'max_concurrent' jobs run at once. Each job declares an estimate of the memory it will consume, and a job is
+// only started when the total estimate of running jobs (including itself) fits within the memory budget. A job that
+// exceeds the budget on its own is run when no other jobs are running. Jobs are started in submission order, so large
+// jobs are not starved by a stream of small jobs.
+class job_queue {
+  public:
+    using job_t = std::function<void(job_status &)>;
+
+  private:
+    struct entry {
+        std::shared_ptr<job_status> status;
+        job_t job;
+        size_t estimated_bytes = 0;
+    };
+
+    const size_t memory_budget; // In bytes. Zero means unlimited.
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::list<entry> pending;
+    size_t running_jobs = 0;
+    size_t running_bytes = 0;
+    bool should_quit = false;
+
+    std::vector<std::thread> workers;
+
+    void worker_loop();
+
+  public:
+    // A 'max_concurrent' of zero selects the hardware concurrency. A 'memory_budget' of zero disables memory admission
+    // control.
+    explicit job_queue(size_t max_concurrent = 0, size_t memory_budget = 0);
+
+    // Cancels any pending jobs and waits for running jobs to finish.
+    ~job_queue();
+
+    job_queue(const job_queue &) = delete;
+    job_queue &operator=(const job_queue &) = delete;
+
+    std::shared_ptr<job_status> submit(job_t job,
+                                       size_t estimated_bytes = 0,
+                                       std::function<void(const job_status &)> on_update = {});
+
+    // The number of jobs waiting to start that were submitted before the given job. Zero if the job is not waiting.
+    size_t jobs_ahead_of(const std::shared_ptr<job_status> &status) const;
+
+    size_t queued_jobs() const;
+    size_t active_jobs() const;
+};
+
@@ -0,0 +1,255 @@
+//KineticModel_1Compartment_ClosedForm.cc - A part of DICOMautomaton 2021. Written by hal clark.
+//
+// This file contains host implementations of the closed-form single-compartment perfusion models. The math follows
+// the stand-alone SYCL prototypes (see sycl/src/Perfusion_SCDI.cc and sycl/src/Perfusion_SCSI.cc), but the per-curve
+// vector arithmetic has been expanded into inner products so that all curves can be accumulated in a single pass.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "YgorMath.h"         //Needed for samples_1D.
+
+#include "Thread_Pool.h"
+#include "KineticModel_1Compartment_ClosedForm.h"
+
+
+void
+KineticModel_1Compartment_ClosedForm_Batch::resize(long int curves, long int samples){
+    if( (curves < 0) || (samples < 0) ){
+        throw std::invalid_argument("Batch dimensions must be non-negative");
+    }
+    this->N_curves  = curves;
+    this->N_samples = samples;
+
+    this->c.assign(curves * samples, 0.0f);
+    this->k1A.assign(curves, std::numeric_limits<float>::quiet_NaN());
+    this->k1V.assign(curves, std::numeric_limits<float>::quiet_NaN());
+    this->k2.assign(curves, std::numeric_limits<float>::quiet_NaN());
+    return;
+}
+
+
+std::vector<float>
+Resample_Time_Course_Regularly(const samples_1D<double> &s, double dt){
+    if(!(0.0 < dt)){
+        throw std::invalid_argument("Resampling interval must be positive");
+    }
+    const auto cropped   = s.Select_Those_Within_Inc(0.0, std::numeric_limits<double>::infinity());
+    if(cropped.samples.empty()){
+        throw std::invalid_argument("Time course contains no samples at or after t=0");
+    }
+    const auto extrema_x = cropped.Get_Extreme_Datum_x();
+    if(0.0 < extrema_x.first[0]){
+        throw std::logic_error("Time courses should start at 0. Please adjust the time course.");
+    }
+
+    std::vector<float> resampled;
+    const auto N = static_cast<long int>(std::floor(extrema_x.second[0] / dt)) + 1;
+    if(1'000'000 < N){
+        throw std::runtime_error("Excessive number of samples detected. Is this intended?");
+    }
+    resampled.reserve(N);
+    for(long int n = 0; n < N; ++n){
+        const double t = static_cast<double>(n) * dt;
+        resampled.emplace_back(static_cast<float>(cropped.Interpolate_Linearly(t)[2]));
+    }
+    return resampled;
+}
+
+
+void
+Fit_1Compartment_ClosedForm(const KineticModel_1Compartment_ClosedForm_Inputs &inputs,
+                            KineticModel_1Compartment_ClosedForm_Batch &batch){
+
+    const bool dual = (inputs.variant == KineticModel_1Compartment_ClosedForm_Variant::DualInput);
+    const auto N  = batch.N_samples;
+    const auto Nc = batch.N_curves;
+    const auto W  = inputs.slope_window;
+    const double dt = inputs.dt;
+
+    if(Nc == 0) return;
+    if(N < 2){
+        throw std::invalid_argument("At least two samples are required");
+    }
+    if( (static_cast<long int>(batch.c.size()) != (N * Nc))
+    ||  (static_cast<long int>(batch.k1A.size()) != Nc)
+    ||  (static_cast<long int>(batch.k1V.size()) != Nc)
+    ||  (static_cast<long int>(batch.k2.size()) != Nc) ){
+        throw std::invalid_argument("Batch storage is inconsistent with the batch dimensions");
+    }
+    if( (static_cast<long int>(inputs.aif.size()) != N)
+    ||  (dual && (static_cast<long int>(inputs.vif.size()) != N)) ){
+        throw std::invalid_argument("Input functions and tissue curves must have the same number of samples");
+    }
+    if( dual && ((W < 2) || (N < W)) ){
+        throw std::invalid_argument("Slope window must contain at least two samples and fit within the time course");
+    }
+    if(!(0.0 < dt)){
+        throw std::invalid_argument("Sampling interval must be positive");
+    }
+
+    // Quantities that are shared by all curves.
+    //
+    // Note that the original prototypes compare c(t) with c(t+dt) using truncated copies of each time course, but take
+    // the difference as c(t) - c(t+dt), which negates the fitted single-input parameters. The forward difference is
+    // used here. The 'a', 'v', 's', and 'd' vectors are never materialized; only their inner products are accumulated,
+    // where
+    //   a_i = aif_i + aif_{i+1},   v_i = vif_i + vif_{i+1},
+    //   s_i = c_i + c_{i+1},       d_i = 2 (c_{i+1} - c_i).
+    const double sum_aif = std::accumulate(std::begin(inputs.aif), std::end(inputs.aif), 0.0);
+    const double sum_vif = dual ? std::accumulate(std::begin(inputs.vif), std::end(inputs.vif), 0.0) : 0.0;
+
+    std::vector<double> a(N-1, 0.0);
+    std::vector<double> v(N-1, 0.0);
+    double Saa = 0.0;
+    double Svv = 0.0;
+    double Sav = 0.0;
+    for(long int i = 0; i < (N-1); ++i){
+        a[i] = static_cast<double>(inputs.aif[i]) + static_cast<double>(inputs.aif[i+1]);
+        if(dual) v[i] = static_cast<double>(inputs.vif[i]) + static_cast<double>(inputs.vif[i+1]);
+        Saa += a[i] * a[i];
+        Svv += v[i] * v[i];
+        Sav += a[i] * v[i];
+    }
+
+    // Late-time linear regression over the trailing window. The abscissae are identical for every curve, so only the
+    // ordinate-dependent sums need to be accumulated per curve.
+    const long int W_begin = N - W;
+    double t_mean = 0.0;
+    for(long int i = W_begin; i < N; ++i) t_mean += dt * static_cast<double>(i);
+    t_mean /= static_cast<double>(W);
+    double Stt = 0.0;
+    for(long int i = W_begin; i < N; ++i) Stt += std::pow(dt * static_cast<double>(i) - t_mean, 2.0);
+
+    const auto linear_fit = [&](const std::vector<float> &f) -> std::pair<double,double> {
+        double f_mean = 0.0;
+        double Stf = 0.0;
+        for(long int i = W_begin; i < N; ++i){
+            f_mean += f[i];
+            Stf += (dt * static_cast<double>(i) - t_mean) * f[i];
+        }
+        f_mean /= static_cast<double>(W);
+        const double slope = Stf / Stt;
+        return { slope, f_mean - slope * t_mean };
+    };
+
+    const double t_mid = (static_cast<double>(N) - static_cast<double>(W) * 0.5) * dt;
+    double AIF_pt = 0.0;
+    double VIF_pt = 0.0;
+    if(dual){
+        const auto aif_fit = linear_fit(inputs.aif);
+        const auto vif_fit = linear_fit(inputs.vif);
+        AIF_pt = t_mid * aif_fit.first + aif_fit.second;
+        VIF_pt = t_mid * vif_fit.first + vif_fit.second;
+    }
+    const double kappa = dual ? sum_aif / sum_vif : 0.0;
+    const double dt2 = dt * dt;
+
+    // Process blocks of curves concurrently. Within a block, time is the outer loop and curves are the inner loop, so
+    // each sample row is streamed once with unit stride.
+    const long int block_size = 1024;
+    asio_thread_pool tp;
+    for(long int j_begin = 0; j_begin < Nc; j_begin += block_size){
+        const long int j_end = std::min(Nc, j_begin + block_size);
+        tp.submit_task([&,j_begin,j_end]() -> void {
+            const long int B = j_end - j_begin;
+            std::vector<double> Sc(B, 0.0), Wc(B, 0.0), Wtc(B, 0.0);
+            std::vector<double> Sas(B, 0.0), Svs(B, 0.0), Sss(B, 0.0);
+            std::vector<double> Sda(B, 0.0), Sdv(B, 0.0), Sds(B, 0.0);
+
+            for(long int i = 0; i < (N-1); ++i){
+                const float *r0 = batch.c.data() + (i * Nc + j_begin);
+                const float *r1 = r0 + Nc;
+                const double a_i = a[i];
+                const double v_i = v[i];
+                if(dual){
+                    for(long int j = 0; j < B; ++j){
+                        const double c0 = r0[j];
+                        const double c1 = r1[j];
+                        const double s = c0 + c1;
+                        const double d = 2.0 * (c1 - c0);
+                        Sc[j]  += c0;
+                        Sas[j] += a_i * s;
+                        Svs[j] += v_i * s;
+                        Sss[j] += s * s;
+                        Sda[j] += d * a_i;
+                        Sdv[j] += d * v_i;
+                        Sds[j] += d * s;
+                    }
+                }else{
+                    for(long int j = 0; j < B; ++j){
+                        const double c0 = r0[j];
+                        const double c1 = r1[j];
+                        const double s = c0 + c1;
+                        const double d = 2.0 * (c1 - c0);
+                        Sc[j]  += c0;
+                        Sas[j] += a_i * s;
+                        Sss[j] += s * s;
+                        Sda[j] += d * a_i;
+                        Sds[j] += d * s;
+                    }
+                }
+            }
+            {
+                const float *r = batch.c.data() + ((N-1) * Nc + j_begin);
+                for(long int j = 0; j < B; ++j) Sc[j] += r[j];
+            }
+            if(dual){
+                for(long int i = W_begin; i < N; ++i){
+                    const float *r = batch.c.data() + (i * Nc + j_begin);
+                    const double dt_i = dt * static_cast<double>(i) - t_mean;
+                    for(long int j = 0; j < B; ++j){
+                        Wc[j]  += r[j];
+                        Wtc[j] += dt_i * r[j];
+                    }
+                }
+            }
+
+            // Solve for the model parameters.
+            for(long int j = 0; j < B; ++j){
+                if(dual){
+                    const double c_slope = Wtc[j] / Stt;
+                    const double c_intercept = Wc[j] / static_cast<double>(W) - c_slope * t_mean;
+                    const double C_pt = t_mid * c_slope + c_intercept;
+
+                    const double denom = AIF_pt - kappa * VIF_pt;
+                    const double R = (C_pt - (Sc[j] / sum_vif) * VIF_pt) / denom;
+                    const double Q = c_slope / denom;
+                    const double M = (Sc[j] - R * sum_aif) / sum_vif;
+
+                    // E = dt (R a + M v - s),   F = dt Q (a - kappa v),   G = D - F.
+                    const double EE = dt2 * ( R * R * Saa + M * M * Svv + Sss[j]
+                                            + 2.0 * R * M * Sav - 2.0 * R * Sas[j] - 2.0 * M * Svs[j] );
+                    const double DE = dt * ( R * Sda[j] + M * Sdv[j] - Sds[j] );
+                    const double FE = dt2 * Q * ( R * Saa + M * Sav - Sas[j]
+                                                - kappa * (R * Sav + M * Svv - Svs[j]) );
+
+                    const double k2 = (DE - FE) / EE;
+                    batch.k2[j_begin + j]  = static_cast<float>(k2);
+                    batch.k1A[j_begin + j] = static_cast<float>(R * k2 + Q);
+                    batch.k1V[j_begin + j] = static_cast<float>(M * k2 - Q * kappa);
+
+                }else{
+                    const double dc_gain = Sc[j] / sum_aif;
+
+                    // E = dt (g a - s).
+                    const double EE = dt2 * ( dc_gain * dc_gain * Saa - 2.0 * dc_gain * Sas[j] + Sss[j] );
+                    const double DE = dt * ( dc_gain * Sda[j] - Sds[j] );
+
+                    const double k2 = DE / EE;
+                    batch.k2[j_begin + j]  = static_cast<float>(k2);
+                    batch.k1A[j_begin + j] = static_cast<float>(dc_gain * k2);
+                    batch.k1V[j_begin + j] = std::numeric_limits<float>::quiet_NaN();
+                }
+            }
+            return;
+        });
+    }
+    // Note: the thread pool destructor waits for all tasks to complete.
+    return;
+}
+
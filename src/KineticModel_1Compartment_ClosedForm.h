@@ -0,0 +1,73 @@
+//KineticModel_1Compartment_ClosedForm.h.
+
+#pragma once
+
+#include <vector>
+
+template <class T> class samples_1D;
+
+
+// Closed-form, linear single-compartment perfusion models.
+//
+// These are the single-compartment single-input (SCSI) and dual-input (SCDI) models that were originally prototyped
+// as stand-alone SYCL programs. Rather than fitting each voxel's time course with an iterative optimizer, the model
+// parameters are recovered from a handful of inner products. All inner products are linear in the tissue time course,
+// so they can be accumulated for many voxels simultaneously in a single streaming pass over the data.
+enum class KineticModel_1Compartment_ClosedForm_Variant {
+    SingleInput,   // SCSI: only an arterial input function is used.
+    DualInput,     // SCDI: both arterial and venous input functions are used.
+};
+
+
+// Input functions, shared by all voxels. These must be regularly sampled with spacing 'dt', starting at t=0.
+struct KineticModel_1Compartment_ClosedForm_Inputs {
+    KineticModel_1Compartment_ClosedForm_Variant variant = KineticModel_1Compartment_ClosedForm_Variant::DualInput;
+
+    double dt = 0.1; // In seconds.
+
+    // The number of trailing samples used to estimate the late-time (linear) behaviour of each time course.
+    long int slope_window = 100;
+
+    std::vector<float> aif;
+    std::vector<float> vif; // Ignored for the single-input model.
+};
+
+
+// A batch of tissue time courses and the fitted parameters for each.
+//
+// Time courses are stored sample-major (i.e., all voxels' first sample, then all voxels' second sample, etc.) so that
+// the innermost loops run over voxels with unit stride and can be vectorized.
+struct KineticModel_1Compartment_ClosedForm_Batch {
+    long int N_curves  = 0;
+    long int N_samples = 0;
+
+    std::vector<float> c; // c[sample * N_curves + curve].
+
+    // Fitted parameters, one per curve. k1V is NaN for the single-input model.
+    std::vector<float> k1A;
+    std::vector<float> k1V;
+    std::vector<float> k2;
+
+    // Allocate storage for the given number of curves and samples. Existing contents are discarded.
+    void resize(long int curves, long int samples);
+
+    // Access a single sample of a single curve.
+    float & sample(long int curve, long int n){
+        return this->c[ n * this->N_curves + curve ];
+    }
+};
+
+
+// Resample a time course with spacing 'dt' using linear interpolation. Samples are generated from t=0 until the last
+// sample in the time course. An exception is thrown if the time course does not span t=0.
+std::vector<float>
+Resample_Time_Course_Regularly(const samples_1D<double> &s, double dt);
+
+
+// Fit the model to every curve in the batch. Curves are partitioned into blocks which are processed concurrently.
+//
+// Throws if the inputs are inconsistent with the batch (e.g., differing sample counts).
+void
+Fit_1Compartment_ClosedForm(const KineticModel_1Compartment_ClosedForm_Inputs &inputs,
+                            KineticModel_1Compartment_ClosedForm_Batch &batch);
+
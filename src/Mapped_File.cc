@@ -0,0 +1,258 @@
+//Mapped_File.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "Thread_Pool.h"
+#include "Mapped_File.h"
+
+
+// ------------------------------------------------- mapped_file ------------------------------------------------------
+
+mapped_file::mapped_file(const std::filesystem::path &filename){
+#if !defined(_WIN32)
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0){
+        throw std::runtime_error("Unable to open file '" + filename.string() + "'");
+    }
+    struct stat sb;
+    if( (::fstat(fd, &sb) == 0)
+    &&  S_ISREG(sb.st_mode) ){
+        this->length = static_cast<size_t>(sb.st_size);
+        if(this->length == 0){
+            ::close(fd);
+            this->ptr = this->fallback.data();
+            return;
+        }
+        void *m = ::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m != MAP_FAILED){
+            // Parsers read the contents front to back.
+            ::madvise(m, this->length, MADV_SEQUENTIAL);
+            ::close(fd);
+            this->ptr = static_cast<const char *>(m);
+            this->is_mapped = true;
+            return;
+        }
+    }
+    ::close(fd);
+#endif
+
+    // Fall back to reading the whole file at once.
+    std::ifstream FI(filename, std::ios::in | std::ios::binary);
+    if(!FI){
+        throw std::runtime_error("Unable to open file '" + filename.string() + "'");
+    }
+    FI.seekg(0, std::ios::end);
+    const auto end = FI.tellg();
+    if(end < 0){
+        throw std::runtime_error("Unable to determine size of file '" + filename.string() + "'");
+    }
+    this->fallback.resize(static_cast<size_t>(end));
+    FI.seekg(0, std::ios::beg);
+    if( !this->fallback.empty()
+    &&  !FI.read(this->fallback.data(), static_cast<std::streamsize>(this->fallback.size())) ){
+        throw std::runtime_error("Unable to read file '" + filename.string() + "'");
+    }
+    this->ptr = this->fallback.data();
+    this->length = this->fallback.size();
+}
+
+void mapped_file::release(){
+#if !defined(_WIN32)
+    if(this->is_mapped){
+        ::munmap(const_cast<char *>(this->ptr), this->length);
+    }
+#endif
+    this->ptr = nullptr;
+    this->length = 0;
+    this->is_mapped = false;
+    this->fallback.clear();
+}
+
+mapped_file::~mapped_file(){
+    this->release();
+}
+
+mapped_file::mapped_file(mapped_file &&rhs) noexcept {
+    *this = std::move(rhs);
+}
+
+mapped_file & mapped_file::operator=(mapped_file &&rhs) noexcept {
+    if(this == &rhs) return *this;
+    this->release();
+
+    this->is_mapped = rhs.is_mapped;
+    this->length = rhs.length;
+    this->fallback = std::move(rhs.fallback);
+    this->ptr = (this->is_mapped) ? rhs.ptr : this->fallback.data();
+
+    rhs.ptr = nullptr;
+    rhs.length = 0;
+    rhs.is_mapped = false;
+    return *this;
+}
+
+
+// -------------------------------------------------- Parsing ---------------------------------------------------------
+
+std::vector<std::string_view> split_at_line_boundaries(std::string_view text, long int chunks){
+    std::vector<std::string_view> out;
+    if(text.empty()) return out;
+    chunks = std::max(1L, chunks);
+
+    const auto target = std::max<size_t>(1, text.size() / static_cast<size_t>(chunks));
+    while(!text.empty()){
+        size_t end = text.size();
+        if(target < text.size()){
+            const auto nl = text.find('\n', target - 1);
+            if(nl != std::string_view::npos) end = nl + 1;
+        }
+        out.emplace_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return out;
+}
+
+std::vector<std::string_view> split_for_concurrent_parsing(std::string_view text){
+    // Small texts are not worth the overhead of distributing.
+    const size_t min_chunk_size = 4UL * 1024UL * 1024UL;
+    const auto N_threads = std::max<long int>(1, static_cast<long int>(std::thread::hardware_concurrency()));
+    const auto N_chunks = std::min<long int>(N_threads * 4L, static_cast<long int>(text.size() / min_chunk_size));
+    return split_at_line_boundaries(text, N_chunks);
+}
+
+std::string_view pop_line(std::string_view &text){
+    const auto nl = text.find('\n');
+    auto line = text.substr(0, nl);
+    text.remove_prefix( (nl == std::string_view::npos) ? text.size() : (nl + 1) );
+    if(!line.empty() && (line.back() == '\r')) line.remove_suffix(1);
+    return line;
+}
+
+std::string_view strip_comment(std::string_view line, char comment){
+    const auto pos = line.find(comment);
+    if(pos != std::string_view::npos) line = line.substr(0, pos);
+    return line;
+}
+
+bool parse_number(std::string_view &text, double &out){
+    const char *first = text.data();
+    const char *last = text.data() + text.size();
+
+    // std::from_chars does not accept a leading '+', but std::strtod does.
+    if( (first != last) && (*first == '+') ){
+        ++first;
+        if( (first == last) || (*first == '-') || (*first == '+') ) return false;
+    }
+    if(first == last) return false;
+
+#if defined(__cpp_lib_to_chars)
+    double x;
+    const auto [ptr, ec] = std::from_chars(first, last, x, std::chars_format::general);
+    if(ec != std::errc()) return false;
+    out = x;
+    text.remove_prefix( static_cast<size_t>(ptr - text.data()) );
+    return true;
+#else
+    // Floating-point std::from_chars is not available, so copy the candidate token and defer to std::strtod.
+    const auto is_token_char = [](char c) -> bool {
+        return ( ('0' <= c) && (c <= '9') )
+            || ( ('a' <= c) && (c <= 'z') )
+            || ( ('A' <= c) && (c <= 'Z') )
+            || (c == '.') || (c == '-') || (c == '+') || (c == '(') || (c == ')') || (c == '_');
+    };
+    char buf[128];
+    size_t n = 0;
+    while( (first + n != last) && (n + 1 < sizeof(buf)) && is_token_char(first[n]) ){
+        buf[n] = first[n];
+        ++n;
+    }
+    buf[n] = '\0';
+    if( (n == 0) || (buf[0] == '-' && n == 1) ) return false;
+    if( (buf[0] == '0') && ((buf[1] == 'x') || (buf[1] == 'X')) ) return false;
+
+    errno = 0;
+    char *end = nullptr;
+    const double x = std::strtod(buf, &end);
+    if( (end == buf) || (errno == ERANGE) ) return false;
+    out = x;
+    text.remove_prefix( static_cast<size_t>((first - text.data()) + (end - buf)) );
+    return true;
+#endif
+}
+
+void extract_numbers(std::string_view text,
+                     std::vector<double> &out,
+                     std::string_view separators,
+                     char comment){
+    const auto is_separator = [&](char c) -> bool {
+        return (c == '\r') || (separators.find(c) != std::string_view::npos);
+    };
+
+    double x;
+    while(!text.empty()){
+        auto line = strip_comment(pop_line(text), comment);
+        while(!line.empty()){
+            if(is_separator(line.front())){
+                line.remove_prefix(1);
+                continue;
+            }
+            if(parse_number(line, x)) out.push_back(x);
+
+            // Skip the remainder of the token, if any.
+            while(!line.empty() && !is_separator(line.front())) line.remove_prefix(1);
+        }
+    }
+    return;
+}
+
+std::vector<double> extract_numbers_parallel(std::string_view text,
+                                             std::string_view separators,
+                                             char comment){
+    std::vector<double> out;
+    const auto chunks = split_for_concurrent_parsing(text);
+    if(chunks.size() < 2){
+        extract_numbers(text, out, separators, comment);
+        return out;
+    }
+
+    std::vector<std::vector<double>> results(chunks.size());
+    {
+        asio_thread_pool tp;
+        for(size_t i = 0; i < chunks.size(); ++i){
+            tp.submit_task([&,i]() -> void {
+                // Numbers typically occupy ten or more characters, so this avoids most regrowth.
+                results[i].reserve(chunks[i].size() / 8);
+                extract_numbers(chunks[i], results[i], separators, comment);
+            });
+        }
+    } // Wait for the tasks to complete.
+
+    size_t N = 0;
+    for(const auto &r : results) N += r.size();
+    out.reserve(N);
+    for(auto &r : results){
+        out.insert( std::end(out), std::begin(r), std::end(r) );
+        r = std::vector<double>();
+    }
+    return out;
+}
+
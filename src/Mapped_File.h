@@ -0,0 +1,102 @@
+//Mapped_File.h.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Read-only view of an entire file's contents.
+//
+// Where supported, the file is memory-mapped so that parsers can operate directly on the contents without copying the
+// file through a stream buffer. Otherwise the file is read into memory in a single read. Either way, the contents
+// remain valid for the lifetime of the object.
+//
+// Throws if the file cannot be opened or read.
+class mapped_file {
+    private:
+        const char *ptr = nullptr;
+        size_t length = 0;
+        bool is_mapped = false;
+        std::string fallback;  // Holds the contents when the file could not be mapped.
+
+        void release();
+
+    public:
+        explicit mapped_file(const std::filesystem::path &filename);
+        ~mapped_file();
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file & operator=(const mapped_file &) = delete;
+        mapped_file(mapped_file &&rhs) noexcept;
+        mapped_file & operator=(mapped_file &&rhs) noexcept;
+
+        const char * data() const { return this->ptr; }
+        size_t size() const { return this->length; }
+        std::string_view view() const { return std::string_view(this->ptr, this->length); }
+};
+
+
+// Splits the text into (at most) the requested number of contiguous chunks of roughly equal size. Chunks only end at
+// line boundaries (i.e., just after a '\n') or at the end of the text, so lines are never split between chunks.
+// Chunks are returned in order and are never empty.
+std::vector<std::string_view> split_at_line_boundaries(std::string_view text, long int chunks);
+
+// Splits the text at line boundaries into chunks suitable for concurrent parsing. Small texts are not split, and large
+// texts are split into several chunks per hardware thread to balance the load.
+std::vector<std::string_view> split_for_concurrent_parsing(std::string_view text);
+
+// Removes the next line from the front of the text and returns it without the trailing "\n" or "\r\n".
+std::string_view pop_line(std::string_view &text);
+
+// Returns the line with any comment, starting at the given character, removed.
+std::string_view strip_comment(std::string_view line, char comment = '#');
+
+// Attempts to parse a floating-point number from the front of the text, advancing past it on success.
+//
+// Accepts the forms std::strtod accepts in the "C" locale (including 'nan' and 'inf'), plus an optional leading '+',
+// but not leading whitespace or hexadecimal notation. On failure the text is left unmodified.
+bool parse_number(std::string_view &text, double &out);
+
+// Extracts all numbers from the text, which may span multiple lines.
+//
+// Tokens are delimited by any of the given separator characters or line endings, and comments (from the comment
+// character to the end of the line) are ignored. Like std::stod, tokens that begin with a number contribute it and
+// any trailing characters are ignored. Tokens that do not begin with a number are skipped.
+void extract_numbers(std::string_view text,
+                     std::vector<double> &out,
+                     std::string_view separators = " \t",
+                     char comment = '#');
+
+// Equivalent to extract_numbers(), but large texts are split at line boundaries and parsed concurrently.
+std::vector<double> extract_numbers_parallel(std::string_view text,
+                                             std::string_view separators = " \t",
+                                             char comment = '#');
+
+
+// Reads a scalar stored in little-endian byte order at the given address, which need not be aligned.
+template <class T>
+T read_little_endian(const char *p){
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    if(first != 1){ // Big-endian host.
+        for(size_t i = 0; i < sizeof(T) / 2; ++i){
+            const auto tmp = bytes[i];
+            bytes[i] = bytes[sizeof(T) - 1 - i];
+            bytes[sizeof(T) - 1 - i] = tmp;
+        }
+    }
+    T out;
+    std::memcpy(&out, bytes, sizeof(T));
+    return out;
+}
+
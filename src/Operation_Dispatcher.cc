@@ -3,22 +3,42 @@
 // This routine routes loaded data to/through specified operations.
 //
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <filesystem>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>    
+#include <system_error>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <Explicator.h>
 
 #include <YgorMisc.h>
+#include <YgorStats.h>
 
 #include "Structs.h"
+#include "Common_Boost_Serialization.h"
+#include "DCMA_Version.h"
+#include "Image_Fingerprint.h"
+#include "Image_Spill_Store.h"
+#include "Operation_Monitor.h"
+#include "Operation_Result_Cache.h"
+#include "Pointwise_Fusion.h"
+#include "Regex_Selectors.h"
+#include "Thread_Pool.h"
+#include "YgorImages_Functors/ConvenienceRoutines.h"
 
 #include "Operations/AccumulateRowsColumns.h"
 #include "Operations/AnalyzeHistograms.h"
@@ -32,6 +52,7 @@
 #include "Operations/BEDConvert.h"
 #include "Operations/BoostSerializeDrover.h"
 #include "Operations/BuildLexiconInteractively.h"
+#include "Operations/CacheCheckpoint.h"
 #include "Operations/ClusterDBSCAN.h"
 #include "Operations/ComparePixels.h"
 #include "Operations/ContourBasedRayCastDoseAccumulate.h"
@@ -122,6 +143,7 @@
 #include "Operations/GridBasedRayCastDoseAccumulate.h"
 #include "Operations/GroupImages.h"
 #include "Operations/GrowContours.h"
+#include "Operations/GrowROIsViaDistanceTransform.h"
 #include "Operations/HighlightROIs.h"
 #include "Operations/IfElse.h"
 #include "Operations/ImageRoutineTests.h"
@@ -133,6 +155,7 @@
 #include "Operations/MaxMinPixels.h"
 #include "Operations/MeldDose.h"
 #include "Operations/ModelIVIM.h"
+#include "Operations/ModelPerfusionClosedForm.h"
 #include "Operations/ModifyContourMetadata.h"
 #include "Operations/ModifyImageMetadata.h"
 #include "Operations/NegatePixels.h"
@@ -161,6 +184,7 @@
 #include "Operations/SpatialBlur.h"
 #include "Operations/SpatialDerivative.h"
 #include "Operations/SpatialSharpen.h"
+#include "Operations/SpillImagesToDisk.h"
 #include "Operations/Subsegment_ComputeDose_VanLuijk.h"
 #include "Operations/SubsegmentContours.h"
 #include "Operations/SubtractImages.h"
@@ -240,6 +264,7 @@ std::map<std::string, op_packet_t> Known_Operations(){
     out["BEDConvert"] = std::make_pair(OpArgDocBEDConvert, BEDConvert);
     out["BoostSerializeDrover"] = std::make_pair(OpArgDocBoost_Serialize_Drover, Boost_Serialize_Drover);
     out["BuildLexiconInteractively"] = std::make_pair(OpArgDocBuildLexiconInteractively, BuildLexiconInteractively);
+    out["CacheCheckpoint"] = std::make_pair(OpArgDocCacheCheckpoint, CacheCheckpoint);
     out["CellularAutomata"] = std::make_pair(OpArgDocCellularAutomata, CellularAutomata);
     out["ClusterDBSCAN"] = std::make_pair(OpArgDocClusterDBSCAN, ClusterDBSCAN);
     out["ComparePixels"] = std::make_pair(OpArgDocComparePixels, ComparePixels);
@@ -329,6 +354,7 @@ std::map<std::string, op_packet_t> Known_Operations(){
     out["GridBasedRayCastDoseAccumulate"] = std::make_pair(OpArgDocGridBasedRayCastDoseAccumulate, GridBasedRayCastDoseAccumulate);
     out["GroupImages"] = std::make_pair(OpArgDocGroupImages, GroupImages);
     out["GrowContours"] = std::make_pair(OpArgDocGrowContours, GrowContours);
+    out["GrowROIsViaDistanceTransform"] = std::make_pair(OpArgDocGrowROIsViaDistanceTransform, GrowROIsViaDistanceTransform);
     out["HighlightROIs"] = std::make_pair(OpArgDocHighlightROIs, HighlightROIs);
     out["IfElse"] = std::make_pair(OpArgDocIfElse, IfElse);
     out["ImageRoutineTests"] = std::make_pair(OpArgDocImageRoutineTests, ImageRoutineTests);
@@ -340,6 +366,7 @@ std::map<std::string, op_packet_t> Known_Operations(){
     out["MaxMinPixels"] = std::make_pair(OpArgDocMaxMinPixels, MaxMinPixels);
     out["MeldDose"] = std::make_pair(OpArgDocMeldDose, MeldDose);
     out["ModelIVIM"] = std::make_pair(OpArgDocModelIVIM, ModelIVIM);
+    out["ModelPerfusionClosedForm"] = std::make_pair(OpArgDocModelPerfusionClosedForm, ModelPerfusionClosedForm);
     out["ModifyContourMetadata"] = std::make_pair(OpArgDocModifyContourMetadata, ModifyContourMetadata);
     out["ModifyImageMetadata"] = std::make_pair(OpArgDocModifyImageMetadata, ModifyImageMetadata);
     out["NegatePixels"] = std::make_pair(OpArgDocNegatePixels, NegatePixels);
@@ -368,6 +395,7 @@ std::map<std::string, op_packet_t> Known_Operations(){
     out["SpatialBlur"] = std::make_pair(OpArgDocSpatialBlur, SpatialBlur);
     out["SpatialDerivative"] = std::make_pair(OpArgDocSpatialDerivative, SpatialDerivative);
     out["SpatialSharpen"] = std::make_pair(OpArgDocSpatialSharpen, SpatialSharpen);
+    out["SpillImagesToDisk"] = std::make_pair(OpArgDocSpillImagesToDisk, SpillImagesToDisk);
     out["Subsegment_ComputeDose_VanLuijk"] = std::make_pair(OpArgDocSubsegment_ComputeDose_VanLuijk, Subsegment_ComputeDose_VanLuijk);
     out["SubsegmentContours"] = std::make_pair(OpArgDocSubsegmentContours, SubsegmentContours);
     out["SubtractImages"] = std::make_pair(OpArgDocSubtractImages, SubtractImages);
@@ -454,48 +482,369 @@ std::map<std::string, std::string> Operation_Lexicon(){
     return op_name_lex;
 }
 
+// Applies consecutive pointwise operations in a single pass over the voxels of each image.
+//
+// The outcome is identical to performing each of the operations in turn. Spilled images are paged in one at a time, so
+// they need not be restored beforehand.
+static
+void Apply_Fused_Pointwise_Operations( Drover &DICOM_data,
+                                       const pointwise_kernel &kernel ){
+    const auto &stages = kernel.get_stages();
+    const auto &last = stages.back();
+
+    const auto monitor = Current_Operation_Monitor();
+    auto IAs_all = All_IAs( DICOM_data );
+    auto IAs = Whitelist( IAs_all, stages.front().selection );
+    for(auto & iap_it : IAs){
+        Check_For_Operation_Cancellation(monitor);
+        Image_Spill_Store *spill_store = (*iap_it)->spill_store.get();
+        for(const auto &animg : (*iap_it)->imagecoll.images){
+            for(const auto &s : stages){
+                if( (s.type == pointwise_stage::kind::threshold)
+                &&  ( (animg.rows < 1) || (animg.columns < 1) || (s.channel >= animg.channels) ) ){
+                    throw std::runtime_error("Image or channel is empty -- cannot contour via thresholds.");
+                }
+            }
+        }
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        {
+            asio_thread_pool tp;
+            for(auto &animg : (*iap_it)->imagecoll.images){
+                std::reference_wrapper<planar_image<float,double>> img_refw( std::ref(animg) );
+                tp.submit_task([&,img_refw]() -> void {
+                    if(Operation_Cancellation_Requested(monitor)) return;
+                    try{
+                        auto &img = img_refw.get();
+                        pinned_images pinned(spill_store, { &img }, true);
+
+                        Stats::Running_MinMax<float> minmax_pixel;
+                        kernel.apply(img.data.data(), img.data.size(), img.channels,
+                                     [&minmax_pixel](float v) -> void { minmax_pixel.Digest(v); });
+
+                        UpdateImageDescription( img_refw, last.description );
+                        UpdateImageWindowCentreWidth( img_refw, minmax_pixel );
+                    }catch(...){
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if(!error) error = std::current_exception();
+                    }
+                });
+            }
+        } // Wait for the tasks to complete.
+        if(error) std::rethrow_exception(error);
+    }
+    Check_For_Operation_Cancellation(monitor);
+    return;
+}
+
+// Appends a length-prefixed token to result cache key material, so distinct sequences of tokens never coincide.
+static
+void Append_Key_Token(std::string &material, const std::string &token){
+    material += std::to_string(token.size());
+    material += ':';
+    material += token;
+    return;
+}
+
+// If the token names an existing file, appends the file's size and modification time so that results depending on
+// the file are not reused after the file is altered. Directories are walked, and every file within contributes.
+//
+// Throws if a directory cannot be fully walked, since alterations within it could then go unnoticed.
+static
+void Append_Key_Path_Token(std::string &material, const std::string &token){
+    const auto file_token = [](const std::filesystem::path &p) -> std::string {
+        const auto size = std::filesystem::file_size(p);
+        const auto t = std::filesystem::last_write_time(p);
+        return std::to_string(size) + "@" + std::to_string(t.time_since_epoch().count());
+    };
+
+    std::error_code ec;
+    const std::filesystem::path p(token);
+    if(token.empty()) return;
+
+    if(std::filesystem::is_regular_file(p, ec)){
+        Append_Key_Token(material, file_token(p));
+
+    }else if(std::filesystem::is_directory(p, ec)){
+        // Directory iteration order is unspecified, so entries are sorted.
+        std::map<std::string, std::string> entries;
+        for(const auto &e : std::filesystem::recursive_directory_iterator(p)){
+            if(e.is_regular_file()){
+                entries[ e.path().lexically_relative(p).generic_string() ] = file_token(e.path());
+            }
+        }
+        for(const auto &kv : entries){
+            Append_Key_Token(material, kv.first);
+            Append_Key_Token(material, kv.second);
+        }
+    }
+    return;
+}
+
+// Appends an operation, its arguments, and its children. Arguments are ordered and their keys are case-folded, so
+// equivalent invocations produce identical key material. Only arguments documented as inputs are treated as paths.
+//
+// Returns false if the operation or any of its children has side-effects, e.g., writes files. Such operations must
+// always be performed, so their results cannot be cached or resumed from.
+static
+bool Append_Key_Operation(std::string &material,
+                          const std::string &op_name,
+                          const OperationArgPkg &optargs,
+                          const std::function<std::optional<OperationDoc>(const std::string &)> &doc_of){
+    const auto doc = doc_of(op_name);
+    if(!doc) throw std::invalid_argument("No operation matched '" + op_name + "'");
+    if(doc->has_side_effects) return false;
+    for(const auto &a : doc->args){
+        if( (a.flow == OpArgFlow::Egress)
+        ||  (a.flow == OpArgFlow::IngressEgress) ) return false;
+    }
+
+    Append_Key_Token(material, doc->name);
+    for(const auto &kv : optargs.getArguments()){
+        Append_Key_Token(material, boost::algorithm::to_lower_copy(kv.first));
+        Append_Key_Token(material, kv.second);
+        for(const auto &a : doc->args){
+            if( boost::iequals(a.name, kv.first)
+            &&  (a.flow == OpArgFlow::Ingress) ){
+                Append_Key_Path_Token(material, kv.second);
+            }
+        }
+    }
+    for(const auto &child : optargs.getChildren()){
+        material += '(';
+        if(!Append_Key_Operation(material, child.getName(), child, doc_of)) return false;
+        material += ')';
+    }
+    return true;
+}
+
 bool Operation_Dispatcher( Drover &DICOM_data,
                            const std::map<std::string,std::string> &InvocationMetadata,
                            const std::string &FilenameLex,
-                           const std::list<OperationArgPkg> &Operations ){
+                           const std::list<OperationArgPkg> &Operations,
+                           Operation_Result_Cache *cache,
+                           const operation_monitor *monitor ){
 
     auto op_name_mapping = Known_Operations();
     Explicator op_name_X( Operation_Lexicon() );
 
+    // Find the operation, and insert all expected, documented parameters with the default value.
+    using op_mapping_it_t = decltype(op_name_mapping)::iterator;
+    const auto find_op = [&](const std::string &user_op_name, bool warn) -> op_mapping_it_t {
+        // Find or estimate the canonical name. If not an exact match, issue a warning.
+        const auto canonical_op_name = op_name_X(user_op_name);
+        if( warn
+        &&  (op_name_X.last_best_score < 1.0) ){
+            FUNCWARN("Selecting operation '" << canonical_op_name << "' because '" << user_op_name << "' not understood");
+        }
+
+        for(auto op_func = std::begin(op_name_mapping); op_func != std::end(op_name_mapping); ++op_func){
+            if(boost::iequals(op_func->first, canonical_op_name)) return op_func;
+        }
+        return std::end(op_name_mapping);
+    };
+    const auto resolve = [&](const OperationArgPkg &OptArgs, bool warn) -> std::pair<op_mapping_it_t, OperationArgPkg> {
+        auto optargs = OptArgs;
+        const auto op_func = find_op(optargs.getName(), warn);
+        if(op_func != std::end(op_name_mapping)){
+            auto OpDocs = op_func->second.first();
+            for(const auto &r : OpDocs.args){
+                if(r.expected) optargs.insert( r.name, r.default_val );
+            }
+        }
+        return { op_func, optargs };
+    };
+    const auto pointwise_stage_of = [](const op_mapping_it_t &op_func, const OperationArgPkg &optargs){
+        return make_pointwise_stage(op_func->first, [&optargs](const std::string &key){ return optargs.getValueStr(key); });
+    };
+
+    //Operations unaware of out-of-core storage must only ever encounter fully-resident images.
+    const auto restore_spilled_images = [&](const std::string &op_name) -> void {
+        for(auto &ia_ptr : DICOM_data.image_data){
+            if( (ia_ptr == nullptr)
+            ||  (ia_ptr->spill_store == nullptr) ) continue;
+            FUNCWARN("Restoring spilled images for operation '" << op_name << "'; this may require considerable memory");
+            ia_ptr->spill_store->restore_all();
+            ia_ptr->spill_store = nullptr;
+        }
+    };
+    const auto has_spilled_images = [&]() -> bool {
+        for(const auto &ia_ptr : DICOM_data.image_data){
+            if( (ia_ptr != nullptr)
+            &&  (ia_ptr->spill_store != nullptr) ) return true;
+        }
+        return false;
+    };
+
+    //Derive a result cache key for the state following each operation. Each key depends on the initial contents of the
+    // Drover and every operation up to and including its own, so altering an operation invalidates all later results.
+    //
+    // Serializing the Drover can be costly, so states are only stored and resumed from at user-specified checkpoints.
+    const auto is_checkpoint = [](const op_mapping_it_t &op_func) -> bool {
+        return (op_func->first == "CacheCheckpoint");
+    };
+    std::vector<uint64_t> keys;
+    std::vector<bool> checkpoints;
+    if( (cache != nullptr)
+    &&  has_spilled_images() ){
+        FUNCWARN("Images have been spilled to disk. Not using the result cache");
+        cache = nullptr;
+    }
+    if(cache != nullptr){
+        try{
+            std::string material;
+            Append_Key_Token(material, DCMA_VERSION_STR);
+            Append_Key_Token(material, FilenameLex);
+            Append_Key_Path_Token(material, FilenameLex);
+            for(const auto &kv : InvocationMetadata){
+                if(kv.first == "Invocation") continue; // Lists the operations, which are accounted for individually.
+                Append_Key_Token(material, kv.first);
+                Append_Key_Token(material, kv.second);
+            }
+            uint64_t key = XXH64_Hash(material.data(), material.size(), Common_Boost_Hash_Drover(DICOM_data));
+
+            // Keys end at the first operation with side-effects, so it and all later operations are always performed.
+            const auto doc_of = [&](const std::string &op_name) -> std::optional<OperationDoc> {
+                const auto op_func = find_op(op_name, false);
+                if(op_func == std::end(op_name_mapping)) return std::nullopt;
+                return op_func->second.first();
+            };
+            for(const auto &oap : Operations){
+                const auto [op_func, optargs] = resolve(oap, false);
+                if(op_func == std::end(op_name_mapping)) break;
+
+                material.clear();
+                if(!Append_Key_Operation(material, op_func->first, optargs, doc_of)) break;
+                key = XXH64_Hash(material.data(), material.size(), key);
+                keys.push_back(key);
+                checkpoints.push_back(is_checkpoint(op_func));
+            }
+        }catch(const std::exception &e){
+            FUNCWARN("Unable to derive result cache keys: '" << e.what() << "'. Not using the result cache");
+            keys.clear();
+            checkpoints.clear();
+            cache = nullptr;
+        }
+        if( (cache != nullptr)
+        &&  std::none_of(std::begin(checkpoints), std::end(checkpoints), [](bool b){ return b; }) ){
+            FUNCINFO("No cache checkpoints are reachable, so the result cache will not be used");
+            cache = nullptr;
+        }
+    }
+
+    //Only the outermost invocation reports progress, but nested invocations are still checked for cancellation.
+    operation_monitor_scope monitor_scope( (monitor != nullptr) ? monitor : Current_Operation_Monitor() );
+
     try{
-        for(const auto &OptArgs : Operations){
-            auto optargs = OptArgs;
-
-            // Find or estimate the canonical name. If not an exact match, issue a warning.
-            const auto user_op_name = optargs.getName();
-            const auto canonical_op_name = op_name_X(user_op_name);
-            if( op_name_X.last_best_score < 1.0 ){
-                FUNCWARN("Selecting operation '" << canonical_op_name << "' because '" << user_op_name << "' not understood");
+        auto op_it = std::begin(Operations);
+        const auto report_progress = [&](const std::string &msg){
+            if( (monitor == nullptr) || !monitor->set_progress ) return;
+            const auto N_completed = std::distance(std::begin(Operations), op_it);
+            const auto N_total = Operations.size();
+            monitor->set_progress( (N_total == 0) ? 1.0 : static_cast<double>(N_completed) / static_cast<double>(N_total),
+                                   msg );
+        };
+
+        //Resume from the latest checkpoint with a cached result.
+        if(cache != nullptr){
+            for(auto n = keys.size(); 0 < n; --n){
+                if(!checkpoints[n - 1]) continue;
+                const auto p = cache->find(keys[n - 1]);
+                if(!p) continue;
+
+                Drover cached;
+                if(Common_Boost_Deserialize_Drover(cached, p.value())){
+                    FUNCINFO("Resuming from the cache checkpoint at operation " << n << " of " << Operations.size());
+                    DICOM_data = cached;
+                    std::advance(op_it, static_cast<long int>(n));
+                    break;
+                }
+                FUNCWARN("Discarding unreadable cached result '" << p.value().string() << "'");
+                cache->remove(keys[n - 1]);
+            }
+        }
+
+        while(op_it != std::end(Operations)){
+            Check_For_Operation_Cancellation();
+            auto [op_func, optargs] = resolve(*op_it, true);
+            if(op_func == std::end(op_name_mapping)){
+                throw std::invalid_argument("No operation matched '" + optargs.getName() + "'");
+            }
+            const auto op_number = std::distance(std::begin(Operations), op_it) + 1;
+            report_progress("Performing operation " + std::to_string(op_number) + " of "
+                            + std::to_string(Operations.size()) + " ('" + op_func->first + "')");
+            ++op_it;
+
+            //Consecutive pointwise operations are fused so the voxels are only traversed once.
+            pointwise_kernel kernel;
+            std::string fused_names = op_func->first;
+            if(auto s = pointwise_stage_of(op_func, optargs)){
+                kernel.append(s.value());
+                while(op_it != std::end(Operations)){
+                    const auto [next_func, next_optargs] = resolve(*op_it, false);
+                    if(next_func == std::end(op_name_mapping)) break;
+                    const auto next_s = pointwise_stage_of(next_func, next_optargs);
+                    if( !next_s
+                    ||  !can_fuse(kernel.get_stages().back(), next_s.value()) ) break;
+
+                    resolve(*op_it, true); // Issue any warnings.
+                    kernel.append(next_s.value());
+                    fused_names += "', '" + next_func->first;
+                    ++op_it;
+                }
             }
 
-            bool WasFound = false;
-            for(const auto &op_func : op_name_mapping){
-                if(boost::iequals(op_func.first, canonical_op_name)){
-                    WasFound = true;
+            if(1 < kernel.size()){
+                FUNCINFO("Performing fused operations '" << fused_names << "' now..");
+                Apply_Fused_Pointwise_Operations(DICOM_data, kernel);
 
-                    //Attempt to insert all expected, documented parameters with the default value.
-                    auto OpDocs = op_func.second.first();
-                    for(const auto &r : OpDocs.args){
-                        if(r.expected) optargs.insert( r.name, r.default_val );
-                    }
+            }else if( (kernel.size() == 1)
+                  &&  has_spilled_images() ){
+                // The operation would otherwise require all spilled images to be restored.
+                FUNCINFO("Performing operation '" << fused_names << "' on spilled images now..");
+                Apply_Fused_Pointwise_Operations(DICOM_data, kernel);
 
-                    FUNCINFO("Performing operation '" << op_func.first << "' now..");
-                    const bool res = op_func.second.second(DICOM_data,
-                                                           optargs,
-                                                           InvocationMetadata,
-                                                           FilenameLex);
-                    if(!res) throw std::runtime_error("Truthiness is false");
+            }else{
+                if(!op_func->second.first().supports_spilled_images){
+                    restore_spilled_images(op_func->first);
+                }
 
-                    break;
+                FUNCINFO("Performing operation '" << op_func->first << "' now..");
+                const bool res = op_func->second.second(DICOM_data,
+                                                        optargs,
+                                                        InvocationMetadata,
+                                                        FilenameLex);
+                if(!res) throw std::runtime_error("Truthiness is false");
+            }
+
+            // Operations may have stopped early without reporting it, e.g., when children are evaluated as conditions.
+            Check_For_Operation_Cancellation();
+
+            //Cache the result at checkpoints so later invocations can resume from here.
+            if(cache != nullptr){
+                const auto n = static_cast<size_t>(std::distance(std::begin(Operations), op_it));
+                if( (n == 0)
+                ||  (keys.size() < n)
+                ||  !checkpoints[n - 1] ){
+                    // Not a checkpoint.
+
+                }else if(has_spilled_images()){
+                    FUNCWARN("Images have been spilled to disk. No longer using the result cache");
+                    cache = nullptr;
+
+                }else if(!cache->store(keys[n - 1], [&](const std::filesystem::path &p) -> bool {
+                                return Common_Boost_Serialize_Drover_to_Binary(DICOM_data, p);
+                         }) ){
+                    FUNCWARN("Unable to cache the result of operation " << n << "; it may exceed the cache size limit");
                 }
             }
-            if(!WasFound) throw std::invalid_argument("No operation matched '" + optargs.getName() + "'");
         }
+        report_progress("Completed all operations");
+
+    }catch(const operation_cancelled &){
+        FUNCWARN("Analysis cancelled. Aborting remaining analyses");
+        throw;
     }catch(const std::exception &e){
         FUNCWARN("Analysis failed: '" << e.what() << "'. Aborting remaining analyses");
         return false;
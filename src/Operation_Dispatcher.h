@@ -9,6 +9,7 @@
 #include <utility>
 
 #include "Structs.h"
+#include "Operation_Monitor.h"
 
 using op_func_t = std::function<bool (Drover &, 
                                       const OperationArgPkg &,
@@ -21,8 +22,22 @@ std::map<std::string, op_packet_t> Known_Operations();
 
 std::map<std::string, std::string> Operation_Lexicon();
 
+class Operation_Result_Cache;
+
+// Performs the operations in order.
+//
+// If a result cache is provided, the state at each top-level 'CacheCheckpoint' operation is stored in the cache, keyed on
+// the initial contents of the Drover and the operations performed so far. Operations are only performed from the latest
+// checkpoint with a cached result onward. Operations with side-effects (e.g., writing files), and all operations
+// following them, are always performed.
+//
+// If a monitor is provided, it is installed for the calling thread while the operations are performed, and progress is
+// reported to it as each operation begins. Nested invocations (e.g., for the children of an operation) use the monitor
+// of the outermost invocation. If cancellation is requested, operation_cancelled is thrown once it has been noticed.
 bool Operation_Dispatcher( Drover &DICOM_data,
                            const std::map<std::string,std::string> &InvocationMetadata,
                            const std::string &FilenameLex,
-                           const std::list<OperationArgPkg> &Operations);
+                           const std::list<OperationArgPkg> &Operations,
+                           Operation_Result_Cache *cache = nullptr,
+                           const operation_monitor *monitor = nullptr );
 
@@ -0,0 +1,41 @@
+//Operation_Monitor.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <string>
+
+#include "Operation_Monitor.h"
+
+
+namespace {
+thread_local const operation_monitor *current_monitor = nullptr;
+} // namespace
+
+
+operation_cancelled::operation_cancelled(const std::string &what) : std::runtime_error(what) {}
+
+
+operation_monitor_scope::operation_monitor_scope(const operation_monitor *monitor) : prev(current_monitor) {
+    current_monitor = monitor;
+}
+
+operation_monitor_scope::~operation_monitor_scope(){
+    current_monitor = this->prev;
+}
+
+
+const operation_monitor * Current_Operation_Monitor(){
+    return current_monitor;
+}
+
+bool Operation_Cancellation_Requested(const operation_monitor *monitor){
+    return (monitor != nullptr)
+        && static_cast<bool>(monitor->is_cancel_requested)
+        && monitor->is_cancel_requested();
+}
+
+void Check_For_Operation_Cancellation(const operation_monitor *monitor){
+    if(Operation_Cancellation_Requested(monitor)){
+        throw operation_cancelled("Operations were cancelled");
+    }
+    return;
+}
+
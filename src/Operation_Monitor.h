@@ -0,0 +1,55 @@
+//Operation_Monitor.h.
+
+#pragma once
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+
+// Cooperative cancellation and progress reporting for operations.
+//
+// A monitor is installed for the calling thread while operations are dispatched. Operations are checked for
+// cancellation between one another, and long-running operations also poll the monitor within their loops. Cancellation
+// is cooperative, so an operation that does not poll the monitor will run to completion before it is noticed.
+struct operation_monitor {
+    // Returns true once the operations should stop. Must be callable from any thread.
+    std::function<bool()> is_cancel_requested;
+
+    // Receives the fraction, [0:1], of the operations that have been performed and a description of the current one.
+    std::function<void(double, const std::string &)> set_progress;
+};
+
+// Thrown when operations stop early because cancellation was requested.
+class operation_cancelled : public std::runtime_error {
+  public:
+    explicit operation_cancelled(const std::string &what);
+};
+
+
+// Installs a monitor for the calling thread for the lifetime of this object. The previously-installed monitor, if any,
+// is restored afterward. The monitor must outlive this object.
+class operation_monitor_scope {
+  private:
+    const operation_monitor *prev;
+
+  public:
+    explicit operation_monitor_scope(const operation_monitor *monitor);
+    ~operation_monitor_scope();
+
+    operation_monitor_scope(const operation_monitor_scope &) = delete;
+    operation_monitor_scope &operator=(const operation_monitor_scope &) = delete;
+};
+
+// The monitor installed for the calling thread, or nullptr if there is none.
+//
+// Worker threads do not inherit the monitor, so operations that distribute work to a thread pool should capture it
+// beforehand and pass it to the routines below.
+const operation_monitor * Current_Operation_Monitor();
+
+// Returns true if cancellation has been requested via the given monitor.
+bool Operation_Cancellation_Requested(const operation_monitor *monitor = Current_Operation_Monitor());
+
+// Throws operation_cancelled if cancellation has been requested via the given monitor.
+void Check_For_Operation_Cancellation(const operation_monitor *monitor = Current_Operation_Monitor());
+
@@ -0,0 +1,148 @@
+//Operation_Result_Cache.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include "Operation_Result_Cache.h"
+
+
+static const std::string entry_extension = ".dcma_result";
+
+// Whether the file is a complete entry, as opposed to a temporary file or an unrelated file.
+static
+bool is_entry(const std::filesystem::path &p){
+    const auto name = p.filename().string();
+    return (name.size() == (16 + entry_extension.size()))
+        && (name.compare(16, std::string::npos, entry_extension) == 0)
+        && std::all_of(std::begin(name), std::next(std::begin(name), 16),
+                       [](char c){ return ( ('0' <= c) && (c <= '9') ) || ( ('a' <= c) && (c <= 'f') ); });
+}
+
+static
+std::string hex_key(uint64_t key){
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long int>(key));
+    return buf;
+}
+
+
+Operation_Result_Cache::Operation_Result_Cache(const std::filesystem::path &dir, std::uintmax_t max_bytes)
+  : cache_dir(dir), max_bytes(max_bytes) {
+    if(this->cache_dir.empty()){
+        this->cache_dir = std::filesystem::temp_directory_path() / "dcma_result_cache";
+    }
+    std::filesystem::create_directories(this->cache_dir);
+}
+
+const std::filesystem::path &
+Operation_Result_Cache::get_directory() const {
+    return this->cache_dir;
+}
+
+std::uintmax_t
+Operation_Result_Cache::get_max_bytes() const {
+    return this->max_bytes;
+}
+
+std::filesystem::path
+Operation_Result_Cache::entry_path(uint64_t key) const {
+    return this->cache_dir / (hex_key(key) + entry_extension);
+}
+
+std::optional<std::filesystem::path>
+Operation_Result_Cache::find(uint64_t key){
+    const auto p = this->entry_path(key);
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(p, ec)) return {};
+
+    std::filesystem::last_write_time(p, std::filesystem::file_time_type::clock::now(), ec);
+    return p;
+}
+
+bool
+Operation_Result_Cache::store(uint64_t key, const std::function<bool(const std::filesystem::path &)> &writer){
+    // The temporary name is unique to this object and time so that concurrent writers do not collide.
+    const auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+    const auto tmp = this->cache_dir / ( "." + hex_key(key)
+                                       + "." + hex_key(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this)) ^ static_cast<uint64_t>(ticks))
+                                       + "." + std::to_string(this->tmp_counter++) + ".tmp" );
+    const auto p = this->entry_path(key);
+
+    std::error_code ec;
+    bool ok = false;
+    try{
+        ok = writer(tmp);
+    }catch(const std::exception &){
+        ok = false;
+    }
+    if(ok){
+        std::filesystem::rename(tmp, p, ec);
+        ok = !ec;
+    }
+    if(!ok){
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    this->evict();
+    return std::filesystem::is_regular_file(p, ec);
+}
+
+void
+Operation_Result_Cache::remove(uint64_t key){
+    std::error_code ec;
+    std::filesystem::remove(this->entry_path(key), ec);
+    return;
+}
+
+long int
+Operation_Result_Cache::evict(){
+    std::vector<std::tuple<std::filesystem::file_time_type, std::filesystem::path, std::uintmax_t>> entries;
+    std::uintmax_t total = 0;
+
+    std::error_code ec;
+    for(const auto &de : std::filesystem::directory_iterator(this->cache_dir, ec)){
+        if(!is_entry(de.path())) continue;
+        const auto size = de.file_size(ec);
+        if(ec) continue;
+        const auto t = de.last_write_time(ec);
+        if(ec) continue;
+        entries.emplace_back(t, de.path(), size);
+        total += size;
+    }
+    if(total <= this->max_bytes) return 0;
+
+    std::sort(std::begin(entries), std::end(entries));
+    long int removed = 0;
+    for(const auto &e : entries){
+        if(total <= this->max_bytes) break;
+        if(std::filesystem::remove(std::get<1>(e), ec)){
+            total -= std::get<2>(e);
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+std::uintmax_t
+Operation_Result_Cache::total_bytes() const {
+    std::uintmax_t total = 0;
+    std::error_code ec;
+    for(const auto &de : std::filesystem::directory_iterator(this->cache_dir, ec)){
+        if(!is_entry(de.path())) continue;
+        const auto size = de.file_size(ec);
+        if(!ec) total += size;
+    }
+    return total;
+}
+
@@ -0,0 +1,56 @@
+//Operation_Result_Cache.h.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+
+
+// A content-addressed, on-disk store of operation results.
+//
+// Each entry is a single file named after a 64-bit key. The key is computed by the caller from everything the result
+// depends on; the store itself never inspects the contents. Entries are written to a temporary file and renamed into
+// place, so a reader never encounters a partially-written entry, even when several processes share the directory.
+//
+// The modification time of each entry records its most recent use. Whenever the total size of the entries exceeds
+// the limit, entries are removed in least-recently-used order.
+class Operation_Result_Cache {
+    private:
+        std::filesystem::path cache_dir;
+        std::uintmax_t max_bytes;
+        uint64_t tmp_counter = 0;
+
+    public:
+        // If the directory is empty, a directory within the system temporary directory is used. The directory is
+        // created if necessary and is not removed afterward, so results persist between invocations.
+        Operation_Result_Cache(const std::filesystem::path &dir, std::uintmax_t max_bytes);
+
+        const std::filesystem::path & get_directory() const;
+        std::uintmax_t get_max_bytes() const;
+
+        // The file an entry is (or would be) stored in.
+        std::filesystem::path entry_path(uint64_t key) const;
+
+        // Returns the file holding the entry, if present, and marks the entry as recently used.
+        std::optional<std::filesystem::path> find(uint64_t key);
+
+        // Creates an entry by invoking the writer with a temporary filename. The entry is only created if the writer
+        // succeeds. Any existing entry is replaced. Least-recently-used entries are then evicted as needed, which may
+        // include the new entry if it alone exceeds the limit.
+        //
+        // Returns whether the entry is present afterward.
+        bool store(uint64_t key, const std::function<bool(const std::filesystem::path &)> &writer);
+
+        // Removes an entry, e.g., because it could not be read.
+        void remove(uint64_t key);
+
+        // Removes least-recently-used entries until the total size is within the limit. Returns the number removed.
+        long int evict();
+
+        // The total size of all entries.
+        std::uintmax_t total_bytes() const;
+};
+
@@ -32,7 +32,7 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorFilesDirs.h"
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "AnalyzePicketFence.h"
 
@@ -140,6 +140,7 @@ OperationDoc OpArgDocAnalyzePicketFence(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -151,6 +152,7 @@ OperationDoc OpArgDocAnalyzePicketFence(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -178,7 +180,7 @@ bool AnalyzePicketFence(Drover &DICOM_data,
                           /*InvocationMetadata*/,
                           const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
@@ -67,6 +67,7 @@ OperationDoc OpArgDocAnalyzeTPlan(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -89,6 +89,7 @@ OperationDoc OpArgDocApplyCalibrationCurve(){
     out.args.back().default_val = "";
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/calib.dat" };
+    out.args.back().flow = OpArgFlow::Ingress;
 
 
     out.args.emplace_back();
@@ -169,6 +170,8 @@ bool ApplyCalibrationCurve(Drover &DICOM_data,
         ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
         ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
         ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+        DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+        ud.mask_cache = DICOM_data.voxel_mask_cache;
         ud.description = "Corrected via calibration curve";
 
         if( std::regex_match(ContourOverlapStr, regex_ignore) ){
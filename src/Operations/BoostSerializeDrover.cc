@@ -33,6 +33,7 @@ OperationDoc OpArgDocBoost_Serialize_Drover(){
                             "./out.xml.gz",
                             "out.xml.gz" };
     out.args.back().mimetype = "application/octet-stream";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -25,6 +25,7 @@
 OperationDoc OpArgDocBuildLexiconInteractively(){
     OperationDoc out;
     out.name = "BuildLexiconInteractively";
+    out.has_side_effects = true;
     out.desc = 
         "This operation interactively builds a lexicon using the currently loaded contour labels."
         " It is useful for constructing a domain-specific lexicon from a set of representative data.";
@@ -81,6 +82,7 @@ OperationDoc OpArgDocBuildLexiconInteractively(){
     out.args.back().default_val = "";
     out.args.back().expected = true;
     out.args.back().examples = { "./some_lexicon", "/tmp/temp_lexicon" };
+    out.args.back().flow = OpArgFlow::Ingress;
 
     return out;
 }
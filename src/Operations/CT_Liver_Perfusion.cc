@@ -36,6 +36,7 @@ template <class T> class contour_collection;
 OperationDoc OpArgDocCT_Liver_Perfusion(){
     OperationDoc out;
     out.name = "CT_Liver_Perfusion";
+    out.has_side_effects = true;
     out.desc = 
         "This operation performed dynamic contrast-enhanced CT perfusion image modeling on a time series image volume.";
 
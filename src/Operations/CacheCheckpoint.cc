@@ -0,0 +1,42 @@
+//CacheCheckpoint.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>    
+
+#include "../Structs.h"
+
+#include "CacheCheckpoint.h"
+
+
+OperationDoc OpArgDocCacheCheckpoint(){
+    OperationDoc out;
+    out.name = "CacheCheckpoint";
+
+    out.desc = 
+        "This operation marks a point at which the state of all loaded data is stored in the operation result cache,"
+        " if one is in use. When the same data are loaded and the same operations are specified again, processing"
+        " resumes from the latest checkpoint that precedes the first altered operation. Otherwise this operation does"
+        " nothing.";
+
+    out.notes.emplace_back(
+        "Storing the state requires serializing all loaded data, which can be costly for large data sets, so"
+        " checkpoints should follow costly operations whose results are likely to be reused."
+    );
+    out.notes.emplace_back(
+        "Checkpoints are only honoured when specified at the top level, i.e., not as children of other operations."
+        " Checkpoints following an operation with side-effects (e.g., writing files) are ignored, since such"
+        " operations must always be performed."
+    );
+
+    return out;
+}
+
+bool CacheCheckpoint(Drover &DICOM_data,
+                     const OperationArgPkg&,
+                     const std::map<std::string, std::string>&,
+                     const std::string& ){
+
+    return true;
+}
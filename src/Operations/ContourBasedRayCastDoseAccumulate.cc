@@ -17,9 +17,10 @@
 
 #include "../Dose_Meld.h"
 #include "../Structs.h"
+#include "../Slice_Index.h"
 #include "../Regex_Selectors.h"
 #include "ContourBasedRayCastDoseAccumulate.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorImagesIO.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -43,6 +44,7 @@ OperationDoc OpArgDocContourBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.img", "derivative_data.img" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -53,6 +55,7 @@ OperationDoc OpArgDocContourBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.img", "derivative_data.img" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -126,7 +129,7 @@ bool ContourBasedRayCastDoseAccumulate(Drover &DICOM_data,
     const auto Rows = std::stol(RowsStr);
     const auto Columns = std::stol(ColumnsStr);
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Ensure the Ray dL is sufficiently small. We enforce that ray cannot step over the cylinder in a single iteration
     // for 95% of the width of the cylinder. So if the rays are oncoming and directed at the cylinder perpendicularly,
@@ -409,7 +412,7 @@ bool ContourBasedRayCastDoseAccumulate(Drover &DICOM_data,
                         accumulated_length += RaydL;
 
                         //Find the dose at the half-way point.
-                        auto encompass_imgs = img_arr_ptr->imagecoll.get_images_which_encompass_point( midpoint );
+                        auto encompass_imgs = img_arr_ptr->slice_lookup->get_images_which_encompass_point( midpoint );
                         for(const auto &enc_img : encompass_imgs){
                             const auto pix_val = enc_img->value(midpoint, 0);
                             accumulated_doselength += RaydL * pix_val;
@@ -425,7 +428,7 @@ bool ContourBasedRayCastDoseAccumulate(Drover &DICOM_data,
                             accumulated_length += RaydL;
 
                             //Find the dose at the half-way point.
-                            auto encompass_imgs = img_arr_ptr->imagecoll.get_images_which_encompass_point( midpoint );
+                            auto encompass_imgs = img_arr_ptr->slice_lookup->get_images_which_encompass_point( midpoint );
                             for(const auto &enc_img : encompass_imgs){
                                 const auto pix_val = enc_img->value(midpoint, 0);
                                 accumulated_doselength += RaydL * pix_val;
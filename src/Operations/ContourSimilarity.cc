@@ -21,7 +21,7 @@
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 #include "YgorFilesDirs.h"
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
@@ -75,6 +75,7 @@ OperationDoc OpArgDocContourSimilarity(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "UserComment";
@@ -104,7 +105,7 @@ bool ContourSimilarity(Drover &DICOM_data,
     auto FileName = OptArgs.getValueStr("FileName").value();
     const auto UserComment = OptArgs.getValueStr("UserComment");
     //-----------------------------------------------------------------------------------------------------------------
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     auto cc_all = All_CCs( DICOM_data );
 
@@ -22,7 +22,7 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
@@ -96,7 +96,7 @@ bool ContourViaGeometry(Drover &DICOM_data,
                           const std::map<std::string, std::string>&
                           /*InvocationMetadata*/,
                           const std::string& FilenameLex){
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ROILabel = OptArgs.getValueStr("ROILabel").value();
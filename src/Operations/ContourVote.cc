@@ -14,7 +14,7 @@
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
 #include "ContourVote.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 
@@ -132,7 +132,7 @@ bool ContourVote(Drover &DICOM_data,
                    /*InvocationMetadata*/,
                    const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto WinnerROILabel = OptArgs.getValueStr("WinnerROILabel").value();
@@ -14,7 +14,7 @@
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
 #include "ContourWholeImages.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 
@@ -74,7 +74,7 @@ bool ContourWholeImages(Drover &DICOM_data,
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
     const auto NormalizedROILabel = X(ROILabel);
     const long int ROINumber = 10001; // TODO: find highest existing and ++ it.
     DICOM_data.Ensure_Contour_Data_Allocated();
@@ -1,28 +1,33 @@
 //ConvertContoursToMeshes.cc - A part of DICOMautomaton 2020. Written by hal clark.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdlib>            //Needed for exit() calls.
+#include <exception>
 #include <fstream>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <set> 
 #include <stdexcept>
 #include <string>    
+#include <vector>
 
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMathIOOBJ.h"
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Contour_Boolean_Operations.h"
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
 #include "../Simple_Meshing.h"
+#include "../Thread_Pool.h"
 
 #include "ConvertContoursToMeshes.h"
 
@@ -106,7 +111,7 @@ bool ConvertContoursToMeshes(Drover &DICOM_data,
                                const std::map<std::string, std::string>&,
                                const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto NormalizedROILabelRegex = OptArgs.getValueStr("NormalizedROILabelRegex").value();
@@ -165,8 +170,6 @@ bool ConvertContoursToMeshes(Drover &DICOM_data,
         ucps.emplace_back(  plane<double>( top_plane.N_0, top_plane.R_0 + top_plane.N_0 * contour_sep ) ); 
     }
 
-    fv_surface_mesh<double, uint64_t> amesh;
-
     const auto locate_contours_on_plane = [&](const plane<double> &P){
         decltype(cops) out;
         for(const auto &cop_refw : cops){
@@ -193,6 +196,36 @@ bool ConvertContoursToMeshes(Drover &DICOM_data,
         // other. (For example, consider two rectangles centred on the same point with one rotated pi/2 about the centre
         // relative to the other.) Nevertheless, it should work reasonable well for most realistic contours that are
         // more highly-sampled.
+        //
+        // Contours with disjoint projected bounding boxes cannot overlap, which is far cheaper to rule out.
+        if(1.0 - 1.0E-6 < std::abs(pln_A.N_0.Dot(pln_B.N_0))){
+            const auto &N = pln_B.N_0;
+            const auto e1 = N.Cross( (std::abs(N.x) < 0.9) ? vec3<double>(1.0, 0.0, 0.0)
+                                                           : vec3<double>(0.0, 1.0, 0.0) ).unit();
+            const auto e2 = N.Cross(e1).unit();
+            const auto projected_extent = [&](cop_refw_t C) -> std::array<double, 4> {
+                const auto inf = std::numeric_limits<double>::infinity();
+                std::array<double, 4> ext = {{ inf, -inf, inf, -inf }};
+                for(const auto &p : C.get().points){
+                    const auto u = p.Dot(e1);
+                    const auto v = p.Dot(e2);
+                    ext[0] = std::min(ext[0], u);
+                    ext[1] = std::max(ext[1], u);
+                    ext[2] = std::min(ext[2], v);
+                    ext[3] = std::max(ext[3], v);
+                }
+                return ext;
+            };
+            const auto ext_A = projected_extent(A);
+            const auto ext_B = projected_extent(B);
+            const auto tol = 1.0E-6 * (1.0 + std::max({ std::abs(ext_A[0]), std::abs(ext_A[1]),
+                                                          std::abs(ext_A[2]), std::abs(ext_A[3]) }));
+            if( (ext_A[1] + tol < ext_B[0]) || (ext_B[1] + tol < ext_A[0])
+            ||  (ext_A[3] + tol < ext_B[2]) || (ext_B[3] + tol < ext_A[2]) ){
+                return false;
+            }
+        }
+
         for(const auto &p_A : A.get().points){
             if(B.get().Is_Point_In_Polygon_Projected_Orthogonally(pln_B, p_A)){
                 return true;
@@ -206,28 +239,21 @@ bool ConvertContoursToMeshes(Drover &DICOM_data,
         return false;
     };
 
-    // Cycle over unique planes.
-    for(auto m_cp_it = std::cbegin(ucps); m_cp_it != std::cend(ucps); ++m_cp_it){
+    // Joins the contours on a plane with the contours on the preceding plane. Each pair of adjacent planes is meshed
+    // independently, so the resulting meshes can be joined afterward.
+    using cp_it_t = decltype(std::cbegin(ucps));
+    const auto mesh_adjacent_planes = [&](cp_it_t m_cp_it) -> fv_surface_mesh<double, uint64_t> {
+        fv_surface_mesh<double, uint64_t> amesh;
 
         // Locate all contours on this plane.
         auto m_cops = locate_contours_on_plane(*m_cp_it);
 
-        // Identify whether there are adjacent planes within the contour spacing on either side.
-        auto l_cp_it = std::prev(m_cp_it);
-        //auto h_cp_it = std::next(m_cp_it);
+        // Identify whether there is an adjacent plane within the contour spacing below.
+        const auto l_cp_it = std::prev(m_cp_it);
+        const auto l_cp_dist = std::abs(m_cp_it->Get_Signed_Distance_To_Point(l_cp_it->R_0));
+        const bool l_cp_is_adjacent = (l_cp_dist <= (1.5 * contour_sep));
 
-        if(l_cp_it == std::cend(ucps)){
-            continue;
-        }else if(l_cp_it != std::cend(ucps)){
-            const auto l_cp_dist = std::abs(m_cp_it->Get_Signed_Distance_To_Point(l_cp_it->R_0));
-            if((1.5 * contour_sep) < l_cp_dist) l_cp_it = std::cend(ucps);
-        }
-        //if(h_cp_it != std::cend(ucps)){
-        //    const auto h_cp_dist = std::abs(m_cp_it->Get_Signed_Distance_To_Point(h_cp_it->R_0));
-        //    if((1.5 * contour_sep) < h_cp_dist) h_cp_it = std::cend(ucps);
-        //}
-
-        auto l_cops = locate_contours_on_plane(*l_cp_it);
+        auto l_cops = (l_cp_is_adjacent) ? locate_contours_on_plane(*l_cp_it) : decltype(cops)();
         if( (l_cops.size() == 0) && (m_cops.size() == 0) ){
             throw std::logic_error("Unable to find any contours on contour plane.");
         }
@@ -475,13 +501,35 @@ bool ConvertContoursToMeshes(Drover &DICOM_data,
                 }
             }
         }
+        return amesh;
+    };
+
+    // Mesh each pair of adjacent planes concurrently.
+    std::vector<fv_surface_mesh<double, uint64_t>> plane_meshes( ucps.size() );
+    std::vector<std::exception_ptr> errors( ucps.size() );
+    {
+        asio_thread_pool tp;
+        size_t i = 0;
+        for(auto m_cp_it = std::next(std::cbegin(ucps)); m_cp_it != std::cend(ucps); ++m_cp_it){
+            ++i;
+            tp.submit_task([&,m_cp_it,i]() -> void {
+                try{
+                    plane_meshes[i] = mesh_adjacent_planes(m_cp_it);
+                }catch(...){
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+    } // Wait until all threads are done.
+
+    // Report the same error that a sequential traversal would have encountered first.
+    for(const auto &e : errors){
+        if(e) std::rethrow_exception(e);
     }
 
     // Create the mesh.
-    amesh.recreate_involved_face_index();
     const auto machine_eps = std::sqrt( 10.0 * std::numeric_limits<double>::epsilon() );
-    amesh.merge_duplicate_vertices(machine_eps);
-    amesh.recreate_involved_face_index();
+    auto amesh = Join_Meshes(plane_meshes, machine_eps);
 /*
 // Leaving this here for future debugging, for which it will no-doubt be needed...
 std::ofstream os("/tmp/mesh.obj");
@@ -20,7 +20,7 @@
 #include "../Regex_Selectors.h"
 #include "../Thread_Pool.h"
 #include "ConvertImageToMeshes.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -131,7 +131,7 @@ bool ConvertImageToMeshes(Drover &DICOM_data,
                             /*InvocationMetadata*/,
                             const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
@@ -20,7 +20,7 @@
 #include "../Regex_Selectors.h"
 #include "../Thread_Pool.h"
 #include "ConvertMeshesToContours.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -86,7 +86,7 @@ bool ConvertMeshesToContours(Drover &DICOM_data,
                                const std::map<std::string, std::string>& /*InvocationMetadata*/,
                                const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ROILabel = OptArgs.getValueStr("ROILabel").value();
@@ -16,7 +16,7 @@
 #include <utility>            //Needed for std::pair.
 #include <vector>
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -114,7 +114,7 @@ bool ConvertMeshesToPoints(Drover &DICOM_data,
                                const std::map<std::string, std::string>& /*InvocationMetadata*/,
                                const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto MeshSelectionStr = OptArgs.getValueStr("MeshSelection").value();
@@ -1,9 +1,13 @@
 //ConvolveImages.cc - A part of DICOMautomaton 2019. Written by hal clark.
 
+#include <algorithm>
 #include <any>
+#include <array>
+#include <cmath>
 #include <optional>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -14,6 +18,8 @@
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../FFT_Correlation.h"
+#include "../Thread_Pool.h"
 #include "../YgorImages_Functors/ConvenienceRoutines.h"
 #include "../YgorImages_Functors/Grouping/Misc_Functors.h"
 #include "../YgorImages_Functors/Compute/Volumetric_Neighbourhood_Sampler.h"
@@ -89,7 +95,8 @@ OperationDoc OpArgDocConvolveImages(){
     out.args.emplace_back();
     out.args.back().name = "Operation";
     out.args.back().desc = "Controls the way the kernel is applied and the reduction is tallied."
-                           " Currently, 'convolution', 'correlation', and 'pattern-match' are supported."
+                           " Currently, 'convolution', 'correlation', 'normalized-cross-correlation', and 'pattern-match' are"
+                           " supported."
                            " For convolution, the reference image is spatially inverted along row-, column-,"
                            " and image-axes. The outgoing voxel intensity is the inner (i.e., dot) product"
                            " of the paired intensities of the surrounding voxel neighbourhood (i.e., the voxel"
@@ -103,12 +110,36 @@ OperationDoc OpArgDocConvolveImages(){
                            " For correlation, the kernel is applied as-is (just like pattern-matching), but the"
                            " inner product of the paired voxel neighbourhood intensities is reported"
                            " (just like convolution)."
+                           " For normalized cross-correlation, the kernel is applied as-is and the Pearson"
+                           " correlation coefficient of the paired intensities is reported. A perfect match"
+                           " results in the outgoing voxel having an intensity of one, and the result is"
+                           " insensitive to linear intensity scaling, which makes it more robust than"
+                           " pattern-matching for locating objects in images with differing contrast."
                            " In all cases the kernel is (approximately) centred.";
     out.args.back().default_val = "convolution";
     out.args.back().expected = true;
     out.args.back().examples = { "convolution",
                                  "correlation",
-                                 "pattern-match" };
+                                 "pattern-match",
+                                 "normalized-cross-correlation" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
+
+
+    out.args.emplace_back();
+    out.args.back().name = "Method";
+    out.args.back().desc = "Controls how the kernel is evaluated."
+                           " The 'direct' method samples the neighbourhood of every voxel individually, so its cost"
+                           " grows with the product of the number of voxels and the kernel size."
+                           " The 'fft' method evaluates the kernel for all voxels at once in the frequency domain,"
+                           " which is considerably faster for all but the smallest kernels. The 'fft' method requires"
+                           " a single channel to be selected and every image to share the same number of rows and"
+                           " columns. The 'auto' method estimates the cost of each and selects the cheapest."
+                           " Results differ only by floating-point rounding.";
+    out.args.back().default_val = "auto";
+    out.args.back().expected = true;
+    out.args.back().examples = { "auto",
+                                 "direct",
+                                 "fft" };
     out.args.back().samples = OpArgSamples::Exhaustive;
 
     return out;
@@ -129,15 +160,29 @@ bool ConvolveImages(Drover &DICOM_data,
 
     const auto Channel = std::stol( OptArgs.getValueStr("Channel").value() );
     const auto OperationStr = OptArgs.getValueStr("Operation").value();
+    const auto MethodStr = OptArgs.getValueStr("Method").value();
 
     //-----------------------------------------------------------------------------------------------------------------
     const auto regex_conv = Compile_Regex("^conv?o?l?u?t?i?o?n?$");
     const auto regex_corr = Compile_Regex("^corr?e?l?a?t?i?o?n?$");
     const auto regex_mtch = Compile_Regex("^pa?t?t?e?r?n?.*ma?t?c?h?$");
+    const auto regex_ncc  = Compile_Regex("^(no?r?m?a?l?i?z?e?d?.*cr?o?s?s?.*corr?e?l?a?t?i?o?n?|ncc)$");
+
+    const auto regex_auto   = Compile_Regex("^au?t?o?$");
+    const auto regex_direct = Compile_Regex("^di?r?e?c?t?$");
+    const auto regex_fft    = Compile_Regex("^ff?t?$");
 
     const bool op_is_conv = std::regex_match(OperationStr, regex_conv);
     const bool op_is_corr = std::regex_match(OperationStr, regex_corr);
     const bool op_is_mtch = std::regex_match(OperationStr, regex_mtch);
+    const bool op_is_ncc  = std::regex_match(OperationStr, regex_ncc);
+
+    const bool method_is_auto   = std::regex_match(MethodStr, regex_auto);
+    const bool method_is_direct = std::regex_match(MethodStr, regex_direct);
+    const bool method_is_fft    = std::regex_match(MethodStr, regex_fft);
+    if(!method_is_auto && !method_is_direct && !method_is_fft){
+        throw std::invalid_argument("Method argument '"_s + MethodStr + "' is not valid");
+    }
     //-----------------------------------------------------------------------------------------------------------------
 
     // Identify the contours to use.
@@ -179,6 +224,128 @@ bool ConvolveImages(Drover &DICOM_data,
 
         auto IAs = Whitelist( IAs_all, ImageSelectionStr );
         for(auto & iap_it : IAs){
+            auto &imagecoll = (*iap_it)->imagecoll;
+            if(imagecoll.images.empty()) continue;
+
+            const long int kernel_rows = img_adj.index_to_image(0L).get().rows;
+            const long int kernel_columns = img_adj.index_to_image(0L).get().columns;
+            const auto kernel_imgs = static_cast<long int>(img_adj.int_to_img.size());
+
+            // Decide whether to evaluate in the frequency domain.
+            bool use_fft = false;
+            if(method_is_fft){
+                if(Channel < 0){
+                    throw std::invalid_argument("The 'fft' method requires a single channel to be selected");
+                }
+                use_fft = true;
+            }else if(method_is_auto && (0 <= Channel)){
+                use_fft = FFT_Correlation_Is_Favourable( {{ static_cast<long int>(imagecoll.images.size()),
+                                                            imagecoll.images.front().rows,
+                                                            imagecoll.images.front().columns }},
+                                                         {{ kernel_imgs, kernel_rows, kernel_columns }} );
+            }
+
+            if(use_fft){
+                FUNCINFO("Evaluating the " << kernel_imgs << "x" << kernel_rows << "x" << kernel_columns
+                         << " kernel in the frequency domain");
+
+                std::list<std::reference_wrapper<planar_image<float,double>>> selected_imgs;
+                for(auto &img : imagecoll.images){
+                    selected_imgs.push_back( std::ref(img) );
+                }
+                if(!Images_Form_Rectilinear_Grid(selected_imgs)){
+                    throw std::invalid_argument("Images do not form a rectilinear grid. Cannot continue");
+                }
+
+                // Gather the images and kernel into dense arrays, ordered using the same adjacency as the direct
+                // method.
+                planar_image_adjacency<float,double> t_adj( {}, { { std::ref(imagecoll) } }, orientation_normal );
+                const auto t_imgs = static_cast<long int>(t_adj.int_to_img.size());
+                const long int t_rows = imagecoll.images.front().rows;
+                const long int t_columns = imagecoll.images.front().columns;
+
+                dense_volume vol(t_imgs, t_rows, t_columns);
+                for(long int i = 0; i < t_imgs; ++i){
+                    const auto &img = t_adj.index_to_image(i).get();
+                    if( (img.rows != t_rows)
+                    ||  (img.columns != t_columns)
+                    ||  (img.channels <= Channel) ){
+                        throw std::invalid_argument("Images differ in number of rows, columns, or channels. Cannot continue");
+                    }
+                    for(long int r = 0; r < t_rows; ++r){
+                        for(long int c = 0; c < t_columns; ++c){
+                            vol.reference(i, r, c) = img.value(r, c, Channel);
+                        }
+                    }
+                }
+
+                const auto d_r = kernel_rows / 2;   // Offsets to (approximately) centre the kernel.
+                const auto d_c = kernel_columns / 2;
+                const auto d_i = kernel_imgs / 2;
+                std::array<long int, 3> centre = {{ d_i, d_r, d_c }};
+
+                dense_volume kernel(kernel_imgs, kernel_rows, kernel_columns);
+                for(long int i = 0; i < kernel_imgs; ++i){
+                    const auto &img = img_adj.index_to_image(i).get();
+                    for(long int r = 0; r < kernel_rows; ++r){
+                        for(long int c = 0; c < kernel_columns; ++c){
+                            if(op_is_conv){
+                                // Spatially flip the kernel, which also reflects the centre.
+                                kernel.reference(kernel_imgs - 1 - i, kernel_rows - 1 - r, kernel_columns - 1 - c)
+                                    = img.value(r, c, Channel);
+                            }else{
+                                kernel.reference(i, r, c) = img.value(r, c, Channel);
+                            }
+                        }
+                    }
+                }
+                if(op_is_conv){
+                    centre = {{ kernel_imgs - 1 - d_i, kernel_rows - 1 - d_r, kernel_columns - 1 - d_c }};
+                }
+
+                Correlation_Reduction reduction;
+                if( op_is_conv
+                ||  op_is_corr ){
+                    reduction = Correlation_Reduction::InnerProduct;
+                }else if(op_is_mtch){
+                    reduction = Correlation_Reduction::EuclideanDistance;
+                }else if(op_is_ncc){
+                    reduction = Correlation_Reduction::NormalizedCrossCorrelation;
+                }else{
+                    throw std::logic_error("Requested operation is not understood. Cannot continue.");
+                }
+                const auto result = FFT_Correlate(vol, kernel, centre, reduction);
+
+                // Only alter voxels within the selected ROIs, as the direct method does.
+                Mutate_Voxels_Opts mv_opts;
+                mv_opts.editstyle      = Mutate_Voxels_Opts::EditStyle::InPlace;
+                mv_opts.inclusivity    = Mutate_Voxels_Opts::Inclusivity::Centre;
+                mv_opts.contouroverlap = Mutate_Voxels_Opts::ContourOverlap::Ignore;
+                mv_opts.aggregate      = Mutate_Voxels_Opts::Aggregate::First;
+                mv_opts.adjacency      = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
+                mv_opts.maskmod        = Mutate_Voxels_Opts::MaskMod::Noop;
+
+                asio_thread_pool tp;
+                for(auto &img : imagecoll.images){
+                    std::reference_wrapper< planar_image<float, double>> img_refw( std::ref(img) );
+                    const auto img_num = t_adj.image_to_index(img_refw);
+                    tp.submit_task([&,img_refw,img_num]() -> void {
+                        auto f_bounded = [&](long int row, long int col, long int channel,
+                                             std::reference_wrapper<planar_image<float,double>>,
+                                             std::reference_wrapper<planar_image<float,double>>,
+                                             float &voxel_val) {
+                            if(channel != Channel) return;
+                            voxel_val = result.value(img_num, row, col);
+                            return;
+                        };
+                        Mutate_Voxels<float,double>( img_refw, { img_refw }, cc_ROIs, mv_opts, f_bounded );
+
+                        UpdateImageDescription( img_refw, "Image Convolved" );
+                        UpdateImageWindowCentreWidth( img_refw );
+                    });
+                }
+                continue;
+            }
 
             ComputeVolumetricNeighbourhoodSamplerUserData ud;
             ud.channel = Channel;
@@ -231,7 +398,8 @@ bool ConvolveImages(Drover &DICOM_data,
                 }
 
             }else if( op_is_corr
-                  ||  op_is_mtch ){
+                  ||  op_is_mtch
+                  ||  op_is_ncc ){
                 // No-op...
 
             }else{
@@ -258,6 +426,32 @@ bool ConvolveImages(Drover &DICOM_data,
                                   return std::sqrt(val);
                               };
 
+            }else if(op_is_ncc){
+                const auto k_mean = std::accumulate( std::begin(k_values), std::end(k_values), 0.0 )
+                                  / static_cast<double>(k_values.size());
+                ud.f_reduce = [=](float /*v*/, std::vector<float> &shtl, vec3<double>) -> float {
+                                  // Compute the Pearson correlation coefficient of the kernel and image voxel intensities.
+                                  double x_mean = 0.0;
+                                  for(const auto &x : shtl){
+                                      if(!std::isfinite(x)) return std::numeric_limits<float>::quiet_NaN();
+                                      x_mean += x;
+                                  }
+                                  x_mean /= static_cast<double>(shtl.size());
+
+                                  double xk = 0.0;
+                                  double xx = 0.0;
+                                  double kk = 0.0;
+                                  for(size_t i = 0; i < shtl.size(); ++i){
+                                      const double dx = shtl[i] - x_mean;
+                                      const double dk = k_values[i] - k_mean;
+                                      xk += dx * dk;
+                                      xx += dx * dx;
+                                      kk += dk * dk;
+                                  }
+                                  const double denom = std::sqrt(xx * kk);
+                                  return (0.0 < denom) ? static_cast<float>(std::clamp(xk / denom, -1.0, 1.0)) : 0.0f;
+                              };
+
             }else{
                 throw std::logic_error("Requested operation is not understood. Cannot continue.");
             }
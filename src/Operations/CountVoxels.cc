@@ -135,6 +135,7 @@ OperationDoc OpArgDocCountVoxels(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -267,6 +268,8 @@ bool CountVoxels(Drover &DICOM_data,
         ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
         ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
         ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+        DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+        ud.mask_cache = DICOM_data.voxel_mask_cache;
         //ud.description = "";
 
         if( std::regex_match(ContourOverlapStr, regex_ignore) ){
@@ -36,6 +36,7 @@ OperationDoc OpArgDocDICOMExportContours(){
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/RTSTRUCT.dcm", "./RTSTRUCT.dcm", "RTSTRUCT.dcm" };
     out.args.back().mimetype = "application/dicom";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "ParanoiaLevel";
@@ -48,6 +48,7 @@ OperationDoc OpArgDocDICOMExportImagesAsCT(){
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/CTs.tgz", "./CTs.tar.gz", "CTs.tgz" };
     out.args.back().mimetype = "application/gzip";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "ParanoiaLevel";
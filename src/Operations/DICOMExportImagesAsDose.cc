@@ -41,6 +41,7 @@ OperationDoc OpArgDocDICOMExportImagesAsDose(){
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/RD.dcm", "./RD.dcm", "RD.dcm" };
     out.args.back().mimetype = "application/dicom";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "ParanoiaLevel";
@@ -1,5 +1,8 @@
 //DeDuplicateImages.cc - A part of DICOMautomaton 2019. Written by hal clark.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <deque>
 #include <optional>
 #include <iterator>
@@ -9,12 +12,17 @@
 #include <regex>
 #include <stdexcept>
 #include <string>    
+#include <tuple>
+#include <vector>
 
+#include "YgorMath.h"
 #include "YgorMisc.h"
 #include "YgorStats.h"
+#include "YgorString.h"
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Image_Fingerprint.h"
 
 #include "DeDuplicateImages.h"
 
@@ -29,11 +37,30 @@ OperationDoc OpArgDocDeDuplicateImages(){
     out.notes.emplace_back(
         "This routine is experimental."
     );
+    out.notes.emplace_back(
+        "Exact criteria fingerprint every image array once and group arrays with identical fingerprints, so the cost"
+        " grows linearly with the number of image arrays. Image order within an array is disregarded."
+    );
 
     out.args.emplace_back();
     out.args.back() = IAWhitelistOpArgDoc();
     out.args.back().name = "ImageSelection";
     out.args.back().default_val = "all";
+
+    out.args.emplace_back();
+    out.args.back().name = "Criteria";
+    out.args.back().desc = "Controls how duplicates are identified."
+                           " 'Voxels' considers image arrays to be duplicates if their geometry and voxel intensities"
+                           " are identical."
+                           " 'Metadata' additionally requires all metadata to be identical (aside from the originating"
+                           " filename)."
+                           " 'Approximate' considers image arrays to be duplicates if their centres, volumes, and"
+                           " voxel intensity ranges are similar, which can identify copies that have been resampled or"
+                           " re-encoded, but is susceptible to false positives.";
+    out.args.back().default_val = "voxels";
+    out.args.back().expected = true;
+    out.args.back().examples = { "voxels", "metadata", "approximate" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
     
     return out;
 }
@@ -46,10 +73,22 @@ bool DeDuplicateImages(Drover &DICOM_data,
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
 
+    const auto CriteriaStr = OptArgs.getValueStr("Criteria").value();
+
     const auto d_center_threshold = 1.0; // DICOM units; mm.
     const auto d_volume_threshold = 1.0 * 1.0 * 1.0; // ~ the volume of a typical voxel.
     const auto vox_range_overlap_dice_threshold = 0.99; // the minimum acceptable dice similarity of the voxel intensity range.
     //-----------------------------------------------------------------------------------------------------------------
+    const auto regex_voxels = Compile_Regex("^vo?x?e?l?s?$");
+    const auto regex_meta   = Compile_Regex("^me?t?a?d?a?t?a?$");
+    const auto regex_approx = Compile_Regex("^ap?p?r?o?x?i?m?a?t?e?$");
+
+    const bool criteria_voxels = std::regex_match(CriteriaStr, regex_voxels);
+    const bool criteria_meta   = std::regex_match(CriteriaStr, regex_meta);
+    const bool criteria_approx = std::regex_match(CriteriaStr, regex_approx);
+    if(!criteria_voxels && !criteria_meta && !criteria_approx){
+        throw std::invalid_argument("Criteria argument '"_s + CriteriaStr + "' is not valid");
+    }
 
     const auto voxel_intensity_min_max = [](std::shared_ptr<Image_Array> ia){
         Stats::Running_MinMax<float> rmm;
@@ -68,44 +107,72 @@ bool DeDuplicateImages(Drover &DICOM_data,
     //std::list<std::shared_ptr<Image_Array>> IA_duplicates;
     std::list< std::list<std::shared_ptr<Image_Array>>::iterator > IA_duplicates;
 
-    // Score each relevant metric for each image array.
-    for(auto iapA_it_it = std::begin(IAs); iapA_it_it != std::end(IAs); ++iapA_it_it){
-        const auto center_A = (*(*iapA_it_it))->imagecoll.center();
-        const auto volume_A = (*(*iapA_it_it))->imagecoll.volume();
-        const auto rmm_A = voxel_intensity_min_max( (*(*iapA_it_it)) );
-
-        for(auto iapB_it_it = std::next(iapA_it_it); iapB_it_it != std::end(IAs);  ){
-            const auto center_B = (*(*iapB_it_it))->imagecoll.center();
-            const auto volume_B = (*(*iapB_it_it))->imagecoll.volume();
-            const auto rmm_B = voxel_intensity_min_max( (*(*iapB_it_it)) );
-
-            // Score the similarity by considering position, spatial extent, and voxel distribution.
-            const auto d_center = (center_A - center_B).length();
-            const auto d_volume = std::abs(volume_A - volume_B);
-
-            //const auto vox_lowest_min  = std::min(rmm_A.Current_Min(), rmm_B.Current_Min());
-            const auto vox_highest_min = std::max(rmm_A.Current_Min(), rmm_B.Current_Min());
-            const auto vox_lowest_max  = std::min(rmm_A.Current_Max(), rmm_B.Current_Max());
-            //const auto vox_highest_max = std::max(rmm_A.Current_Max(), rmm_B.Current_Max());
-            const auto vox_range_dice_numer = 2.0 * std::abs(vox_lowest_max - vox_highest_min);
-            const auto vox_range_dice_denom = std::abs(rmm_A.Current_Max() - rmm_A.Current_Min()) 
-                                            + std::abs(rmm_B.Current_Max() - rmm_B.Current_Min());
-            const auto vox_range_dice = vox_range_dice_numer + vox_range_dice_denom;
-
-FUNCINFO("About to compare image arrays: "
-      << " d_center = " << d_center
-      << " d_volume = " << d_volume
-      << " vox_range_dice = " << vox_range_dice );
-
-            // Check if the pair are duplicates. If so, erase the latter.
-            if( (d_center <= d_center_threshold)
-            &&  (d_volume <= d_volume_threshold)
-            &&  (vox_range_overlap_dice_threshold <= vox_range_dice) ){
+    if(criteria_voxels || criteria_meta){
+        // Bucket the image arrays by fingerprint. The first image array encountered in each bucket is retained.
+        using key_t = std::tuple<uint64_t, uint64_t, uint64_t, size_t>;
+        std::map<key_t, long int> buckets;
+        for(auto & iap_it : IAs){
+            const auto fp = Fingerprint_Image_Array( *(*iap_it) );
+            const key_t key( fp.geometry,
+                             fp.voxels,
+                             (criteria_meta ? fp.metadata : static_cast<uint64_t>(0)),
+                             fp.images.size() );
+            if(buckets[key]++ != 0){
                 FUNCINFO("Duplicate image array identified");
-                IA_duplicates.push_back( *iapB_it_it );
-                iapB_it_it = IAs.erase( iapB_it_it );
-            }else{
-                ++iapB_it_it;
+                IA_duplicates.push_back( iap_it );
+            }
+        }
+
+    }else{
+        // Summarize each image array once, and then compare the summaries pairwise.
+        struct summary_t {
+            vec3<double> center;
+            double volume;
+            Stats::Running_MinMax<float> rmm;
+        };
+        std::vector<summary_t> summaries;
+        for(auto & iap_it : IAs){
+            summaries.push_back( summary_t{ (*iap_it)->imagecoll.center(),
+                                            (*iap_it)->imagecoll.volume(),
+                                            voxel_intensity_min_max( *iap_it ) } );
+        }
+
+        std::vector<bool> is_duplicate(summaries.size(), false);
+        auto iapA_it_it = std::begin(IAs);
+        for(size_t a = 0; a < summaries.size(); ++a, ++iapA_it_it){
+            if(is_duplicate[a]) continue;
+            const auto &sA = summaries[a];
+
+            auto iapB_it_it = std::next(iapA_it_it);
+            for(size_t b = a + 1; b < summaries.size(); ++b, ++iapB_it_it){
+                if(is_duplicate[b]) continue;
+                const auto &sB = summaries[b];
+
+                // Score the similarity by considering position, spatial extent, and voxel distribution.
+                const auto d_center = (sA.center - sB.center).length();
+                const auto d_volume = std::abs(sA.volume - sB.volume);
+
+                const auto vox_highest_min = std::max(sA.rmm.Current_Min(), sB.rmm.Current_Min());
+                const auto vox_lowest_max  = std::min(sA.rmm.Current_Max(), sB.rmm.Current_Max());
+                const auto vox_range_dice_numer = 2.0 * std::abs(vox_lowest_max - vox_highest_min);
+                const auto vox_range_dice_denom = std::abs(sA.rmm.Current_Max() - sA.rmm.Current_Min()) 
+                                                + std::abs(sB.rmm.Current_Max() - sB.rmm.Current_Min());
+                const auto vox_range_dice = (vox_range_dice_denom == 0.0) ? 1.0
+                                          : vox_range_dice_numer / vox_range_dice_denom;
+
+                FUNCINFO("About to compare image arrays: "
+                      << " d_center = " << d_center
+                      << " d_volume = " << d_volume
+                      << " vox_range_dice = " << vox_range_dice );
+
+                // Check if the pair are duplicates. If so, mark the latter.
+                if( (d_center <= d_center_threshold)
+                &&  (d_volume <= d_volume_threshold)
+                &&  (vox_range_overlap_dice_threshold <= vox_range_dice) ){
+                    FUNCINFO("Duplicate image array identified");
+                    is_duplicate[b] = true;
+                    IA_duplicates.push_back( *iapB_it_it );
+                }
             }
         }
     }
@@ -14,7 +14,7 @@
 #include "../YgorImages_Functors/Grouping/Misc_Functors.h"
 #include "../YgorImages_Functors/Processing/DecayDoseOverTime.h"
 #include "DecayDoseOverTimeHalve.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 
 
@@ -75,7 +75,7 @@ bool DecayDoseOverTimeHalve(Drover &DICOM_data,
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Merge the image arrays if necessary.
     if(DICOM_data.image_data.empty()){
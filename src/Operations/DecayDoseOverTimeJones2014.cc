@@ -16,7 +16,7 @@
 #include "../YgorImages_Functors/Grouping/Misc_Functors.h"
 #include "../YgorImages_Functors/Processing/DecayDoseOverTime.h"
 #include "DecayDoseOverTimeJones2014.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -170,7 +170,7 @@ bool DecayDoseOverTimeJones2014(Drover &DICOM_data,
 
     ud.UseMoreConservativeRecovery = std::regex_match(UseMoreConservativeRecovery_str, TrueRegex);
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Merge the image arrays if necessary.
     if(DICOM_data.image_data.empty()){
@@ -42,6 +42,7 @@
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Point_KD_Tree.h"
 #include "../Insert_Contours.h"
 #include "../Write_File.h"
 #include "../YgorImages_Functors/ConvenienceRoutines.h"
@@ -1150,6 +1151,7 @@ OperationDoc OpArgDocDetectGrid3D(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "UserComment";
@@ -1272,6 +1274,9 @@ if(false){
             return;
         };
 
+        // Index the point cloud so the vicinity of each RANSAC centre can be extracted without a full scan.
+        const point_kd_tree pset_tree((*pcp_it)->pset);
+
         // Perform a RANSAC analysis by only analyzing the vicinity of a randomly selected point.
         long int ransac_loop = 0;
         std::mutex saver_printer;
@@ -1282,15 +1287,10 @@ if(false){
             ICPC.ransac_centre = (* std::next( std::begin((*pcp_it)->pset.points), N ));
 
             // Retain only the points within a small distance of the RANSAC centre.
-            using pcp_t = decltype((*pcp_it)->pset.points.front());
-            ICPC.cohort = (*pcp_it)->pset.points;
-            ICPC.cohort.erase(
-                std::remove_if(std::begin(ICPC.cohort), 
-                               std::end(ICPC.cohort),
-                               [&](pcp_t &pcp) -> bool {
-                                   return (pcp.distance(ICPC.ransac_centre) > RANSACDist);
-                               }),
-                std::end(ICPC.cohort) );
+            ICPC.cohort.clear();
+            for(const auto &n : pset_tree.within_radius(ICPC.ransac_centre, RANSACDist)){
+                ICPC.cohort.push_back( (*pcp_it)->pset.points[n.index] );
+            }
 
             if(ICPC.cohort.size() < 3){
                 // If there are too few points to meaningfully continue, then the only thing we can assume is that the
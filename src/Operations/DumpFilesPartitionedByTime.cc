@@ -16,6 +16,7 @@
 OperationDoc OpArgDocDumpFilesPartitionedByTime(){
     OperationDoc out;
     out.name = "DumpFilesPartitionedByTime";
+    out.has_side_effects = true;
        
     out.desc = 
         " This operation prints PACS filenames along with the associated time. It is more focused than the metadata "
@@ -55,6 +55,7 @@ OperationDoc OpArgDocDumpImageMeshes(){
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/image_mesh_", "./", "../model_" };
     //out.args.back().mimetype = "application/obj"; // "application/mtl";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "HistogramBins";
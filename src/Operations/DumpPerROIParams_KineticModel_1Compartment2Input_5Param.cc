@@ -49,6 +49,7 @@ OperationDoc OpArgDocDumpPerROIParams_KineticModel_1Compartment2Input_5Param(){
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/results.txt", "/dev/null", "~/output.txt" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "Separator";
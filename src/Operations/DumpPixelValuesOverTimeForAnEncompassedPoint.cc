@@ -18,6 +18,7 @@
 OperationDoc OpArgDocDumpPixelValuesOverTimeForAnEncompassedPoint(){
     OperationDoc out;
     out.name = "DumpPixelValuesOverTimeForAnEncompassedPoint";
+    out.has_side_effects = true;
 
     out.desc = 
         "Output the pixel values over time for a generic point."
@@ -46,6 +46,7 @@ OperationDoc OpArgDocDumpROIContours(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile.obj", "localfile.obj", "derivative_data.obj" };
     out.args.back().mimetype = "application/obj";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "MTLFileName";
@@ -56,6 +57,7 @@ OperationDoc OpArgDocDumpROIContours(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/materials.mtl", "localfile.mtl", "somefile.mtl" };
     out.args.back().mimetype = "application/mtl";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back() = NCWhitelistOpArgDoc();
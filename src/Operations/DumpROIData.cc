@@ -22,6 +22,7 @@
 OperationDoc OpArgDocDumpROIData(){
     OperationDoc out;
     out.name = "DumpROIData";
+    out.has_side_effects = true;
 
     out.desc = "This operation dumps ROI contour information for debugging and quick inspection purposes.";
 
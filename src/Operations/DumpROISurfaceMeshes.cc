@@ -142,6 +142,7 @@ OperationDoc OpArgDocDumpROISurfaceMeshes(){
     out.args.back().examples = { "/tmp/dicomautomaton_dumproisurfacemesh", 
                                  "../somedir/output", 
                                  "/path/to/some/mesh" };
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back() = NCWhitelistOpArgDoc();
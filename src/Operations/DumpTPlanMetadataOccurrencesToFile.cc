@@ -44,6 +44,7 @@ OperationDoc OpArgDocDumpTPlanMetadataOccurrencesToFile(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.tsv", "derivative_data.tsv" };
     out.args.back().mimetype = "text/tsv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
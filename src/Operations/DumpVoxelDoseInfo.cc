@@ -17,6 +17,7 @@
 OperationDoc OpArgDocDumpVoxelDoseInfo(){
     OperationDoc out;
     out.name = "DumpVoxelDoseInfo";
+    out.has_side_effects = true;
 
     out.desc = 
         "This operation locates the minimum and maximum dose voxel values. It is useful for estimating prescription doses.";
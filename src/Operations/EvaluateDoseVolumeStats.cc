@@ -23,7 +23,7 @@
 #include "../Regex_Selectors.h"
 #include "../YgorImages_Functors/Compute/AccumulatePixelDistributions.h"
 #include "EvaluateDoseVolumeStats.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -53,6 +53,11 @@ OperationDoc OpArgDocEvaluateDoseVolumeStats(){
         " combine separate image_arrays though. If needed, you'll have to perform a meld on them beforehand."
     );
 
+    out.notes.emplace_back(
+        "Dose percentiles (including the median) are estimated from a streaming summary of the dose distribution"
+        " and are accurate to within 0.1% of the true dose. All other quantities are exact."
+    );
+
 
 
     out.args.emplace_back();
@@ -63,6 +68,7 @@ OperationDoc OpArgDocEvaluateDoseVolumeStats(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -130,7 +136,7 @@ bool EvaluateDoseVolumeStats(Drover &DICOM_data,
     const auto theregex_Body = Compile_Regex(BodyROILabelRegex);
     const auto thenormalizedregex_Body = Compile_Regex(BodyNormalizedROILabelRegex);
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
 
     //Merge the image arrays if necessary.
@@ -195,29 +201,33 @@ bool EvaluateDoseVolumeStats(Drover &DICOM_data,
         patient_ID = "unknown_person";
     }
 
+    const auto Dpres95 = 0.95 * PTVPrescriptionDose;
+
     //Accumulate the voxel intensity distributions.
+    //
+    // Note: distributions are summarized as they are accumulated, so individual voxels are not retained.
     AccumulatePixelDistributionsUserData ud_PTV;
+    ud_PTV.retain_voxels = false;
+    ud_PTV.summarize = true;
+    ud_PTV.tally_thresholds = { Dpres95 };
     if(!img_arr_ptr->imagecoll.Compute_Images( AccumulatePixelDistributions, { },
                                                cc_PTV_ROIs, &ud_PTV )){
         throw std::runtime_error("Unable to accumulate PTV pixel distributions.");
     }
     AccumulatePixelDistributionsUserData ud_Body;
+    ud_Body.retain_voxels = false;
+    ud_Body.tally_thresholds = { Dpres95 };
     if(!img_arr_ptr->imagecoll.Compute_Images( AccumulatePixelDistributions, { },
                                                cc_Body_ROIs, &ud_Body )){
         throw std::runtime_error("Unable to accumulate Body pixel distributions.");
     }
 
-
-    const auto Dpres95 = 0.95 * PTVPrescriptionDose;
     long int N_Body_over_Dpres95 = 0; //We assume all body ROIs are part of a single object.
 
     //Evalute the models.
     {
-        for(auto &av : ud_Body.accumulated_voxels){
-            for(const auto &D_voxel : av.second){
-                if(D_voxel > Dpres95) ++N_Body_over_Dpres95;
-            }
-            av.second.clear(); // Reduce memory pressure.
+        for(const auto &t : ud_Body.tallies){
+            N_Body_over_Dpres95 += t.second.front();
         }
     }
 
@@ -226,24 +236,20 @@ bool EvaluateDoseVolumeStats(Drover &DICOM_data,
 
     std::map<std::string, long int> N_PTV_over_Dpres95; //We assume all PTV ROIs are distinct.
     {
-        for(const auto &av : ud_PTV.accumulated_voxels){
-            const auto lROIname = av.first;
+        for(const auto &s : ud_PTV.summaries){
+            const auto lROIname = s.first;
 
-            const auto D_02 = Stats::Percentile(av.second, 0.98); // D_02 == 98% dose percentile.
-            const auto D_50 = Stats::Percentile(av.second, 0.50);
-            const auto D_98 = Stats::Percentile(av.second, 0.02); // D_98 == 2% dose percentile.
+            const auto D_02 = s.second.quantile(0.98); // D_02 == 98% dose percentile.
+            const auto D_50 = s.second.quantile(0.50);
+            const auto D_98 = s.second.quantile(0.02); // D_98 == 2% dose percentile.
 
             HI[lROIname] = (D_02 - D_98)/D_50;
 
-            long int N_over_Dpres95 = 0;
-            for(const auto &D_voxel : av.second){
-                if(D_voxel > Dpres95) ++N_over_Dpres95;
-            }
-            N_PTV_over_Dpres95[lROIname] += N_over_Dpres95;
+            N_PTV_over_Dpres95[lROIname] += ud_PTV.tallies[lROIname].front();
         }
-        for(const auto &av : ud_PTV.accumulated_voxels){
-            const auto lROIname = av.first;
-            const auto N = av.second.size();
+        for(const auto &s : ud_PTV.summaries){
+            const auto lROIname = s.first;
+            const auto N = s.second.get_moments().count;
             //const long double V_frac = static_cast<long double>(1) / N; // Fractional volume of a single voxel compared to whole ROI.
 
             const auto N_T = static_cast<double>(N);
@@ -288,13 +294,14 @@ bool EvaluateDoseVolumeStats(Drover &DICOM_data,
                    << "VoxelCount"
                    << std::endl;
         }
-        for(const auto &av : ud_PTV.accumulated_voxels){
-            const auto lROIname = av.first;
-            const auto DoseMin = Stats::Min( av.second );
-            const auto DoseMean = Stats::Mean( av.second );
-            const auto DoseMedian = Stats::Median( av.second );
-            const auto DoseMax = Stats::Max( av.second );
-            const auto DoseStdDev = std::sqrt(Stats::Unbiased_Var_Est( av.second ));
+        for(const auto &s : ud_PTV.summaries){
+            const auto lROIname = s.first;
+            const auto &moments = s.second.get_moments();
+            const auto DoseMin = moments.min;
+            const auto DoseMean = moments.mean;
+            const auto DoseMedian = s.second.quantile(0.5);
+            const auto DoseMax = moments.max;
+            const auto DoseStdDev = std::sqrt(moments.variance());
             const auto HeterogeneityIndex = HI[lROIname];
             const auto ConformityNumber = CN[lROIname];
 
@@ -309,7 +316,7 @@ bool EvaluateDoseVolumeStats(Drover &DICOM_data,
                     << DoseMedian         << ","
                     << DoseMax            << ","
                     << DoseStdDev         << ","
-                    << av.second.size()
+                    << moments.count
                     << std::endl;
         }
         FO_tcp.flush();
@@ -24,7 +24,7 @@
 #include "../Regex_Selectors.h"
 #include "../YgorImages_Functors/Compute/AccumulatePixelDistributions.h"
 #include "EvaluateTCPModels.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -73,6 +73,7 @@ OperationDoc OpArgDocEvaluateTCPModels(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -257,7 +258,7 @@ bool EvaluateTCPModels(Drover &DICOM_data,
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Merge the image arrays if necessary.
     if(DICOM_data.image_data.empty()){
@@ -62,6 +62,7 @@ OperationDoc OpArgDocExportFITSImages(){
     out.args.back().examples = { "../somedir/out", 
                                  "/path/to/some/dir/file_prefix" };
     out.args.back().mimetype = "application/object-file-format"; // TODO: find correct MIME type.
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
@@ -61,6 +61,7 @@ OperationDoc OpArgDocExportLineSamples(){
                                  "../somedir/data", 
                                  "/path/to/some/line_sample_to_plot" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
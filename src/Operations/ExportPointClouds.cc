@@ -62,6 +62,7 @@ OperationDoc OpArgDocExportPointClouds(){
                                  "../somedir/data", 
                                  "/path/to/some/points" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
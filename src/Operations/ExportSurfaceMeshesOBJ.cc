@@ -71,6 +71,7 @@ OperationDoc OpArgDocExportSurfaceMeshesOBJ(){
                                  "/path/to/some/surface_mesh.obj" };
     //out.args.back().mimetype = "application/object-file-format";
     out.args.back().mimetype = "model/obj";
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
@@ -72,6 +72,7 @@ OperationDoc OpArgDocExportSurfaceMeshesOFF(){
                                  "../somedir/mesh.off", 
                                  "/path/to/some/surface_mesh.off" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
@@ -69,6 +69,7 @@ OperationDoc OpArgDocExportSurfaceMeshesPLY(){
                                  "../somedir/mesh.ply", 
                                  "/path/to/some/surface_mesh.ply" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -73,6 +73,7 @@ OperationDoc OpArgDocExportSurfaceMeshesSTL(){
                                  "../somedir/mesh.stl", 
                                  "/path/to/some/surface_mesh.stl" };
     out.args.back().mimetype = "model/stl";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -60,6 +60,7 @@ OperationDoc OpArgDocExportWarps(){
                                  "trans.txt",
                                  "/path/to/some/trans.txt" };
     out.args.back().mimetype = "text/plain";
+    out.args.back().flow = OpArgFlow::Egress;
 
     return out;
 }
@@ -24,7 +24,7 @@
 #include "../Regex_Selectors.h"
 #include "../YgorImages_Functors/Compute/Extract_Histograms.h"
 #include "ExtractImageHistograms.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -180,9 +180,8 @@ OperationDoc OpArgDocExtractImageHistograms(){
     out.args.emplace_back();
     out.args.back().name = "dDose";
     out.args.back().desc = "The (fixed) bin width, in units of dose (DICOM units; nominally Gy)."
-                           " Note that this is the *maximum* bin width, in practice bins may be"
-                           " smaller to account for slop (i.e., excess caused by the extrema being"
-                           " separated by a non-integer number of bins of width $dDose$).";
+                           " Bin edges are integer multiples of $dDose$, so the first and last bins may extend"
+                           " beyond the extrema of the voxel distribution.";
     out.args.back().default_val = "0.1";
     out.args.back().expected = true;
     out.args.back().examples = { "0.0001", "0.001", "0.01", "5.0", "10", "50" };
@@ -239,7 +238,7 @@ bool ExtractImageHistograms(Drover &DICOM_data,
     const auto regex_separate = Compile_Regex("^se?p?[ea]?r?a?t?e?$");
     const auto regex_combined = Compile_Regex("^co?m?b?i?n?e?d?$");
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     if( std::regex_match(GroupingStr, regex_combined) && !GroupLabelOpt ){
         throw std::invalid_argument("A valid 'GroupLabel' must be provided when 'Grouping'='combined'.");
@@ -289,6 +288,8 @@ bool ExtractImageHistograms(Drover &DICOM_data,
         ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
         ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
         ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+        DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+        ud.mask_cache = DICOM_data.voxel_mask_cache;
 
         if( std::regex_match(ContourOverlapStr, regex_ignore) ){
             ud.mutation_opts.contouroverlap = Mutate_Voxels_Opts::ContourOverlap::Ignore;
@@ -23,7 +23,7 @@
 #include "../Alignment_Rigid.h"
 #include "../Alignment_TPSRPM.h"
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -36,6 +36,7 @@
 OperationDoc OpArgDocExtractPointsWarp(){
     OperationDoc out;
     out.name = "ExtractPointsWarp";
+    out.has_side_effects = true;
 
     out.desc = 
         "This operation uses two point clouds (one 'moving' and the other 'stationary' or 'reference') to find a"
@@ -485,7 +486,7 @@ bool ExtractPointsWarp(Drover &DICOM_data,
                          /*InvocationMetadata*/,
                          const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto MovingPointSelectionStr = OptArgs.getValueStr("MovingPointSelection").value();
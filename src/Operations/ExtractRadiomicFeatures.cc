@@ -31,7 +31,7 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorFilesDirs.h"
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Insert_Contours.h"
 #include "../Structs.h"
@@ -81,6 +81,7 @@ OperationDoc OpArgDocExtractRadiomicFeatures(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -109,7 +110,7 @@ bool ExtractRadiomicFeatures(Drover &DICOM_data,
                                const std::map<std::string, std::string>& /*InvocationMetadata*/,
                                const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     auto FeaturesFileName = OptArgs.getValueStr("FeaturesFileName").value();
@@ -101,6 +101,7 @@ OperationDoc OpArgDocGenerateCalibrationCurve(){
     out.args.back().default_val = "";
     out.args.back().expected = true;
     out.args.back().examples = { "./calib.dat" };
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back() = NCWhitelistOpArgDoc();
@@ -13,7 +13,7 @@
 #include "../Regex_Selectors.h"
 #include "../Metadata.h"
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -196,7 +196,7 @@ bool GenerateSyntheticImages(Drover &DICOM_data,
                                const std::map<std::string, std::string>&,
                                const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto NumberOfImages = std::stol( OptArgs.getValueStr("NumberOfImages").value() );
@@ -11,7 +11,7 @@
 #include "../Imebra_Shim.h"
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "GenerateVirtualDataImageSphereV1.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -33,7 +33,7 @@ bool GenerateVirtualDataImageSphereV1(Drover &DICOM_data,
                                         const std::map<std::string, std::string>&,
                                         const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     using loaded_imgs_storage_t = decltype(DICOM_data.image_data);
     std::list<loaded_imgs_storage_t> loaded_imgs_storage;
@@ -15,7 +15,7 @@
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Imebra_Shim.h"
 #include "../Structs.h"
@@ -39,7 +39,7 @@ bool GenerateVirtualDataPerfusionV1(Drover &DICOM_data,
                                       const std::map<std::string, std::string>&,
                                       const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     using loaded_imgs_storage_t = decltype(DICOM_data.image_data);
     std::list<loaded_imgs_storage_t> loaded_imgs_storage;
@@ -18,12 +18,13 @@
 
 #include "../Dose_Meld.h"
 #include "../Structs.h"
+#include "../Slice_Index.h"
 #include "../Regex_Selectors.h"
 #include "../Thread_Pool.h"
 #include "../YgorImages_Functors/Compute/GenerateSurfaceMask.h"
 #include "../YgorImages_Functors/Grouping/Misc_Functors.h"
 #include "../YgorImages_Functors/Processing/In_Image_Plane_Bicubic_Supersample.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "GridBasedRayCastDoseAccumulate.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
@@ -51,6 +52,7 @@ OperationDoc OpArgDocGridBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/dose.fits", "localfile.fits", "derivative_data.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "DoseLengthMapFileName";
@@ -60,6 +62,7 @@ OperationDoc OpArgDocGridBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/doselength.fits", "localfile.fits", "derivative_data.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -70,6 +73,7 @@ OperationDoc OpArgDocGridBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/surfacelength.fits", "localfile.fits", "derivative_data.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -194,7 +198,7 @@ bool GridBasedRayCastDoseAccumulate(Drover &DICOM_data,
     const auto refregex = Compile_Regex(ReferenceROILabelRegex);
     const auto refnormalizedregex = Compile_Regex(NormalizedReferenceROILabelRegex);
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Merge the dose arrays if multiple are available.
     DICOM_data = Meld_Only_Dose_Data(DICOM_data);
@@ -475,7 +479,7 @@ bool GridBasedRayCastDoseAccumulate(Drover &DICOM_data,
                         const auto midpoint = ray_pos - (ray_dir * RaydL * 0.5);
 
                         //Check if it was in the surface at the midpoint.
-                        auto rel_img = grid_arr_ptr->imagecoll.get_images_which_encompass_point(midpoint);
+                        auto rel_img = grid_arr_ptr->slice_lookup->get_images_which_encompass_point(midpoint);
                         if(rel_img.empty()) continue;
                         const auto mask_val = rel_img.front()->value(midpoint, 0);
                         const auto is_in_surface = (mask_val == surface_mask_val);
@@ -483,7 +487,7 @@ bool GridBasedRayCastDoseAccumulate(Drover &DICOM_data,
                             accumulated_length += RaydL;
 
                             //Find the dose at the half-way point.
-                            auto encompass_imgs = img_arr_ptr->imagecoll.get_images_which_encompass_point( midpoint );
+                            auto encompass_imgs = img_arr_ptr->slice_lookup->get_images_which_encompass_point( midpoint );
                             for(const auto &enc_img : encompass_imgs){
                                 const auto pix_val = enc_img->value(midpoint, 0);
                                 accumulated_doselength += RaydL * pix_val;
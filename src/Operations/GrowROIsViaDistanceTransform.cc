@@ -0,0 +1,326 @@
+//GrowROIsViaDistanceTransform.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+#include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
+#include "YgorString.h"       //Needed for SplitStringToVector(...)
+
+#include "../Structs.h"
+#include "../Regex_Selectors.h"
+#include "../FFT_Correlation.h"
+#include "../Distance_Transform.h"
+#include "../Operation_Dispatcher.h"
+#include "../Operation_Monitor.h"
+#include "../Thread_Pool.h"
+
+#include "GrowROIsViaDistanceTransform.h"
+
+
+OperationDoc OpArgDocGrowROIsViaDistanceTransform(){
+    OperationDoc out;
+    out.name = "GrowROIsViaDistanceTransform";
+
+    out.desc =
+        "This operation adds a margin to (or subtracts a margin from) the selected ROIs in the voxel domain."
+        " ROIs are rasterized onto the selected image array, an exact Euclidean distance transform is computed,"
+        " and the grown or shrunk ROI is re-contoured from the resulting distance map."
+        " Unlike mesh-based approaches, the margin is applied in 3D (i.e., across image planes) and the cost scales"
+        " linearly with the number of voxels rather than the ROI complexity.";
+
+    out.notes.emplace_back(
+        "The selected image array must form a rectilinear grid. Only its geometry is used; voxel values are ignored."
+        " The margin is clipped to the extent of the image grid, so images should encompass the grown ROI."
+    );
+    out.notes.emplace_back(
+        "Voxels are considered part of the ROI if their centre is bounded by the ROI contours, and the margin is"
+        " measured from the boundary of these voxels (i.e., half a voxel beyond their centres). The resulting contours"
+        " are therefore accurate to within approximately half a voxel, and small features (i.e., comparable to a voxel)"
+        " may not be faithfully reproduced."
+    );
+    out.notes.emplace_back(
+        "All selected ROIs are combined into a single ROI before the margin is applied."
+    );
+
+    out.args.emplace_back();
+    out.args.back() = IAWhitelistOpArgDoc();
+    out.args.back().name = "ImageSelection";
+    out.args.back().desc += " Note that the selected images define the grid on which the ROIs are rasterized and"
+                            " the new contours are generated.";
+    out.args.back().default_val = "last";
+
+    out.args.emplace_back();
+    out.args.back() = NCWhitelistOpArgDoc();
+    out.args.back().name = "NormalizedROILabelRegex";
+    out.args.back().default_val = ".*";
+
+    out.args.emplace_back();
+    out.args.back() = RCWhitelistOpArgDoc();
+    out.args.back().name = "ROILabelRegex";
+    out.args.back().default_val = ".*";
+
+    out.args.emplace_back();
+    out.args.back().name = "Distance";
+    out.args.back().desc = "The margin to add to the ROIs, in DICOM units. Positive distances grow the ROIs and"
+                           " negative distances shrink them."
+                           " Either a single distance can be provided, which is applied isotropically, or three"
+                           " comma-separated distances can be provided, which are applied along the direction of"
+                           " increasing row number, increasing column number, and across image planes (i.e., along"
+                           " the image normal), respectively. Anisotropic margins must all share the same sign."
+                           " A zero distance along an axis means the ROI will not grow or shrink along that axis.";
+    out.args.back().default_val = "5.0";
+    out.args.back().expected = true;
+    out.args.back().examples = { "5.0", "-3.0", "5.0,5.0,10.0", "7.0,7.0,0.0", "-2.0,-2.0,-4.0" };
+
+    out.args.emplace_back();
+    out.args.back().name = "ROILabel";
+    out.args.back().desc = "A label to attach to the new contours.";
+    out.args.back().default_val = "margin";
+    out.args.back().expected = true;
+    out.args.back().examples = { "margin", "PTV", "PRV", "body_shrunk" };
+
+    out.args.emplace_back();
+    out.args.back().name = "Method";
+    out.args.back().desc = "The contour extraction method to use. See the ContourViaThreshold operation for details."
+                           " The 'marching-squares' method interpolates the distance map, which reduces the"
+                           " jaggedness of the extracted contours considerably.";
+    out.args.back().default_val = "marching-squares";
+    out.args.back().expected = true;
+    out.args.back().examples = { "binary", "marching-squares" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
+
+    out.args.emplace_back();
+    out.args.back().name = "KeepDistanceMap";
+    out.args.back().desc = "Whether to retain the signed distance map as a new image array."
+                           " Distances are in DICOM units, positive outside the original ROIs, and negative inside."
+                           " Voxels that cannot be reached (e.g., when no voxels are bounded by the ROIs) are"
+                           " assigned infinite distances.";
+    out.args.back().default_val = "false";
+    out.args.back().expected = true;
+    out.args.back().examples = { "true", "false" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
+
+    return out;
+}
+
+
+
+bool GrowROIsViaDistanceTransform(Drover &DICOM_data,
+                                  const OperationArgPkg& OptArgs,
+                                  const std::map<std::string, std::string>& InvocationMetadata,
+                                  const std::string& FilenameLex){
+
+    //---------------------------------------------- User Parameters --------------------------------------------------
+    const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
+
+    const auto NormalizedROILabelRegex = OptArgs.getValueStr("NormalizedROILabelRegex").value();
+    const auto ROILabelRegex = OptArgs.getValueStr("ROILabelRegex").value();
+
+    const auto DistanceStr = OptArgs.getValueStr("Distance").value();
+    const auto ROILabel = OptArgs.getValueStr("ROILabel").value();
+    const auto MethodStr = OptArgs.getValueStr("Method").value();
+    const auto KeepDistanceMapStr = OptArgs.getValueStr("KeepDistanceMap").value();
+
+    //-----------------------------------------------------------------------------------------------------------------
+    const auto regex_true = Compile_Regex("^tr?u?e?$");
+    const auto KeepDistanceMap = std::regex_match(KeepDistanceMapStr, regex_true);
+
+    // Margins along the (image, row, column) axes, matching the dense_volume layout.
+    std::array<double, 3> margin;
+    {
+        const auto distances = SplitStringToVector(DistanceStr, ',', 'd');
+        if(distances.size() == 1){
+            margin.fill( std::stod(distances.front()) );
+        }else if(distances.size() == 3){
+            margin = {{ std::stod(distances.at(2)),
+                        std::stod(distances.at(0)),
+                        std::stod(distances.at(1)) }};
+        }else{
+            throw std::invalid_argument("Distance must be a single distance or three comma-separated distances");
+        }
+    }
+    const auto grows = std::any_of(std::begin(margin), std::end(margin), [](double m){ return (0.0 < m); });
+    const auto shrinks = std::any_of(std::begin(margin), std::end(margin), [](double m){ return (m < 0.0); });
+    if(std::any_of(std::begin(margin), std::end(margin), [](double m){ return !std::isfinite(m); })){
+        throw std::invalid_argument("Distances must be finite. Cannot continue.");
+    }
+    if(grows && shrinks){
+        throw std::invalid_argument("Distances must share the same sign. Cannot continue.");
+    }
+
+    // Distances are evaluated in units of the margin along each axis, so the (possibly anisotropic) margin boundary
+    // becomes the unit level set. See Margin_Scaled_Spacing() for details.
+    const double level = (shrinks) ? -1.0 : 1.0;
+
+    // Distance maps can be infinite, which is not suitable for interpolation.
+    const auto clamp = [](double x) -> float {
+        constexpr double bound = 1.0E6;
+        return static_cast<float>( std::clamp(x, -bound, bound) );
+    };
+
+    // Identify the contours to use.
+    auto cc_all = All_CCs( DICOM_data );
+    auto cc_ROIs = Whitelist( cc_all, { { "ROIName", ROILabelRegex },
+                                        { "NormalizedROIName", NormalizedROILabelRegex } } );
+    if(cc_ROIs.empty()){
+        throw std::invalid_argument("No contours selected. Cannot continue.");
+    }
+
+    // Single-channel images sharing the geometry and metadata of the reference image.
+    const auto make_image = [](const planar_image<float,double> &ref) -> planar_image<float,double> {
+        planar_image<float,double> out;
+        out.metadata = ref.metadata;
+        out.init_orientation(ref.row_unit, ref.col_unit);
+        out.init_buffer(ref.rows, ref.columns, 1);
+        out.init_spatial(ref.pxl_dx, ref.pxl_dy, ref.pxl_dz, ref.anchor, ref.offset);
+        out.fill_pixels(0.0f);
+        return out;
+    };
+
+    const auto monitor = Current_Operation_Monitor();
+    auto IAs_all = All_IAs( DICOM_data );
+    auto IAs = Whitelist( IAs_all, ImageSelectionStr );
+    for(auto & iap_it : IAs){
+        Check_For_Operation_Cancellation(monitor);
+        auto &imagecoll = (*iap_it)->imagecoll;
+        if(imagecoll.images.empty()) continue;
+
+        {
+            std::list<std::reference_wrapper<planar_image<float,double>>> selected_imgs;
+            for(auto &img : imagecoll.images){
+                selected_imgs.push_back( std::ref(img) );
+            }
+            if(!Images_Form_Rectilinear_Grid(selected_imgs)){
+                throw std::invalid_argument("Images do not form a rectilinear grid. Cannot continue");
+            }
+        }
+
+        const auto &ref_img = imagecoll.images.front();
+        const auto normal = ref_img.row_unit.Cross(ref_img.col_unit).unit();
+        planar_image_adjacency<float,double> img_adj( {}, { { std::ref(imagecoll) } }, normal );
+
+        const auto N = static_cast<long int>(img_adj.int_to_img.size());
+        const long int rows = ref_img.rows;
+        const long int columns = ref_img.columns;
+        for(const auto &img : imagecoll.images){
+            if( (img.rows != rows)
+            ||  (img.columns != columns) ){
+                throw std::invalid_argument("Images differ in number of rows or columns. Cannot continue");
+            }
+        }
+
+        // Voxel centre spacing along the (image, row, column) axes.
+        double dz = 1.0; // Arbitrary, since distances cannot propagate across a single image.
+        if(1 < N){
+            const auto C0 = img_adj.index_to_image(0L).get().center();
+            const auto C1 = img_adj.index_to_image(1L).get().center();
+            dz = std::abs( (C1 - C0).Dot(normal) );
+        }
+        const std::array<double, 3> spacing = {{ dz, ref_img.pxl_dx, ref_img.pxl_dy }};
+
+        // Rasterize the ROIs.
+        dense_volume mask(N, rows, columns);
+        {
+            Mutate_Voxels_Opts mv_opts;
+            mv_opts.editstyle      = Mutate_Voxels_Opts::EditStyle::InPlace;
+            mv_opts.inclusivity    = Mutate_Voxels_Opts::Inclusivity::Centre;
+            mv_opts.contouroverlap = Mutate_Voxels_Opts::ContourOverlap::Ignore;
+            mv_opts.aggregate      = Mutate_Voxels_Opts::Aggregate::First;
+            mv_opts.adjacency      = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
+            mv_opts.maskmod        = Mutate_Voxels_Opts::MaskMod::Noop;
+
+            std::mutex error_mutex;
+            std::exception_ptr error;
+            {
+                asio_thread_pool tp;
+                for(long int i = 0; i < N; ++i){
+                    tp.submit_task([&,i]() -> void {
+                        if(Operation_Cancellation_Requested(monitor)) return;
+                        try{
+                            auto l_mask = make_image( img_adj.index_to_image(i).get() );
+
+                            auto f_bounded = [&](long int row, long int col, long int,
+                                                 std::reference_wrapper<planar_image<float,double>>,
+                                                 std::reference_wrapper<planar_image<float,double>>,
+                                                 float &) {
+                                mask.reference(i, row, col) = 1.0f;
+                                return;
+                            };
+                            Mutate_Voxels<float,double>( std::ref(l_mask), { std::ref(l_mask) }, cc_ROIs, mv_opts, f_bounded );
+                        }catch(...){
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if(!error) error = std::current_exception();
+                        }
+                    });
+                }
+            } // Wait until all threads are done.
+            if(error) std::rethrow_exception(error);
+            Check_For_Operation_Cancellation(monitor);
+        }
+
+        // Evaluate the distance map so that the (grown or shrunk) ROI corresponds to non-negative values.
+        Drover contouring;
+        contouring.image_data.emplace_back( std::make_shared<Image_Array>() );
+        {
+            const auto sdt = Signed_Distance_Transform(mask, Margin_Scaled_Spacing(margin, spacing));
+            auto &field_imgs = contouring.image_data.back()->imagecoll.images;
+            for(long int i = 0; i < N; ++i){
+                field_imgs.emplace_back( make_image( img_adj.index_to_image(i).get() ) );
+                for(long int r = 0; r < rows; ++r){
+                    for(long int c = 0; c < columns; ++c){
+                        field_imgs.back().reference(r, c, 0) = clamp(level - sdt.value(i, r, c));
+                    }
+                }
+            }
+        }
+
+        std::list<OperationArgPkg> Operations;
+        Operations.emplace_back("ContourViaThreshold");
+        Operations.back().insert("ImageSelection=last");
+        Operations.back().insert("Channel=0");
+        Operations.back().insert("Lower=0.0");
+        Operations.back().insert("Method="_s + MethodStr);
+        Operations.back().insert("ROILabel="_s + ROILabel);
+        if(!Operation_Dispatcher(contouring, InvocationMetadata, FilenameLex, Operations)){
+            throw std::runtime_error("Unable to extract contours from the distance map. Cannot continue.");
+        }
+        if(contouring.Has_Contour_Data()){
+            DICOM_data.Ensure_Contour_Data_Allocated();
+            DICOM_data.contour_data->ccs.splice( std::end(DICOM_data.contour_data->ccs),
+                                                 contouring.contour_data->ccs );
+        }
+
+        if(KeepDistanceMap){
+            const auto sdt = Signed_Distance_Transform(mask, spacing);
+            auto out = std::make_shared<Image_Array>();
+            for(long int i = 0; i < N; ++i){
+                out->imagecoll.images.emplace_back( make_image( img_adj.index_to_image(i).get() ) );
+                auto &img = out->imagecoll.images.back();
+                for(long int r = 0; r < rows; ++r){
+                    for(long int c = 0; c < columns; ++c){
+                        img.reference(r, c, 0) = sdt.value(i, r, c);
+                    }
+                }
+                img.metadata["Description"] = "Signed distance map";
+            }
+            DICOM_data.image_data.emplace_back( out );
+        }
+        FUNCINFO("Applied margin using a " << N << "x" << rows << "x" << columns << " distance map");
+    }
+
+    return true;
+}
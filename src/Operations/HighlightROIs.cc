@@ -473,6 +473,10 @@ bool HighlightROIs(Drover &DICOM_data,
         ud.f_visitor = f_noop;
 
         if(std::regex_match(MethodStr, regex_binary)){
+            // Only the binary method can reuse cached masks since the receding squares method inspects the mask.
+            DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+            ud.mask_cache = DICOM_data.voxel_mask_cache;
+
             if(ShouldOverwriteInterior){
                 ud.f_bounded = [&](long int /*row*/, long int /*col*/, long int chan,
                                    std::reference_wrapper<planar_image<float,double>> /*img_refw*/,
@@ -31,6 +31,7 @@
 #include "../Thread_Pool.h"
 #include "../Write_File.h"
 #include "../File_Loader.h"
+#include "../Image_Fingerprint.h"
 #include "../Operation_Dispatcher.h"
 
 #include "LoadFiles.h"
@@ -57,6 +58,17 @@ OperationDoc OpArgDocLoadFiles(){
     out.args.back().default_val = "";
     out.args.back().expected = true;
     out.args.back().examples = { "/tmp/image.dcm", "rois.dcm", "dose.dcm", "image.fits", "point_cloud.xyz" };
+    out.args.back().flow = OpArgFlow::Ingress;
+
+    out.args.emplace_back();
+    out.args.back().name = "RejectDuplicateInstances";
+    out.args.back().desc = "Controls whether images with a SOPInstanceUID that has already been loaded are discarded."
+                           " Repeated exports frequently contain the same instances, and retaining them results in"
+                           " duplicate image arrays or duplicate images within an array.";
+    out.args.back().default_val = "false";
+    out.args.back().expected = true;
+    out.args.back().examples = { "true", "false" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
 
     return out;
 }
@@ -68,8 +80,11 @@ bool LoadFiles(Drover &DICOM_data,
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto FileNameStr = OptArgs.getValueStr("FileName").value();
+    const auto RejectDuplicateInstancesStr = OptArgs.getValueStr("RejectDuplicateInstances").value();
 
     //-----------------------------------------------------------------------------------------------------------------
+    const auto regex_true = Compile_Regex("^tr?u?e?$");
+    const bool RejectDuplicateInstances = std::regex_match(RejectDuplicateInstancesStr, regex_true);
 
     std::list<std::string> FileNames = { { FileNameStr } };
     std::list<std::filesystem::path> Paths;
@@ -101,6 +116,10 @@ bool LoadFiles(Drover &DICOM_data,
         throw std::runtime_error("Unable to load one or more files. Refusing to continue.");
     }
 
+    if(RejectDuplicateInstances){
+        Purge_Duplicate_Instances(DICOM_data, DD_work);
+    }
+
     // Merge the loaded files into the current Drover class.
     DICOM_data.Consume(DD_work);
 
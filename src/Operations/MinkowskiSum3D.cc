@@ -54,6 +54,7 @@
 OperationDoc OpArgDocMinkowskiSum3D(){
     OperationDoc out;
     out.name = "MinkowskiSum3D";
+    out.has_side_effects = true;
 
     out.desc = 
         "This operation computes a Minkowski sum or symmetric difference of a 3D surface mesh generated from the"
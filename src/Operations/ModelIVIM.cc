@@ -22,6 +22,7 @@
 #endif //DCMA_USE_EIGEN
 
 #include "../Structs.h"
+#include "../Slice_Index.h"
 #include "../Regex_Selectors.h"
 #include "../BED_Conversion.h"
 #include "../YgorImages_Functors/Compute/Joint_Pixel_Sampler.h"
@@ -285,6 +286,7 @@ bool ModelIVIM(Drover &DICOM_data,
         }else if(std::regex_match(ModelStr, model_kurtosis)){
             // Add channels to each image for each model parameter.
             auto imgarr_ptr = &((*iap_it)->imagecoll);
+            auto slice_lookup = (*iap_it)->slice_lookup;
             for(auto &img : imgarr_ptr->images){
                 img.add_channel( nan ); // for D.
                 img.add_channel( nan ); // for pseduoD.
@@ -297,7 +299,7 @@ bool ModelIVIM(Drover &DICOM_data,
             ud.f_reduce = [bvalues,
                            bvalue_min_i,
                            bvalue_max_i,
-                           imgarr_ptr,
+                           slice_lookup,
                            chan_D,
                            chan_pD ]( std::vector<float> &vals, 
                                       vec3<double> pos ) -> float {
@@ -312,7 +314,7 @@ bool ModelIVIM(Drover &DICOM_data,
 
                 // The image/voxel iterator interface isn't capable of handling multiple-channel values,
                 // so we have to explicitly lookup the position and insert it directly.
-                const auto img_it_l = imgarr_ptr->get_images_which_encompass_point(pos);
+                const auto img_it_l = slice_lookup->get_images_which_encompass_point(pos);
                 if(img_it_l.size() != 1){
                     throw std::logic_error("Unable to find singular overlapping image.");
                 }
@@ -333,6 +335,7 @@ bool ModelIVIM(Drover &DICOM_data,
         }else if(std::regex_match(ModelStr, model_biexp)){
             // Add channels to each image for each model parameter.
             auto imgarr_ptr = &((*iap_it)->imagecoll);
+            auto slice_lookup = (*iap_it)->slice_lookup;
             for(auto &img : imgarr_ptr->images){
                 img.add_channel( nan ); // for D.
                 img.add_channel( nan ); // for pseduoD.
@@ -345,7 +348,7 @@ bool ModelIVIM(Drover &DICOM_data,
             ud.f_reduce = [bvalues,
                            bvalue_min_i,
                            bvalue_max_i,
-                           imgarr_ptr,
+                           slice_lookup,
                            chan_D,
                            chan_pD ]( std::vector<float> &vals, 
                                       vec3<double> pos ) -> float {
@@ -359,7 +362,7 @@ bool ModelIVIM(Drover &DICOM_data,
 
                 // The image/voxel iterator interface isn't capable of handling multiple-channel values,
                 // so we have to explicitly lookup the position and insert it directly.
-                const auto img_it_l = imgarr_ptr->get_images_which_encompass_point(pos);
+                const auto img_it_l = slice_lookup->get_images_which_encompass_point(pos);
                 if(img_it_l.size() != 1){
                     throw std::logic_error("Unable to find singular overlapping image.");
                 }
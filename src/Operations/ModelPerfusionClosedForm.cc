@@ -0,0 +1,428 @@
+//ModelPerfusionClosedForm.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>            //Needed for std::pair.
+#include <vector>
+
+#include "../Structs.h"
+#include "../Regex_Selectors.h"
+#include "../Image_Spill_Store.h"
+#include "../Operation_Monitor.h"
+#include "../KineticModel_1Compartment_ClosedForm.h"
+#include "../YgorImages_Functors/ConvenienceRoutines.h"
+#include "../YgorImages_Functors/Compute/Per_ROI_Time_Courses.h"
+#include "../YgorImages_Functors/Grouping/Misc_Functors.h"
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for samples_1D.
+#include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
+#include "YgorStats.h"        //Needed for Stats:: namespace.
+
+#include "ModelPerfusionClosedForm.h"
+
+
+OperationDoc OpArgDocModelPerfusionClosedForm(){
+    OperationDoc out;
+    out.name = "ModelPerfusionClosedForm";
+    out.supports_spilled_images = true;
+
+    out.desc =
+        "This operation fits a linear, closed-form single-compartment perfusion model to every voxel within the"
+        " selected ROI(s). Either a single-input (arterial) or dual-input (arterial and venous) model can be used."
+        " Parameter maps (k1A, k1V, and k2) are created as new image arrays.";
+
+    out.notes.emplace_back(
+        "Images within each selected image array are grouped by spatial overlap, and each group is treated as a"
+        " time series. Every image must have 'dt' metadata, which is interpreted as the acquisition time in seconds."
+        " Times are shifted so that the earliest image in the array occurs at t=0."
+    );
+    out.notes.emplace_back(
+        "Voxel intensities are modeled directly, so images should already represent contrast enhancement"
+        " (e.g., with the pre-contrast baseline subtracted)."
+    );
+    out.notes.emplace_back(
+        "Unlike iterative models, the closed-form models reduce to a handful of inner products per voxel. Voxel"
+        " time courses are resampled into a shared, regular grid and all voxels are processed together in"
+        " vectorized blocks on the host using all available CPU cores."
+    );
+    out.notes.emplace_back(
+        "All voxels within a spatially-overlapping group must share the same rows, columns, and channels."
+    );
+    out.notes.emplace_back(
+        "This operation supports images that have been spilled to disk (see SpillImagesToDisk). Only a single"
+        " spatially-overlapping group needs to be held in memory at a time, so 4D series larger than the"
+        " available memory can be modeled."
+    );
+
+    out.args.emplace_back();
+    out.args.back() = IAWhitelistOpArgDoc();
+    out.args.back().name = "ImageSelection";
+    out.args.back().default_val = "last";
+
+    out.args.emplace_back();
+    out.args.back() = NCWhitelistOpArgDoc();
+    out.args.back().name = "NormalizedROILabelRegex";
+    out.args.back().default_val = ".*";
+    out.args.back().desc = "The tissue region to model. " + out.args.back().desc;
+
+    out.args.emplace_back();
+    out.args.back() = RCWhitelistOpArgDoc();
+    out.args.back().name = "ROILabelRegex";
+    out.args.back().default_val = ".*";
+    out.args.back().desc = "The tissue region to model. " + out.args.back().desc;
+
+    out.args.emplace_back();
+    out.args.back() = RCWhitelistOpArgDoc();
+    out.args.back().name = "AIFROILabelRegex";
+    out.args.back().default_val = ".*Aorta.*";
+    out.args.back().desc = "The ROI(s) used to derive the arterial input function. Voxels within all selected"
+                           " ROIs are averaged together. " + out.args.back().desc;
+
+    out.args.emplace_back();
+    out.args.back() = RCWhitelistOpArgDoc();
+    out.args.back().name = "VIFROILabelRegex";
+    out.args.back().default_val = ".*Portal.*";
+    out.args.back().desc = "The ROI(s) used to derive the venous input function. Voxels within all selected"
+                           " ROIs are averaged together. This argument is ignored for the single-input model. "
+                         + out.args.back().desc;
+
+    out.args.emplace_back();
+    out.args.back().name = "Model";
+    out.args.back().desc = "The kinetic model to use."
+                           " 'SCDI' is the single-compartment dual-input model with arterial and venous inputs."
+                           " 'SCSI' is the single-compartment single-input model with only an arterial input.";
+    out.args.back().default_val = "SCDI";
+    out.args.back().expected = true;
+    out.args.back().examples = { "SCDI", "SCSI" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
+
+    out.args.emplace_back();
+    out.args.back().name = "ResamplingInterval";
+    out.args.back().desc = "All time courses are resampled with this regular spacing (in seconds) using linear"
+                           " interpolation before modeling.";
+    out.args.back().default_val = "0.1";
+    out.args.back().expected = true;
+    out.args.back().examples = { "0.1", "0.5", "1.0" };
+
+    out.args.emplace_back();
+    out.args.back().name = "SlopeWindow";
+    out.args.back().desc = "The number of trailing (resampled) samples used to estimate the late-time linear"
+                           " behaviour of each time course. Only used by the dual-input model.";
+    out.args.back().default_val = "100";
+    out.args.back().expected = true;
+    out.args.back().examples = { "20", "100", "500" };
+
+    out.args.emplace_back();
+    out.args.back().name = "Channel";
+    out.args.back().desc = "The image channel to use. Zero-based.";
+    out.args.back().default_val = "0";
+    out.args.back().expected = true;
+    out.args.back().examples = { "0", "1", "2" };
+
+    out.args.emplace_back();
+    out.args.back().name = "Benchmark";
+    out.args.back().desc = "Whether to report timing information, including the number of voxels modeled per"
+                           " second.";
+    out.args.back().default_val = "false";
+    out.args.back().expected = true;
+    out.args.back().examples = { "true", "false" };
+    out.args.back().samples = OpArgSamples::Exhaustive;
+
+    return out;
+}
+
+bool ModelPerfusionClosedForm(Drover &DICOM_data,
+                              const OperationArgPkg& OptArgs,
+                              const std::map<std::string, std::string>& /*InvocationMetadata*/,
+                              const std::string& /*FilenameLex*/){
+
+    //---------------------------------------------- User Parameters --------------------------------------------------
+    const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
+
+    const auto NormalizedROILabelRegex = OptArgs.getValueStr("NormalizedROILabelRegex").value();
+    const auto ROILabelRegex = OptArgs.getValueStr("ROILabelRegex").value();
+    const auto AIFROILabelRegex = OptArgs.getValueStr("AIFROILabelRegex").value();
+    const auto VIFROILabelRegex = OptArgs.getValueStr("VIFROILabelRegex").value();
+
+    const auto ModelStr = OptArgs.getValueStr("Model").value();
+    const auto ResamplingInterval = std::stod( OptArgs.getValueStr("ResamplingInterval").value() );
+    const auto SlopeWindow = std::stol( OptArgs.getValueStr("SlopeWindow").value() );
+    const auto Channel = std::stol( OptArgs.getValueStr("Channel").value() );
+    const auto BenchmarkStr = OptArgs.getValueStr("Benchmark").value();
+
+    //-----------------------------------------------------------------------------------------------------------------
+    const auto regex_scdi = Compile_Regex("^sc?di?$");
+    const auto regex_scsi = Compile_Regex("^sc?si?$");
+    const auto regex_true = Compile_Regex("^tr?u?e?$");
+
+    KineticModel_1Compartment_ClosedForm_Inputs model_inputs;
+    if(std::regex_match(ModelStr, regex_scdi)){
+        model_inputs.variant = KineticModel_1Compartment_ClosedForm_Variant::DualInput;
+    }else if(std::regex_match(ModelStr, regex_scsi)){
+        model_inputs.variant = KineticModel_1Compartment_ClosedForm_Variant::SingleInput;
+    }else{
+        throw std::invalid_argument("Model argument '"_s + ModelStr + "' is not valid");
+    }
+    const bool dual = (model_inputs.variant == KineticModel_1Compartment_ClosedForm_Variant::DualInput);
+    const bool Benchmark = std::regex_match(BenchmarkStr, regex_true);
+    model_inputs.dt = ResamplingInterval;
+    model_inputs.slope_window = SlopeWindow;
+
+    if(!(0.0 < ResamplingInterval)){
+        throw std::invalid_argument("Resampling interval must be positive.");
+    }
+    if(Channel < 0){
+        throw std::invalid_argument("Channel must be non-negative.");
+    }
+
+    auto cc_all = All_CCs( DICOM_data );
+    auto cc_ROIs = Whitelist( cc_all, { { "ROIName", ROILabelRegex },
+                                        { "NormalizedROIName", NormalizedROILabelRegex } } );
+    auto cc_AIF = Whitelist( cc_all, "ROIName", AIFROILabelRegex );
+    auto cc_VIF = Whitelist( cc_all, "ROIName", VIFROILabelRegex );
+    if(cc_ROIs.empty()){
+        throw std::invalid_argument("No tissue contours selected. Cannot continue.");
+    }
+    if(cc_AIF.empty()){
+        throw std::invalid_argument("No AIF contours selected. Cannot continue.");
+    }
+    if(dual && cc_VIF.empty()){
+        throw std::invalid_argument("No VIF contours selected. Cannot continue.");
+    }
+
+    using clock_t = std::chrono::steady_clock;
+    const auto seconds_since = [](clock_t::time_point t) -> double {
+        return std::chrono::duration<double>(clock_t::now() - t).count();
+    };
+
+    auto IAs_all = All_IAs( DICOM_data );
+    auto IAs = Whitelist( IAs_all, ImageSelectionStr );
+    for(auto & iap_it : IAs){
+        Check_For_Operation_Cancellation();
+        auto &imagecoll = (*iap_it)->imagecoll;
+        if(imagecoll.images.empty()) continue;
+
+        const auto t_start = clock_t::now();
+
+        // Determine the time offset so the series begins at t=0.
+        double t0 = std::numeric_limits<double>::infinity();
+        for(const auto &img : imagecoll.images){
+            const auto dt = img.GetMetadataValueAs<double>("dt");
+            if(!dt) throw std::invalid_argument("Image is missing 'dt' metadata. Cannot continue.");
+            t0 = std::min(t0, dt.value());
+        }
+
+        // Partition the images into spatial groups (i.e., time series) up-front. If the voxel data has been spilled
+        // to disk, each group is paged in as a unit and pinned only while it is in use.
+        Image_Spill_Store *spill_store = (*iap_it)->spill_store.get();
+        std::vector<std::list<planar_image_collection<float,double>::images_list_it_t>> groups;
+        {
+            auto all_images = imagecoll.get_all_images();
+            while(!all_images.empty()){
+                auto curr_img_it = all_images.front();
+                auto selected_imgs = GroupSpatiallyOverlappingImages(curr_img_it, std::ref(imagecoll));
+                for(auto &an_img_it : selected_imgs){
+                    all_images.remove(an_img_it);
+                }
+                if(selected_imgs.empty()){
+                    throw std::logic_error("No spatially-overlapping images found. Cannot continue.");
+                }
+                groups.emplace_back(std::move(selected_imgs));
+            }
+        }
+        const auto pointers_to = [](const std::list<planar_image_collection<float,double>::images_list_it_t> &its){
+            std::list<planar_image<float,double>*> out;
+            for(const auto &it : its) out.push_back( &(*it) );
+            return out;
+        };
+
+        // Derive the input functions by averaging all voxels within the selected ROIs.
+        const auto derive_input_function = [&](std::list<std::reference_wrapper<contour_collection<double>>> ccs)
+                                                  -> std::vector<float> {
+            ComputePerROITimeCoursesUserData ud;
+            if(spill_store == nullptr){
+                if(!imagecoll.Compute_Images( ComputePerROICourses, { }, ccs, &ud )){
+                    throw std::runtime_error("Unable to compute per-ROI time courses.");
+                }
+            }else{
+                // Time courses accumulate incrementally, so they can be computed one resident group at a time.
+                // Groups are visited in reverse so the first group, which is needed next, remains resident.
+                for(auto g_it = std::rbegin(groups); g_it != std::rend(groups); ++g_it){
+                    pinned_images pinned(spill_store, pointers_to(*g_it));
+                    planar_image_collection<float,double> group_coll;
+                    for(const auto &an_img_it : *g_it) group_coll.images.push_back( *an_img_it );
+                    if(!group_coll.Compute_Images( ComputePerROICourses, { }, ccs, &ud )){
+                        throw std::runtime_error("Unable to compute per-ROI time courses.");
+                    }
+                }
+            }
+            samples_1D<double> summed;
+            uint64_t voxel_count = 0;
+            for(auto &tc : ud.time_courses){
+                summed = summed.Sum_With(tc.second);
+                voxel_count += ud.voxel_count[tc.first];
+            }
+            if(voxel_count == 0) throw std::runtime_error("Input function ROI(s) do not contain any voxels.");
+            summed = summed.Multiply_With(1.0 / static_cast<double>(voxel_count));
+            for(auto &s : summed.samples) s[0] -= t0;
+            return Resample_Time_Course_Regularly(summed, ResamplingInterval);
+        };
+        model_inputs.aif = derive_input_function(cc_AIF);
+        model_inputs.vif.clear();
+        if(dual) model_inputs.vif = derive_input_function(cc_VIF);
+
+        DICOM_data.image_data.emplace_back( std::make_shared<Image_Array>() );
+        auto k1A_map = DICOM_data.image_data.back();
+        std::shared_ptr<Image_Array> k1V_map;
+        if(dual){
+            DICOM_data.image_data.emplace_back( std::make_shared<Image_Array>() );
+            k1V_map = DICOM_data.image_data.back();
+        }
+        DICOM_data.image_data.emplace_back( std::make_shared<Image_Array>() );
+        auto k2_map = DICOM_data.image_data.back();
+
+        double harvest_time = 0.0;
+        double fit_time = 0.0;
+        long int voxels_modeled = 0;
+
+        // Process each spatial location (i.e., each time series) in turn.
+        for(const auto &selected_imgs : groups){
+            Check_For_Operation_Cancellation();
+            const auto t_harvest = clock_t::now();
+
+            pinned_images pinned(spill_store, pointers_to(selected_imgs));
+            auto curr_img_it = selected_imgs.front();
+
+            const auto rows     = curr_img_it->rows;
+            const auto columns  = curr_img_it->columns;
+            const auto channels = curr_img_it->channels;
+            if(channels <= Channel){
+                throw std::invalid_argument("Channel is not present in the image. Cannot continue.");
+            }
+
+            // Order the series temporally.
+            std::vector<std::pair<double, planar_image<float,double>*>> series;
+            for(auto &an_img_it : selected_imgs){
+                if( (rows     != an_img_it->rows)
+                ||  (columns  != an_img_it->columns)
+                ||  (channels != an_img_it->channels) ){
+                    throw std::domain_error("Spatially-overlapping images have differing number of rows, columns, or"
+                                            " channels. This is not currently supported.");
+                }
+                const auto dt = an_img_it->GetMetadataValueAs<double>("dt");
+                if(!dt) throw std::invalid_argument("Image is missing 'dt' metadata. Cannot continue.");
+                series.emplace_back( dt.value() - t0, &(*an_img_it) );
+            }
+            std::stable_sort(std::begin(series), std::end(series),
+                             [](const auto &L, const auto &R){ return (L.first < R.first); });
+
+            // Identify which voxels are within the tissue ROI(s).
+            planar_image<float,double> mask = *curr_img_it;
+            mask.fill_pixels(0.0f);
+            {
+                Mutate_Voxels_Opts mv_opts;
+                mv_opts.editstyle      = Mutate_Voxels_Opts::EditStyle::InPlace;
+                mv_opts.inclusivity    = Mutate_Voxels_Opts::Inclusivity::Centre;
+                mv_opts.contouroverlap = Mutate_Voxels_Opts::ContourOverlap::Ignore;
+                mv_opts.aggregate      = Mutate_Voxels_Opts::Aggregate::First;
+                mv_opts.adjacency      = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
+                mv_opts.maskmod        = Mutate_Voxels_Opts::MaskMod::Noop;
+
+                auto f_bounded = [&](long int, long int, long int chan,
+                                     std::reference_wrapper<planar_image<float,double>>,
+                                     std::reference_wrapper<planar_image<float,double>>,
+                                     float &val) {
+                    if(chan == Channel) val = 1.0f;
+                    return;
+                };
+                Mutate_Voxels<float,double>( std::ref(mask), { std::ref(mask) }, cc_ROIs, mv_opts, f_bounded );
+            }
+            std::vector<long int> voxel_indices;
+            for(long int row = 0; row < rows; ++row){
+                for(long int col = 0; col < columns; ++col){
+                    const auto index = mask.index(row, col, Channel);
+                    if(mask.value(index) != 0.0f) voxel_indices.emplace_back(index);
+                }
+            }
+
+            // Resample the series onto the same regular grid as the input functions. The interpolation weights are
+            // shared by all voxels, so they are computed once and the voxel time courses are gathered row-by-row.
+            const auto N = static_cast<long int>(model_inputs.aif.size());
+            const auto Nc = static_cast<long int>(voxel_indices.size());
+            KineticModel_1Compartment_ClosedForm_Batch batch;
+            if(!voxel_indices.empty()){
+                if( (series.front().first > 0.0)
+                ||  (series.back().first < (static_cast<double>(N - 1) * ResamplingInterval)) ){
+                    throw std::invalid_argument("Time series does not span the input functions. Cannot continue.");
+                }
+                batch.resize(Nc, N);
+                size_t k = 0;
+                for(long int n = 0; n < N; ++n){
+                    const double t = static_cast<double>(n) * ResamplingInterval;
+                    while( ((k + 2) < series.size()) && (series[k+1].first < t) ) ++k;
+                    const auto &L = series[k];
+                    const auto &R = series[std::min(k + 1, series.size() - 1)];
+                    const double span = R.first - L.first;
+                    const auto w = (0.0 < span) ? static_cast<float>(std::clamp((t - L.first) / span, 0.0, 1.0))
+                                                : 0.0f;
+                    const float *pL = L.second->data.data();
+                    const float *pR = R.second->data.data();
+                    float *out = batch.c.data() + n * Nc;
+                    for(long int j = 0; j < Nc; ++j){
+                        const auto index = voxel_indices[j];
+                        out[j] = pL[index] + w * (pR[index] - pL[index]);
+                    }
+                }
+            }
+            harvest_time += seconds_since(t_harvest);
+
+            const auto t_fit = clock_t::now();
+            Fit_1Compartment_ClosedForm(model_inputs, batch);
+            fit_time += seconds_since(t_fit);
+            voxels_modeled += Nc;
+
+            // Write the parameters into maps.
+            const auto emit_map = [&](std::shared_ptr<Image_Array> &map, const std::vector<float> &params,
+                                      const std::string &desc){
+                map->imagecoll.images.emplace_back( *curr_img_it );
+                auto &img = map->imagecoll.images.back();
+                img.fill_pixels(std::numeric_limits<float>::quiet_NaN());
+                for(long int j = 0; j < Nc; ++j) img.reference(voxel_indices[j]) = params[j];
+
+                Stats::Running_MinMax<float> minmax;
+                for(const auto &p : params) if(std::isfinite(p)) minmax.Digest(p);
+                UpdateImageDescription( std::ref(img), desc );
+                UpdateImageWindowCentreWidth( std::ref(img), minmax );
+                return;
+            };
+            const std::string model_name = (dual ? "SCDI" : "SCSI");
+            emit_map(k1A_map, batch.k1A, "Perfusion model (" + model_name + ") k1A map");
+            if(dual) emit_map(k1V_map, batch.k1V, "Perfusion model (" + model_name + ") k1V map");
+            emit_map(k2_map, batch.k2, "Perfusion model (" + model_name + ") k2 map");
+        }
+
+        if(Benchmark){
+            const auto total_time = seconds_since(t_start);
+            const auto rate = [](double n, double t) -> double { return (0.0 < t) ? (n / t) : 0.0; };
+            FUNCINFO("Modeled " << voxels_modeled << " voxels with " << model_inputs.aif.size()
+                     << " samples each in " << total_time << " s");
+            FUNCINFO("    Time course harvesting: " << harvest_time << " s ("
+                     << rate(static_cast<double>(voxels_modeled), harvest_time) << " voxels/s)");
+            FUNCINFO("    Model fitting: " << fit_time << " s ("
+                     << rate(static_cast<double>(voxels_modeled), fit_time) << " voxels/s)");
+            FUNCINFO("    Overall: " << rate(static_cast<double>(voxels_modeled), total_time) << " voxels/s");
+        }
+    }
+
+    return true;
+}
@@ -14,6 +14,7 @@
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Slice_Index.h"
 #include "../Metadata.h"
 
 #include "YgorImages.h"
@@ -234,6 +235,7 @@ bool ModifyImageMetadata(Drover &DICOM_data,
             auto l_key_values = key_values;
             inject_metadata( animg.metadata, std::move(l_key_values) );
         }
+        (*iap_it)->slice_lookup->invalidate();
     }
 
     return true;
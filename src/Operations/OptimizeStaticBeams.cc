@@ -32,7 +32,7 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorFilesDirs.h"
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Insert_Contours.h"
 #include "../Structs.h"
@@ -136,6 +136,7 @@ OperationDoc OpArgDocOptimizeStaticBeams(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -214,7 +215,7 @@ bool OptimizeStaticBeams(Drover &DICOM_data,
                            /*InvocationMetadata*/,
                            const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
@@ -25,7 +25,7 @@
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
 #include "../YgorImages_Functors/Compute/AccumulatePixelDistributions.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "PartitionContours.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
@@ -249,7 +249,7 @@ bool PartitionContours(Drover &DICOM_data,
         throw std::invalid_argument("Requested number of partitions along 'Z' axis is not valid. Refusing to continue.");
     }
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     // Stuff references to all contours into a list. Remember that you can still address specific contours through
     // the original holding containers (which are not modified here).
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -21,10 +22,11 @@
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 #include "YgorFilesDirs.h"
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Point_KD_Tree.h"
 #include "../YgorImages_Functors/Compute/Contour_Similarity.h"
 
 #include "PointSeparation.h"
@@ -68,6 +70,7 @@ OperationDoc OpArgDocPointSeparation(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -94,7 +97,7 @@ bool PointSeparation(Drover &DICOM_data,
     auto FileName = OptArgs.getValueStr("FileName").value();
     const auto UserComment = OptArgs.getValueStr("UserComment");
     //-----------------------------------------------------------------------------------------------------------------
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     auto PCs_all = All_PCs( DICOM_data );
     const auto PCs_A = Whitelist( PCs_all, PointSelectionAStr );
@@ -133,26 +136,28 @@ bool PointSeparation(Drover &DICOM_data,
     double sq_separation_max = -sq_separation_min;
     double sq_hausdorff = -std::numeric_limits<double>::infinity();
 
+    // Index all B points so that nearest and farthest points can be located without exhaustively pairing all points.
+    std::vector<vec3<double>> points_B;
+    for(const auto & pcpB_it : PCs_B){
+        points_B.insert( std::end(points_B), std::begin((*pcpB_it)->pset.points), std::end((*pcpB_it)->pset.points) );
+    }
+    const point_kd_tree tree_B(points_B);
+
     for(const auto & pcpA_it : PCs_A){
-        for(const auto& vA : (*pcpA_it)->pset.points){
-
-            double sq_nearest = std::numeric_limits<double>::infinity();
-            for(const auto & pcpB_it : PCs_B){
-                for(const auto& vB : (*pcpB_it)->pset.points){
-                    const auto sq_sep = vA.sq_dist(vB);
-                    // Identify the nearest point in set B for the current set A point.
-                    if(sq_sep < sq_nearest){
-                        sq_nearest = sq_sep;
-                    }
-                    // Identify the shortest A-point to B-point distance for all points in A and B.
-                    if(sq_sep < sq_separation_min){
-                        sq_separation_min = sq_sep;
-                    }
-                    // Identify the longest A-point to B-point distance for all points in A and B.
-                    if(sq_separation_max < sq_sep){
-                        sq_separation_max = sq_sep;
-                    }
-                }
+        const auto nearest = tree_B.nearest( (*pcpA_it)->pset.points );
+        const auto farthest = tree_B.farthest( (*pcpA_it)->pset.points );
+        for(size_t i = 0; i < nearest.size(); ++i){
+            if( (nearest[i].index < 0)
+            ||  (farthest[i].index < 0) ) continue;
+
+            // Identify the shortest A-point to B-point distance for all points in A and B.
+            const auto sq_nearest = nearest[i].sq_dist;
+            if(sq_nearest < sq_separation_min){
+                sq_separation_min = sq_nearest;
+            }
+            // Identify the longest A-point to B-point distance for all points in A and B.
+            if(sq_separation_max < farthest[i].sq_dist){
+                sq_separation_max = farthest[i].sq_dist;
             }
 
             // Identify if the nearest matching point in set B for the current set A point is the A-B Hausdorff distance.
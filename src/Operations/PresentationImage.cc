@@ -73,6 +73,7 @@ OperationDoc OpArgDocPresentationImage(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/an_image.png", "afile.png" };
     out.args.back().mimetype = "image/png";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "ColourMapRegex";
@@ -268,6 +269,9 @@ bool PresentationImage(Drover &DICOM_data,
         sf::Image animage;
         animage.create(img_cols, img_rows);
 
+        //Use a precomputed lookup table rather than evaluating the colour map for every pixel, if possible.
+        const auto lut = Get_Colour_Map_LUT(colour_maps[colour_map].second);
+
         //------------------------------------------------------------------------------------------------
         //Apply a window to the data if it seems like the WindowCenter or WindowWidth specified in the image metadata
         // are applicable. Note that it is likely that pixels will be clipped or truncated. This is intentional.
@@ -316,7 +320,8 @@ bool PresentationImage(Drover &DICOM_data,
                             x = (val - (win_c - win_r)) / win_fw;
                         }
 
-                        const auto res = colour_maps[colour_map].second(x);
+                        const auto res = (lut != nullptr) ? lut->clamped(x)
+                                                            : colour_maps[colour_map].second(x);
                         const double x_R = res.R;
                         const double x_G = res.G;
                         const double x_B = res.B;
@@ -365,7 +370,8 @@ bool PresentationImage(Drover &DICOM_data,
                         const double clamped_value = (static_cast<double>(val) - pixel_type_min)/(pixel_type_max - pixel_type_min);
                         const auto rescaled_value = (clamped_value - clamped_low)/(clamped_high - clamped_low);
 
-                        const auto res = colour_maps[colour_map].second(rescaled_value);
+                        const auto res = (lut != nullptr) ? lut->clamped(rescaled_value)
+                                                            : colour_maps[colour_map].second(rescaled_value);
                         const double x_R = res.R;
                         const double x_G = res.G;
                         const double x_B = res.B;
@@ -56,11 +56,12 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Operation_Dispatcher.h"
 
 #include "../Colour_Maps.h"
+#include "../Slice_Cache.h"
 #include "../Common_Boost_Serialization.h"
 #include "../Common_Plotting.h"
 
@@ -571,6 +572,7 @@ void draw_with_brush( const decltype(planar_image_collection<float,double>().get
 OperationDoc OpArgDocSDL_Viewer(){
     OperationDoc out;
     out.name = "SDL_Viewer";
+    out.has_side_effects = true;
     out.desc = 
         "Launch an interactive viewer based on SDL.";
 
@@ -593,7 +595,7 @@ bool SDL_Viewer(Drover &DICOM_data,
         return;
     });
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     struct View_Toggles {
         bool set_about_popup = false;
@@ -979,175 +981,26 @@ bool SDL_Viewer(Drover &DICOM_data,
             return;
     };
 
-    std::atomic<bool> need_to_reload_opengl_texture = true;
-    const auto Load_OpenGL_Texture = [&colour_maps,
-                                      &colour_map,
-                                      &nan_colour,
-                                      &img_channel ]( const planar_image<float,double>& img,
-                                                      const std::optional<double>& custom_centre,
-                                                      const std::optional<double>& custom_width ) -> opengl_texture_handle_t {
-
-            const auto img_cols = img.columns;
-            const auto img_rows = img.rows;
-            const auto img_chns = img.channels;
-
-            if(!isininc(1,img_rows,10000) || !isininc(1,img_cols,10000)){
-                throw std::invalid_argument("Image dimensions are not reasonable. Refusing to continue");
-            }
-            if(!isininc(1,img_channel+1,img_chns)){
-                throw std::invalid_argument("Image does not have selected channel. Refusing to continue");
-            }
-
-            std::vector<std::byte> animage;
-            animage.reserve(img_cols * img_rows * 3);
-
-            //------------------------------------------------------------------------------------------------
-            //Apply a window to the data if it seems like the WindowCenter or WindowWidth specified in the image metadata
-            // are applicable. Note that it is likely that pixels will be clipped or truncated. This is intentional.
-            
-            auto img_win_valid = img.GetMetadataValueAs<std::string>("WindowValidFor");
-            auto img_desc      = img.GetMetadataValueAs<std::string>("Description");
-            auto img_win_c     = img.GetMetadataValueAs<double>("WindowCenter");
-            auto img_win_fw    = img.GetMetadataValueAs<double>("WindowWidth"); //Full width or range. (Diameter, not radius.)
-
-            auto custom_win_c  = custom_centre; 
-            auto custom_win_fw = custom_width; 
-
-            const auto UseCustomWL = (custom_win_c && custom_win_fw);
-            const auto UseImgWL = (UseCustomWL) ? false 
-                                                : (   (img_chns == 1) // Only honour for single-channel images.
-                                                   && img_win_valid 
-                                                   && img_desc
-                                                   && img_win_c 
-                                                   && img_win_fw 
-                                                   && (img_win_valid.value() == img_desc.value()));
-
-            if( UseCustomWL || UseImgWL ){
-                //Window/linear scaling transformation parameters.
-                //const auto win_r = 0.5*(win_fw.value() - 1.0); //The 'radius' of the range, or half width omitting the centre point.
-
-                //The 'radius' of the range, or half width omitting the centre point.
-                const auto win_r  = (UseCustomWL) ? 0.5*custom_win_fw.value()
-                                                  : 0.5*img_win_fw.value();
-                const auto win_c  = (UseCustomWL) ? custom_win_c.value()
-                                                  : img_win_c.value();
-                const auto win_fw = (UseCustomWL) ? custom_win_fw.value()
-                                                  : img_win_fw.value();
-
-                //The output range we are targeting. In this case, a commodity 8 bit (2^8 = 256 intensities) display.
-                const auto destmin = static_cast<double>( 0 );
-                const auto destmax = static_cast<double>( std::numeric_limits<uint8_t>::max() );
-
-                for(auto j = 0; j < img_rows; ++j){
-                    for(auto i = 0; i < img_cols; ++i){
-                        const auto val = static_cast<double>( img.value(j,i,img_channel) ); //The first (R or gray) channel.
-                        if(!std::isfinite(val)){
-                            animage.push_back( nan_colour[0] );
-                            animage.push_back( nan_colour[1] );
-                            animage.push_back( nan_colour[2] );
-                        }else{
-                            double x; // range = [0,1].
-                            if(val <= (win_c - win_r)){
-                                x = 0.0;
-                            }else if(val >= (win_c + win_r)){
-                                x = 1.0;
-                            }else{
-                                x = (val - (win_c - win_r)) / win_fw;
-                            }
-
-                            const auto res = colour_maps[colour_map].second(x);
-                            const double x_R = res.R;
-                            const double x_G = res.G;
-                            const double x_B = res.B;
-
-                            const double out_R = x_R * (destmax - destmin) + destmin;
-                            const double out_B = x_B * (destmax - destmin) + destmin;
-                            const double out_G = x_G * (destmax - destmin) + destmin;
-
-                            const auto scaled_R = static_cast<uint8_t>( std::floor(out_R) );
-                            const auto scaled_G = static_cast<uint8_t>( std::floor(out_G) );
-                            const auto scaled_B = static_cast<uint8_t>( std::floor(out_B) );
-
-                            animage.push_back( std::byte{scaled_R} );
-                            animage.push_back( std::byte{scaled_G} );
-                            animage.push_back( std::byte{scaled_B} );
-                        }
-                    }
-                }
-
-            //------------------------------------------------------------------------------------------------
-            //Scale pixels to fill the maximum range. None will be clipped or truncated.
-            }else{
-                //Due to a strange dependence on windowing, some manufacturers spit out massive pixel values.
-                // If you don't want to window you need to anticipate and ignore the gigantic numbers being 
-                // you might encounter. This is not the place to do this! If you need to do it here, write a
-                // filter routine and *call* it from here.
-                //
-                // NOTE: This routine could definitely use a re-working, especially to make it safe for all
-                //       arithmetical types (i.e., handling negatives, ensuring there is no overflow or wrap-
-                //       around, ensuring there is minimal precision loss).
-                using pixel_value_t = decltype(img.value(0, 0, 0));
-                Stats::Running_MinMax<pixel_value_t> rmm;
-                img.apply_to_pixels([&rmm,&img_channel](long int /*row*/,
-                                                        long int /*col*/,
-                                                        long int chnl,
-                                                        pixel_value_t val) -> void {
-                    if( (img_channel < 0)
-                    ||  (chnl == img_channel) ) rmm.Digest(val);
-                    return;
-                });
-                const auto lowest = rmm.Current_Min();
-                const auto highest = rmm.Current_Max();
-
-                //const auto lowest = Stats::Percentile(img.data, 0.01);
-                //const auto highest = Stats::Percentile(img.data, 0.99);
-
-                const auto pixel_type_max = static_cast<double>(std::numeric_limits<pixel_value_t>::max());
-                const auto pixel_type_min = static_cast<double>(std::numeric_limits<pixel_value_t>::min());
-                const auto dest_type_max = static_cast<double>(std::numeric_limits<uint8_t>::max()); //Min is implicitly 0.
-
-                const double clamped_low  = static_cast<double>(lowest )/pixel_type_max;
-                const double clamped_high = static_cast<double>(highest)/pixel_type_max;
-
-                for(auto j = 0; j < img_rows; ++j){ 
-                    for(auto i = 0; i < img_cols; ++i){ 
-                        const auto val = img.value(j,i,img_channel);
-                        if(!std::isfinite(val)){
-                            animage.push_back( nan_colour[0] );
-                            animage.push_back( nan_colour[1] );
-                            animage.push_back( nan_colour[2] );
-                        }else{
-                            const double clamped_value = (static_cast<double>(val) - pixel_type_min)/(pixel_type_max - pixel_type_min);
-                            auto rescaled_value = (clamped_value - clamped_low)/(clamped_high - clamped_low);
-                            if( rescaled_value < 0.0 ){
-                                rescaled_value = 0.0;
-                            }else if( rescaled_value > 1.0 ){
-                                rescaled_value = 1.0;
-                            }
-
-                            const auto res = colour_maps[colour_map].second(rescaled_value);
-                            const double x_R = res.R;
-                            const double x_G = res.G;
-                            const double x_B = res.B;
-                            
-                            const auto scaled_R = static_cast<uint8_t>(x_R * dest_type_max);
-                            const auto scaled_G = static_cast<uint8_t>(x_G * dest_type_max);
-                            const auto scaled_B = static_cast<uint8_t>(x_B * dest_type_max);
+    // Cached, renderer-independent per-slice state. Entries are keyed on a data epoch, which must be bumped (and the
+    // cache cleared) whenever the Drover image or contour data could have been altered.
+    slice_cache cached_slices;
+    std::atomic<long int> slice_cache_epoch = 0L;
+    const auto invalidate_slice_cache = [&cached_slices,
+                                         &slice_cache_epoch ]() -> void {
+        slice_cache_epoch.fetch_add(1);
+        cached_slices.clear();
+        return;
+    };
 
-                            animage.push_back( std::byte{scaled_R} );
-                            animage.push_back( std::byte{scaled_G} );
-                            animage.push_back( std::byte{scaled_B} );
-                        }
-                    }
-                }
-            }
-        
+    const auto Upload_OpenGL_Texture = []( const planar_image<float,double>& img,
+                                           const windowed_slice& pixels ) -> opengl_texture_handle_t {
+            const auto img_cols = pixels.columns;
+            const auto img_rows = pixels.rows;
 
             opengl_texture_handle_t out;
             out.col_count = img_cols;
             out.row_count = img_rows;
             out.aspect_ratio = (img.pxl_dx / img.pxl_dy) * (static_cast<float>(img_rows) / static_cast<float>(img_cols));
-            out.aspect_ratio = (img.pxl_dx / img.pxl_dy) * (static_cast<float>(img_rows) / static_cast<float>(img_cols));
             out.aspect_ratio = std::isfinite(out.aspect_ratio) ? out.aspect_ratio : (img.pxl_dx / img.pxl_dy);
 
             CHECK_FOR_GL_ERRORS();
@@ -1168,13 +1021,68 @@ bool SDL_Viewer(Drover &DICOM_data,
             glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
                          static_cast<int>(out.col_count), static_cast<int>(out.row_count),
-                         0, GL_RGB, GL_UNSIGNED_BYTE, static_cast<void*>(animage.data()));
+                         0, GL_RGB, GL_UNSIGNED_BYTE, static_cast<const void*>(pixels.rgb.data()));
             CHECK_FOR_GL_ERRORS();
 
             out.texture_exists = true;
             return out;
     };
 
+    // Window and upload an image that is not part of the Drover (e.g., scale bar, contouring images).
+    std::atomic<bool> need_to_reload_opengl_texture = true;
+    const auto Load_OpenGL_Texture = [&colour_maps,
+                                      &colour_map,
+                                      &nan_colour,
+                                      &img_channel,
+                                      &Upload_OpenGL_Texture ]( const planar_image<float,double>& img,
+                                                                const std::optional<double>& custom_centre,
+                                                                const std::optional<double>& custom_width ) -> opengl_texture_handle_t {
+            const auto pixels = Window_Slice(img, img_channel, custom_centre, custom_width,
+                                             colour_maps[colour_map].second, nan_colour);
+            return Upload_OpenGL_Texture(img, *pixels);
+    };
+
+    // Key for the windowed pixels of a Drover image using the current display settings.
+    const auto current_windowed_slice_key = [&img_channel,
+                                             &colour_map ]( long int l_epoch,
+                                                            long int l_img_array_num,
+                                                            long int l_img_num,
+                                                            const std::optional<double>& custom_centre,
+                                                            const std::optional<double>& custom_width ) -> windowed_slice_key {
+            windowed_slice_key key;
+            key.slice = slice_key{ l_epoch, l_img_array_num, l_img_num };
+            key.channel = img_channel;
+            key.colour_map = colour_map;
+            key.custom_window = (custom_centre && custom_width);
+            key.custom_centre = key.custom_window ? custom_centre.value() : 0.0;
+            key.custom_width  = key.custom_window ? custom_width.value() : 0.0;
+            return key;
+    };
+
+    // Window and upload a Drover image, reusing previously windowed pixels when possible.
+    const auto Load_Cached_OpenGL_Texture = [&colour_maps,
+                                             &colour_map,
+                                             &nan_colour,
+                                             &img_channel,
+                                             &cached_slices,
+                                             &slice_cache_epoch,
+                                             &current_windowed_slice_key,
+                                             &Upload_OpenGL_Texture ]( const planar_image<float,double>& img,
+                                                                       long int l_img_array_num,
+                                                                       long int l_img_num,
+                                                                       const std::optional<double>& custom_centre,
+                                                                       const std::optional<double>& custom_width ) -> opengl_texture_handle_t {
+            const auto key = current_windowed_slice_key(slice_cache_epoch.load(), l_img_array_num, l_img_num,
+                                                        custom_centre, custom_width);
+            auto pixels = cached_slices.pixels.get(key).value_or(nullptr);
+            if(!pixels){
+                pixels = Window_Slice(img, img_channel, custom_centre, custom_width,
+                                      colour_maps[colour_map].second, nan_colour);
+                cached_slices.pixels.put(key, pixels);
+            }
+            return Upload_OpenGL_Texture(img, *pixels);
+    };
+
 
     // Recompute image array and image iterators for the current image.
     const auto recompute_image_iters = [ &DICOM_data,
@@ -1359,6 +1267,10 @@ bool SDL_Viewer(Drover &DICOM_data,
     // Determine which contours should be displayed on the current image.
     const auto preprocess_contours = [ &DICOM_data,
                                        &drover_mutex,
+                                       &img_array_num,
+                                       &img_num,
+                                       &cached_slices,
+                                       &slice_cache_epoch,
                                        &recompute_image_iters,
                                        &preprocessed_contour_epoch,
                                        &preprocessed_contour_mutex,
@@ -1398,62 +1310,48 @@ bool SDL_Viewer(Drover &DICOM_data,
                     }
                 }
 
-                // Identify contours appropriate to the current image.
-                for(const auto & cc : DICOM_data.contour_data->ccs){
-                    for(const auto & c : cc.contours){
-                        if(!c.points.empty() 
-                        && ( 
-                              // Permit contours with any included vertices or at least the 'centre' within the image.
-                              //( disp_img_it->sandwiches_point_within_top_bottom_planes(c.Average_Point())
-                              disp_img_it->sandwiches_point_within_top_bottom_planes(c.points.front())
-                              || disp_img_it->encompasses_any_of_contour_of_points(c)
-                              || ( disp_img_it->pxl_dz <= std::numeric_limits<double>::min() ) // Permit contours on purely 2D images.
-                           ) ){
-
-                            // If the contour epoch has moved on, this thread is futile. Terminate ASAP.
-                            const auto current_epoch = preprocessed_contour_epoch.load();
-                            if( epoch != current_epoch ) return;
-
-                            // Access name.
-                            const auto ROIName = c.GetMetadataValueAs<std::string>("ROIName").value_or("unknown");
-                            const auto NormalizedROIName = c.GetMetadataValueAs<std::string>("NormalizedROIName").value_or("unknown");
-                            ImVec4 c_colour = pos_contour_colour;
-
-                            // Override the colour if metadata requests it and we know the colour.
-                            if(auto m_color = c.GetMetadataValueAs<std::string>("OutlineColour")){
-                                if(auto rgb_c = Colour_from_name(m_color.value())){
-                                    c_colour = ImVec4( static_cast<float>(rgb_c.value().R),
-                                                       static_cast<float>(rgb_c.value().G),
-                                                       static_cast<float>(rgb_c.value().B),
-                                                       1.0f );
-                                    // Note: what to do here if metadata is not present for all contours? TODO.
-                                    contour_colours_l[ROIName] = c_colour;
-                                }
+                // Identify contours appropriate to the current image. The (expensive) geometric selection is
+                // cached per slice, so only colours need to be assigned when revisiting a slice.
+                const slice_key key{ slice_cache_epoch.load(), img_array_num, img_num };
+                auto projected = cached_slices.contours.get(key).value_or(nullptr);
+                if(!projected){
+                    // If the contour epoch has moved on, this thread is futile. Terminate ASAP.
+                    projected = Project_Contours_Onto_Slice(*disp_img_it, *(DICOM_data.contour_data),
+                                                            [&]() -> bool {
+                                                                return (epoch == preprocessed_contour_epoch.load());
+                                                            });
+                    if(!projected) return;
+                    cached_slices.contours.put(key, projected);
+                }
 
-                            // Override the colour depending on the orientation.
-                            }else if(contour_colour_from_orientation_l){
-                                const auto arb_pos_unit = disp_img_it->row_unit.Cross(disp_img_it->col_unit).unit();
-                                vec3<double> c_orient;
-                                try{ // Protect against degenerate contours. (Should we instead ignore them altogether?)
-                                    c_orient = c.Estimate_Planar_Normal();
-                                }catch(const std::exception &){
-                                    c_orient = arb_pos_unit;
-                                }
-                                const auto c_orient_pos = (c_orient.Dot(arb_pos_unit) > 0);
-                                c_colour = ( c_orient_pos ? pos_contour_colour : neg_contour_colour );
+                for(const auto & pc : *projected){
+                    ImVec4 c_colour = pos_contour_colour;
+
+                    // Override the colour if metadata requests it and we know the colour.
+                    if(pc.OutlineColour){
+                        if(auto rgb_c = Colour_from_name(pc.OutlineColour.value())){
+                            c_colour = ImVec4( static_cast<float>(rgb_c.value().R),
+                                               static_cast<float>(rgb_c.value().G),
+                                               static_cast<float>(rgb_c.value().B),
+                                               1.0f );
+                            // Note: what to do here if metadata is not present for all contours? TODO.
+                            contour_colours_l[pc.ROIName] = c_colour;
+                        }
 
-                            // Otherwise use the uniquely-generated colour.
-                            }else{
-                                c_colour = contour_colours_l[ROIName];
-                            }
+                    // Override the colour depending on the orientation.
+                    }else if(contour_colour_from_orientation_l){
+                        c_colour = ( pc.positive_orientation ? pos_contour_colour : neg_contour_colour );
 
-                            out.push_back( preprocessed_contour{ epoch,
-                                                                 ImGui::GetColorU32(c_colour),
-                                                                 ROIName,
-                                                                 NormalizedROIName,
-                                                                 c } );
-                        }
+                    // Otherwise use the uniquely-generated colour.
+                    }else{
+                        c_colour = contour_colours_l[pc.ROIName];
                     }
+
+                    out.push_back( preprocessed_contour{ epoch,
+                                                         ImGui::GetColorU32(c_colour),
+                                                         pc.ROIName,
+                                                         pc.NormalizedROIName,
+                                                         pc.contour } );
                 }
             }
         }
@@ -1489,6 +1387,76 @@ bool SDL_Viewer(Drover &DICOM_data,
         //contour_colours.clear(); // Persist these unless user specifically specifies.
         return;
     };
+
+    // Speculatively preprocess the slices adjacent to the current image in a background thread so that scrolling
+    // through an image array mostly encounters cached contours and pixels.
+    work_queue<std::function<void(void)>> prefetch_wq;
+    const long int prefetch_radius = 2;
+    const auto prefetch_neighbouring_slices = [ &DICOM_data,
+                                                &drover_mutex,
+                                                &img_array_num,
+                                                &img_num,
+                                                &img_channel,
+                                                &colour_maps,
+                                                &colour_map,
+                                                &nan_colour,
+                                                &custom_centre,
+                                                &custom_width,
+                                                &cached_slices,
+                                                &slice_cache_epoch,
+                                                &current_windowed_slice_key,
+                                                &prefetch_wq,
+                                                &prefetch_radius ]() -> void {
+        prefetch_wq.clear_tasks(); // Requests for previously-displayed slices are no longer relevant.
+
+        const auto l_epoch = slice_cache_epoch.load();
+        const auto l_img_array_num = img_array_num;
+        const auto l_img_num = img_num;
+        const auto l_img_channel = img_channel;
+        const auto l_colour_map = colour_maps[colour_map].second;
+        const auto l_custom_centre = custom_centre;
+        const auto l_custom_width = custom_width;
+        if( (l_img_array_num < 0) || (l_img_num < 0) || (l_img_channel < 0) ) return;
+
+        // Note: keys are generated here, in the main thread, since they depend on the current display settings.
+        std::vector<std::pair<long int, windowed_slice_key>> targets;
+        for(long int n = l_img_num - prefetch_radius; n <= (l_img_num + prefetch_radius); ++n){
+            targets.emplace_back(n, current_windowed_slice_key(l_epoch, l_img_array_num, n,
+                                                               l_custom_centre, l_custom_width));
+        }
+
+        prefetch_wq.submit_task([=, &DICOM_data, &drover_mutex, &nan_colour, &cached_slices, &slice_cache_epoch]() -> void {
+            std::shared_lock<std::shared_timed_mutex> drover_lock(drover_mutex);
+            if( l_epoch != slice_cache_epoch.load() ) return;
+            if( !isininc(1, l_img_array_num+1, DICOM_data.image_data.size()) ) return;
+            const auto &imgs = (*std::next(DICOM_data.image_data.begin(), l_img_array_num))->imagecoll.images;
+            const long int N_images = imgs.size();
+
+            for(const auto &n : Neighbouring_Slices(l_img_num, N_images, prefetch_radius)){
+                if( l_epoch != slice_cache_epoch.load() ) return;
+                const auto &wkey = std::find_if(std::begin(targets), std::end(targets),
+                                                [n](const auto &p){ return (p.first == n); })->second;
+                const auto &img = *std::next(std::begin(imgs), n);
+
+                if( (DICOM_data.contour_data != nullptr)
+                &&  !cached_slices.contours.contains(wkey.slice) ){
+                    auto projected = Project_Contours_Onto_Slice(img, *(DICOM_data.contour_data),
+                                                                 [&]() -> bool {
+                                                                     return (l_epoch == slice_cache_epoch.load());
+                                                                 });
+                    if(projected) cached_slices.contours.put(wkey.slice, projected);
+                }
+
+                if( isininc(1, l_img_channel+1, img.channels)
+                &&  !cached_slices.pixels.contains(wkey) ){
+                    cached_slices.pixels.put(wkey, Window_Slice(img, l_img_channel, l_custom_centre, l_custom_width,
+                                                                l_colour_map, nan_colour));
+                }
+            }
+            return;
+        });
+        return;
+    };
     
     //Save the current contour collection.
     const auto save_contour_buffer = [ &DICOM_data,
@@ -1498,6 +1466,7 @@ bool SDL_Viewer(Drover &DICOM_data,
                                        &recompute_image_iters,
                                        &X,
                                        &reset_contouring_state,
+                                       &invalidate_slice_cache,
                                        &launch_contour_preprocessor ](const std::string &roi_name) -> bool {
             //std::shared_lock<std::shared_timed_mutex> drover_lock(drover_mutex);
             //auto [img_valid, img_array_ptr_it, disp_img_it] = recompute_cimage_iters();
@@ -1541,6 +1510,7 @@ bool SDL_Viewer(Drover &DICOM_data,
                 contouring_imgs.contour_data->ccs.clear();
                 FUNCINFO("Drover class imbued with new contour collection");
 
+                invalidate_slice_cache();
                 reset_contouring_state(img_array_ptr_it);
                 launch_contour_preprocessor();
 
@@ -1749,6 +1719,7 @@ bool SDL_Viewer(Drover &DICOM_data,
 
                 // Regenerate all Drover state that may have changed.
                 {
+                    invalidate_slice_cache();
                     recompute_image_state();
                     auto [img_valid, img_array_ptr_it, disp_img_it] = recompute_image_iters();
                     if( img_valid ){
@@ -1829,13 +1800,15 @@ bool SDL_Viewer(Drover &DICOM_data,
                                            &img_num,
                                            &img_array_num,
                                            &img_channel,
-                                           &Load_OpenGL_Texture ]() -> void {
+                                           &Load_Cached_OpenGL_Texture,
+                                           &prefetch_neighbouring_slices ]() -> void {
             std::unique_lock<std::shared_timed_mutex> drover_lock(drover_mutex);
             auto [img_valid, img_array_ptr_it, disp_img_it] = recompute_image_iters();
             if( view_toggles.view_images_enabled
             &&  img_valid ){
                 img_channel = std::clamp<long int>(img_channel, 0, disp_img_it->channels-1);
-                current_texture = Load_OpenGL_Texture(*disp_img_it, custom_centre, custom_width);
+                current_texture = Load_Cached_OpenGL_Texture(*disp_img_it, img_array_num, img_num, custom_centre, custom_width);
+                prefetch_neighbouring_slices();
             }else{
                 img_channel = -1;
                 img_array_num = -1;
@@ -2567,6 +2540,7 @@ script_files.back().content.emplace_back('\0');
                                            &last_mouse_button_pos,
                                            &reset_contouring_state,
                                            &need_to_reload_opengl_texture,
+                                           &invalidate_slice_cache,
                                            &editing_contour_colour,
                                            &pos_contour_colour,
                                            &neg_contour_colour,
@@ -3083,6 +3057,7 @@ script_files.back().content.emplace_back('\0');
                     if(view_toggles.view_contouring_enabled){
                         contouring_img_altered = true;
                     }else if(view_toggles.view_drawing_enabled){
+                        invalidate_slice_cache();
                         need_to_reload_opengl_texture.store(true);
                     }
                 }
@@ -3556,6 +3531,7 @@ script_files.back().content.emplace_back('\0');
                                           &drover_mutex,
                                           &DICOM_data,
                                           &recompute_image_state,
+                                          &invalidate_slice_cache,
 
                                           &loaded_files,
                                           &open_files_selection,
@@ -3581,6 +3557,7 @@ script_files.back().content.emplace_back('\0');
                         view_toggles.open_files_enabled = false;
                         open_files_selection.clear();
                         DICOM_data.Consume(f.DICOM_data);
+                        invalidate_slice_cache();
                     }else{
                         FUNCWARN("Unable to load files");
                         // TODO ... warn about the issue.
@@ -4130,6 +4107,7 @@ script_files.back().content.emplace_back('\0');
                                                &advance_to_image_array,
                                                &recompute_image_state,
                                                &need_to_reload_opengl_texture,
+                                               &invalidate_slice_cache,
                                                &launch_contour_preprocessor,
                                                &reset_contouring_state,
                                                &advance_to_image,
@@ -4226,6 +4204,7 @@ script_files.back().content.emplace_back('\0');
                           &&  image_mouse_pos.mouse_hovering_image ){
                         contouring_img_altered = true;
                         need_to_reload_opengl_texture.store(true);
+                        if(view_toggles.view_drawing_enabled) invalidate_slice_cache();
 
                         decltype(disp_img_it) l_img_it = (view_toggles.view_contouring_enabled) ? cimg_it : disp_img_it;
                         decltype(img_array_ptr_it) l_img_array_ptr_it = (view_toggles.view_contouring_enabled) ? cimg_array_ptr_it : img_array_ptr_it;
@@ -4610,6 +4589,8 @@ script_files.back().content.emplace_back('\0');
         SDL_GL_SwapWindow(window);
     }
     terminate_contour_preprocessors();
+    prefetch_wq.clear_tasks();
+    invalidate_slice_cache();
     std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Hope that this is enough time for preprocessing threads to terminate.
                                                                  // TODO: use a work queue with condition variable to
                                                                  // signal termination!
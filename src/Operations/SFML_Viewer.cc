@@ -40,7 +40,7 @@
 #include "YgorStats.h"        //Needed for Stats:: namespace.
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "../Colour_Maps.h"
 #include "../Common_Boost_Serialization.h"
@@ -89,6 +89,7 @@ OperationDoc OpArgDocSFML_Viewer(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/a_screenshot.png", "afile.png" };
     out.args.back().mimetype = "image/png";
+    out.args.back().flow = OpArgFlow::Egress;
 
     out.args.emplace_back();
     out.args.back().name = "FPSLimit";
@@ -117,7 +118,7 @@ bool SFML_Viewer(Drover &DICOM_data,
     const auto SingleScreenshot = std::regex_match(SingleScreenshotStr, TrueRegex);
     long int SingleScreenshotCounter = 3; // Used to count down frames before taking the snapshot.
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Trim any empty image sets.
     for(auto it = DICOM_data.image_data.begin(); it != DICOM_data.image_data.end();  ){
@@ -310,6 +311,9 @@ bool SFML_Viewer(Drover &DICOM_data,
         sf::Image animage;
         animage.create(img_cols, img_rows);
 
+        //Use a precomputed lookup table rather than evaluating the colour map for every pixel, if possible.
+        const auto lut = Get_Colour_Map_LUT(colour_maps[colour_map].second);
+
         //------------------------------------------------------------------------------------------------
         //Apply a window to the data if it seems like the WindowCenter or WindowWidth specified in the image metadata
         // are applicable. Note that it is likely that pixels will be clipped or truncated. This is intentional.
@@ -358,7 +362,8 @@ bool SFML_Viewer(Drover &DICOM_data,
                             x = (val - (win_c - win_r)) / win_fw;
                         }
 
-                        const auto res = colour_maps[colour_map].second(x);
+                        const auto res = (lut != nullptr) ? lut->clamped(x)
+                                                            : colour_maps[colour_map].second(x);
                         const double x_R = res.R;
                         const double x_G = res.G;
                         const double x_B = res.B;
@@ -415,7 +420,8 @@ bool SFML_Viewer(Drover &DICOM_data,
                             rescaled_value = 1.0;
                         }
 
-                        const auto res = colour_maps[colour_map].second(rescaled_value);
+                        const auto res = (lut != nullptr) ? lut->clamped(rescaled_value)
+                                                            : colour_maps[colour_map].second(rescaled_value);
                         const double x_R = res.R;
                         const double x_G = res.G;
                         const double x_B = res.B;
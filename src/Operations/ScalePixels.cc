@@ -147,6 +147,8 @@ bool ScalePixels(Drover &DICOM_data,
         ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
         ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
         ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+        DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+        ud.mask_cache = DICOM_data.voxel_mask_cache;
         //ud.description = "";
 
         if( std::regex_match(ContourOverlapStr, regex_ignore) ){
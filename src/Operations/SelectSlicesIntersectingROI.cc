@@ -5,10 +5,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>    
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Slice_Index.h"
 #include "SelectSlicesIntersectingROI.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
@@ -58,20 +60,25 @@ bool SelectSlicesIntersectingROI(Drover &DICOM_data,
                                         { "NormalizedROIName", NormalizedROILabelRegex } } );
 
 
-    //Generate a closure that discards images not encompassing any ROI contours.
-    const auto retain_encompassing_imgs = [&cc_ROIs](const planar_image<float, double> &animg) -> bool {
-                //Retain the image IFF it intersects one of the contours.
-                for(const auto &cc_ref : cc_ROIs){
-                    for(const auto &acontour : cc_ref.get().contours){
-                        if(animg.encompasses_contour_of_points(acontour)) return true;
-                    }
-                }
-                return false;
-    };
-
     //Cycle over all images and dose arrays, trimming spurious images.
     for(auto &img_arr : DICOM_data.image_data){
-        img_arr->imagecoll.Retain_Images_Satisfying( retain_encompassing_imgs );
+        //Identify the images which intersect one of the contours. Only images that sandwich a contour's first vertex
+        // can encompass the contour, so the slice index is used to avoid testing every image against every contour.
+        std::set<const planar_image<float, double> *> encompassing_imgs;
+        for(const auto &cc_ref : cc_ROIs){
+            for(const auto &acontour : cc_ref.get().contours){
+                auto candidates = acontour.points.empty() ? img_arr->imagecoll.get_all_images()
+                                                          : img_arr->slice_lookup->get_images_which_sandwich_point(acontour.points.front());
+                for(const auto &img_it : candidates){
+                    if(img_it->encompasses_contour_of_points(acontour)) encompassing_imgs.insert( &(*img_it) );
+                }
+            }
+        }
+
+        //Retain the image IFF it intersects one of the contours.
+        img_arr->imagecoll.Retain_Images_Satisfying( [&encompassing_imgs](const planar_image<float, double> &animg) -> bool {
+            return (encompassing_imgs.count( &animg ) != 0);
+        });
     }
 
     return true;
@@ -18,7 +18,7 @@
 
 #include "YgorMath.h"         //Needed for vec3 class.
 
-#include "Explicator.h"
+#include "../Explicator_Cache.h"
 
 #include "SimplifyContours.h"
 
@@ -96,7 +96,7 @@ bool SimplifyContours(Drover &DICOM_data,
                         const std::map<std::string, std::string>& /*InvocationMetadata*/,
                         const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto NormalizedROILabelRegex = OptArgs.getValueStr("NormalizedROILabelRegex").value();
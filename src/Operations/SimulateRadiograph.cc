@@ -92,6 +92,7 @@ OperationDoc OpArgDocSimulateRadiograph(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "./img.fits", "sim_radiograph.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -0,0 +1,105 @@
+//SpillImagesToDisk.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "../Structs.h"
+#include "../Regex_Selectors.h"
+#include "../Image_Spill_Store.h"
+#include "SpillImagesToDisk.h"
+#include "YgorImages.h"
+#include "YgorMisc.h"         //Needed for FUNCINFO macros.
+#include "YgorString.h"       //Needed for GetFirstRegex(...)
+
+
+OperationDoc OpArgDocSpillImagesToDisk(){
+    OperationDoc out;
+    out.name = "SpillImagesToDisk";
+    out.supports_spilled_images = true;
+
+    out.desc = 
+        "This operation enables out-of-core processing of the selected image arrays. Voxel data is written to disk"
+        " and released from memory whenever the voxel data held in memory exceeds the specified budget. Image metadata"
+        " and geometry always remain in memory.";
+
+    out.notes.emplace_back(
+        "Only operations that explicitly support spilled images benefit. Before any other operation is performed,"
+        " all spilled images are restored to memory and out-of-core processing is disabled for the affected"
+        " image arrays, so this operation should immediately precede the operation(s) that support it."
+    );
+    out.notes.emplace_back(
+        "Currently the following operations support spilled images: ModelPerfusionClosedForm, ConvertNaNsToAir,"
+        " ConvertNaNsToZeros, LogScale, NegatePixels, PreFilterEnormousCTValues, and ThresholdImages (with"
+        " non-percentile bounds)."
+    );
+    out.notes.emplace_back(
+        "Images can also be spilled while DICOM files are loaded, which avoids ever holding the whole series in"
+        " memory. See the '--spill-budget' option."
+    );
+    out.notes.emplace_back(
+        "Each image array is given its own budget. Spill files are removed when the images are restored."
+    );
+
+    out.args.emplace_back();
+    out.args.back() = IAWhitelistOpArgDoc();
+    out.args.back().name = "ImageSelection";
+    out.args.back().default_val = "all";
+
+    out.args.emplace_back();
+    out.args.back().name = "MemoryBudget";
+    out.args.back().desc = "The maximum amount of voxel data, in MiB, that should be held in memory for each"
+                           " image array. Images in active use are never evicted, so the budget may be temporarily"
+                           " exceeded if an operation requires more images simultaneously than fit in the budget.";
+    out.args.back().default_val = "4096";
+    out.args.back().expected = true;
+    out.args.back().examples = { "0", "512", "4096", "16384" };
+
+    out.args.emplace_back();
+    out.args.back().name = "SpillDirectory";
+    out.args.back().desc = "The directory in which spill files will be written. A unique subdirectory will be"
+                           " created and removed when no longer needed. If empty, the system temporary directory"
+                           " is used. A location on fast local storage is recommended.";
+    out.args.back().default_val = "";
+    out.args.back().expected = true;
+    out.args.back().examples = { "", "/tmp/", "/scratch/" };
+    out.args.back().flow = OpArgFlow::Egress;
+
+    return out;
+}
+
+bool SpillImagesToDisk(Drover &DICOM_data,
+                       const OperationArgPkg& OptArgs,
+                       const std::map<std::string, std::string>&,
+                       const std::string&){
+
+    //---------------------------------------------- User Parameters --------------------------------------------------
+    const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
+    const auto MemoryBudget = std::stod( OptArgs.getValueStr("MemoryBudget").value() );
+    const auto SpillDirectory = OptArgs.getValueStr("SpillDirectory").value();
+
+    //-----------------------------------------------------------------------------------------------------------------
+    if(MemoryBudget < 0.0){
+        throw std::invalid_argument("Memory budget must be non-negative");
+    }
+    const auto budget_bytes = static_cast<size_t>(MemoryBudget * 1024.0 * 1024.0);
+
+    auto IAs_all = All_IAs( DICOM_data );
+    auto IAs = Whitelist( IAs_all, ImageSelectionStr );
+    for(auto & iap_it : IAs){
+        auto &ia = *(*iap_it);
+        if(ia.spill_store == nullptr){
+            ia.spill_store = std::make_shared<Image_Spill_Store>( std::filesystem::path(SpillDirectory), budget_bytes );
+        }
+        for(auto &img : ia.imagecoll.images){
+            ia.spill_store->manage(img);
+        }
+        FUNCINFO("Spilled image array: " << ia.spill_store->get_page_out_count() << " images written to disk, "
+                 << ia.spill_store->get_resident_bytes() << " bytes remain resident");
+    }
+
+    return true;
+}
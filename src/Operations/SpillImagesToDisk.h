@@ -0,0 +1,16 @@
+// SpillImagesToDisk.h.
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "../Structs.h"
+
+
+OperationDoc OpArgDocSpillImagesToDisk();
+
+bool SpillImagesToDisk(Drover &DICOM_data,
+                       const OperationArgPkg& /*OptArgs*/,
+                       const std::map<std::string, std::string>& /*InvocationMetadata*/,
+                       const std::string& /*FilenameLex*/);
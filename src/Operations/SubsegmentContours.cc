@@ -16,7 +16,7 @@
 #include "../Dose_Meld.h"
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "SubsegmentContours.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -256,7 +256,7 @@ bool SubsegmentContours(Drover &DICOM_data,
                  << ZSelectionLower << " and " << ZSelectionUpper << " respectively");
     }
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
 
     // Stuff references to all contours into a list. Remember that you can still address specific contours through
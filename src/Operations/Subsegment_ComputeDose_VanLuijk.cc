@@ -24,7 +24,7 @@
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
 #include "../YgorImages_Functors/Compute/AccumulatePixelDistributions.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "Subsegment_ComputeDose_VanLuijk.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
 #include "YgorImages.h"
@@ -52,6 +52,7 @@ OperationDoc OpArgDocSubsegment_ComputeDose_VanLuijk(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "area_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -62,6 +63,7 @@ OperationDoc OpArgDocSubsegment_ComputeDose_VanLuijk(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "derivative_data.csv" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -75,6 +77,7 @@ OperationDoc OpArgDocSubsegment_ComputeDose_VanLuijk(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/somefile", "localfile.csv", "distributions.data" };
     out.args.back().mimetype = "text/csv";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -283,7 +286,7 @@ bool Subsegment_ComputeDose_VanLuijk(Drover &DICOM_data,
                  << ZSelectionLower << " and " << ZSelectionUpper << " respectively");
     }
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //Merge the dose arrays if multiple are available.
     DICOM_data = Meld_Only_Dose_Data(DICOM_data);
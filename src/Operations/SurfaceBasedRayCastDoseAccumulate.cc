@@ -72,7 +72,7 @@
 #include "YgorImagesIO.h"
 #include "YgorImagesPlotting.h"
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
@@ -148,6 +148,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "total_dose_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -161,6 +162,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "total_dose_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -176,6 +178,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "intersection_count_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -188,6 +191,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "depth_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -201,6 +205,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "radial_dist_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -216,6 +221,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "ref_roi_intersection_count_map.fits", "/tmp/out.fits" };
     out.args.back().mimetype = "image/fits";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -227,6 +233,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/roi_surface_mesh.off", "roi_surface_mesh.off" };
     out.args.back().mimetype = "application/off";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -238,6 +245,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/subdivided_roi_surface_mesh.off", "subdivided_roi_surface_mesh.off" };
     out.args.back().mimetype = "application/off";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -250,6 +258,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/roi_surface_mesh.off", "roi_surface_mesh.off" };
     out.args.back().mimetype = "application/off";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -262,6 +271,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/subdivided_roi_surface_mesh.off", "subdivided_roi_surface_mesh.off" };
     out.args.back().mimetype = "application/off";
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -273,6 +283,7 @@ OperationDoc OpArgDocSurfaceBasedRayCastDoseAccumulate(){
     out.args.back().default_val = "";
     out.args.back().expected = true;
     out.args.back().examples = { "", "/tmp/roi_com_com_line.off", "roi_com_com_line.off" };
+    out.args.back().flow = OpArgFlow::Egress;
 
 
     out.args.emplace_back();
@@ -453,7 +464,7 @@ bool SurfaceBasedRayCastDoseAccumulate(Drover &DICOM_data,
     const auto refnormalizedregex = Compile_Regex(NormalizedReferenceROILabelRegex);
     const auto TrueRegex = Compile_Regex("^tr?u?e?$");
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
 
     //Boolean options.
@@ -448,14 +448,15 @@ void draw_image( std::ostream &os,
                 { " ",".","-","~","+","c","o","x","=","/","?","$","%","&","#","@","A","X","M"});
     };
 
+    // Colour map lookups are performed for every glyph, so use a precomputed table if possible.
+    const auto lut = Get_Colour_Map_LUT(colour_map);
+
     // Note: we split a terminal character into an upper and lower rectangular block. This is done because common
     // terminal fonts proportions are (roughly) twice as tall as they are wide. Splitting this way helps normalize the
     // aspect ratio presented to the user.
     const auto emit_vert_split_colours = [&](std::ostream &os, double upper_intensity, double lower_intensity){
-        //const auto cm = ColourMap_Linear(intensity);
-        //const auto cm = ColourMap_Magma(intensity);
-        const auto upper_cm = ColourMap_Viridis(upper_intensity);
-        const auto lower_cm = ColourMap_Viridis(lower_intensity);
+        const auto upper_cm = (lut != nullptr) ? lut->clamped(upper_intensity) : colour_map(upper_intensity);
+        const auto lower_cm = (lut != nullptr) ? lut->clamped(lower_intensity) : colour_map(lower_intensity);
 
         // 24-bit colour.
         if(colour_mode == terminal_colour_mode_t::bit24){
@@ -559,6 +560,7 @@ void draw_image( std::ostream &os,
 OperationDoc OpArgDocTerminal_Viewer(){
     OperationDoc out;
     out.name = "Terminal_Viewer";
+    out.has_side_effects = true;
     out.desc = 
         "Launch an interactive viewer inside a terminal/console.";
 
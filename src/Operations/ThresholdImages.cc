@@ -22,7 +22,7 @@
 #include "../YgorImages_Functors/ConvenienceRoutines.h"
 
 #include "ThresholdImages.h"
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -118,7 +118,7 @@ bool ThresholdImages(Drover &DICOM_data,
                        /*InvocationMetadata*/,
                        const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto LowerStr = OptArgs.getValueStr("Lower").value();
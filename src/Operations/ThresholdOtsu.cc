@@ -16,7 +16,7 @@
 #include <utility>            //Needed for std::pair.
 #include <vector>
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "../Explicator_Cache.h"
 #include "YgorImages.h"
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
@@ -37,6 +37,7 @@
 OperationDoc OpArgDocThresholdOtsu(){
     OperationDoc out;
     out.name = "ThresholdOtsu";
+    out.has_side_effects = true;
 
     out.desc = 
         "This routine performs Otsu thresholding (i.e., 'binarization') on an image volume."
@@ -154,7 +155,7 @@ bool ThresholdOtsu(Drover &DICOM_data,
                      /*InvocationMetadata*/,
                      const std::string& FilenameLex){
 
-    Explicator X(FilenameLex);
+    cached_explicator X(FilenameLex);
 
     //---------------------------------------------- User Parameters --------------------------------------------------
     const auto ImageSelectionStr = OptArgs.getValueStr("ImageSelection").value();
@@ -223,6 +224,8 @@ bool ThresholdOtsu(Drover &DICOM_data,
             ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
             ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
             ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+            DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+            ud.mask_cache = DICOM_data.voxel_mask_cache;
             //ud.description = "";
 
             if( std::regex_match(ContourOverlapStr, regex_ignore) ){
@@ -301,6 +304,8 @@ bool ThresholdOtsu(Drover &DICOM_data,
             ud.mutation_opts.aggregate = Mutate_Voxels_Opts::Aggregate::First;
             ud.mutation_opts.adjacency = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
             ud.mutation_opts.maskmod   = Mutate_Voxels_Opts::MaskMod::Noop;
+            DICOM_data.Ensure_Voxel_Mask_Cache_Allocated();
+            ud.mask_cache = DICOM_data.voxel_mask_cache;
             ud.description = "Otsu thresholded (binarized)";
 
             if( std::regex_match(ContourOverlapStr, regex_ignore) ){
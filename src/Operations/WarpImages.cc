@@ -27,6 +27,7 @@
 
 #include "../Structs.h"
 #include "../Regex_Selectors.h"
+#include "../Slice_Index.h"
 #include "../Thread_Pool.h"
 #include "WarpImages.h"
 
@@ -174,6 +175,8 @@ bool WarpImages(Drover &DICOM_data,
         //
         // Note: This should be a standalone function that operates on an Image_Array or equivalent.
         //       It should re-compute afresh all metadata using the current planar_image data members.
+
+        (*iap_it)->slice_lookup->invalidate();
     }
 
     return true;
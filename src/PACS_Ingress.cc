@@ -4,6 +4,11 @@
 // The modality and linkage is ignored for the purposes of ingress. Files can be properly
 // linked, queried, and further examined after they have been imported.
 //
+// A batch mode is also provided for importing entire directory trees. Headers are parsed and
+// files are copied (or hard-linked) into the store concurrently, and metadata rows are
+// streamed to the database using COPY in large transactions. A checkpoint file can be used
+// to resume an interrupted batch import.
+//
 // Note that, because this program essentially just distills files down to a collection of
 // DICOM key-values, routines are tightly coupled with the DICOM parser. 
 //
@@ -13,14 +18,23 @@
     #error "Attempted to compile without PostgreSQL support, which is required."
 #endif
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <list>
 #include <map>
+#include <optional>
 #include <pqxx/pqxx> //PostgreSQL C++ interface.
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 #include "Imebra_Shim.h"     //Wrapper for Imebra library. Black-boxed to speed up compilation.
 #include "YgorArguments.h"
@@ -28,6 +42,330 @@
 #include "YgorMisc.h"           //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 #include "YgorString.h"         //Needed for stringtoX(), X_to_string().
 
+#include "Thread_Pool.h"
+
+
+//Figure out a reasonable place to keep a file in the filesystem store. It isn't so important except to be reasonably
+// human-readable, fairly balanced in the filesystem, and not already present.
+//
+// Returns false if the metadata needed to place the file are missing.
+static bool
+Determine_Store_Location(std::map<std::string,std::string> &mmap,
+                         const std::string &DICOMFileSystemStoreBase,
+                         std::string &NewFullDir,
+                         std::string &StoreFullPathName){
+    const auto StudyInstanceUID  = mmap["StudyInstanceUID"];
+    const auto StudyDate         = mmap["StudyDate"];
+    const auto StudyTime         = mmap["StudyTime"];
+    const auto SeriesInstanceUID = mmap["SeriesInstanceUID"];
+    const auto SeriesNumber      = mmap["SeriesNumber"];
+    const auto SOPInstanceUID    = mmap["SOPInstanceUID"];
+
+    if(StudyInstanceUID.empty()  || StudyDate.empty()    || StudyTime.empty() 
+    || SeriesInstanceUID.empty() || SeriesNumber.empty() || SOPInstanceUID.empty() ){
+        return false;
+    }
+
+    const auto TopDirName = Detox_String(StudyDate) + "-"_s
+                          + Detox_String(StudyTime) + "_"_s
+                          + Detox_String(StudyInstanceUID);
+
+    const auto MidDirName = Detox_String(SeriesNumber) + "-"_s
+                          + Detox_String(SeriesInstanceUID);
+
+    NewFullDir = DICOMFileSystemStoreBase + "/"_s
+               + TopDirName + "/"_s
+               + MidDirName + "/";    //Not the full path, just the complete directory.
+
+    const auto NewFileName = Detox_String(SOPInstanceUID) + ".dcm";
+    StoreFullPathName = NewFullDir + NewFileName;
+    return true;
+}
+
+
+//The state of a single file during batch ingress.
+struct batch_record {
+    std::filesystem::path source;
+    std::map<std::string,std::string> mmap;
+    std::string NewFullDir;
+    std::string StoreFullPathName;
+    uintmax_t bytes = 0;
+
+    enum class status { pending, failed, duplicate, stored } state = status::pending;
+};
+
+static std::optional<std::string>
+null_if_empty(const std::string &s){
+    if(s.empty()) return {};
+    return s;
+}
+
+//Import all files within the given directories (recursively).
+//
+//Files are processed in batches. For each batch, headers are parsed concurrently, duplicates are identified with a
+// single query, files are copied into the store concurrently, and all metadata rows are streamed to the database using
+// COPY within a single transaction. The source path of every file that was imported (or identified as a duplicate) is
+// appended to the checkpoint file after the transaction is committed so that an interrupted run can be resumed.
+static void
+Batch_Ingress(const std::string &db_params,
+              const std::string &DICOMFileSystemStoreBase,
+              const std::list<std::string> &Directories,
+              const std::string &Project,
+              const std::string &Comments,
+              const std::string &CheckpointFile,
+              long int BatchSize,
+              long int Jobs,
+              bool HardLink,
+              bool dryrun,
+              bool verbose){
+
+    //Load the checkpoint, if any.
+    std::set<std::string> completed;
+    if(!CheckpointFile.empty()){
+        std::ifstream fi(CheckpointFile);
+        for(std::string l; std::getline(fi, l); ){
+            if(!l.empty()) completed.insert(l);
+        }
+        if(!completed.empty()) FUNCINFO("Resuming: " << completed.size() << " files were previously imported");
+    }
+
+    //Enumerate the files.
+    std::vector<std::filesystem::path> files;
+    for(const auto &d : Directories){
+        const auto opts = std::filesystem::directory_options::skip_permission_denied;
+        for(const auto &e : std::filesystem::recursive_directory_iterator(d, opts)){
+            if(!e.is_regular_file()) continue;
+            const auto p = std::filesystem::absolute(e.path()).lexically_normal();
+            if(completed.count(p.string()) != 0) continue;
+            files.push_back(p);
+        }
+    }
+    std::sort(std::begin(files), std::end(files));
+    FUNCINFO("Located " << files.size() << " files to import");
+
+    std::ofstream checkpoint;
+    if(!CheckpointFile.empty() && !dryrun){
+        checkpoint.open(CheckpointFile, std::ios::out | std::ios::app);
+        if(!checkpoint) FUNCERR("Unable to open checkpoint file '" << CheckpointFile << "'. Cannot continue");
+    }
+
+    //Identifies a single DICOM instance.
+    const auto instance_key = [](const std::string &PatientID,
+                                 const std::string &StudyInstanceUID,
+                                 const std::string &SeriesInstanceUID,
+                                 const std::string &SOPInstanceUID) -> std::string {
+        return PatientID + '\x1f' + StudyInstanceUID + '\x1f' + SeriesInstanceUID + '\x1f' + SOPInstanceUID;
+    };
+    std::set<std::string> seen; // Instances imported during this run.
+
+    long int N_stored = 0;
+    long int N_duplicate = 0;
+    long int N_failed = 0;
+    uintmax_t bytes_stored = 0;
+    const auto t_start = std::chrono::steady_clock::now();
+
+    try{
+        pqxx::connection c(db_params);
+
+        for(size_t batch_begin = 0; batch_begin < files.size(); batch_begin += BatchSize){
+            const auto batch_end = std::min(files.size(), batch_begin + static_cast<size_t>(BatchSize));
+            std::vector<batch_record> recs(batch_end - batch_begin);
+            for(size_t i = 0; i < recs.size(); ++i) recs[i].source = files[batch_begin + i];
+
+            //----------------------------------- Parse the headers concurrently --------------------------------------
+            {
+                asio_thread_pool tp(Jobs);
+                for(auto &rec : recs){
+                    tp.submit_task([&]() -> void {
+                        try{
+                            rec.mmap = get_metadata_top_level_tags(rec.source.string());
+                            rec.bytes = std::filesystem::file_size(rec.source);
+                            if(!Determine_Store_Location(rec.mmap, DICOMFileSystemStoreBase, rec.NewFullDir, rec.StoreFullPathName)){
+                                FUNCWARN("File '" << rec.source << "' is missing information and cannot be imported into the database");
+                                rec.state = batch_record::status::failed;
+                            }
+                        }catch(const std::exception &e){
+                            FUNCWARN("Unable to parse file '" << rec.source << "': " << e.what());
+                            rec.state = batch_record::status::failed;
+                        }
+                    });
+                }
+            } // Wait until all threads are done.
+
+            pqxx::work txn(c);
+            std::stringstream tb1;
+            pqxx::result r;
+
+            //--------------------------------- Determine if records already exist ------------------------------------
+            //As in single-file mode, this is not a conclusive test, but will stop many unneccesary file insertions.
+            {
+                std::set<std::string> existing;
+                tb1.str("");
+                tb1 << "SELECT PatientID, StudyInstanceUID, SeriesInstanceUID, SOPInstanceUID FROM metadata WHERE ";
+                tb1 << "SOPInstanceUID IN ( ";
+                bool first = true;
+                for(auto &rec : recs){
+                    if(rec.state != batch_record::status::pending) continue;
+                    tb1 << (first ? "" : ", ") << txn.quote(rec.mmap["SOPInstanceUID"]);
+                    first = false;
+                }
+                tb1 << " );";
+                if(!first){
+                    r = txn.exec(tb1.str());
+                    for(const auto &row : r){
+                        existing.insert( instance_key( row[0].as<std::string>(std::string()),
+                                                       row[1].as<std::string>(std::string()),
+                                                       row[2].as<std::string>(std::string()),
+                                                       row[3].as<std::string>(std::string()) ) );
+                    }
+                }
+
+                for(auto &rec : recs){
+                    if(rec.state != batch_record::status::pending) continue;
+                    const auto key = instance_key( rec.mmap["PatientID"],
+                                                   rec.mmap["StudyInstanceUID"],
+                                                   rec.mmap["SeriesInstanceUID"],
+                                                   rec.mmap["SOPInstanceUID"] );
+                    if( (existing.count(key) != 0)
+                    ||  !seen.insert(key).second ){
+                        if(verbose) FUNCINFO("File '" << rec.source << "' is a duplicate. Not ingressing");
+                        rec.state = batch_record::status::duplicate;
+                    }
+                }
+            }
+
+            //--------------------------------- Import the files concurrently -----------------------------------------
+            if(!dryrun){
+                std::set<std::string> dirs;
+                for(const auto &rec : recs){
+                    if(rec.state == batch_record::status::pending) dirs.insert(rec.NewFullDir);
+                }
+                for(const auto &d : dirs){
+                    if(!Does_Dir_Exist_And_Can_Be_Read(d) && !Create_Dir_and_Necessary_Parents(d)){
+                        FUNCERR("Unable to create directory '" << d << "'. Cannot continue");
+                    }
+                }
+
+                asio_thread_pool tp(Jobs);
+                for(auto &rec : recs){
+                    if(rec.state != batch_record::status::pending) continue;
+                    tp.submit_task([&]() -> void {
+                        const std::filesystem::path dest(rec.StoreFullPathName);
+                        std::error_code ec;
+                        bool linked = false;
+                        if(HardLink){
+                            //Remnants of an interrupted run are replaced.
+                            std::filesystem::remove(dest, ec);
+                            ec.clear();
+                            std::filesystem::create_hard_link(rec.source, dest, ec);
+                            linked = !ec;
+                            ec.clear();
+                        }
+                        if(!linked){
+                            std::filesystem::copy_file(rec.source, dest, std::filesystem::copy_options::overwrite_existing, ec);
+                        }
+                        if(ec){
+                            FUNCWARN("Unable to copy file '" << rec.source << "' to filesystem store destination '"
+                                     << rec.StoreFullPathName << "': " << ec.message());
+                            rec.state = batch_record::status::failed;
+                        }
+                    });
+                }
+            } // Wait until all threads are done.
+
+            //------------------------------------- Claim new pacsids -------------------------------------------------
+            long int N_pending = 0;
+            for(const auto &rec : recs){
+                if(rec.state == batch_record::status::pending) ++N_pending;
+            }
+
+            if(0 < N_pending){
+                tb1.str("");
+                tb1 << "INSERT INTO pacsid_nidus (pacsid)                  ";
+                tb1 << "    SELECT nextval('pacsid_nidus_seq')              ";
+                tb1 << "    FROM generate_series(1, " << N_pending << ") ";
+                tb1 << "RETURNING pacsid;                                  ";
+                r = txn.exec(tb1.str());
+                if(static_cast<long int>(r.size()) != N_pending) FUNCERR("Unable to create new pacsids. Cannot continue");
+
+                //The import timepoint is shared by all records in the transaction, just as now() would be.
+                const auto ImportTimepoint = txn.exec("SELECT CAST(now() AS TEXT);")[0][0].as<std::string>();
+
+                //------------------------ Stream the metadata to the database ----------------------------------------
+                pqxx::stream_to stream(txn, "metadata", std::vector<std::string>{{
+                    "pacsid",
+                    "patientid", "studyinstanceuid", "seriesinstanceuid", "sopinstanceuid",
+                    "project", "comments", "fullpathname", "importtimepoint", "storefullpathname" }});
+                long int i = 0;
+                for(auto &rec : recs){
+                    if(rec.state != batch_record::status::pending) continue;
+                    const auto pacsid = r[i++]["pacsid"].as<long int>();
+                    stream << std::make_tuple( pacsid,
+                                               null_if_empty(rec.mmap["PatientID"]),
+                                               null_if_empty(rec.mmap["StudyInstanceUID"]),
+                                               null_if_empty(rec.mmap["SeriesInstanceUID"]),
+                                               null_if_empty(rec.mmap["SOPInstanceUID"]),
+                                               null_if_empty(Project),
+                                               null_if_empty(Comments),
+                                               null_if_empty(rec.source.string()),
+                                               ImportTimepoint,
+                                               rec.StoreFullPathName );
+                }
+                stream.complete();
+            }
+
+            if(dryrun){
+                //The transaction is aborted when it goes out of scope.
+                for(auto &rec : recs){
+                    if(rec.state == batch_record::status::pending) rec.state = batch_record::status::stored;
+                }
+            }else{
+                txn.commit();
+                for(auto &rec : recs){
+                    if(rec.state == batch_record::status::pending) rec.state = batch_record::status::stored;
+                }
+
+                if(checkpoint.is_open()){
+                    for(const auto &rec : recs){
+                        if( (rec.state == batch_record::status::stored)
+                        ||  (rec.state == batch_record::status::duplicate) ){
+                            checkpoint << rec.source.string() << std::endl;
+                        }
+                    }
+                    checkpoint.flush();
+                    if(!checkpoint) FUNCERR("Unable to write to checkpoint file '" << CheckpointFile << "'. Cannot continue");
+                }
+            }
+
+            //------------------------------------- Report throughput ---------------------------------------------
+            for(const auto &rec : recs){
+                if(rec.state == batch_record::status::stored){
+                    ++N_stored;
+                    bytes_stored += rec.bytes;
+                }else if(rec.state == batch_record::status::duplicate){
+                    ++N_duplicate;
+                }else{
+                    ++N_failed;
+                }
+            }
+            const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+            const auto N_done = N_stored + N_duplicate + N_failed;
+            FUNCINFO("Processed " << N_done << "/" << files.size() << " files"
+                     << " (" << N_stored << " imported, " << N_duplicate << " duplicates, " << N_failed << " failures)"
+                     << " at " << (static_cast<double>(N_done) / elapsed) << " files/s"
+                     << " and " << (static_cast<double>(bytes_stored) / (1024.0 * 1024.0 * elapsed)) << " MiB/s");
+        }
+
+    }catch(const std::exception &e){
+        FUNCERR("Unable to push to database:\n" << e.what() << "\n" << "Cannot continue");
+    }
+
+    if(dryrun && verbose) FUNCINFO("Dry run successful. No files were imported");
+    if(0 < N_failed) FUNCWARN(N_failed << " files could not be imported. Re-run to retry them");
+    return;
+}
+
+
 int main(int argc, char **argv){
     //std::string db_params("dbname=pacs user=hal host=localhost port=63443");
     std::string db_params("dbname=pacs user=hal host=localhost");
@@ -39,6 +377,13 @@ int main(int argc, char **argv){
     bool dryrun = false;    //Do not actually insert the file into the db, just test for errors.
     bool verbose = false;   //Print extra information. Normally successful info is suppresed.
 
+    //Batch mode options.
+    std::list<std::string> Directories; //Directories to recursively import.
+    std::string CheckpointFile;         //Records which files have already been imported.
+    long int BatchSize = 5000;          //Number of files imported per transaction.
+    long int Jobs = std::max(1L, static_cast<long int>(std::thread::hardware_concurrency()));
+    bool HardLink = false;              //Hard-link files into the store instead of copying, where possible.
+
     //---------------------------------------------------------------------------------------------------------
     //------------------------------------------ Argument Handling --------------------------------------------
     //---------------------------------------------------------------------------------------------------------
@@ -50,7 +395,10 @@ int main(int argc, char **argv){
                         " the database and various bits of data will be deciphered.          ";
 
     arger.examples = { { " -f '/tmp/a.dcm' -g '/tmp/a.gdcmdump' -p 'XYZ Study 2017' -c 'Bulk insert for XYZ.'" ,
-                         "Insert the file '/tmp/a.dcm' into the database." } 
+                         "Insert the file '/tmp/a.dcm' into the database." },
+                       { " -r '/tmp/xyz/' -p 'XYZ Study 2017' -c 'Bulk insert for XYZ.' -k '/tmp/xyz.checkpoint'" ,
+                         "Insert all files within '/tmp/xyz/' into the database. If interrupted, re-running"
+                         " the same command will resume where the previous invocation left off." }
     };
     //----
 
@@ -112,15 +460,65 @@ int main(int argc, char **argv){
         DICOMFileSystemStoreBase = optarg;
         return;
     }));
+    arger.push_back( std::make_tuple(1, 'd', "database-parameters", true, db_params,
+                                     "Database connection parameters.",
+                                     [&](const std::string &optarg) -> void {
+        db_params = optarg;
+        return;
+    }));
+    arger.push_back( std::make_tuple(4, 'r', "directory", true, "/tmp/xyz/",
+                                     "Batch mode: recursively import all files within this directory."
+                                     " Can be provided multiple times. The gdcmdump file is not used in batch mode.",
+                                     [&](const std::string &optarg) -> void {
+        if(!Does_Dir_Exist_And_Can_Be_Read(optarg)) FUNCERR("Cannot access directory '" << optarg << "'");
+        Directories.push_back(optarg);
+        return;
+    }));
+    arger.push_back( std::make_tuple(4, 'j', "jobs", true, std::to_string(Jobs),
+                                     "Batch mode: the number of files to parse and copy concurrently.",
+                                     [&](const std::string &optarg) -> void {
+        Jobs = std::stol(optarg);
+        if(Jobs < 1) FUNCERR("The number of jobs must be positive");
+        return;
+    }));
+    arger.push_back( std::make_tuple(4, 's', "batch-size", true, std::to_string(BatchSize),
+                                     "Batch mode: the number of files imported within each database transaction.",
+                                     [&](const std::string &optarg) -> void {
+        BatchSize = std::stol(optarg);
+        if(BatchSize < 1) FUNCERR("The batch size must be positive");
+        return;
+    }));
+    arger.push_back( std::make_tuple(4, 'k', "checkpoint-file", true, "/tmp/xyz.checkpoint",
+                                     "Batch mode: a file that records which files have been imported."
+                                     " Files listed in it are skipped, so an interrupted import can be resumed.",
+                                     [&](const std::string &optarg) -> void {
+        CheckpointFile = optarg;
+        return;
+    }));
+    arger.push_back( std::make_tuple(4, 'l', "hard-link", false, "",
+                                     "Batch mode: hard-link files into the store rather than copying them, where possible."
+                                     " Only use this option if the original files will not be subsequently modified.",
+                                     [&](const std::string &optarg) -> void {
+        HardLink = true;
+        return;
+    }));
 
     arger.Launch(argc, argv);
 
     //---------------------------------------------------------------------------------------------------------
     //--------------------------------------- Requirement Verification ----------------------------------------
     //---------------------------------------------------------------------------------------------------------
-    if(DICOMFile.empty()) FUNCERR("Cannot read DICOM file '" << DICOMFile << "'. Cannot continue");
     if(Project.empty())   FUNCERR("The 'project' string is mandatory. Cannot continue");
     if(Comments.empty())  FUNCERR("The 'comments' string is mandatory. Cannot continue");
+
+    if(!Directories.empty()){
+        if(!DICOMFile.empty()) FUNCERR("Individual files cannot be imported in batch mode. Cannot continue");
+        Batch_Ingress(db_params, DICOMFileSystemStoreBase, Directories, Project, Comments,
+                      CheckpointFile, BatchSize, Jobs, HardLink, dryrun, verbose);
+        return 0;
+    }
+
+    if(DICOMFile.empty()) FUNCERR("Cannot read DICOM file '" << DICOMFile << "'. Cannot continue");
     if(GDCMDump.empty())  FUNCERR("The 'gdcmdump' string is strongly suggested. Refusing to continue");
 
     //---------------------------------------------------------------------------------------------------------
@@ -129,33 +527,12 @@ int main(int argc, char **argv){
     //Process the file.
     auto mmap = get_metadata_top_level_tags(DICOMFile);
 
-    //Figure out a reasonable place to keep the file in the filesystem store. It isn't so important except to
-    // be reasonably human-readable, fairly balanced in the filesystem, and not already present.
-    const auto StudyInstanceUID  = mmap["StudyInstanceUID"];
-    const auto StudyDate         = mmap["StudyDate"];
-    const auto StudyTime         = mmap["StudyTime"];
-    const auto SeriesInstanceUID = mmap["SeriesInstanceUID"];
-    const auto SeriesNumber      = mmap["SeriesNumber"];
-    const auto SOPInstanceUID    = mmap["SOPInstanceUID"];
-
-    if(StudyInstanceUID.empty()  || StudyDate.empty()    || StudyTime.empty() 
-    || SeriesInstanceUID.empty() || SeriesNumber.empty() || SOPInstanceUID.empty() ){
+    std::string NewFullDir;
+    std::string StoreFullPathName;
+    if(!Determine_Store_Location(mmap, DICOMFileSystemStoreBase, NewFullDir, StoreFullPathName)){
         FUNCERR("File is '" << DICOMFile << "' missing information and cannot be imported into the database");
     }
-
-    const auto TopDirName = Detox_String(StudyDate) + "-"_s
-                          + Detox_String(StudyTime) + "_"_s
-                          + Detox_String(StudyInstanceUID);
-
-    const auto MidDirName = Detox_String(SeriesNumber) + "-"_s
-                          + Detox_String(SeriesInstanceUID);
-
-    const auto NewFullDir = DICOMFileSystemStoreBase + "/"_s
-                          + TopDirName + "/"_s
-                          + MidDirName + "/";    //Not the full path, just the complete directory.
-
-    const auto NewFileName = Detox_String(SOPInstanceUID) + ".dcm";
-    const auto StoreFullPathName = NewFullDir + NewFileName;
+    const auto SOPInstanceUID = mmap["SOPInstanceUID"];
 
     const auto NewGDCMDumpFileName = Detox_String(SOPInstanceUID) + ".gdcmdump";
     const auto StoreGDCMDumpFileName = NewFullDir + NewGDCMDumpFileName;
@@ -9,6 +9,8 @@
 #endif
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <cctype>
+#include <deque>
 #include <exception>
 #include <fstream>
 #include <list>
@@ -16,13 +18,14 @@
 #include <memory>
 #include <set> 
 #include <string>    
+#include <vector>
 //#include <cfenv>              //Needed for std::feclearexcept(FE_ALL_EXCEPT).
 
 #include <algorithm>
 #include <pqxx/pqxx>          //PostgreSQL C++ interface.
 #include <utility>            //Needed for std::pair.
 
-#include "Explicator.h"       //Needed for Explicator class.
+#include "Explicator_Cache.h"
 #include "Imebra_Shim.h"      //Wrapper for Imebra library. Black-boxed to speed up compilation.
 #include "Structs.h"
 #include "YgorFilesDirs.h"    //Needed for Does_File_Exist_And_Can_Be_Read(...), etc..
@@ -30,6 +33,8 @@
 #include "YgorMath.h"         //Needed for vec3 class.
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 
+#include "DICOM_File_Loader.h"
+
 
 static
 std::unique_ptr<Contour_Data> 
@@ -42,6 +47,49 @@ Concatenate_Contour_Data(std::unique_ptr<Contour_Data> A,
 }
 
 
+//The fields of a single query1 record that are needed to load and annotate the corresponding file.
+struct pacs_record {
+    std::string StoreFullPathName;
+    std::string Modality;
+    std::string key;        // SOPInstanceUID, if available, otherwise the StoreFullPathName.
+
+    bool has_dt = false;
+    std::string dt;
+    bool has_FrameOfReferenceUID = false;
+    std::string FrameOfReferenceUID;
+
+    bool submitted = false; // Whether the file was submitted for loading, or will be copied from the cache.
+};
+
+static
+bool
+Has_Column(const pqxx::result &r, const std::string &name){
+    for(pqxx::row::size_type i = 0; i < r.columns(); ++i){
+        if(boost::iequals(r.column_name(i), name)) return true;
+    }
+    return false;
+}
+
+//Cursors can only be declared for a single query, so trailing statement terminators are removed. Returns false if the
+// query cannot be used with a cursor, in which case it should be executed directly.
+static
+bool
+Prepare_Cursor_Query(std::string &query){
+    while(!query.empty() && ( std::isspace(static_cast<unsigned char>(query.back())) || (query.back() == ';') )){
+        query.pop_back();
+    }
+
+    //Conservatively reject anything that may contain multiple statements or is not a plain query.
+    if(query.find(';') != std::string::npos) return false;
+    size_t i = 0;
+    while(i < query.size() && std::isspace(static_cast<unsigned char>(query[i]))) ++i;
+    const auto first = query.substr(i, 6);
+    return boost::iequals(first, "SELECT")
+        || boost::iequals(first.substr(0,4), "WITH")
+        || boost::iequals(first, "VALUES");
+}
+
+
 bool Load_From_PACS_DB( Drover &DICOM_data,
                         const std::map<std::string,std::string> & /* InvocationMetadata */,
                         const std::string &FilenameLex,
@@ -61,7 +109,112 @@ bool Load_From_PACS_DB( Drover &DICOM_data,
     std::list<loaded_imgs_storage_t> loaded_imgs_storage;
     using loaded_dose_storage_t = decltype(DICOM_data.image_data);
     std::list<loaded_dose_storage_t> loaded_dose_storage;
-    std::shared_ptr<Contour_Data> loaded_contour_data_storage = std::make_shared<Contour_Data>();
+    std::unique_ptr<Contour_Data> loaded_contour_data_storage = std::make_unique<Contour_Data>();
+
+    //Files are loaded concurrently as query1 records are streamed from the database, but are consumed in query order.
+    //
+    //Image and dose files that have already been loaded (e.g., because they appear in several groups) are copied
+    // rather than re-read from the store.
+    dicom_file_load_pool pool;
+    std::map<std::string, std::shared_ptr<Image_Array>> loaded_cache;
+    std::deque<pacs_record> outstanding;
+    const size_t max_outstanding = 1024;
+    const long int cursor_chunk_size = 256;
+    size_t N_consumed = 0;
+
+    //Consume the earliest outstanding record. Returns false if loading should be aborted.
+    const auto consume_next = [&]() -> bool {
+        auto rec = std::move(outstanding.front());
+        outstanding.pop_front();
+        ++N_consumed;
+        FUNCINFO("Parsing file #" << N_consumed << " = " << rec.StoreFullPathName);
+
+        //Parse the file and/or try load the data. Push it into the list (we can collate later).
+        // If we cannot ascertain the type then we will treat it as an image and hope it can be loaded.
+        dicom_file_load_result res;
+        if(rec.submitted){
+            res = pool.next();
+        }else{
+            auto c_it = loaded_cache.find(rec.key);
+            if(c_it == std::end(loaded_cache)){
+                FUNCWARN("Previously loaded file could not be loaded. Ignoring file and continuing");
+                return true;
+            }
+            res.type = (boost::iequals(rec.Modality,"RTDOSE")) ? dicom_file_load_result::kind::dose
+                                                                : dicom_file_load_result::kind::images;
+            res.image_data = std::make_unique<Image_Array>(*(c_it->second));
+        }
+
+        if(res.type == dicom_file_load_result::kind::contours){
+            const auto preloadcount = loaded_contour_data_storage->ccs.size();
+            try{
+                if(res.error) std::rethrow_exception(res.error);
+                loaded_contour_data_storage = Concatenate_Contour_Data( std::move(loaded_contour_data_storage),
+                                                                        std::move(res.contour_data) );
+            }catch(const std::exception &e){
+                FUNCWARN("Difficulty encountered during contour data loading: '" << e.what() <<
+                         "'. Ignoring file and continuing");
+                return true;
+            }
+
+            const auto postloadcount = loaded_contour_data_storage->ccs.size();
+            if(postloadcount == preloadcount){
+                FUNCWARN("RTSTRUCT file was loaded, but contained no ROIs");
+                return false;
+                //If you get here, it isn't necessarily an error. But something has most likely gone wrong. Why bother
+                // to load an RTSTRUCT file if it is empty? If you know what you're doing, you can safely disable this
+                // error and pop the last-added data. Otherwise, try examining the contour loading code and file data.
+            }
+
+        }else if(res.type == dicom_file_load_result::kind::dose){
+            try{
+                if(res.error) std::rethrow_exception(res.error);
+                loaded_dose_storage.back().push_back( std::move(res.image_data) );
+            }catch(const std::exception &e){
+                FUNCWARN("Difficulty encountered during dose array loading: '" << e.what() <<
+                         "'. Ignoring file and continuing");
+                return true;
+            }
+            if(rec.submitted && !rec.key.empty()) loaded_cache[rec.key] = loaded_dose_storage.back().back();
+
+        }else{ //Image loading. 'CT' and 'MR' should work. Not sure about others.
+            try{
+                if(res.error) std::rethrow_exception(res.error);
+                loaded_imgs_storage.back().push_back( std::move(res.image_data) );
+            }catch(const std::exception &e){
+                FUNCWARN("Difficulty encountered during image array loading: '" << e.what() <<
+                         "'. Ignoring file and continuing");
+                return true;
+            }
+
+            if(loaded_imgs_storage.back().back()->imagecoll.images.size() != 1){
+                FUNCWARN("More or less than one image loaded into the image array. You'll need to tweak the code to handle this");
+                return false;
+                //If you get here, you've tried to load a file that contains more than one image slice. This is OK,
+                // (and is legitimate behaviour) but you'll need to update the following code to ensure each file's 
+                // metadata is set accordingly. This is all you need to do at the time of writing, but take a look over
+                // the rest of the code to ensure the code doesn't assume too much.
+            }
+            if(rec.submitted && !rec.key.empty()) loaded_cache[rec.key] = loaded_imgs_storage.back().back();
+
+            //If we want to add any additional image metadata, or replace the default Imebra_Shim.cc populated metadata
+            // with, say, the non-null PostgreSQL metadata, it should be done here.
+            auto &metadata = loaded_imgs_storage.back().back()->imagecoll.images.back().metadata;
+            metadata["StoreFullPathName"] = rec.StoreFullPathName;
+            if(rec.has_dt){
+                metadata["dt"] = rec.dt;
+            }else if(!rec.submitted){
+                metadata.erase("dt"); // Copied from another record.
+            }
+            // ... more metadata operations ...
+        }
+
+        //Whatever file type, 
+        if(rec.has_FrameOfReferenceUID){
+            FrameOfReferenceUIDs.insert(rec.FrameOfReferenceUID);
+        }
+        return true;
+    };
 
     try{
         //Loop over each group of filter query files.
@@ -78,108 +231,86 @@ bool Load_From_PACS_DB( Drover &DICOM_data,
             pqxx::connection c(db_connection_params);
             pqxx::work txn(c);
 
+            //Register the records of a query1 result and submit them for loading.
+            std::set<std::string> submitted_keys;
+            size_t N_records = 0;
+            const auto enqueue = [&](const pqxx::result &r) -> bool {
+                const bool has_SOPInstanceUID = Has_Column(r, "SOPInstanceUID");
+                for(const auto &row : r){
+                    pacs_record rec;
+                    rec.StoreFullPathName = (row["StoreFullPathName"].is_null()) ? 
+                                            "" : row["StoreFullPathName"].as<std::string>();
+                    rec.Modality = row["Modality"].as<std::string>();
+                    rec.key = rec.StoreFullPathName;
+                    if(has_SOPInstanceUID && !row["SOPInstanceUID"].is_null()){
+                        rec.key = row["SOPInstanceUID"].as<std::string>();
+                    }
+                    if(!row["dt"].is_null()){
+                        rec.has_dt = true;
+                        rec.dt = row["dt"].c_str();
+                    }
+                    if(!row["FrameOfReferenceUID"].is_null()){
+                        rec.has_FrameOfReferenceUID = true;
+                        rec.FrameOfReferenceUID = row["FrameOfReferenceUID"].as<std::string>();
+                    }
+
+                    //Contours are consumed when they are concatenated, so they are always loaded anew.
+                    const bool cacheable = !boost::iequals(rec.Modality,"RTSTRUCT") && !rec.key.empty();
+                    if( !cacheable
+                    ||  ( (loaded_cache.count(rec.key) == 0) && submitted_keys.insert(rec.key).second ) ){
+                        pool.submit(rec.StoreFullPathName, rec.Modality, true);
+                        rec.submitted = true;
+                    }
+                    outstanding.emplace_back(std::move(rec));
+                    ++N_records;
+                }
+
+                //Bound the number of files held in memory awaiting consumption.
+                while(max_outstanding < outstanding.size()){
+                    if(!consume_next()) return false;
+                }
+                return true;
+            };
+
             //-------------------------------------------------------------------------------------------------------------
             //Query1 stage: select records from the system pacs database.
             //
-            //Whatever is in the file(s), let the database figure out if they're legal and valid.
-            pqxx::result r1;
-     
+            //Whatever is in the file(s), let the database figure out if they're legal and valid. Only the final
+            // query's records are used. If possible, they are streamed using a cursor so that the full result need not
+            // be held in memory.
             std::stringstream ss;
-            for(const auto &FilterQueryFile : FilterQueryFiles){ 
+            for(auto it = std::begin(FilterQueryFiles); it != std::end(FilterQueryFiles); ++it){
+                const auto &FilterQueryFile = *it;
                 ss << "'" << FilterQueryFile << "'"; //Save the names in case something goes wrong.
-                const auto query1 = LoadFileToString(FilterQueryFile);
-                r1 = txn.exec(query1);
+                auto query1 = LoadFileToString(FilterQueryFile);
+
+                if(std::next(it) != std::end(FilterQueryFiles)){
+                    txn.exec(query1);
+
+                }else if(Prepare_Cursor_Query(query1)){
+                    pqxx::icursorstream cur(txn, query1, "dcma_pacs_loader_query1", cursor_chunk_size);
+                    pqxx::result r1;
+                    while(cur >> r1){
+                        if(!enqueue(r1)) return false;
+                    }
+
+                }else{
+                    const auto r1 = txn.exec(query1);
+                    if(!enqueue(r1)) return false;
+                }
             }
-            if(r1.empty()){
+            if(N_records == 0){
                 FUNCWARN("Database query1 stage " << ss.str() << " resulted in no records. Cannot continue");
                 return false;
             }
     
-    
             //-------------------------------------------------------------------------------------------------------------
-            FUNCINFO("Query1 stage: number of records found = " << r1.size());
+            FUNCINFO("Query1 stage: number of records found = " << N_records);
     
             //-------------------------------------------------------------------------------------------------------------
-            //Query2 stage: process each record, loading whatever data is needed later into memory.
-            for(pqxx::result::size_type i = 0; i != r1.size(); ++i){
-                FUNCINFO("Parsing file #" << i+1 << "/" << r1.size() << " = " << 100*(i+1)/r1.size() << "%");
-
-                //Get the returned pacsid.
-                //const auto pacsid = r1[i]["pacsid"].as<long int>();
-                const auto StoreFullPathName = (r1[i]["StoreFullPathName"].is_null()) ? 
-                                               "" : r1[i]["StoreFullPathName"].as<std::string>();
-
-                //Parse the file and/or try load the data. Push it into the list (we can collate later).
-                // If we cannot ascertain the type then we will treat it as an image and hope it can be loaded.
-                const auto Modality = r1[i]["Modality"].as<std::string>();
-                if(boost::iequals(Modality,"RTSTRUCT")){
-                    const auto preloadcount = loaded_contour_data_storage->ccs.size();
-                    try{
-                        auto combined = Concatenate_Contour_Data( loaded_contour_data_storage->Duplicate(),
-                                                                  get_Contour_Data(StoreFullPathName));
-                        loaded_contour_data_storage = std::move(combined);
-                    }catch(const std::exception &e){
-                        FUNCWARN("Difficulty encountered during contour data loading: '" << e.what() <<
-                                 "'. Ignoring file and continuing");
-                        //loaded_contour_data_storage.back().pop_back();
-                        continue;
-                    }
-
-                    const auto postloadcount = loaded_contour_data_storage->ccs.size();
-                    if(postloadcount == preloadcount){
-                        FUNCWARN("RTSTRUCT file was loaded, but contained no ROIs");
-                        return false;
-                        //If you get here, it isn't necessarily an error. But something has most likely gone wrong. Why bother
-                        // to load an RTSTRUCT file if it is empty? If you know what you're doing, you can safely disable this
-                        // error and pop the last-added data. Otherwise, try examining the contour loading code and file data.
-                    }
-
-
-                }else if(boost::iequals(Modality,"RTDOSE")){
-                    try{
-                        loaded_dose_storage.back().push_back( Load_Dose_Array(StoreFullPathName));
-                    }catch(const std::exception &e){
-                        FUNCWARN("Difficulty encountered during dose array loading: '" << e.what() <<
-                                 "'. Ignoring file and continuing");
-                        //loaded_dose_storage.back().pop_back();
-                        continue;
-                    }
-
-                }else{ //Image loading. 'CT' and 'MR' should work. Not sure about others.
-                    try{
-                        loaded_imgs_storage.back().push_back( Load_Image_Array(StoreFullPathName));
-                    }catch(const std::exception &e){
-                        FUNCWARN("Difficulty encountered during image array loading: '" << e.what() <<
-                                 "'. Ignoring file and continuing");
-                        //loaded_imgs_storage.back().pop_back();
-                        continue;
-                    }
-
-                    if(loaded_imgs_storage.back().back()->imagecoll.images.size() != 1){
-                        FUNCWARN("More or less than one image loaded into the image array. You'll need to tweak the code to handle this");
-                        return false;
-                        //If you get here, you've tried to load a file that contains more than one image slice. This is OK,
-                        // (and is legitimate behaviour) but you'll need to update the following code to ensure each file's 
-                        // metadata is set accordingly. This is all you need to do at the time of writing, but take a look over
-                        // the rest of the code to ensure the code doesn't assume too much.
-                    }
- 
-                    //If we want to add any additional image metadata, or replace the default Imebra_Shim.cc populated metadata
-                    // with, say, the non-null PostgreSQL metadata, it should be done here.
-                    loaded_imgs_storage.back().back()->imagecoll.images.back().metadata["StoreFullPathName"] = StoreFullPathName;
-                    if(!r1[i]["dt"].is_null()){
-                        //DICOM_data.image_data.back()->imagecoll.images.back().metadata["dt"] = r1[i]["dt"].c_str();
-                        //loaded_imgs_storage.back()->imagecoll.images.back().metadata["dt"] = r1[i]["dt"].c_str();
-                        loaded_imgs_storage.back().back()->imagecoll.images.back().metadata["dt"] = r1[i]["dt"].c_str();
-                    }
-                    // ... more metadata operations ...
-                }
-
-                //Whatever file type, 
-                if(!r1[i]["FrameOfReferenceUID"].is_null()){
-                    FrameOfReferenceUIDs.insert(r1[i]["FrameOfReferenceUID"].as<std::string>());
-                }
-
+            //Query2 stage: process each remaining record, loading whatever data is needed later into memory.
+            while(!outstanding.empty()){
+                if(!consume_next()) return false;
             }
 
             //-------------------------------------------------------------------------------------------------------------
@@ -274,22 +405,30 @@ bool Load_From_PACS_DB( Drover &DICOM_data,
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    //Attempt contour name normalization using the selected lexicon.
+    //Attempt contour name normalization using the selected lexicon. Distinct names are normalized concurrently and
+    // only once.
     {
-        Explicator X(FilenameLex);
+        std::vector<std::string> ROINames;
+        for(auto & cc : loaded_contour_data_storage->ccs){
+             for(auto & c : cc.contours){
+                 ROINames.push_back(c.metadata["ROIName"]);
+             }
+        }
+        const auto NormalizedROINames = Explicate(FilenameLex, ROINames);
+
+        size_t i = 0;
         for(auto & cc : loaded_contour_data_storage->ccs){
              for(auto & c : cc.contours){
-                 const auto NormalizedROIName = X(c.metadata["ROIName"]); //Could be cached, externally or internally.
-                 c.metadata["NormalizedROIName"] = NormalizedROIName;
+                 c.metadata["NormalizedROIName"] = NormalizedROINames.at(i++);
              }
-        }   
+        }
     }
 
     //Concatenate contour data into the Drover instance.
     {
         if(DICOM_data.contour_data == nullptr) DICOM_data.contour_data = std::make_shared<Contour_Data>();
         auto combined = Concatenate_Contour_Data( DICOM_data.contour_data->Duplicate(),
-                                                  loaded_contour_data_storage->Duplicate());
+                                                  std::move(loaded_contour_data_storage));
         DICOM_data.contour_data = std::move(combined);
     }
 
@@ -12,6 +12,9 @@
 #include <memory>
 #include <stdexcept>
 #include <string>    
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <cstdlib>            //Needed for exit() calls.
 
@@ -24,6 +27,7 @@
 
 #include "Structs.h"
 #include "Imebra_Shim.h"
+#include "Mapped_File.h"
 
 
 bool Load_From_PLY_Files( Drover &DICOM_data,
@@ -40,11 +44,175 @@ bool Load_From_PLY_Files( Drover &DICOM_data,
     //       However, line endings *might* be problematic on some systems. If problems are encountered, consider making
     //       all line endings in the (text) header equal to '\n' -- namely, replace '\r\n' or '\r' with '\n'.
     //
+    // Note: Binary files with the most common layout are read directly from memory. Other files are read via streams.
+    //
     // Note: This routine returns false only iff a file is suspected of being suited for this loader, but could not be
     //       loaded (e.g., the file seems appropriate, but a parsing failure was encountered).
     //
     if(Filenames.empty()) return true;
 
+    // Reads a binary little-endian PLY file directly from memory.
+    //
+    // Only the simplest and most common layout is handled: a 'vertex' element with x, y, and z properties, optionally
+    // followed by a 'face' element with a single vertex index list property. Returns false for anything else (e.g.,
+    // ASCII files or vertices with normals or colours), in which case the stream-based reader is used instead.
+    const auto read_binary_ply = [](std::string_view contents, fv_surface_mesh<double, uint64_t> &mesh) -> bool {
+        const auto scalar_size = [](std::string_view type) -> size_t {
+            if( (type == "char")   || (type == "int8")
+            ||  (type == "uchar")  || (type == "uint8") )   return 1;
+            if( (type == "short")  || (type == "int16")
+            ||  (type == "ushort") || (type == "uint16") )  return 2;
+            if( (type == "int")    || (type == "int32")
+            ||  (type == "uint")   || (type == "uint32")
+            ||  (type == "float")  || (type == "float32") ) return 4;
+            if( (type == "double") || (type == "float64") ) return 8;
+            return 0;
+        };
+        const auto is_signed = [](std::string_view type) -> bool {
+            return (type == "char") || (type == "int8")
+                || (type == "short") || (type == "int16")
+                || (type == "int") || (type == "int32");
+        };
+        const auto split = [](std::string_view line) -> std::vector<std::string_view> {
+            std::vector<std::string_view> tokens;
+            while(true){
+                const auto b = line.find_first_not_of(" \t");
+                if(b == std::string_view::npos) break;
+                line.remove_prefix(b);
+                const auto e = line.find_first_of(" \t");
+                tokens.emplace_back(line.substr(0, e));
+                if(e == std::string_view::npos) break;
+                line.remove_prefix(e);
+            }
+            return tokens;
+        };
+
+        // Parse the header.
+        if(pop_line(contents) != "ply") return false;
+
+        long int N_vertices = -1;
+        long int N_faces = 0;
+        std::string_view vertex_type[3];   // x, y, z.
+        size_t vertex_offset[3] = { 0, 0, 0 };
+        size_t vertex_stride = 0;
+        std::string_view face_count_type;
+        std::string_view face_index_type;
+        std::string_view current_element;
+        bool end_of_header = false;
+        while(!end_of_header && !contents.empty()){
+            const auto tokens = split(pop_line(contents));
+            if(tokens.empty()) continue;
+            const auto &kw = tokens.front();
+
+            if(kw == "end_header"){
+                end_of_header = true;
+
+            }else if( (kw == "comment") || (kw == "obj_info") ){
+                continue;
+
+            }else if(kw == "format"){
+                if( (tokens.size() != 3)
+                ||  (tokens[1] != "binary_little_endian") ) return false;
+
+            }else if( (kw == "element") && (tokens.size() == 3) ){
+                current_element = tokens[1];
+                double count = -1.0;
+                auto count_sv = tokens[2];
+                if( !parse_number(count_sv, count)
+                ||  !count_sv.empty()
+                ||  !(0.0 <= count) ) return false;
+
+                if( (current_element == "vertex") && (N_vertices < 0) ){
+                    N_vertices = static_cast<long int>(count);
+                }else if( (current_element == "face") && (0 <= N_vertices) && face_count_type.empty() ){
+                    N_faces = static_cast<long int>(count);
+                }else{
+                    return false;
+                }
+
+            }else if( (kw == "property") && (current_element == "vertex") && (tokens.size() == 3) ){
+                const auto size = scalar_size(tokens[1]);
+                const auto &name = tokens[2];
+                const long int j = (name == "x") ? 0 : (name == "y") ? 1 : (name == "z") ? 2 : -1;
+                if( (j < 0)
+                ||  !vertex_type[j].empty()
+                ||  ((tokens[1] != "float") && (tokens[1] != "float32")
+                     && (tokens[1] != "double") && (tokens[1] != "float64")) ) return false;
+                vertex_type[j] = tokens[1];
+                vertex_offset[j] = vertex_stride;
+                vertex_stride += size;
+
+            }else if( (kw == "property") && (current_element == "face") && (tokens.size() == 5)
+                  &&  (tokens[1] == "list") && face_count_type.empty()
+                  &&  ((tokens[4] == "vertex_indices") || (tokens[4] == "vertex_index")) ){
+                face_count_type = tokens[2];
+                face_index_type = tokens[3];
+                if( (scalar_size(face_count_type) == 0)
+                ||  (scalar_size(face_index_type) == 0)
+                ||  (face_count_type.find("float") != std::string_view::npos)
+                ||  (face_index_type.find("float") != std::string_view::npos)
+                ||  (face_count_type == "double")
+                ||  (face_index_type == "double") ) return false;
+
+            }else{
+                return false;
+            }
+        }
+        if( !end_of_header
+        ||  (N_vertices < 0)
+        ||  vertex_type[0].empty() || vertex_type[1].empty() || vertex_type[2].empty()
+        ||  ((0 < N_faces) && face_count_type.empty()) ){
+            return false;
+        }
+
+        // Read the vertices.
+        if(contents.size() < vertex_stride * static_cast<size_t>(N_vertices)) return false;
+        mesh.vertices.reserve(N_vertices);
+        const char *p = contents.data();
+        for(long int v = 0; v < N_vertices; ++v, p += vertex_stride){
+            double x[3];
+            for(size_t j = 0; j < 3; ++j){
+                x[j] = (scalar_size(vertex_type[j]) == 4) ? static_cast<double>(read_little_endian<float>(p + vertex_offset[j]))
+                                                          : read_little_endian<double>(p + vertex_offset[j]);
+            }
+            mesh.vertices.emplace_back(x[0], x[1], x[2]);
+        }
+
+        // Read the faces, which have variable length.
+        const char *end = contents.data() + contents.size();
+        const auto read_integer = [&](std::string_view type) -> int64_t {
+            switch(scalar_size(type)){
+                case 1: return is_signed(type) ? static_cast<int64_t>(read_little_endian<int8_t>(p))
+                                               : static_cast<int64_t>(read_little_endian<uint8_t>(p));
+                case 2: return is_signed(type) ? static_cast<int64_t>(read_little_endian<int16_t>(p))
+                                               : static_cast<int64_t>(read_little_endian<uint16_t>(p));
+                default: return is_signed(type) ? static_cast<int64_t>(read_little_endian<int32_t>(p))
+                                                : static_cast<int64_t>(read_little_endian<uint32_t>(p));
+            }
+        };
+        const auto count_size = static_cast<long int>(scalar_size(face_count_type));
+        const auto index_size = static_cast<long int>(scalar_size(face_index_type));
+        mesh.faces.reserve(N_faces);
+        for(long int f = 0; f < N_faces; ++f){
+            if((end - p) < count_size) return false;
+            const auto N_indices = read_integer(face_count_type);
+            p += count_size;
+            if( (N_indices < 0)
+            ||  ((end - p) / index_size < N_indices) ) return false;
+
+            std::vector<uint64_t> face(N_indices);
+            for(auto &i : face){
+                const auto index = read_integer(face_index_type);
+                p += index_size;
+                if( (index < 0)
+                ||  (N_vertices <= index) ) return false;
+                i = static_cast<uint64_t>(index);
+            }
+            mesh.faces.emplace_back(std::move(face));
+        }
+        return true;
+    };
+
     size_t i = 0;
     const size_t N = Filenames.size();
 
@@ -59,11 +227,16 @@ bool Load_From_PLY_Files( Drover &DICOM_data,
         try{
             //////////////////////////////////////////////////////////////
             // Attempt to load the file.
-            std::ifstream FI(Filename.c_str(), std::ios::in | std::ios::binary);
-            if(!ReadFVSMeshFromPLY(DICOM_data.smesh_data.back()->meshes, FI)){
-                throw std::runtime_error("Unable to read mesh or point cloud from file.");
+            auto &mesh = DICOM_data.smesh_data.back()->meshes;
+            const bool read_directly = read_binary_ply( mapped_file(*bfit).view(), mesh );
+            if(!read_directly){
+                mesh = fv_surface_mesh<double, uint64_t>();
+                std::ifstream FI(Filename.c_str(), std::ios::in | std::ios::binary);
+                if(!ReadFVSMeshFromPLY(mesh, FI)){
+                    throw std::runtime_error("Unable to read mesh or point cloud from file.");
+                }
+                FI.close();
             }
-            FI.close();
             //////////////////////////////////////////////////////////////
 
             // Reject the file if the mesh is not valid.
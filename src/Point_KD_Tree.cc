@@ -0,0 +1,332 @@
+//Point_KD_Tree.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "Thread_Pool.h"
+
+#include "YgorMath.h"         //Needed for vec3 class.
+
+#include "Point_KD_Tree.h"
+
+
+// The traversal stack only needs to hold one pending sibling per level, and the tree is balanced.
+static constexpr long int max_stack_depth = 128;
+
+static double
+coordinate(const vec3<double> &v, int axis){
+    return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z);
+}
+
+static double
+sq_dist_to_box(const vec3<double> &p, const vec3<double> &lo, const vec3<double> &hi){
+    const auto dx = std::max({ lo.x - p.x, 0.0, p.x - hi.x });
+    const auto dy = std::max({ lo.y - p.y, 0.0, p.y - hi.y });
+    const auto dz = std::max({ lo.z - p.z, 0.0, p.z - hi.z });
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static double
+sq_max_dist_to_box(const vec3<double> &p, const vec3<double> &lo, const vec3<double> &hi){
+    const auto dx = std::max( std::abs(p.x - lo.x), std::abs(p.x - hi.x) );
+    const auto dy = std::max( std::abs(p.y - lo.y), std::abs(p.y - hi.y) );
+    const auto dz = std::max( std::abs(p.z - lo.z), std::abs(p.z - hi.z) );
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Whether neighbour 'a' is closer than 'b', breaking ties using the index.
+static bool
+is_closer(const kd_neighbour &a, const kd_neighbour &b){
+    return (a.sq_dist < b.sq_dist)
+        || ((a.sq_dist == b.sq_dist) && (a.index < b.index));
+}
+
+
+point_kd_tree::point_kd_tree(const std::vector<vec3<double>> &points){
+    std::vector<vec3<double>> l_pts;
+    l_pts.reserve(points.size());
+    this->ids.reserve(points.size());
+    for(size_t i = 0; i < points.size(); ++i){
+        if(!points[i].isfinite()) continue;
+        l_pts.push_back(points[i]);
+        this->ids.push_back(static_cast<long int>(i));
+    }
+
+    const auto N = static_cast<long int>(l_pts.size());
+    if(N == 0) return;
+
+    std::vector<long int> order(N);
+    std::iota(std::begin(order), std::end(order), 0L);
+    this->pts.swap(l_pts);
+    this->nodes.reserve( 4 * (N / leaf_size + 1) );
+    this->build(order, 0, N);
+
+    // Reorder the points so that every node refers to a contiguous range.
+    std::vector<vec3<double>> sorted_pts;
+    std::vector<long int> sorted_ids;
+    sorted_pts.reserve(N);
+    sorted_ids.reserve(N);
+    for(const auto &i : order){
+        sorted_pts.push_back(this->pts[i]);
+        sorted_ids.push_back(this->ids[i]);
+    }
+    this->pts.swap(sorted_pts);
+    this->ids.swap(sorted_ids);
+}
+
+point_kd_tree::point_kd_tree(const point_set<double> &ps) : point_kd_tree(ps.points) {}
+
+long int
+point_kd_tree::build(std::vector<long int> &order, long int begin, long int end){
+    const auto n = static_cast<long int>(this->nodes.size());
+    this->nodes.emplace_back();
+
+    const auto inf = std::numeric_limits<double>::infinity();
+    vec3<double> lo( inf, inf, inf );
+    vec3<double> hi( -inf, -inf, -inf );
+    for(long int i = begin; i < end; ++i){
+        const auto &p = this->pts[order[i]];
+        lo.x = std::min(lo.x, p.x);
+        lo.y = std::min(lo.y, p.y);
+        lo.z = std::min(lo.z, p.z);
+        hi.x = std::max(hi.x, p.x);
+        hi.y = std::max(hi.y, p.y);
+        hi.z = std::max(hi.z, p.z);
+    }
+    this->nodes[n].lo = lo;
+    this->nodes[n].hi = hi;
+    this->nodes[n].begin = begin;
+    this->nodes[n].end = end;
+    if((end - begin) <= leaf_size) return n;
+
+    // Split at the median along the widest extent.
+    const auto extent = hi - lo;
+    const int axis = ( (extent.y <= extent.x) && (extent.z <= extent.x) ) ? 0
+                   : ( (extent.z <= extent.y) ? 1 : 2 );
+    const auto mid = begin + (end - begin) / 2;
+    std::nth_element( std::next(std::begin(order), begin),
+                      std::next(std::begin(order), mid),
+                      std::next(std::begin(order), end),
+                      [&](long int a, long int b) -> bool {
+                          return coordinate(this->pts[a], axis) < coordinate(this->pts[b], axis);
+                      });
+
+    this->build(order, begin, mid);
+    const auto right = this->build(order, mid, end);
+    this->nodes[n].right = right;
+    return n;
+}
+
+long int
+point_kd_tree::size() const {
+    return static_cast<long int>(this->pts.size());
+}
+
+bool
+point_kd_tree::empty() const {
+    return this->pts.empty();
+}
+
+kd_neighbour
+point_kd_tree::nearest(const vec3<double> &p) const {
+    kd_neighbour best;
+    if(this->nodes.empty() || !p.isfinite()) return best;
+
+    std::array<long int, max_stack_depth> stack;
+    long int depth = 0;
+    stack[depth++] = 0;
+    while(0 < depth){
+        const auto &node = this->nodes[stack[--depth]];
+        if(best.sq_dist < sq_dist_to_box(p, node.lo, node.hi)) continue;
+
+        if(node.right < 0){
+            for(long int i = node.begin; i < node.end; ++i){
+                const kd_neighbour candidate = { this->ids[i], p.sq_dist(this->pts[i]) };
+                if(is_closer(candidate, best)) best = candidate;
+            }
+            continue;
+        }
+
+        // Visit the nearer child first.
+        const auto left = static_cast<long int>(&node - this->nodes.data()) + 1;
+        const auto &l_node = this->nodes[left];
+        const auto &r_node = this->nodes[node.right];
+        if(sq_dist_to_box(p, l_node.lo, l_node.hi) <= sq_dist_to_box(p, r_node.lo, r_node.hi)){
+            stack[depth++] = node.right;
+            stack[depth++] = left;
+        }else{
+            stack[depth++] = left;
+            stack[depth++] = node.right;
+        }
+    }
+    return best;
+}
+
+std::vector<kd_neighbour>
+point_kd_tree::k_nearest(const vec3<double> &p, long int k) const {
+    std::vector<kd_neighbour> heap; // Max-heap, so the farthest retained neighbour is on top.
+    if(this->nodes.empty() || !p.isfinite() || (k <= 0)) return heap;
+    heap.reserve(static_cast<size_t>( std::min(k, this->size()) ));
+
+    std::array<long int, max_stack_depth> stack;
+    long int depth = 0;
+    stack[depth++] = 0;
+    while(0 < depth){
+        const auto &node = this->nodes[stack[--depth]];
+        if( (static_cast<long int>(heap.size()) == k)
+        &&  (heap.front().sq_dist < sq_dist_to_box(p, node.lo, node.hi)) ) continue;
+
+        if(node.right < 0){
+            for(long int i = node.begin; i < node.end; ++i){
+                const kd_neighbour candidate = { this->ids[i], p.sq_dist(this->pts[i]) };
+                if(static_cast<long int>(heap.size()) < k){
+                    heap.push_back(candidate);
+                    std::push_heap(std::begin(heap), std::end(heap), is_closer);
+                }else if(is_closer(candidate, heap.front())){
+                    std::pop_heap(std::begin(heap), std::end(heap), is_closer);
+                    heap.back() = candidate;
+                    std::push_heap(std::begin(heap), std::end(heap), is_closer);
+                }
+            }
+            continue;
+        }
+
+        const auto left = static_cast<long int>(&node - this->nodes.data()) + 1;
+        const auto &l_node = this->nodes[left];
+        const auto &r_node = this->nodes[node.right];
+        if(sq_dist_to_box(p, l_node.lo, l_node.hi) <= sq_dist_to_box(p, r_node.lo, r_node.hi)){
+            stack[depth++] = node.right;
+            stack[depth++] = left;
+        }else{
+            stack[depth++] = left;
+            stack[depth++] = node.right;
+        }
+    }
+
+    std::sort_heap(std::begin(heap), std::end(heap), is_closer);
+    return heap;
+}
+
+std::vector<kd_neighbour>
+point_kd_tree::within_radius(const vec3<double> &p, double radius) const {
+    std::vector<kd_neighbour> out;
+    if( this->nodes.empty()
+    ||  !p.isfinite()
+    ||  !std::isfinite(radius)
+    ||  (radius < 0.0) ) return out;
+    const auto sq_radius = radius * radius;
+
+    std::array<long int, max_stack_depth> stack;
+    long int depth = 0;
+    stack[depth++] = 0;
+    while(0 < depth){
+        const auto &node = this->nodes[stack[--depth]];
+        if(sq_radius < sq_dist_to_box(p, node.lo, node.hi)) continue;
+
+        if(node.right < 0){
+            for(long int i = node.begin; i < node.end; ++i){
+                const auto sq_dist = p.sq_dist(this->pts[i]);
+                if(sq_dist <= sq_radius) out.push_back( kd_neighbour{ this->ids[i], sq_dist } );
+            }
+            continue;
+        }
+        stack[depth++] = node.right;
+        stack[depth++] = static_cast<long int>(&node - this->nodes.data()) + 1;
+    }
+
+    std::sort(std::begin(out), std::end(out),
+              [](const kd_neighbour &a, const kd_neighbour &b) -> bool { return a.index < b.index; });
+    return out;
+}
+
+kd_neighbour
+point_kd_tree::farthest(const vec3<double> &p) const {
+    kd_neighbour best;
+    if(this->nodes.empty() || !p.isfinite()) return best;
+    best.sq_dist = -1.0;
+
+    const auto is_farther = [](const kd_neighbour &a, const kd_neighbour &b) -> bool {
+        return (b.sq_dist < a.sq_dist)
+            || ((a.sq_dist == b.sq_dist) && (a.index < b.index));
+    };
+
+    std::array<long int, max_stack_depth> stack;
+    long int depth = 0;
+    stack[depth++] = 0;
+    while(0 < depth){
+        const auto &node = this->nodes[stack[--depth]];
+        if(sq_max_dist_to_box(p, node.lo, node.hi) < best.sq_dist) continue;
+
+        if(node.right < 0){
+            for(long int i = node.begin; i < node.end; ++i){
+                const kd_neighbour candidate = { this->ids[i], p.sq_dist(this->pts[i]) };
+                if(is_farther(candidate, best)) best = candidate;
+            }
+            continue;
+        }
+
+        // Visit the farther child first.
+        const auto left = static_cast<long int>(&node - this->nodes.data()) + 1;
+        const auto &l_node = this->nodes[left];
+        const auto &r_node = this->nodes[node.right];
+        if(sq_max_dist_to_box(p, r_node.lo, r_node.hi) <= sq_max_dist_to_box(p, l_node.lo, l_node.hi)){
+            stack[depth++] = node.right;
+            stack[depth++] = left;
+        }else{
+            stack[depth++] = left;
+            stack[depth++] = node.right;
+        }
+    }
+    return best;
+}
+
+
+// Evaluates a query for every point, distributing contiguous chunks of queries over a thread pool.
+template <class R, class F>
+static std::vector<R>
+batch_query(const std::vector<vec3<double>> &ps, F f){
+    std::vector<R> out(ps.size());
+    const auto N = static_cast<long int>(ps.size());
+    const long int chunk = 256;
+    if(N <= chunk){
+        for(long int i = 0; i < N; ++i) out[i] = f(ps[i]);
+        return out;
+    }
+
+    {
+        asio_thread_pool tp;
+        for(long int b = 0; b < N; b += chunk){
+            const auto e = std::min(N, b + chunk);
+            tp.submit_task([&,b,e]() -> void {
+                for(long int i = b; i < e; ++i) out[i] = f(ps[i]);
+            }); // thread pool task closure.
+        }
+    } // Wait until all threads are done.
+    return out;
+}
+
+std::vector<kd_neighbour>
+point_kd_tree::nearest(const std::vector<vec3<double>> &ps) const {
+    return batch_query<kd_neighbour>(ps, [&](const vec3<double> &p){ return this->nearest(p); });
+}
+
+std::vector<std::vector<kd_neighbour>>
+point_kd_tree::k_nearest(const std::vector<vec3<double>> &ps, long int k) const {
+    return batch_query<std::vector<kd_neighbour>>(ps, [&](const vec3<double> &p){ return this->k_nearest(p, k); });
+}
+
+std::vector<std::vector<kd_neighbour>>
+point_kd_tree::within_radius(const std::vector<vec3<double>> &ps, double radius) const {
+    return batch_query<std::vector<kd_neighbour>>(ps, [&](const vec3<double> &p){ return this->within_radius(p, radius); });
+}
+
+std::vector<kd_neighbour>
+point_kd_tree::farthest(const std::vector<vec3<double>> &ps) const {
+    return batch_query<kd_neighbour>(ps, [&](const vec3<double> &p){ return this->farthest(p); });
+}
+
@@ -0,0 +1,69 @@
+//Point_KD_Tree.h.
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "YgorMath.h"         //Needed for vec3 class.
+
+
+// A single query result. The index refers to the position of the point in the container used to build the tree.
+struct kd_neighbour {
+    long int index = -1; // Negative if no point was found.
+    double sq_dist = std::numeric_limits<double>::infinity();
+};
+
+
+// A static KD-tree over a set of 3D points, for nearest-neighbour, k-nearest-neighbour, radius, and farthest-point
+// queries.
+//
+// The tree is built once and cannot be altered afterward. Points are copied into a contiguous, spatially-sorted buffer
+// and nodes are laid out in depth-first order, so traversals mostly touch adjacent memory. Non-finite points are
+// omitted from the tree, and queries using non-finite points return no results.
+//
+// Ties are broken in favour of the lowest index, which matches a brute-force search that retains the first closest
+// point encountered. Individual queries are thread-safe; batched queries are evaluated in parallel.
+class point_kd_tree {
+    private:
+        struct node_t {
+            vec3<double> lo;     // Bounding box of the contained points.
+            vec3<double> hi;
+            long int begin = 0;  // Range of contained points within 'pts'.
+            long int end = 0;
+            long int right = -1; // The right child, or -1 for leaf nodes. The left child always immediately follows.
+        };
+
+        std::vector<vec3<double>> pts;
+        std::vector<long int> ids;
+        std::vector<node_t> nodes;
+
+        long int build(std::vector<long int> &order, long int begin, long int end);
+
+    public:
+        static constexpr long int leaf_size = 12;
+
+        point_kd_tree() = default;
+        explicit point_kd_tree(const std::vector<vec3<double>> &points);
+        explicit point_kd_tree(const point_set<double> &ps);
+
+        long int size() const;
+        bool empty() const;
+
+        kd_neighbour nearest(const vec3<double> &p) const;
+
+        // Results are sorted by increasing distance. Fewer than k results are returned if the tree is small.
+        std::vector<kd_neighbour> k_nearest(const vec3<double> &p, long int k) const;
+
+        // Returns all points with distance <= radius, sorted by index.
+        std::vector<kd_neighbour> within_radius(const vec3<double> &p, double radius) const;
+
+        kd_neighbour farthest(const vec3<double> &p) const;
+
+        // Batched queries, evaluated in parallel. Results are ordered like the queries.
+        std::vector<kd_neighbour> nearest(const std::vector<vec3<double>> &ps) const;
+        std::vector<std::vector<kd_neighbour>> k_nearest(const std::vector<vec3<double>> &ps, long int k) const;
+        std::vector<std::vector<kd_neighbour>> within_radius(const std::vector<vec3<double>> &ps, double radius) const;
+        std::vector<kd_neighbour> farthest(const std::vector<vec3<double>> &ps) const;
+};
+
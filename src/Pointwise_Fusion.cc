@@ -0,0 +1,129 @@
+//Pointwise_Fusion.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "Pointwise_Fusion.h"
+
+
+static
+bool contains_case_insensitive(std::string haystack, const std::string &needle){
+    std::transform(std::begin(haystack), std::end(haystack), std::begin(haystack),
+                   [](unsigned char c){ return static_cast<char>(std::tolower(c)); });
+    return (haystack.find(needle) != std::string::npos);
+}
+
+std::optional<pointwise_stage>
+make_pointwise_stage(const std::string &op_name,
+                     const std::function<std::optional<std::string>(const std::string &)> &get_arg){
+    pointwise_stage s;
+    using kind = pointwise_stage::kind;
+
+    if(op_name == "NegatePixels"){
+        s.type = kind::negate;
+        s.description = "Negated";
+    }else if(op_name == "LogScale"){
+        s.type = kind::log_scale;
+        s.description = "Log-Scaled";
+    }else if(op_name == "ConvertNaNsToZeros"){
+        s.type = kind::replace_nonfinite;
+        s.replacement = 0.0f;
+        s.description = "NaN Pixel Filtered";
+    }else if(op_name == "ConvertNaNsToAir"){
+        s.type = kind::replace_nonfinite;
+        s.replacement = -1024.0f;
+        s.description = "NaN Pixel Filtered";
+    }else if(op_name == "PreFilterEnormousCTValues"){
+        s.type = kind::filter_enormous;
+        s.description = "Enormous Pixel Filtered";
+    }else if(op_name == "ThresholdImages"){
+        s.type = kind::threshold;
+        s.description = "Thresholded";
+
+        const auto LowerStr = get_arg("Lower");
+        const auto LowStr = get_arg("Low");
+        const auto UpperStr = get_arg("Upper");
+        const auto HighStr = get_arg("High");
+        const auto ChannelStr = get_arg("Channel");
+        if( !LowerStr || !LowStr || !UpperStr || !HighStr || !ChannelStr ) return std::nullopt;
+
+        // Percentage and percentile bounds depend on the whole image.
+        for(const auto &b : { LowerStr.value(), UpperStr.value() }){
+            if( contains_case_insensitive(b, "%")
+            ||  contains_case_insensitive(b, "tile") ) return std::nullopt;
+        }
+        try{
+            s.lower = std::stod(LowerStr.value());
+            s.low = std::stod(LowStr.value());
+            s.upper = std::stod(UpperStr.value());
+            s.high = std::stod(HighStr.value());
+            s.channel = std::stol(ChannelStr.value());
+        }catch(const std::exception &){
+            return std::nullopt; // Let the operation itself report the problem.
+        }
+        if(s.channel < 0) return std::nullopt;
+    }else{
+        return std::nullopt;
+    }
+
+    // Operations that do not accept a selection act on all image arrays.
+    if( (s.type == kind::negate)
+    ||  (s.type == kind::log_scale)
+    ||  (s.type == kind::threshold) ){
+        const auto sel = get_arg("ImageSelection");
+        if(!sel) return std::nullopt;
+        s.selection = sel.value();
+    }
+    return s;
+}
+
+bool can_fuse(const pointwise_stage &prev, const pointwise_stage &next){
+    return (prev.selection == next.selection)
+        && (next.selection.find('@') == std::string::npos);
+}
+
+void pointwise_fusion_detail::apply_stage(const pointwise_stage &s, float *p, size_t n, long int channels){
+    using kind = pointwise_stage::kind;
+    switch(s.type){
+        case kind::negate:
+            for(size_t i = 0; i < n; ++i) p[i] = -p[i];
+            break;
+
+        case kind::log_scale:
+            for(size_t i = 0; i < n; ++i){
+                const auto v = p[i];
+                p[i] = (v > static_cast<float>(0)) ? std::log(v) : std::numeric_limits<float>::quiet_NaN();
+            }
+            break;
+
+        case kind::replace_nonfinite:
+            for(size_t i = 0; i < n; ++i){
+                const auto v = p[i];
+                p[i] = std::isfinite(v) ? v : s.replacement;
+            }
+            break;
+
+        case kind::filter_enormous:
+            for(size_t i = 0; i < n; ++i){
+                const auto v = p[i];
+                p[i] = (v < static_cast<float>(2E4)) ? v : std::numeric_limits<float>::quiet_NaN();
+            }
+            break;
+
+        case kind::threshold:
+            if(channels <= s.channel) break;
+            for(size_t i = static_cast<size_t>(s.channel); i < n; i += static_cast<size_t>(channels)){
+                const auto v = p[i];
+                if(!(s.lower < v)) p[i] = s.low;
+                if(!(v < s.upper)) p[i] = s.high;
+            }
+            break;
+    }
+    return;
+}
+
@@ -0,0 +1,116 @@
+//Pointwise_Fusion.h.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// A single pointwise voxel transformation, corresponding to one operation.
+//
+// Each stage is intended to reproduce the per-voxel behaviour of the operation it was derived from, including the
+// arithmetic precision, the image description it leaves behind, and which outgoing values it uses to update the
+// window. The formulas are duplicated from the operations, so changes to either must be made to both.
+struct pointwise_stage {
+    enum class kind {
+        negate,            // NegatePixels.
+        log_scale,         // LogScale.
+        replace_nonfinite, // ConvertNaNsToZeros and ConvertNaNsToAir.
+        filter_enormous,   // PreFilterEnormousCTValues.
+        threshold,         // ThresholdImages with absolute bounds.
+    } type = kind::negate;
+
+    long int channel = -1;   // The only channel altered. Negative for all channels.
+    float replacement = 0.0f; // For replace_nonfinite.
+    double lower = 0.0;      // Threshold bounds and replacement values.
+    double low = 0.0;
+    double upper = 0.0;
+    double high = 0.0;
+
+    std::string selection = "all"; // The image array selection the operation was given.
+    std::string description;       // The image description the operation leaves behind.
+
+    // Whether the outgoing value would be used to update the window by the corresponding operation.
+    bool windows(float out) const {
+        if(this->type == kind::log_scale) return !std::isnan(out);
+        if(this->type == kind::filter_enormous) return std::isfinite(out);
+        return true;
+    }
+};
+
+// Creates a stage from an operation name and a means of looking up its arguments (with defaults inserted). Returns
+// nothing if the operation is not pointwise, or if the arguments request behaviour that depends on more than a single
+// voxel (e.g., percentile threshold bounds).
+std::optional<pointwise_stage>
+make_pointwise_stage(const std::string &op_name,
+                     const std::function<std::optional<std::string>(const std::string &)> &get_arg);
+
+// Whether the stage can be applied together with the stages preceding it.
+//
+// Operations rewrite the image description, so only selections that do not depend on metadata are eligible.
+bool can_fuse(const pointwise_stage &prev, const pointwise_stage &next);
+
+
+// A sequence of pointwise stages applied together in a single pass over voxel data.
+//
+// Voxels are processed in blocks small enough to remain in cache, and each stage is applied to the whole block in a
+// simple loop the compiler can vectorize. The results are identical to applying each stage in turn to the entire image.
+class pointwise_kernel {
+    private:
+        std::vector<pointwise_stage> stages;
+
+    public:
+        void append(const pointwise_stage &s){ this->stages.push_back(s); }
+        bool empty() const { return this->stages.empty(); }
+        size_t size() const { return this->stages.size(); }
+        const std::vector<pointwise_stage> & get_stages() const { return this->stages; }
+
+        // Applies all stages to channel-interleaved voxel data, in place. Afterward, the digest functor is invoked on
+        // every outgoing value the final stage would have used to update the window.
+        template <class F>
+        void apply(float *data, size_t N, long int channels, F &&digest) const;
+};
+
+
+namespace pointwise_fusion_detail {
+
+void apply_stage(const pointwise_stage &s, float *data, size_t N, long int channels);
+
+} // namespace pointwise_fusion_detail
+
+
+template <class F>
+void pointwise_kernel::apply(float *data, size_t N, long int channels, F &&digest) const {
+    if( this->stages.empty()
+    ||  (N == 0) ) return;
+    channels = std::max<long int>(1, channels);
+
+    // Blocks always begin on the first channel of a voxel.
+    const size_t block = static_cast<size_t>(channels) * 2048UL;
+    const auto &last = this->stages.back();
+    for(size_t offset = 0; offset < N; offset += block){
+        const auto n = std::min(block, N - offset);
+        float *p = data + offset;
+        for(const auto &s : this->stages){
+            pointwise_fusion_detail::apply_stage(s, p, n, channels);
+        }
+
+        if(last.channel < 0){
+            for(size_t i = 0; i < n; ++i){
+                if(last.windows(p[i])) digest(p[i]);
+            }
+        }else if(last.channel < channels){
+            for(size_t i = static_cast<size_t>(last.channel); i < n; i += static_cast<size_t>(channels)){
+                if(last.windows(p[i])) digest(p[i]);
+            }
+        }
+    }
+    return;
+}
+
@@ -3,8 +3,10 @@
 // This program loads surface meshes from both ASCII and binary STL files.
 //
 
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <list>
@@ -12,6 +14,10 @@
 #include <memory>
 #include <stdexcept>
 #include <string>    
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <filesystem>
 #include <cstdlib>            //Needed for exit() calls.
@@ -23,6 +29,7 @@
 
 #include "Structs.h"
 #include "Imebra_Shim.h"
+#include "Mapped_File.h"
 
 bool Load_Mesh_From_ASCII_STL_Files( Drover &DICOM_data,
                                      const std::map<std::string,std::string> & /* InvocationMetadata */,
@@ -124,6 +131,58 @@ bool Load_Mesh_From_Binary_STL_Files( Drover &DICOM_data,
     //
     if(Filenames.empty()) return true;
 
+    // Reads a binary STL file directly from memory: an 80 byte header, a 32 bit triangle count, and 50 bytes per
+    // triangle. Identical vertices are merged so that adjacent faces share vertices.
+    //
+    // Returns false if the file size is inconsistent with the triangle count, in which case the stream-based reader is
+    // used instead.
+    const auto read_binary_stl = [](std::string_view contents, fv_surface_mesh<double, uint64_t> &mesh) -> bool {
+        const size_t header_size = 84;
+        const size_t triangle_size = 50;
+        if(contents.size() < header_size) return false;
+        const auto N_triangles = static_cast<size_t>( read_little_endian<uint32_t>(contents.data() + 80) );
+        if( (N_triangles == 0)
+        ||  (contents.size() != (header_size + triangle_size * N_triangles)) ){
+            return false;
+        }
+
+        // Vertices are keyed on the bit patterns of their coordinates, with signed zeros treated as equal.
+        using key_t = std::array<uint32_t, 3>;
+        struct key_hash {
+            size_t operator()(const key_t &k) const {
+                uint64_t h = 1469598103934665603ULL;
+                for(const auto &w : k) h = (h ^ w) * 1099511628211ULL;
+                return static_cast<size_t>(h);
+            }
+        };
+        std::unordered_map<key_t, uint64_t, key_hash> vertex_index;
+        vertex_index.reserve(N_triangles);
+
+        // A closed triangle mesh has roughly half as many vertices as faces.
+        mesh.vertices.reserve(N_triangles / 2 + 3);
+        mesh.faces.reserve(N_triangles);
+        for(size_t t = 0; t < N_triangles; ++t){
+            const char *p = contents.data() + header_size + triangle_size * t + 12; // Skip the facet normal.
+            std::vector<uint64_t> face(3);
+            for(auto &f : face){
+                key_t k;
+                float x[3];
+                for(size_t j = 0; j < 3; ++j, p += 4){
+                    x[j] = read_little_endian<float>(p);
+                    if(x[j] == 0.0f) x[j] = 0.0f;
+                    std::memcpy(&k[j], &x[j], sizeof(float));
+                }
+                const auto [it, inserted] = vertex_index.try_emplace(k, mesh.vertices.size());
+                if(inserted) mesh.vertices.emplace_back( static_cast<double>(x[0]),
+                                                         static_cast<double>(x[1]),
+                                                         static_cast<double>(x[2]) );
+                f = it->second;
+            }
+            mesh.faces.emplace_back(std::move(face));
+        }
+        return true;
+    };
+
     // Attempt to read as a binary file.
     {
         size_t i = 0;
@@ -140,11 +199,16 @@ bool Load_Mesh_From_Binary_STL_Files( Drover &DICOM_data,
             try{
                 //////////////////////////////////////////////////////////////
                 // Attempt to load the file.
-                std::ifstream FI(Filename.c_str(), std::ios::in);
-                if(!ReadFVSMeshFromBinarySTL(DICOM_data.smesh_data.back()->meshes, FI)){
-                    throw std::runtime_error("Unable to read mesh from file.");
+                auto &mesh = DICOM_data.smesh_data.back()->meshes;
+                const bool read_directly = read_binary_stl( mapped_file(*bfit).view(), mesh );
+                if(!read_directly){
+                    mesh = fv_surface_mesh<double, uint64_t>();
+                    std::ifstream FI(Filename.c_str(), std::ios::in | std::ios::binary);
+                    if(!ReadFVSMeshFromBinarySTL(mesh, FI)){
+                        throw std::runtime_error("Unable to read mesh from file.");
+                    }
+                    FI.close();
                 }
-                FI.close();
                 //////////////////////////////////////////////////////////////
 
                 // Reject the file if the mesh is not valid.
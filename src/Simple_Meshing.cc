@@ -30,6 +30,7 @@
 #include "YgorString.h"       //Needed for GetFirstRegex(...)
 
 #include "Structs.h"
+#include "Point_KD_Tree.h"
 
 #include "Simple_Meshing.h"
 
@@ -123,10 +124,15 @@ Estimate_Contour_Correspondence(
         }
     }
 
-    auto beg_A = std::begin(contour_A.points);
-    auto beg_B = std::begin(contour_B.points);
-    auto end_A = std::end(contour_A.points);
-    auto end_B = std::end(contour_B.points);
+    // Vertex indices are needed for every face emitted while walking the contours, so walk contiguous copies of the
+    // vertices to keep the walk linear in the number of vertices.
+    const std::vector<vec3<double>> verts_A( std::begin(contour_A.points), std::end(contour_A.points) );
+    const std::vector<vec3<double>> verts_B( std::begin(contour_B.points), std::end(contour_B.points) );
+
+    auto beg_A = std::begin(verts_A);
+    auto beg_B = std::begin(verts_B);
+    auto end_A = std::end(verts_A);
+    auto end_B = std::end(verts_B);
 
     // Additional metrics needed for alternative meshing heuristics below.
     //const auto total_perimeter_A = contour_A.Perimeter();
@@ -234,6 +240,7 @@ Estimate_Contour_Correspondence(
     size_t N_edges_consumed_A = 0;
     size_t N_edges_consumed_B = 0;
     std::vector<std::array<size_t, 3>> faces; // Assuming A vertices are first. Zero-based.
+    faces.reserve(N_A + N_B);
 
     for(size_t n = 0; n < (N_A + N_B); ++n){
         // Figure out which candidate vertices we have.
@@ -621,81 +628,91 @@ Minimally_Amalgamate_Contours(
         throw std::invalid_argument("Seed contour in B contains insufficient vertices. Cannot continue.");
     }
 
-    std::list< decltype(std::begin(amal.points)) > pseudo_verts;
-    const auto is_a_pseudo_vert = [&]( decltype(std::begin(amal.points)) it ) -> bool {
-        for(const auto &pv : pseudo_verts){
-            if( it == pv ) return true;
+    // Vertices are held contiguously so edges can be referred to by index. Each edge is identified by the index of its
+    // second vertex, so edge 0 joins the last and first vertices.
+    std::vector<vec3<double>> amal_verts( std::begin(amal.points), std::end(amal.points) );
+    std::vector<bool> amal_is_pseudo( amal_verts.size(), false );
+
+    std::vector<std::vector<vec3<double>>> remaining;
+    for(const auto &cop_refw : B){
+        remaining.emplace_back( std::begin(cop_refw.get().points), std::end(cop_refw.get().points) );
+    }
+
+    const auto machine_eps = std::sqrt(10.0 * std::numeric_limits<double>::epsilon() );
+    while(!remaining.empty()){
+        // Index the midpoints of the (non-degenerate) edges of all remaining candidate contours.
+        //
+        // The fusion criteria (the sum of the two bridging edge lengths) is bounded from below by twice the distance
+        // between edge midpoints, so only edges with nearby midpoints need to be evaluated.
+        struct b_edge_t {
+            size_t cop;
+            size_t v2;
+        };
+        std::vector<b_edge_t> b_edges;
+        std::vector<vec3<double>> b_midpoints;
+        for(size_t c = 0; c < remaining.size(); ++c){
+            const auto &verts = remaining[c];
+            const auto N = verts.size();
+            for(size_t v2 = 0; v2 < N; ++v2){
+                const auto &b_v1 = verts[(v2 == 0) ? (N - 1) : (v2 - 1)];
+                const auto &b_v2 = verts[v2];
+                if(b_v1.distance(b_v2) < machine_eps) continue;
+                b_edges.push_back( b_edge_t{ c, v2 } );
+                b_midpoints.emplace_back( (b_v1 + b_v2) * 0.5 );
+            }
         }
-        return false;
-    };
+        const point_kd_tree b_tree(b_midpoints);
 
-    while(true){
+        // Ties are broken in favour of the earliest contour, then the earliest amal edge, then the earliest contour
+        // edge, which is the order in which an exhaustive search would encounter them.
         double shortest_criteria = std::numeric_limits<double>::infinity();
-        auto closest_cop = std::begin(B);
-        decltype(std::begin(amal.points)) closest_a_v1_it;
-        decltype(std::begin(amal.points)) closest_a_v2_it;
-        decltype(std::begin(B.front().get().points)) closest_b_v1_it;
-        decltype(std::begin(B.front().get().points)) closest_b_v2_it;
-        vec3<double> closest_edge_1_midpoint;
-        vec3<double> closest_edge_2_midpoint;
-
-        // Cycle through all remaining candidate contours.
-        for(auto b_it = std::begin(B); b_it != std::end(B); ++b_it){
-            // Cycle through edge-edge pairings to identify a reasonable place to fuse contours.
-            auto a_v1_it = std::prev(std::end(amal.points));
-            auto a_v2_it = std::begin(amal.points);
+        std::array<size_t, 3> closest = {{ 0, 0, 0 }}; // Contour, amal edge, contour edge.
+
+        const auto N_amal = amal_verts.size();
+        for(size_t a_v2 = 0; a_v2 < N_amal; ++a_v2){
+            const auto a_v1 = (a_v2 == 0) ? (N_amal - 1) : (a_v2 - 1);
 
             // Disregard this edge if any of the verts are ficticious.
-            if( is_a_pseudo_vert(a_v1_it)
-            ||  is_a_pseudo_vert(a_v2_it) ){
+            if( amal_is_pseudo[a_v1]
+            ||  amal_is_pseudo[a_v2] ){
                 continue;
             }
 
-            const auto a_end = std::end(amal.points);
-            while(a_v2_it != a_end){
-                auto b_v1_it = std::prev(std::end(b_it->get().points));
-                auto b_v2_it = std::begin(b_it->get().points);
-                const auto b_end = std::end(b_it->get().points);
-                while(b_v2_it != b_end){
-
-                    const auto d_a = a_v1_it->distance( *a_v2_it );
-                    const auto d_b = b_v1_it->distance( *b_v2_it );
-                    
-                    const auto machine_eps = std::sqrt(10.0 * std::numeric_limits<double>::epsilon() );
-                    if( (d_a < machine_eps)
-                    ||  (d_b < machine_eps) ){
-                        b_v1_it = b_v2_it;
-                        ++b_v2_it;
-                        continue;
-                    }
-
-                    const auto edge_1_length = a_v1_it->distance( *b_v2_it );
-                    const auto edge_2_length = a_v2_it->distance( *b_v1_it );
-
-                    //const auto edge_1 = line_segment<double>(*a_v1_it, *b_v2_it);
-                    //const auto edge_2 = line_segment<double>(*a_v2_it, *b_v1_it);
-                    //const auto edge_1_centroid_dist = edge_1.Closest_Point_To(centroid_A).distance(centroid_A);
-                    //const auto edge_2_centroid_dist = edge_2.Closest_Point_To(centroid_A).distance(centroid_A);
-
-                    //const auto total_criteria = edge_1_length + edge_2_length + edge_1_centroid_dist + edge_2_centroid_dist;
-                    const auto total_criteria = edge_1_length + edge_2_length;
-
-                    if( !std::isfinite(shortest_criteria)
-                    ||  (total_criteria < shortest_criteria) ){
-                        shortest_criteria = total_criteria;
-                        closest_cop = b_it;
-                        closest_a_v1_it = a_v1_it;
-                        closest_a_v2_it = a_v2_it;
-                        closest_b_v1_it = b_v1_it;
-                        closest_b_v2_it = b_v2_it;
-                        closest_edge_1_midpoint = (*a_v1_it + *b_v2_it) * 0.5;
-                        closest_edge_2_midpoint = (*a_v2_it + *b_v1_it) * 0.5;
-                    }
-                    b_v1_it = b_v2_it;
-                    ++b_v2_it;
+            const auto &a_p1 = amal_verts[a_v1];
+            const auto &a_p2 = amal_verts[a_v2];
+            if(a_p1.distance(a_p2) < machine_eps) continue;
+            const auto a_midpoint = (a_p1 + a_p2) * 0.5;
+
+            const auto evaluate = [&](long int e) -> void {
+                const auto &b_edge = b_edges[e];
+                const auto &verts = remaining[b_edge.cop];
+                const auto N = verts.size();
+                const auto &b_p1 = verts[(b_edge.v2 == 0) ? (N - 1) : (b_edge.v2 - 1)];
+                const auto &b_p2 = verts[b_edge.v2];
+
+                const auto edge_1_length = a_p1.distance( b_p2 );
+                const auto edge_2_length = a_p2.distance( b_p1 );
+                const auto total_criteria = edge_1_length + edge_2_length;
+                if(!std::isfinite(total_criteria)) return;
+
+                const std::array<size_t, 3> candidate = {{ b_edge.cop, a_v2, b_edge.v2 }};
+                if( (total_criteria < shortest_criteria)
+                ||  ((total_criteria == shortest_criteria) && (candidate < closest)) ){
+                    shortest_criteria = total_criteria;
+                    closest = candidate;
                 }
-                a_v1_it = a_v2_it;
-                ++a_v2_it;
+                return;
+            };
+
+            const auto nearest = b_tree.nearest(a_midpoint);
+            if(nearest.index < 0) continue;
+            evaluate(nearest.index);
+
+            // Slightly inflate the search radius so rounding cannot exclude ties.
+            const auto radius = 0.5 * shortest_criteria * (1.0 + 1.0E-9) + machine_eps;
+            if(radius < std::sqrt(nearest.sq_dist)) continue;
+            for(const auto &n : b_tree.within_radius(a_midpoint, radius)){
+                evaluate(n.index);
             }
         }
 
@@ -704,43 +721,136 @@ Minimally_Amalgamate_Contours(
             break;
         }
 
-        // Adjust the closest contour so the selected edges break naturally at the list front and back.
-        //std::rotate( std::begin(closest_cop->points),
-        //             closest_b_v1_it,
-        //             std::end(closest_cop->points) );
-        contour_of_points<double> cop_copy;
-        cop_copy.closed = true;
-        if( closest_b_v2_it == std::begin(closest_cop->get().points) ){
-            cop_copy.points.insert( std::end(cop_copy.points),
-                                    std::begin(closest_cop->get().points),
-                                    std::end(closest_cop->get().points) );
-        }else{
-            cop_copy.points.insert( std::end(cop_copy.points),
-                                    closest_b_v2_it,
-                                    std::end(closest_cop->get().points) );
-            cop_copy.points.insert( std::end(cop_copy.points),
-                                    std::begin(closest_cop->get().points),
-                                    closest_b_v2_it );
-        }
-
-        // Insert ficticious verts on the front and back.
+        // Rotate the closest contour so the selected edge breaks naturally at the front and back, and insert ficticious
+        // verts on the front and back.
         //
         // Note: these vertices are offset so that later contour interpolation (i.e., mesh "slicing") on the original
         //       planes will return (approximately) the original contours.
         //
-        cop_copy.points.emplace_front(closest_edge_1_midpoint + pseudo_vert_offset);
-        cop_copy.points.emplace_back(closest_edge_2_midpoint + pseudo_vert_offset);
-        pseudo_verts.emplace_back( std::begin(cop_copy.points) );
-        pseudo_verts.emplace_back( std::prev( std::end(cop_copy.points) ) );
-        
+        const auto &[closest_cop, closest_a_v2, closest_b_v2] = closest;
+        const auto closest_a_v1 = (closest_a_v2 == 0) ? (N_amal - 1) : (closest_a_v2 - 1);
+        const auto &verts = remaining[closest_cop];
+        const auto closest_b_v1 = (closest_b_v2 == 0) ? (verts.size() - 1) : (closest_b_v2 - 1);
+        const auto closest_edge_1_midpoint = (amal_verts[closest_a_v1] + verts[closest_b_v2]) * 0.5;
+        const auto closest_edge_2_midpoint = (amal_verts[closest_a_v2] + verts[closest_b_v1]) * 0.5;
+
+        std::vector<vec3<double>> bridged;
+        bridged.reserve(verts.size() + 2);
+        bridged.emplace_back(closest_edge_1_midpoint + pseudo_vert_offset);
+        bridged.insert( std::end(bridged), std::next(std::begin(verts), closest_b_v2), std::end(verts) );
+        bridged.insert( std::end(bridged), std::begin(verts), std::next(std::begin(verts), closest_b_v2) );
+        bridged.emplace_back(closest_edge_2_midpoint + pseudo_vert_offset);
+
+        std::vector<bool> bridged_is_pseudo(bridged.size(), false);
+        bridged_is_pseudo.front() = true;
+        bridged_is_pseudo.back() = true;
 
         // Merge the points into amal.
-        amal.points.splice( closest_a_v2_it, // Before this point.
-                            cop_copy.points );
+        amal_verts.insert( std::next(std::begin(amal_verts), closest_a_v2), // Before this point.
+                           std::begin(bridged), std::end(bridged) );
+        amal_is_pseudo.insert( std::next(std::begin(amal_is_pseudo), closest_a_v2),
+                               std::begin(bridged_is_pseudo), std::end(bridged_is_pseudo) );
 
-        B.erase(closest_cop);
+        remaining.erase( std::next(std::begin(remaining), closest_cop) );
     }
 
+    amal.points.assign( std::begin(amal_verts), std::end(amal_verts) );
+
     return amal;
 }
 
+
+fv_surface_mesh<double, uint64_t>
+Join_Meshes(
+        const std::vector<fv_surface_mesh<double, uint64_t>> &meshes,
+        double distance_eps ){
+
+    if( !std::isfinite(distance_eps)
+    ||  (distance_eps <= 0.0) ){
+        throw std::invalid_argument("Vertex merge distance must be positive and finite. Cannot continue.");
+    }
+    fv_surface_mesh<double, uint64_t> out;
+
+    // Vertices are bucketed on a grid with cells as wide as the merge distance, so any vertex within the merge distance
+    // will be found in one of the 27 cells surrounding a given vertex.
+    using cell_t = std::array<int64_t, 3>;
+    struct cell_hash {
+        size_t operator()(const cell_t &c) const {
+            size_t h = 0;
+            for(const auto &x : c){
+                h ^= std::hash<int64_t>()(x) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+    };
+    std::unordered_map<cell_t, std::vector<uint64_t>, cell_hash> buckets;
+
+    const auto eps = distance_eps;
+    const auto max_cell = static_cast<double>(std::numeric_limits<int64_t>::max() / 4);
+    const auto to_cell = [&](const vec3<double> &p, cell_t &c) -> bool {
+        const std::array<double, 3> r = {{ p.x, p.y, p.z }};
+        for(size_t i = 0; i < 3; ++i){
+            const auto x = std::floor(r[i] / eps);
+            if( !std::isfinite(x)
+            ||  (max_cell < std::abs(x)) ) return false;
+            c[i] = static_cast<int64_t>(x);
+        }
+        return true;
+    };
+
+    const auto insert_vertex = [&](const vec3<double> &p) -> uint64_t {
+        cell_t c;
+        if(!to_cell(p, c)){
+            // Vertices that cannot be bucketed are never merged.
+            out.vertices.emplace_back(p);
+            return static_cast<uint64_t>(out.vertices.size() - 1);
+        }
+
+        std::optional<uint64_t> match;
+        for(int64_t dx = -1; dx <= 1; ++dx){
+            for(int64_t dy = -1; dy <= 1; ++dy){
+                for(int64_t dz = -1; dz <= 1; ++dz){
+                    const auto it = buckets.find( cell_t{{ c[0] + dx, c[1] + dy, c[2] + dz }} );
+                    if(it == std::end(buckets)) continue;
+                    for(const auto &i : it->second){
+                        if( (!match || (i < match.value()))
+                        &&  (out.vertices[i].sq_dist(p) <= eps * eps) ){
+                            match = i;
+                        }
+                    }
+                }
+            }
+        }
+        if(match) return match.value();
+
+        out.vertices.emplace_back(p);
+        const auto i = static_cast<uint64_t>(out.vertices.size() - 1);
+        buckets[c].push_back(i);
+        return i;
+    };
+
+    size_t N_verts = 0;
+    size_t N_faces = 0;
+    for(const auto &m : meshes){
+        N_verts += m.vertices.size();
+        N_faces += m.faces.size();
+    }
+    out.vertices.reserve(N_verts);
+    out.faces.reserve(N_faces);
+
+    std::vector<uint64_t> index_map;
+    for(const auto &m : meshes){
+        index_map.clear();
+        index_map.reserve(m.vertices.size());
+        for(const auto &p : m.vertices) index_map.push_back( insert_vertex(p) );
+
+        for(const auto &f : m.faces){
+            out.faces.emplace_back();
+            out.faces.back().reserve(f.size());
+            for(const auto &i : f) out.faces.back().push_back( index_map.at(i) );
+        }
+    }
+
+    out.recreate_involved_face_index();
+    return out;
+}
@@ -19,6 +19,7 @@
 #include <utility>            //Needed for std::pair.
 #include <algorithm>
 #include <optional>
+#include <cstdint>
 
 // Low-level routine that joins the vertices of two contours.
 // Returns a list of faces where the vertex indices refer to A followed by B.
@@ -33,6 +34,13 @@ Minimally_Amalgamate_Contours(
         const vec3<double> &pseudo_vert_offset,
         std::list<std::reference_wrapper<contour_of_points<double>>> B );
 
+// Joins meshes into a single indexed mesh. Vertices within 'distance_eps' of a vertex that has already been added are
+// merged with it rather than being duplicated. Faces are retained in order.
+fv_surface_mesh<double, uint64_t>
+Join_Meshes(
+        const std::vector<fv_surface_mesh<double, uint64_t>> &meshes,
+        double distance_eps );
+
 /*
 Polyhedron
 Estimate_Surface_Mesh(
@@ -0,0 +1,251 @@
+//Slice_Cache.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+#include "YgorMisc.h"         //Needed for isininc().
+#include "YgorStats.h"        //Needed for Stats:: namespace.
+
+#include "Structs.h"
+#include "Colour_Maps.h"
+#include "Slice_Cache.h"
+
+
+std::shared_ptr<const projected_contours_t>
+Project_Contours_Onto_Slice(const planar_image<float,double> &img,
+                            const Contour_Data &cd,
+                            const std::function<bool(void)> &keep_going){
+
+    auto out = std::make_shared<projected_contours_t>();
+    const auto arb_pos_unit = img.row_unit.Cross(img.col_unit).unit();
+    const bool is_2D = ( img.pxl_dz <= std::numeric_limits<double>::min() ); // Permit contours on purely 2D images.
+
+    for(const auto & cc : cd.ccs){
+        for(const auto & c : cc.contours){
+            if( c.points.empty() ) continue;
+
+            // Permit contours with any included vertices or at least the 'centre' within the image.
+            if( !is_2D
+            &&  !img.sandwiches_point_within_top_bottom_planes(c.points.front())
+            &&  !img.encompasses_any_of_contour_of_points(c) ){
+                continue;
+            }
+
+            // If the caller has lost interest, terminate ASAP.
+            if( keep_going && !keep_going() ) return nullptr;
+
+            projected_contour pc;
+            pc.ROIName = c.GetMetadataValueAs<std::string>("ROIName").value_or("unknown");
+            pc.NormalizedROIName = c.GetMetadataValueAs<std::string>("NormalizedROIName").value_or("unknown");
+            pc.OutlineColour = c.GetMetadataValueAs<std::string>("OutlineColour");
+
+            vec3<double> c_orient;
+            try{ // Protect against degenerate contours. (Should we instead ignore them altogether?)
+                c_orient = c.Estimate_Planar_Normal();
+            }catch(const std::exception &){
+                c_orient = arb_pos_unit;
+            }
+            pc.positive_orientation = (c_orient.Dot(arb_pos_unit) > 0);
+            pc.contour = c;
+
+            out->emplace_back(std::move(pc));
+        }
+    }
+    return out;
+}
+
+
+std::shared_ptr<const windowed_slice>
+Window_Slice(const planar_image<float,double> &img,
+             long int img_channel,
+             const std::optional<double> &custom_centre,
+             const std::optional<double> &custom_width,
+             const std::function<ClampedColourRGB(double)> &colour_map,
+             const std::array<std::byte, 3> &nan_colour){
+
+    const auto img_cols = img.columns;
+    const auto img_rows = img.rows;
+    const auto img_chns = img.channels;
+
+    if(!isininc(1,img_rows,10000) || !isininc(1,img_cols,10000)){
+        throw std::invalid_argument("Image dimensions are not reasonable. Refusing to continue");
+    }
+    if(!isininc(1,img_channel+1,img_chns)){
+        throw std::invalid_argument("Image does not have selected channel. Refusing to continue");
+    }
+
+    auto out = std::make_shared<windowed_slice>();
+    out->rows = img_rows;
+    out->columns = img_cols;
+    auto &animage = out->rgb;
+    animage.reserve(img_cols * img_rows * 3);
+
+    // Prefer the quantized lookup table, which maps whole slices at once, when the colour map supports it.
+    const auto lut = Get_Colour_Map_LUT(colour_map);
+    const auto map_with_lut = [&](double scale, double offset) -> bool {
+        if( (lut == nullptr)
+        ||  !std::isfinite(scale)
+        ||  !std::isfinite(offset) ){
+            return false;
+        }
+        const Colour_Map_LUT::rgb_t nan_rgb = {{ static_cast<uint8_t>(nan_colour[0]),
+                                                 static_cast<uint8_t>(nan_colour[1]),
+                                                 static_cast<uint8_t>(nan_colour[2]) }};
+        animage.resize(img_cols * img_rows * 3);
+        lut->map_pixels(img.data.data() + img_channel, img_rows * img_cols, img_chns,
+                        scale, offset, nan_rgb, reinterpret_cast<uint8_t *>(animage.data()));
+        return true;
+    };
+
+    //------------------------------------------------------------------------------------------------
+    //Apply a window to the data if it seems like the WindowCenter or WindowWidth specified in the image metadata
+    // are applicable. Note that it is likely that pixels will be clipped or truncated. This is intentional.
+
+    auto img_win_valid = img.GetMetadataValueAs<std::string>("WindowValidFor");
+    auto img_desc      = img.GetMetadataValueAs<std::string>("Description");
+    auto img_win_c     = img.GetMetadataValueAs<double>("WindowCenter");
+    auto img_win_fw    = img.GetMetadataValueAs<double>("WindowWidth"); //Full width or range. (Diameter, not radius.)
+
+    auto custom_win_c  = custom_centre;
+    auto custom_win_fw = custom_width;
+
+    const auto UseCustomWL = (custom_win_c && custom_win_fw);
+    const auto UseImgWL = (UseCustomWL) ? false
+                                        : (   (img_chns == 1) // Only honour for single-channel images.
+                                           && img_win_valid
+                                           && img_desc
+                                           && img_win_c
+                                           && img_win_fw
+                                           && (img_win_valid.value() == img_desc.value()));
+
+    if( UseCustomWL || UseImgWL ){
+        //The 'radius' of the range, or half width omitting the centre point.
+        const auto win_r  = (UseCustomWL) ? 0.5*custom_win_fw.value()
+                                          : 0.5*img_win_fw.value();
+        const auto win_c  = (UseCustomWL) ? custom_win_c.value()
+                                          : img_win_c.value();
+        const auto win_fw = (UseCustomWL) ? custom_win_fw.value()
+                                          : img_win_fw.value();
+
+        if(map_with_lut( 1.0 / win_fw, -(win_c - win_r) / win_fw )) return out;
+
+        //The output range we are targeting. In this case, a commodity 8 bit (2^8 = 256 intensities) display.
+        const auto destmin = static_cast<double>( 0 );
+        const auto destmax = static_cast<double>( std::numeric_limits<uint8_t>::max() );
+
+        for(auto j = 0; j < img_rows; ++j){
+            for(auto i = 0; i < img_cols; ++i){
+                const auto val = static_cast<double>( img.value(j,i,img_channel) );
+                if(!std::isfinite(val)){
+                    animage.push_back( nan_colour[0] );
+                    animage.push_back( nan_colour[1] );
+                    animage.push_back( nan_colour[2] );
+                }else{
+                    double x; // range = [0,1].
+                    if(val <= (win_c - win_r)){
+                        x = 0.0;
+                    }else if(val >= (win_c + win_r)){
+                        x = 1.0;
+                    }else{
+                        x = (val - (win_c - win_r)) / win_fw;
+                    }
+
+                    const auto res = colour_map(x);
+                    const double out_R = res.R * (destmax - destmin) + destmin;
+                    const double out_G = res.G * (destmax - destmin) + destmin;
+                    const double out_B = res.B * (destmax - destmin) + destmin;
+
+                    animage.push_back( std::byte{ static_cast<uint8_t>( std::floor(out_R) ) } );
+                    animage.push_back( std::byte{ static_cast<uint8_t>( std::floor(out_G) ) } );
+                    animage.push_back( std::byte{ static_cast<uint8_t>( std::floor(out_B) ) } );
+                }
+            }
+        }
+
+    //------------------------------------------------------------------------------------------------
+    //Scale pixels to fill the maximum range. None will be clipped or truncated.
+    }else{
+        //Due to a strange dependence on windowing, some manufacturers spit out massive pixel values.
+        // If you don't want to window you need to anticipate and ignore the gigantic numbers being
+        // you might encounter. This is not the place to do this! If you need to do it here, write a
+        // filter routine and *call* it from here.
+        //
+        // NOTE: This routine could definitely use a re-working, especially to make it safe for all
+        //       arithmetical types (i.e., handling negatives, ensuring there is no overflow or wrap-
+        //       around, ensuring there is minimal precision loss).
+        using pixel_value_t = decltype(img.value(0, 0, 0));
+        Stats::Running_MinMax<pixel_value_t> rmm;
+        img.apply_to_pixels([&rmm,&img_channel](long int /*row*/,
+                                                long int /*col*/,
+                                                long int chnl,
+                                                pixel_value_t val) -> void {
+            if( (img_channel < 0)
+            ||  (chnl == img_channel) ) rmm.Digest(val);
+            return;
+        });
+        const auto lowest = rmm.Current_Min();
+        const auto highest = rmm.Current_Max();
+
+        const auto pixel_type_max = static_cast<double>(std::numeric_limits<pixel_value_t>::max());
+        const auto pixel_type_min = static_cast<double>(std::numeric_limits<pixel_value_t>::min());
+        const auto dest_type_max = static_cast<double>(std::numeric_limits<uint8_t>::max()); //Min is implicitly 0.
+
+        const double clamped_low  = static_cast<double>(lowest )/pixel_type_max;
+        const double clamped_high = static_cast<double>(highest)/pixel_type_max;
+
+        const double pixel_type_range = pixel_type_max - pixel_type_min;
+        const double clamped_range = clamped_high - clamped_low;
+        if(map_with_lut( 1.0 / (pixel_type_range * clamped_range),
+                         -(pixel_type_min / pixel_type_range + clamped_low) / clamped_range )) return out;
+
+        for(auto j = 0; j < img_rows; ++j){
+            for(auto i = 0; i < img_cols; ++i){
+                const auto val = img.value(j,i,img_channel);
+                if(!std::isfinite(val)){
+                    animage.push_back( nan_colour[0] );
+                    animage.push_back( nan_colour[1] );
+                    animage.push_back( nan_colour[2] );
+                }else{
+                    const double clamped_value = (static_cast<double>(val) - pixel_type_min)/(pixel_type_max - pixel_type_min);
+                    auto rescaled_value = (clamped_value - clamped_low)/(clamped_high - clamped_low);
+                    if( rescaled_value < 0.0 ){
+                        rescaled_value = 0.0;
+                    }else if( rescaled_value > 1.0 ){
+                        rescaled_value = 1.0;
+                    }
+
+                    const auto res = colour_map(rescaled_value);
+                    animage.push_back( std::byte{ static_cast<uint8_t>(res.R * dest_type_max) } );
+                    animage.push_back( std::byte{ static_cast<uint8_t>(res.G * dest_type_max) } );
+                    animage.push_back( std::byte{ static_cast<uint8_t>(res.B * dest_type_max) } );
+                }
+            }
+        }
+    }
+    return out;
+}
+
+
+std::vector<long int>
+Neighbouring_Slices(long int img_num, long int img_count, long int radius){
+    std::vector<long int> out;
+    if( (img_num < 0) || (img_count <= img_num) ) return out;
+    for(long int d = 1; d <= radius; ++d){
+        if((img_num + d) < img_count) out.push_back(img_num + d);
+        if(0 <= (img_num - d))        out.push_back(img_num - d);
+    }
+    return out;
+}
+
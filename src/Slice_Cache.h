@@ -0,0 +1,196 @@
+//Slice_Cache.h.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+
+#include "Colour_Maps.h"
+
+class Contour_Data;
+
+
+// A thread-safe, fixed-capacity least-recently-used cache.
+//
+// Values are returned by copy, so large values should be wrapped in a std::shared_ptr<const T>.
+template <class K, class V>
+class lru_cache {
+    private:
+        using item_t = std::pair<K,V>;
+        using items_t = std::list<item_t>;
+
+        mutable std::mutex m;
+        size_t cap;
+        items_t items; // Most recently used at the front.
+        std::map<K, typename items_t::iterator> lookup;
+
+        void evict(){
+            while(this->cap < this->items.size()){
+                this->lookup.erase(this->items.back().first);
+                this->items.pop_back();
+            }
+            return;
+        }
+
+    public:
+        explicit lru_cache(size_t capacity) : cap(capacity) {}
+
+        // Retrieve an item, marking it as most recently used.
+        std::optional<V> get(const K &k){
+            std::lock_guard<std::mutex> lock(this->m);
+            const auto it = this->lookup.find(k);
+            if(it == std::end(this->lookup)) return {};
+            this->items.splice(std::begin(this->items), this->items, it->second);
+            return it->second->second;
+        }
+
+        // Insert or replace an item, marking it as most recently used. Least recently used items are evicted.
+        void put(const K &k, V v){
+            std::lock_guard<std::mutex> lock(this->m);
+            const auto it = this->lookup.find(k);
+            if(it != std::end(this->lookup)){
+                it->second->second = std::move(v);
+                this->items.splice(std::begin(this->items), this->items, it->second);
+            }else{
+                this->items.emplace_front(k, std::move(v));
+                this->lookup[k] = std::begin(this->items);
+            }
+            this->evict();
+            return;
+        }
+
+        // Check for an item without altering its recency.
+        bool contains(const K &k) const {
+            std::lock_guard<std::mutex> lock(this->m);
+            return (this->lookup.count(k) != 0);
+        }
+
+        void clear(){
+            std::lock_guard<std::mutex> lock(this->m);
+            this->lookup.clear();
+            this->items.clear();
+            return;
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(this->m);
+            return this->items.size();
+        }
+
+        size_t capacity() const {
+            std::lock_guard<std::mutex> lock(this->m);
+            return this->cap;
+        }
+
+        void set_capacity(size_t capacity){
+            std::lock_guard<std::mutex> lock(this->m);
+            this->cap = capacity;
+            this->evict();
+            return;
+        }
+};
+
+
+// Identifies a single image slice. The epoch should be incremented whenever the underlying data could have changed so
+// that stale entries can never be retrieved.
+struct slice_key {
+    long int epoch = 0;
+    long int img_array_num = -1;
+    long int img_num = -1;
+
+    bool operator<(const slice_key &rhs) const {
+        return std::tie(this->epoch, this->img_array_num, this->img_num)
+             < std::tie(rhs.epoch, rhs.img_array_num, rhs.img_num);
+    }
+};
+
+// Identifies a single windowed and colour-mapped rendering of an image slice.
+struct windowed_slice_key {
+    slice_key slice;
+    long int channel = 0;
+    size_t colour_map = 0;
+    bool custom_window = false;
+    double custom_centre = 0.0;
+    double custom_width = 0.0;
+
+    bool operator<(const windowed_slice_key &rhs) const {
+        return std::tie(this->slice, this->channel, this->colour_map,
+                        this->custom_window, this->custom_centre, this->custom_width)
+             < std::tie(rhs.slice, rhs.channel, rhs.colour_map,
+                        rhs.custom_window, rhs.custom_centre, rhs.custom_width);
+    }
+};
+
+
+// A contour that has been determined to lie on a specific slice, along with the properties needed to draw it.
+struct projected_contour {
+    std::string ROIName;
+    std::string NormalizedROIName;
+    std::optional<std::string> OutlineColour;
+    bool positive_orientation = true; // Relative to the slice's row x column normal.
+    contour_of_points<double> contour;
+};
+using projected_contours_t = std::vector<projected_contour>;
+
+// 8-bit RGB pixels, row-major.
+struct windowed_slice {
+    long int rows = 0;
+    long int columns = 0;
+    std::vector<std::byte> rgb;
+};
+
+
+// Identify the contours that should be displayed on the given slice.
+//
+// The optional predicate is polled periodically; if it returns false the search is abandoned and nullptr is returned.
+std::shared_ptr<const projected_contours_t>
+Project_Contours_Onto_Slice(const planar_image<float,double> &img,
+                            const Contour_Data &cd,
+                            const std::function<bool(void)> &keep_going = std::function<bool(void)>());
+
+// Apply a window and colour map to a single image channel, producing 8-bit RGB pixels.
+//
+// If a custom window is not provided, the window specified in the image metadata is used when it is applicable.
+// Otherwise, the full range of pixel values is mapped.
+std::shared_ptr<const windowed_slice>
+Window_Slice(const planar_image<float,double> &img,
+             long int channel,
+             const std::optional<double> &custom_centre,
+             const std::optional<double> &custom_width,
+             const std::function<ClampedColourRGB(double)> &colour_map,
+             const std::array<std::byte, 3> &nan_colour);
+
+// Image numbers adjacent to the given image, nearest first (alternating after, then before), that should be
+// prefetched. Numbers outside [0, img_count) are omitted.
+std::vector<long int>
+Neighbouring_Slices(long int img_num, long int img_count, long int radius);
+
+
+// Caches for preprocessed per-slice data that is independent of the renderer.
+struct slice_cache {
+    lru_cache<slice_key, std::shared_ptr<const projected_contours_t>> contours;
+    lru_cache<windowed_slice_key, std::shared_ptr<const windowed_slice>> pixels;
+
+    explicit slice_cache(size_t contour_capacity = 2048, size_t pixel_capacity = 64)
+        : contours(contour_capacity), pixels(pixel_capacity) {}
+
+    void clear(){
+        this->contours.clear();
+        this->pixels.clear();
+        return;
+    }
+};
+
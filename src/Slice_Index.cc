@@ -0,0 +1,266 @@
+//Slice_Index.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+
+#include "Slice_Index.h"
+
+
+Slice_Index::geometry_t Slice_Index::geometry_t::from(const img_t &img){
+    geometry_t out;
+    out.addr     = &img;
+    out.offset   = img.offset;
+    out.row_unit = img.row_unit;
+    out.col_unit = img.col_unit;
+    out.pxl_dz   = img.pxl_dz;
+    return out;
+}
+
+bool Slice_Index::geometry_t::operator==(const geometry_t &rhs) const {
+    return (this->addr == rhs.addr)
+        && (this->offset == rhs.offset)
+        && (this->row_unit == rhs.row_unit)
+        && (this->col_unit == rhs.col_unit)
+        && (this->pxl_dz == rhs.pxl_dz);
+}
+
+
+Slice_Index::Slice_Index(planar_image_collection<float,double> &imagecoll) : imagecoll(imagecoll) {}
+
+bool Slice_Index::is_current() const {
+    if(!this->built) return false;
+    if(this->N_images != this->imagecoll.images.size()) return false;
+    if(this->imagecoll.images.empty()) return true;
+    return (this->first == geometry_t::from(this->imagecoll.images.front()))
+        && (this->last  == geometry_t::from(this->imagecoll.images.back()));
+}
+
+void Slice_Index::build(){
+    this->built = false;
+    this->indexed = false;
+    this->regular = false;
+    this->regular_spacing = 0.0;
+    this->tolerance = 0.0;
+    this->max_deviation = 0.0;
+    this->max_offset = 0.0;
+    this->slices.clear();
+    this->max_upper.clear();
+
+    this->N_images = this->imagecoll.images.size();
+    if(!this->imagecoll.images.empty()){
+        this->first = geometry_t::from(this->imagecoll.images.front());
+        this->last  = geometry_t::from(this->imagecoll.images.back());
+
+        const auto &front = this->imagecoll.images.front();
+        this->normal = front.row_unit.Cross( front.col_unit ).unit();
+        this->indexed = this->normal.isfinite();
+    }
+
+    // Project each image onto the stack normal. Images are only required to be parallel, so the images' own normals
+    // may be antiparallel to the stack normal.
+    double max_extent = 0.0;
+    size_t order = 0;
+    for(auto it = std::begin(this->imagecoll.images); this->indexed && (it != std::end(this->imagecoll.images)); ++it, ++order){
+        auto n = it->row_unit.Cross( it->col_unit ).unit();
+        if(n.Dot(this->normal) < 0.0) n = n * -1.0;
+        const auto deviation = (n - this->normal).length();
+        const auto centre = it->offset.Dot(this->normal);
+        const auto half_thickness = std::abs(it->pxl_dz) * 0.5;
+        if( !std::isfinite(deviation)
+        ||  (1.0E-6 < deviation)
+        ||  !std::isfinite(centre)
+        ||  !std::isfinite(half_thickness) ){
+            this->indexed = false;
+            break;
+        }
+        this->max_deviation = std::max(this->max_deviation, deviation);
+        this->max_offset = std::max(this->max_offset, it->offset.length());
+        max_extent = std::max(max_extent, std::abs(centre) + half_thickness);
+
+        slice_t s;
+        s.lower  = centre - half_thickness;
+        s.upper  = centre + half_thickness;
+        s.order  = order;
+        s.img_it = it;
+        this->slices.push_back(s);
+    }
+
+    if(!this->indexed){
+        this->slices.clear();
+
+    }else{
+        std::sort(std::begin(this->slices), std::end(this->slices), [](const slice_t &L, const slice_t &R) -> bool {
+            return (L.lower == R.lower) ? (L.order < R.order)
+                                        : (L.lower < R.lower);
+        });
+        this->tolerance = 1.0E-9 * (1.0 + max_extent);
+
+        // Regular stacks have uniform thickness and uniform, non-zero spacing.
+        const auto N = this->slices.size();
+        if(2 <= N){
+            const auto thickness = this->slices.front().upper - this->slices.front().lower;
+            const auto spacing = this->slices[1].lower - this->slices[0].lower;
+            this->regular = (this->tolerance < spacing);
+            for(size_t i = 1; this->regular && (i < N); ++i){
+                const auto &s = this->slices[i];
+                this->regular = (std::abs((s.upper - s.lower) - thickness) <= this->tolerance)
+                             && (std::abs((s.lower - this->slices[i-1].lower) - spacing) <= this->tolerance);
+            }
+            if(this->regular){
+                this->regular_spacing = (this->slices.back().lower - this->slices.front().lower)
+                                      / static_cast<double>(N - 1);
+            }
+        }
+
+        this->max_upper.resize(N);
+        this->build_tree(0, N);
+    }
+
+    this->built = true;
+    return;
+}
+
+std::shared_lock<std::shared_mutex> Slice_Index::lock_current(){
+    while(true){
+        {
+            std::shared_lock<std::shared_mutex> lock(this->m);
+            if(this->is_current()) return lock;
+        }
+        std::unique_lock<std::shared_mutex> lock(this->m);
+        if(!this->is_current()) this->build();
+    }
+}
+
+// The tree is implicit: the root of the subtree spanning [beg, end) is the middle slice, so each subtree's slices are
+// contiguous and sorted by lower extent.
+double Slice_Index::build_tree(size_t beg, size_t end){
+    if(end <= beg) return -std::numeric_limits<double>::infinity();
+    const auto mid = beg + (end - beg) / 2;
+    const auto u = std::max({ this->slices[mid].upper,
+                              this->build_tree(beg, mid),
+                              this->build_tree(mid + 1, end) });
+    this->max_upper[mid] = u;
+    return u;
+}
+
+void Slice_Index::query_tree(size_t beg, size_t end, double lower, double upper, std::vector<size_t> &out) const {
+    if(end <= beg) return;
+    const auto mid = beg + (end - beg) / 2;
+    if(this->max_upper[mid] < lower) return; // Nothing in this subtree extends far enough.
+
+    this->query_tree(beg, mid, lower, upper, out);
+
+    // Every slice to the right begins at or after this slice.
+    if(upper < this->slices[mid].lower) return;
+    if(lower <= this->slices[mid].upper) out.push_back(mid);
+
+    this->query_tree(mid + 1, end, lower, upper, out);
+    return;
+}
+
+std::vector<size_t> Slice_Index::overlapping(double lower, double upper) const {
+    std::vector<size_t> out;
+    if( !this->indexed
+    ||  this->slices.empty()
+    ||  !std::isfinite(lower)
+    ||  !std::isfinite(upper) ) return out;
+
+    if(this->regular){
+        // Estimate the range of slices arithmetically, conservatively widening it to absorb rounding.
+        const auto N = this->slices.size();
+        const auto &s0 = this->slices.front();
+        const auto thickness = s0.upper - s0.lower;
+        const auto i_lo = std::floor((lower - s0.lower - thickness) / this->regular_spacing);
+        const auto i_hi = std::ceil((upper - s0.lower) / this->regular_spacing);
+        if( (i_hi < 0.0) || (static_cast<double>(N) <= i_lo) ) return out;
+
+        const auto beg = (i_lo < 0.0) ? static_cast<size_t>(0) : static_cast<size_t>(i_lo);
+        const auto end = (static_cast<double>(N) <= i_hi) ? N : (static_cast<size_t>(i_hi) + 1);
+        for(size_t i = beg; i < end; ++i){
+            if( (this->slices[i].lower <= upper)
+            &&  (lower <= this->slices[i].upper) ) out.push_back(i);
+        }
+
+    }else{
+        this->query_tree(0, this->slices.size(), lower, upper, out);
+    }
+    return out;
+}
+
+template <class F>
+std::list<Slice_Index::img_it_t> Slice_Index::confirmed_candidates(const vec3<double> &pos, F f_confirm){
+    auto lock = this->lock_current();
+
+    std::list<img_it_t> out;
+    if(!this->indexed){
+        for(auto it = std::begin(this->imagecoll.images); it != std::end(this->imagecoll.images); ++it){
+            if(f_confirm(*it)) out.push_back(it);
+        }
+        return out;
+    }
+
+    // Images' normals can differ slightly from the stack normal, so widen the search enough to account for the
+    // discrepancy at this position.
+    const auto z = pos.Dot(this->normal);
+    const auto pad = this->tolerance + this->max_deviation * (pos.length() + this->max_offset);
+    auto candidates = this->overlapping(z - pad, z + pad);
+    std::sort(std::begin(candidates), std::end(candidates), [&](size_t L, size_t R) -> bool {
+        return (this->slices[L].order < this->slices[R].order);
+    });
+    for(const auto &i : candidates){
+        if(f_confirm(*(this->slices[i].img_it))) out.push_back(this->slices[i].img_it);
+    }
+    return out;
+}
+
+void Slice_Index::invalidate(){
+    std::unique_lock<std::shared_mutex> lock(this->m);
+    this->built = false;
+    return;
+}
+
+bool Slice_Index::is_indexed(){
+    auto lock = this->lock_current();
+    return this->indexed;
+}
+
+std::optional<vec3<double>> Slice_Index::stack_normal(){
+    auto lock = this->lock_current();
+    if(!this->indexed) return {};
+    return this->normal;
+}
+
+std::list<Slice_Index::img_it_t> Slice_Index::get_images_at_offset(double z){
+    auto lock = this->lock_current();
+
+    std::list<img_it_t> out;
+    auto candidates = this->overlapping(z, z);
+    std::sort(std::begin(candidates), std::end(candidates), [&](size_t L, size_t R) -> bool {
+        return (this->slices[L].order < this->slices[R].order);
+    });
+    for(const auto &i : candidates) out.push_back(this->slices[i].img_it);
+    return out;
+}
+
+std::list<Slice_Index::img_it_t> Slice_Index::get_images_which_sandwich_point(const vec3<double> &pos){
+    return this->confirmed_candidates(pos, [&](const img_t &img) -> bool {
+        return img.sandwiches_point_within_top_bottom_planes(pos);
+    });
+}
+
+std::list<Slice_Index::img_it_t> Slice_Index::get_images_which_encompass_point(const vec3<double> &pos){
+    return this->confirmed_candidates(pos, [&](const img_t &img) -> bool {
+        return img.encompasses_point(pos);
+    });
+}
+
@@ -0,0 +1,112 @@
+//Slice_Index.h.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for vec3 class.
+
+
+// An acceleration index for locating the images of a collection that contain a given position.
+//
+// Searches like planar_image_collection::get_images_which_encompass_point() scan every image, which is costly when
+// performed per-voxel or per-contour. This index projects each image onto the stack normal, giving an interval (the
+// image thickness) along the normal. Regularly-spaced stacks are then searched arithmetically in O(1), and irregular or
+// overlapping stacks are searched with an augmented interval tree in O(log(N) + K) for K overlapping images. Candidates
+// are always confirmed with the images' own predicates, so results are identical to an exhaustive scan.
+//
+// The index is built lazily when first queried. Adding or removing images, or altering the geometry of the first or
+// last image, is detected and triggers a rebuild; other in-place geometry changes should be followed by invalidate().
+// Collections containing non-parallel images are not indexed, and queries fall back to exhaustive scans.
+//
+// Queries are safe to perform concurrently, but image geometry must not be altered while a query is in progress.
+class Slice_Index {
+  public:
+    using img_t = planar_image<float,double>;
+    using img_it_t = std::list<img_t>::iterator;
+
+  private:
+    struct slice_t {
+        double lower = 0.0; // Extent along the stack normal.
+        double upper = 0.0;
+        size_t order = 0;   // Position within the collection, so results can be reported in collection order.
+        img_it_t img_it;
+    };
+
+    // Enough of an image's geometry to detect whether its position within the stack has changed.
+    struct geometry_t {
+        const img_t *addr = nullptr;
+        vec3<double> offset;
+        vec3<double> row_unit;
+        vec3<double> col_unit;
+        double pxl_dz = 0.0;
+
+        static geometry_t from(const img_t &img);
+        bool operator==(const geometry_t &rhs) const;
+    };
+
+    planar_image_collection<float,double> &imagecoll;
+
+    mutable std::shared_mutex m;
+    bool built = false;
+    bool indexed = false;          // Whether the images could be indexed.
+    size_t N_images = 0;
+    geometry_t first;
+    geometry_t last;
+
+    vec3<double> normal;
+    double tolerance = 0.0;        // Numerical tolerance for extents along the normal.
+    double max_deviation = 0.0;    // Largest difference between an image's normal and the stack normal.
+    double max_offset = 0.0;       // Largest image offset magnitude.
+    std::vector<slice_t> slices;   // Sorted by lower extent.
+    std::vector<double> max_upper; // Largest upper extent within the (implicit) subtree rooted at each slice.
+
+    bool regular = false;          // Uniform thickness and uniform spacing.
+    double regular_spacing = 0.0;
+
+    bool is_current() const;
+    void build();
+
+    // Rebuild the index if needed, and return a shared lock that keeps it current.
+    std::shared_lock<std::shared_mutex> lock_current();
+
+    double build_tree(size_t beg, size_t end);
+    void query_tree(size_t beg, size_t end, double lower, double upper, std::vector<size_t> &out) const;
+
+    // Indices of slices whose extent overlaps [lower, upper]. Requires a shared lock to be held.
+    std::vector<size_t> overlapping(double lower, double upper) const;
+
+    template <class F>
+    std::list<img_it_t> confirmed_candidates(const vec3<double> &pos, F f_confirm);
+
+  public:
+    explicit Slice_Index(planar_image_collection<float,double> &imagecoll);
+
+    Slice_Index(const Slice_Index &) = delete;
+    Slice_Index &operator=(const Slice_Index &) = delete;
+
+    // Discard the index. It will be rebuilt when next needed.
+    void invalidate();
+
+    // Whether the images are parallel and can therefore be indexed along a common normal.
+    bool is_indexed();
+
+    // The unit normal of the stack, if the images could be indexed.
+    std::optional<vec3<double>> stack_normal();
+
+    // Images with extent along the stack normal that covers the given signed distance along the stack normal, i.e.,
+    // 'which slices contain z.' Nothing is returned if the images could not be indexed.
+    std::list<img_it_t> get_images_at_offset(double z);
+
+    // Equivalent to checking planar_image::sandwiches_point_within_top_bottom_planes() for every image.
+    std::list<img_it_t> get_images_which_sandwich_point(const vec3<double> &pos);
+
+    // Equivalent to planar_image_collection::get_images_which_encompass_point().
+    std::list<img_it_t> get_images_which_encompass_point(const vec3<double> &pos);
+};
+
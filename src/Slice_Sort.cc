@@ -0,0 +1,36 @@
+//Slice_Sort.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <cmath>
+#include <optional>
+#include <string>
+
+#include "Slice_Sort.h"
+
+
+namespace {
+
+// Returns -1, 0, or 1. Absent values order after present values.
+template <class T>
+int compare_optional(const std::optional<T> &lhs, const std::optional<T> &rhs){
+    if( lhs && !rhs ) return -1;
+    if( !lhs && rhs ) return 1;
+    if( !lhs && !rhs ) return 0;
+    if(lhs.value() < rhs.value()) return -1;
+    if(rhs.value() < lhs.value()) return 1;
+    return 0;
+}
+
+std::optional<double> finite_or_absent(const std::optional<double> &x){
+    if( x && std::isnan(x.value()) ) return std::nullopt;
+    return x;
+}
+
+} // namespace
+
+bool operator<(const slice_sort_key &lhs, const slice_sort_key &rhs){
+    if(const auto c = compare_optional(lhs.patient_id, rhs.patient_id); c != 0) return (c < 0);
+    if(const auto c = compare_optional(lhs.modality, rhs.modality); c != 0) return (c < 0);
+    if(const auto c = compare_optional(finite_or_absent(lhs.slice_location),
+                                       finite_or_absent(rhs.slice_location)); c != 0) return (c < 0);
+    return (compare_optional(lhs.instance_number, rhs.instance_number) < 0);
+}
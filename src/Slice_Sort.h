@@ -0,0 +1,54 @@
+//Slice_Sort.h.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// A composite, typed sort key for image slices.
+//
+// Keys are meant to be extracted once per slice so that comparisons do not repeatedly look up and parse metadata.
+// Ordering is by PatientID, then Modality (both lexicographic), then SliceLocation, then InstanceNumber (both numeric).
+// This is the same order produced by consecutive stable sorts on InstanceNumber, SliceLocation, Modality, and
+// PatientID. Within each component, slices lacking a value are ordered after those that have one. NaN slice locations
+// are treated as absent.
+struct slice_sort_key {
+    std::optional<std::string> patient_id;
+    std::optional<std::string> modality;
+    std::optional<double> slice_location;
+    std::optional<long int> instance_number;
+};
+
+bool operator<(const slice_sort_key &lhs, const slice_sort_key &rhs);
+
+
+// Stably sorts a list using keys extracted exactly once per element.
+//
+// Elements are relinked rather than copied or moved, so references to them remain valid. Keys must be comparable with
+// operator<.
+template <class T, class F>
+void stable_sort_by_extracted_key(std::list<T> &l, F key_of){
+    using key_t = decltype(key_of(l.front()));
+    using it_t = typename std::list<T>::iterator;
+    if(l.size() < 2) return;
+
+    std::vector<std::pair<key_t, it_t>> keyed;
+    keyed.reserve(l.size());
+    for(auto it = std::begin(l); it != std::end(l); ++it){
+        keyed.emplace_back( key_of(*it), it );
+    }
+    std::stable_sort( std::begin(keyed), std::end(keyed),
+                      [](const auto &a, const auto &b){ return a.first < b.first; } );
+
+    // Moving each element to the end in sorted order leaves the list sorted.
+    for(auto &p : keyed){
+        l.splice( std::end(l), l, p.second );
+    }
+    return;
+}
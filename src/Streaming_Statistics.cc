@@ -0,0 +1,290 @@
+//Streaming_Statistics.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Streaming_Statistics.h"
+
+
+// ------------------------------------------------ stream_moments ----------------------------------------------------
+
+void stream_moments::digest(double x){
+    ++this->count;
+    if(x < this->min) this->min = x;
+    if(this->max < x) this->max = x;
+
+    const auto delta = x - this->mean;
+    this->mean += delta / static_cast<double>(this->count);
+    this->m2 += delta * (x - this->mean);
+    return;
+}
+
+void stream_moments::merge(const stream_moments &rhs){
+    if(rhs.count == 0) return;
+    if(this->count == 0){
+        *this = rhs;
+        return;
+    }
+
+    const auto n_l = static_cast<double>(this->count);
+    const auto n_r = static_cast<double>(rhs.count);
+    const auto n = n_l + n_r;
+    const auto delta = rhs.mean - this->mean;
+
+    this->mean += delta * n_r / n;
+    this->m2 += rhs.m2 + delta * delta * n_l * n_r / n;
+    this->count += rhs.count;
+    this->min = std::min(this->min, rhs.min);
+    this->max = std::max(this->max, rhs.max);
+    return;
+}
+
+double stream_moments::variance() const {
+    if(this->count < 2) return std::numeric_limits<double>::quiet_NaN();
+    return this->m2 / static_cast<double>(this->count - 1);
+}
+
+
+// --------------------------------------------- streaming_histogram --------------------------------------------------
+
+streaming_histogram::streaming_histogram(double bin_width, long int max_bins)
+    : bin_width(bin_width), max_bins(max_bins) {
+    if( !std::isfinite(bin_width)
+    ||  (bin_width <= 0.0) ){
+        throw std::invalid_argument("Histogram bin width must be positive and finite");
+    }
+    if(max_bins < 1){
+        throw std::invalid_argument("Histogram must permit at least one bin");
+    }
+}
+
+bool streaming_histogram::reserve_bin(long int bin){
+    const auto size = static_cast<long int>(this->weights.size());
+    if(size == 0){
+        this->first_stored = bin;
+        this->weights.assign(1, 0.0);
+        return true;
+    }
+    if( (this->first_stored <= bin)
+    &&  (bin < (this->first_stored + size)) ){
+        return true;
+    }
+
+    const auto lo = std::min(this->first_stored, bin);
+    const auto hi = std::max(this->first_stored + size - 1, bin);
+    const auto needed = hi - lo + 1;
+    if(this->max_bins < needed){
+        this->overflow = true;
+        this->weights.clear();
+        this->weights.shrink_to_fit();
+        return false;
+    }
+
+    // Grow geometrically in the direction of the new bin so that gradually-drifting values remain cheap to bin.
+    const auto slack = std::min(size, this->max_bins - needed);
+    const auto new_lo = (bin < this->first_stored) ? (lo - slack) : lo;
+    const auto new_hi = (bin < this->first_stored) ? hi : (hi + slack);
+
+    std::vector<double> grown(new_hi - new_lo + 1, 0.0);
+    std::copy( std::begin(this->weights), std::end(this->weights),
+               std::next( std::begin(grown), this->first_stored - new_lo ) );
+    this->weights.swap(grown);
+    this->first_stored = new_lo;
+    return true;
+}
+
+void streaming_histogram::digest(double x, double weight){
+    if(!std::isfinite(x)) return;
+    this->moments.digest(x);
+    if(this->overflow) return;
+
+    // Guard against bin numbers that cannot be represented.
+    const auto bin_f = std::floor(x / this->bin_width);
+    if(!(std::abs(bin_f) < 1.0E18)){
+        this->overflow = true;
+        this->weights.clear();
+        return;
+    }
+    const auto bin = static_cast<long int>(bin_f);
+    if(!this->reserve_bin(bin)) return;
+    this->weights[bin - this->first_stored] += weight;
+    return;
+}
+
+void streaming_histogram::merge(const streaming_histogram &rhs){
+    if(rhs.bin_width != this->bin_width){
+        throw std::invalid_argument("Unable to merge histograms with differing bin widths");
+    }
+    this->moments.merge(rhs.moments);
+
+    if(rhs.overflow){
+        this->overflow = true;
+        this->weights.clear();
+        return;
+    }
+    if(this->overflow) return;
+
+    const auto N = rhs.get_bin_count();
+    if(N == 0) return;
+    const auto rhs_first = rhs.get_first_bin();
+    const auto rhs_last = rhs_first + N - 1;
+    if( !this->reserve_bin(rhs_first)
+    ||  !this->reserve_bin(rhs_last) ){
+        return;
+    }
+    for(long int bin = rhs_first; bin <= rhs_last; ++bin){
+        this->weights[bin - this->first_stored] += rhs.bin_weight(bin);
+    }
+    return;
+}
+
+long int streaming_histogram::get_first_bin() const {
+    if( this->overflow
+    ||  this->weights.empty() ) return 0;
+    return static_cast<long int>(std::floor(this->moments.min / this->bin_width));
+}
+
+long int streaming_histogram::get_bin_count() const {
+    if( this->overflow
+    ||  this->weights.empty() ) return 0;
+    const auto last = static_cast<long int>(std::floor(this->moments.max / this->bin_width));
+    return last - this->get_first_bin() + 1;
+}
+
+double streaming_histogram::bin_weight(long int bin) const {
+    const auto size = static_cast<long int>(this->weights.size());
+    if( (bin < this->first_stored)
+    ||  ((this->first_stored + size) <= bin) ){
+        return 0.0;
+    }
+    return this->weights[bin - this->first_stored];
+}
+
+double streaming_histogram::bin_lower(long int bin) const {
+    return static_cast<double>(bin) * this->bin_width;
+}
+
+double streaming_histogram::bin_centre(long int bin) const {
+    return (static_cast<double>(bin) + 0.5) * this->bin_width;
+}
+
+
+// ----------------------------------------------- quantile_sketch ----------------------------------------------------
+
+void quantile_sketch::bucket_store::add(long int bucket, long int count){
+    const auto size = static_cast<long int>(this->counts.size());
+    if(size == 0){
+        this->first_bucket = bucket;
+        this->counts.assign(1, 0);
+
+    }else if( (bucket < this->first_bucket)
+          ||  ((this->first_bucket + size) <= bucket) ){
+        // Grow geometrically in the direction of the new bucket.
+        const auto lo = std::min(this->first_bucket, bucket);
+        const auto hi = std::max(this->first_bucket + size - 1, bucket);
+        const auto new_lo = (bucket < this->first_bucket) ? (lo - size) : lo;
+        const auto new_hi = (bucket < this->first_bucket) ? hi : (hi + size);
+
+        std::vector<long int> grown(new_hi - new_lo + 1, 0);
+        std::copy( std::begin(this->counts), std::end(this->counts),
+                   std::next( std::begin(grown), this->first_bucket - new_lo ) );
+        this->counts.swap(grown);
+        this->first_bucket = new_lo;
+    }
+    this->counts[bucket - this->first_bucket] += count;
+    return;
+}
+
+void quantile_sketch::bucket_store::merge(const bucket_store &rhs){
+    const auto N = static_cast<long int>(rhs.counts.size());
+    for(long int i = 0; i < N; ++i){
+        if(rhs.counts[i] != 0) this->add(rhs.first_bucket + i, rhs.counts[i]);
+    }
+    return;
+}
+
+quantile_sketch::quantile_sketch(double relative_accuracy, double zero_threshold)
+    : alpha(relative_accuracy), zero_threshold(zero_threshold) {
+    if( !(0.0 < relative_accuracy)
+    ||  !(relative_accuracy < 1.0) ){
+        throw std::invalid_argument("Quantile sketch relative accuracy must be within (0,1)");
+    }
+    if( !std::isfinite(zero_threshold)
+    ||  !(0.0 < zero_threshold) ){
+        throw std::invalid_argument("Quantile sketch zero threshold must be positive and finite");
+    }
+    this->gamma = (1.0 + this->alpha) / (1.0 - this->alpha);
+    this->log_gamma = std::log(this->gamma);
+}
+
+long int quantile_sketch::bucket_of(double magnitude) const {
+    return static_cast<long int>(std::ceil(std::log(magnitude) / this->log_gamma));
+}
+
+double quantile_sketch::bucket_value(long int bucket) const {
+    // The midpoint (in the relative sense) of the bucket, which is within alpha of every value in the bucket.
+    return 2.0 * std::pow(this->gamma, static_cast<double>(bucket)) / (this->gamma + 1.0);
+}
+
+void quantile_sketch::digest(double x){
+    if(!std::isfinite(x)) return;
+    this->moments.digest(x);
+
+    const auto magnitude = std::abs(x);
+    if(magnitude < this->zero_threshold){
+        ++this->zero_count;
+    }else if(0.0 < x){
+        this->positive.add(this->bucket_of(magnitude), 1);
+    }else{
+        this->negative.add(this->bucket_of(magnitude), 1);
+    }
+    return;
+}
+
+void quantile_sketch::merge(const quantile_sketch &rhs){
+    if( (rhs.alpha != this->alpha)
+    ||  (rhs.zero_threshold != this->zero_threshold) ){
+        throw std::invalid_argument("Unable to merge quantile sketches with differing accuracy");
+    }
+    this->positive.merge(rhs.positive);
+    this->negative.merge(rhs.negative);
+    this->zero_count += rhs.zero_count;
+    this->moments.merge(rhs.moments);
+    return;
+}
+
+double quantile_sketch::quantile(double q) const {
+    if(this->moments.count == 0){
+        throw std::invalid_argument("Unable to estimate quantile: no values have been digested");
+    }
+    if( !(0.0 <= q)
+    ||  !(q <= 1.0) ){
+        throw std::invalid_argument("Quantile must be within [0,1]");
+    }
+    if(q == 0.0) return this->moments.min;
+    if(q == 1.0) return this->moments.max;
+
+    const auto rank = static_cast<long int>(std::floor(q * static_cast<double>(this->moments.count - 1)));
+    const auto clamp = [&](double x) -> double {
+        return std::clamp(x, this->moments.min, this->moments.max);
+    };
+
+    // Visit buckets in order of increasing value: negatives (largest magnitude first), zeros, then positives.
+    long int cumulative = 0;
+    for(long int i = static_cast<long int>(this->negative.counts.size()) - 1; 0 <= i; --i){
+        cumulative += this->negative.counts[i];
+        if(rank < cumulative) return clamp( -this->bucket_value(this->negative.first_bucket + i) );
+    }
+    cumulative += this->zero_count;
+    if(rank < cumulative) return clamp(0.0);
+
+    const auto N = static_cast<long int>(this->positive.counts.size());
+    for(long int i = 0; i < N; ++i){
+        cumulative += this->positive.counts[i];
+        if(rank < cumulative) return clamp( this->bucket_value(this->positive.first_bucket + i) );
+    }
+    return this->moments.max;
+}
@@ -0,0 +1,125 @@
+//Streaming_Statistics.h.
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+
+// Exact summary statistics of a stream of values: count, extrema, mean, and variance.
+//
+// The mean and variance are accumulated using Welford's method and combined using the pairwise update of Chan et al.,
+// so partial results computed independently (e.g., per image or per thread) can be merged without loss of accuracy.
+struct stream_moments {
+    long int count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double mean = 0.0;
+    double m2 = 0.0;   // Sum of squared deviations from the mean.
+
+    void digest(double x);
+    void merge(const stream_moments &rhs);
+
+    // Unbiased variance estimate. Requires at least two values, otherwise NaN is returned.
+    double variance() const;
+};
+
+
+// A fixed-width histogram whose bins are allocated on demand.
+//
+// Bins are anchored at zero, i.e., bin k covers [k*bin_width, (k+1)*bin_width), so the range of values need not be
+// known in advance and histograms with the same bin width can be merged. This permits histograms to be built in a
+// single pass, with independent partial histograms built concurrently and merged afterward.
+//
+// The number of bins is capped. If a value would require exceeding the cap, the histogram is marked as overflowed and
+// no further values are binned, though the summary statistics remain exact.
+class streaming_histogram {
+    private:
+        double bin_width;
+        long int max_bins;
+        long int first_stored = 0;     // The bin number of weights.front().
+        std::vector<double> weights;   // Storage may extend beyond the occupied bins to amortize growth.
+        stream_moments moments;
+        bool overflow = false;
+
+        // Extends the storage to include the given bin, or marks the histogram as overflowed.
+        bool reserve_bin(long int bin);
+
+    public:
+        explicit streaming_histogram(double bin_width, long int max_bins = 100000000);
+
+        // Non-finite values are ignored.
+        void digest(double x, double weight = 1.0);
+
+        // The histograms must have the same bin width.
+        void merge(const streaming_histogram &rhs);
+
+        double get_bin_width() const { return this->bin_width; }
+        bool overflowed() const { return this->overflow; }
+        const stream_moments & get_moments() const { return this->moments; }
+
+        // Bins spanning the smallest and largest values digested. Bins within this range may be empty.
+        // Both are zero if no values have been binned.
+        long int get_first_bin() const;
+        long int get_bin_count() const;
+        double bin_weight(long int bin) const;  // The total weight of the given bin (zero if not allocated).
+        double bin_lower(long int bin) const;   // The lower edge of the given bin.
+        double bin_centre(long int bin) const;
+};
+
+
+// A mergeable quantile sketch with bounded relative error.
+//
+// Values are counted in logarithmically-spaced buckets, such that every value in a bucket is within a relative
+// distance alpha (the 'relative accuracy') of the bucket's representative value. Quantile estimates are therefore
+// within alpha*|x| of the true quantile x, regardless of the distribution, with memory proportional to the log of the
+// dynamic range rather than the number of values. This is the 'DDSketch' of Masson et al. (2019).
+//
+// Sketches with the same relative accuracy can be merged exactly, so sketches can be built concurrently and combined.
+// Exact summary statistics are also maintained.
+//
+// Magnitudes smaller than zero_threshold are treated as zero to bound the number of buckets.
+class quantile_sketch {
+    private:
+        // Counts of logarithmically-spaced buckets for positive or negative values. Bucket k holds magnitudes in
+        // (gamma^(k-1), gamma^k].
+        struct bucket_store {
+            long int first_bucket = 0;
+            std::vector<long int> counts;
+
+            void add(long int bucket, long int count);
+            void merge(const bucket_store &rhs);
+        };
+
+        double alpha;
+        double gamma;
+        double log_gamma;
+        double zero_threshold;
+
+        bucket_store positive;
+        bucket_store negative;
+        long int zero_count = 0;
+        stream_moments moments;
+
+        long int bucket_of(double magnitude) const;
+        double bucket_value(long int bucket) const;
+
+    public:
+        explicit quantile_sketch(double relative_accuracy = 1.0E-3,
+                                 double zero_threshold = 1.0E-30);
+
+        // Non-finite values are ignored.
+        void digest(double x);
+
+        // The sketches must have the same relative accuracy.
+        void merge(const quantile_sketch &rhs);
+
+        double relative_accuracy() const { return this->alpha; }
+        const stream_moments & get_moments() const { return this->moments; }
+
+        // Estimates the q-th quantile, q in [0,1], of the digested values.
+        //
+        // The estimate corresponds to the value with (zero-based) rank floor(q*(N-1)), and is exact for q = 0 and q = 1.
+        // Throws if no values have been digested.
+        double quantile(double q) const;
+};
@@ -2,13 +2,18 @@
 
 #include <algorithm> //std::min_element/max_element, std::stable_sort.
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <cstdint>   //For int64_t.
 #include <optional>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <list>
 #include <map>
+#include <memory_resource>
 #include <ostream>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -30,6 +35,10 @@
 
 #include "Structs.h"
 #include "Dose_Meld.h"
+#include "Voxel_Mask_Cache.h"
+#include "Image_Spill_Store.h"
+#include "Slice_Index.h"
+#include "Thread_Arena.h"
 
 //This is a mapping from the segmentation history to a human-readable description.
 // Try avoid using commas or tabs to make dumping as csv easier. This should in
@@ -522,15 +531,28 @@ std::unique_ptr<Contour_Data> Contour_Data::Split_Core_and_Peel(double frac_dist
 //---------------------------------------------------------------------------------------------------------------------------
 //-------------------------------------------------------- Image_Array ------------------------------------------------------
 //---------------------------------------------------------------------------------------------------------------------------
-Image_Array::Image_Array() = default;
+Image_Array::Image_Array() : slice_lookup(std::make_shared<Slice_Index>(this->imagecoll)) {}
 
-Image_Array::Image_Array(const Image_Array &rhs){
+Image_Array::Image_Array(const Image_Array &rhs) : Image_Array() {
     *this = rhs; //Performs a deep copy (unless copying self).
 }
 
 Image_Array & Image_Array::operator=(const Image_Array &rhs){
     if(this != &rhs){
         this->imagecoll  = rhs.imagecoll;
+        this->spill_store = nullptr;
+        this->slice_lookup->invalidate();
+
+        // Copies are always fully resident.
+        if(rhs.spill_store != nullptr){
+            auto r_it = std::begin(rhs.imagecoll.images);
+            for(auto &img : this->imagecoll.images){
+                if(!rhs.spill_store->is_resident(*r_it)){
+                    img.data = rhs.spill_store->copy_voxels(*r_it);
+                }
+                ++r_it;
+            }
+        }
     }
     return *this;
 }
@@ -1037,6 +1059,7 @@ void Drover::operator=(const Drover &rhs){
         this->tplan_data      = rhs.tplan_data;
         this->lsamp_data      = rhs.lsamp_data;
         this->trans_data      = rhs.trans_data;
+        this->voxel_mask_cache = rhs.voxel_mask_cache;
     }
     return;
 }
@@ -1129,6 +1152,42 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
     // map<cc_iter, pair<Total dose (in unscaled integer units), Number of voxels>>.
     auto accumulated_dose = drover_bnded_dose_accm_dose_map_factory();
 
+    //Lookup tables and per-voxel outputs used only within this routine are drawn from a single arena, which draws from
+    // the thread's arena, and are released together at the end.
+    std::pmr::monotonic_buffer_resource lookup_arena(thread_arena());
+
+    //Per-voxel outputs are accumulated in the arena, indexed by contour collection ordinal, and are only converted to
+    // the caller's containers at the end.
+    const auto N_ccs = static_cast<size_t>(std::distance(this->contour_data->ccs.begin(), this->contour_data->ccs.end()));
+    std::pmr::list<double> l_pixel_doses(&lookup_arena);
+    std::pmr::vector<std::pmr::list<double>> l_bulk_doses(N_ccs, &lookup_arena);
+    std::pmr::vector<std::pmr::list<bnded_dose_pos_dose_tup_t>> l_pos_doses(N_ccs, &lookup_arena);
+    std::pmr::vector<std::array<double,125>> l_cent_moms((cent_moms == nullptr) ? 0 : N_ccs, &lookup_arena); //Indexed by (p*5 + q)*5 + r.
+    std::pmr::vector<bool> l_cent_moms_used(l_cent_moms.size(), false, &lookup_arena);
+
+    //Bound each contour with a cartesian bounding box (in the XY plane). Only pixels within the box can be within the
+    // contour. The boxes do not depend on the dose data, so they are only computed once per contour.
+    //
+    // Boxes are stored as {min_x, max_x, min_y, max_y}.
+    const float alrgnum(1E30);
+    std::pmr::map<const contour_of_points<double> *, std::array<float,4>> xy_bounds(&lookup_arena);
+    for(auto cc_it = this->contour_data->ccs.begin(); cc_it != this->contour_data->ccs.end(); ++cc_it){
+        for(auto c_it = cc_it->contours.begin(); c_it != cc_it->contours.end(); ++c_it){
+            if(c_it->points.size() < 3) continue;
+
+            const contour_of_points<double> BB(c_it->Bounding_Box_Along(vec3<double>(1.0,0.0,0.0)));
+            float min_x = alrgnum, max_x = -alrgnum;
+            float min_y = alrgnum, max_y = -alrgnum;
+            for(const auto & point : BB.points){
+                if(point.x < min_x) min_x = point.x;
+                if(point.x > max_x) max_x = point.x;
+                if(point.y < min_y) min_y = point.y;
+                if(point.y > max_y) max_y = point.y;
+            }
+            xy_bounds[ &(*c_it) ] = { min_x, max_x, min_y, max_y };
+        }
+    }
+
     //Loop over the attached dose datasets (NOT the dose slices!). It is implied that we have to sum up doses 
     // from each attached data in order to find the total (actual) dose.
     //
@@ -1140,17 +1199,36 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
             accumulated_dose[cc_it] = std::pair<int64_t,int64_t>(0,0);
         }
 
+        //Determine which contours each dose frame sandwiches using the slice index, rather than testing every
+        // (frame, contour) pair.
+        std::pmr::map<const planar_image<float,double> *, std::pmr::set<const contour_of_points<double> *>> sandwiched_contours(&lookup_arena);
+        for(auto cc_it = this->contour_data->ccs.begin(); cc_it != this->contour_data->ccs.end(); ++cc_it){
+            for(auto c_it = cc_it->contours.begin(); c_it != cc_it->contours.end(); ++c_it){
+                if(c_it->points.size() < 3) continue;
+
+                const auto filtering_avg_point = c_it->First_N_Point_Avg(3); //Average_Point(); //Just need a point at the correct height, somewhere inside contour.
+                for(const auto &img_it : dd_it->slice_lookup->get_images_which_sandwich_point(filtering_avg_point)){
+                    sandwiched_contours[ &(*img_it) ].insert( &(*c_it) );
+                }
+            }
+        }
+
         //We now loop through all dose frames (slices) and accumulate dose within the contour bounds.
         for(auto & image : dd_it->imagecoll.images){
             //Note: i_it is something like std::list<planar_image<T,R>>::iterator.
+            const auto s_it = sandwiched_contours.find( &image );
+            if(s_it == std::end(sandwiched_contours)) continue;
     
-            for(auto cc_it = this->contour_data->ccs.begin(); cc_it != this->contour_data->ccs.end(); ++cc_it){
+            size_t cc_n = 0;
+            for(auto cc_it = this->contour_data->ccs.begin(); cc_it != this->contour_data->ccs.end(); ++cc_it, ++cc_n){
 
-                for(auto c_it = cc_it->contours.begin(); c_it != cc_it->contours.end(); ++c_it){
-                    if(c_it->points.size() < 3) continue;
+                //Resolve the per-collection outputs once, since the map comparator is costly and may allocate.
+                auto &l_accumulated_dose = accumulated_dose[cc_it];
+                auto *l_min_max_dose = (min_max_doses == nullptr) ? nullptr : &((*min_max_doses)[cc_it]);
+                const auto cc_centroid = (cent_moms == nullptr) ? vec3<double>() : cc_centroids[cc_it];
 
-                    const auto filtering_avg_point = c_it->First_N_Point_Avg(3); //Average_Point(); //Just need a point at the correct height, somewhere inside contour.
-                    if(!image.sandwiches_point_within_top_bottom_planes(filtering_avg_point)) continue;
+                for(auto c_it = cc_it->contours.begin(); c_it != cc_it->contours.end(); ++c_it){
+                    if(s_it->second.count( &(*c_it) ) == 0) continue;
  
                     //Now we have a contour of points and pixel data (note: we can ignore the z components for both) 
                     // which may or may not lie within the contour. This is called the 'Point-in-polygon' problem and is
@@ -1178,22 +1256,16 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
                     //     | \______________/    |
                     //     |---------------------|
                     //
-                    const contour_of_points<double> BB(c_it->Bounding_Box_Along(vec3<double>(1.0,0.0,0.0)));
-                    const float alrgnum(1E30);
-                    float min_x = alrgnum, max_x = -alrgnum;
-                    float min_y = alrgnum, max_y = -alrgnum;
-                    for(const auto & point : BB.points){
-                        if(point.x < min_x) min_x = point.x;
-                        if(point.x > max_x) max_x = point.x;
-                        if(point.y < min_y) min_y = point.y;
-                        if(point.y > max_y) max_y = point.y;
-                    }
+                    const auto [min_x, max_x, min_y, max_y] = xy_bounds.at( &(*c_it) );
                     if((min_x == alrgnum) || (min_y == alrgnum) || (max_x == -alrgnum) || (max_y == -alrgnum)){
                         FUNCERR("Unable to find a reasonable bounding box around this contour");
                     }
     
                     //Now cycle through every pixel in the plane. This is kind of a shit way to do this, but then again this entire program is basically
                     // a shit way to do it. I would like to have had more time to properly fix/plan/think about what I've got here...  -h
+                    //
+                    // Apart from the user's selection function, this loop only allocates from the arena.
+                    thread_arena_scope arena_scope;
                     for(long int i=0; i<image.rows; ++i)  for(long int j=0; j<image.columns; ++j){
                         const auto pos = image.position(i,j);
                         const float X = pos.x, Y = pos.y;
@@ -1224,20 +1296,20 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
                             const auto pointdose = static_cast<double>(pointval); 
 
                             if(mean_doses != nullptr){
-                                accumulated_dose[cc_it].first  += pointval;
-                                accumulated_dose[cc_it].second += 1;
+                                l_accumulated_dose.first  += pointval;
+                                l_accumulated_dose.second += 1;
                             }
                             if(bulk_doses != nullptr){
-                                (*bulk_doses)[cc_it].push_back(pointdose);
+                                l_bulk_doses[cc_n].push_back(pointdose);
                             }
 
                             if(pixel_doses != nullptr){
-                                pixel_doses->push_back(pointdose); 
+                                l_pixel_doses.push_back(pointdose); 
                             }
 
-                            if(min_max_doses != nullptr){
-                                if(pointdose < (*min_max_doses)[cc_it].first)  (*min_max_doses)[cc_it].first  = pointdose; //min.
-                                if(pointdose > (*min_max_doses)[cc_it].second) (*min_max_doses)[cc_it].second = pointdose; //max.
+                            if(l_min_max_dose != nullptr){
+                                if(pointdose < l_min_max_dose->first)  l_min_max_dose->first  = pointdose; //min.
+                                if(pointdose > l_min_max_dose->second) l_min_max_dose->second = pointdose; //max.
                             }
 
                             if(pos_doses != nullptr){
@@ -1245,21 +1317,22 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
                                 const vec3<double> r_dy = image.col_unit*image.pxl_dy*0.5;
                                 const auto tup = std::make_tuple(pos, r_dx, r_dy, pointdose, i, j);
 
-                                if(Fselection(tup)) (*pos_doses)[cc_it].push_back(tup);
+                                if(Fselection(tup)) l_pos_doses[cc_n].push_back(tup);
                             }
                             if(cent_moms != nullptr){ //Centralized moments. This routine requires a centroid for each cc.
-                                const auto cc_centroid = cc_centroids[cc_it];
+                                l_cent_moms_used[cc_n] = true;
                                 for(int p = 0; p < 5; ++p) for(int q = 0; q < 5; ++q) for(int r = 0; r < 5; ++r){
                                     //const std::array<int,3> triplet = {p,q,r};
                                     const auto spatial = pow(pos.x-cc_centroid.x,p)*pow(pos.y-cc_centroid.y,q)*pow(pos.z-cc_centroid.z,r);
                                     const auto grid_factor = image.pxl_dx * image.pxl_dy * image.pxl_dz;
-                                    (*cent_moms)[cc_it][{p,q,r}] += spatial*pointdose*grid_factor;
+                                    l_cent_moms[cc_n][(p*5 + q)*5 + r] += spatial*pointdose*grid_factor;
                                 }
                             }
 
                             //-----------------------------------------------------------------------------------------------------------------------
                         }
                     }
+                    assert((pos_doses != nullptr) || (arena_scope.bypassing_allocations() == 0));
                 }
             }
         }
@@ -1282,6 +1355,30 @@ void Drover::Bounded_Dose_General( std::list<double> *pixel_doses,
         }
     }//Loop over the distinct dose file data.
 
+    //Convert the per-voxel outputs for the caller.
+    if(pixel_doses != nullptr){
+        pixel_doses->insert(pixel_doses->end(), l_pixel_doses.begin(), l_pixel_doses.end());
+    }
+    {
+        size_t cc_n = 0;
+        for(auto cc_it = this->contour_data->ccs.begin(); cc_it != this->contour_data->ccs.end(); ++cc_it, ++cc_n){
+            if((bulk_doses != nullptr) && !l_bulk_doses[cc_n].empty()){
+                auto &l = (*bulk_doses)[cc_it];
+                l.insert(l.end(), l_bulk_doses[cc_n].begin(), l_bulk_doses[cc_n].end());
+            }
+            if((pos_doses != nullptr) && !l_pos_doses[cc_n].empty()){
+                auto &l = (*pos_doses)[cc_it];
+                l.insert(l.end(), l_pos_doses[cc_n].begin(), l_pos_doses[cc_n].end());
+            }
+            if((cent_moms != nullptr) && l_cent_moms_used[cc_n]){
+                auto &m = (*cent_moms)[cc_it];
+                for(int p = 0; p < 5; ++p) for(int q = 0; q < 5; ++q) for(int r = 0; r < 5; ++r){
+                    m[{p,q,r}] += l_cent_moms[cc_n][(p*5 + q)*5 + r];
+                }
+            }
+        }
+    }
+
 
     //Verification.
     if(min_max_doses != nullptr){
@@ -1513,19 +1610,32 @@ std::map<double,double>  Drover::Get_DVH() const {
         return output;
     }
 
-    double cumulative;
-    double test_dose = 0.0;
-    do{
-        cumulative = 0.0;
-        for(double & pixel_dose : pixel_doses){
-            if(pixel_dose > test_dose) cumulative += 1.0;
-        }
-
-        const auto dose = test_dose;
-        const auto frac = static_cast<double>(cumulative) / static_cast<double>(pixel_doses.size());
+    // Tally how many of the test doses (0, dD, 2*dD, ...) each voxel strictly exceeds, so the DVH can be evaluated in a
+    // single pass over the voxels rather than one pass per test dose.
+    const double dD = 0.5;
+    std::vector<long int> exceeded_counts;
+    for(const auto &pixel_dose : pixel_doses){
+        if( !std::isfinite(pixel_dose)
+        ||  !(0.0 < pixel_dose) ) continue;
+        const auto N_exceeded = static_cast<size_t>( std::ceil(pixel_dose / dD) );
+        if(exceeded_counts.size() <= N_exceeded) exceeded_counts.resize(N_exceeded + 1, 0);
+        ++exceeded_counts[N_exceeded];
+    }
+    if(exceeded_counts.empty()) exceeded_counts.resize(1, 0);
+
+    // Cumulative counts, from the highest test dose down.
+    const auto N_test_doses = exceeded_counts.size();
+    std::vector<double> cumulative(N_test_doses, 0.0);
+    double running = 0.0;
+    for(size_t i = N_test_doses; 0 < i; --i){
+        cumulative[i - 1] = running; // Voxels exceeding test dose (i-1)*dD.
+        running += static_cast<double>(exceeded_counts[i - 1]);
+    }
+    for(size_t i = 0; i < N_test_doses; ++i){
+        const auto dose = static_cast<double>(i) * dD;
+        const auto frac = cumulative[i] / static_cast<double>(pixel_doses.size());
         output[dose] = frac;
-        test_dose += 0.5;
-    }while(cumulative != 0.0);
+    }
     return output;
 }
 
@@ -1604,6 +1714,12 @@ void Drover::Ensure_Contour_Data_Allocated(){
      } 
 }
 
+void Drover::Ensure_Voxel_Mask_Cache_Allocated(){
+     if(this->voxel_mask_cache == nullptr){
+         this->voxel_mask_cache = std::make_shared<Voxel_Mask_Cache>();
+     } 
+}
+
 void Drover::Concatenate(const std::shared_ptr<Contour_Data>& in){
     //If there are no existing contours, incoming contours are shared instead of copied.
     // Otherwise, incoming contours are copied and concatenated into *this' contour_data.
@@ -1958,6 +2074,11 @@ OperationArgPkg::getValueStr(const std::string& key) const {
     return std::make_optional(cit->second);
 }
 
+icase_map_t<std::string>
+OperationArgPkg::getArguments() const {
+    return this->opts;
+}
+
 
 //Will not overwrite.
 bool
@@ -22,6 +22,10 @@
 
 #include "Alignment_TPSRPM.h"
 
+class Voxel_Mask_Cache;
+class Image_Spill_Store;
+class Slice_Index;
+
 
 //This is a wrapper around the YgorMath.h class "contour_of_points." It holds an instance of a contour_of_points, but also provides some meta information
 // which helps identify the origin, quality, and purpose of the data.
@@ -121,6 +125,15 @@ class Image_Array { //: public Base_Array {
 
         std::string filename; //The filename from which the data originated, if applicable.
 
+        // When present, voxel data may have been paged to disk. Operations that are not aware of this will only ever
+        // encounter fully-restored images; see Image_Spill_Store.h. Declared after imagecoll so that it is destroyed
+        // before the images it refers to. Destroying it removes the spill files without restoring the images.
+        std::shared_ptr<Image_Spill_Store> spill_store;
+
+        // Lazily-built index for locating images by position; see Slice_Index.h. Always bound to this->imagecoll, so it
+        // is never shared with copies.
+        std::shared_ptr<Slice_Index> slice_lookup;
+
         //Constructor/Destructors.
         Image_Array();
         Image_Array(const Image_Array &rhs); //Performs a deep copy (unless copying self).
@@ -415,6 +428,8 @@ class Drover {
         std::list<std::shared_ptr<TPlan_Config>> tplan_data;
         std::list<std::shared_ptr<Line_Sample>>  lsamp_data;
         std::list<std::shared_ptr<Transform3>>   trans_data;
+
+        std::shared_ptr<Voxel_Mask_Cache>        voxel_mask_cache; //Memoized contour-voxel containment. Shared with copies.
     
         //Constructors.
         Drover();
@@ -456,6 +471,7 @@ class Drover {
         bool Has_Tran3_Data() const;
 
         void Ensure_Contour_Data_Allocated();
+        void Ensure_Voxel_Mask_Cache_Allocated();
 
         void Concatenate(const std::shared_ptr<Contour_Data>& in);
         void Concatenate(std::list<std::shared_ptr<Image_Array>> in);
@@ -514,6 +530,9 @@ class OperationArgPkg {
 
         std::optional<std::string> getValueStr(const std::string& key) const;
 
+        //All arguments, ordered case-insensitively by key.
+        icase_map_t<std::string> getArguments() const;
+
         bool insert(const std::string& key, std::string val); //Will not overwrite.
         bool insert(const std::string& keyval); //Will not overwrite.
 
@@ -575,5 +594,11 @@ struct OperationDoc {
     std::string desc; // Documentation for the operation itself.
     std::list<std::string> notes; // Special notes concerning the operation, usually caveats or notices.
 
+    bool supports_spilled_images = false; // Whether the operation pins images spilled by an Image_Spill_Store itself.
+                                          // If not, spilled images are restored before the operation is invoked.
+
+    bool has_side_effects = false; // Whether the operation affects anything other than the Drover, e.g., by writing
+                                   // files or interacting with the user, even if no argument is documented as an output.
+                                   // Such operations are always performed, so their results are never cached.
 };
 
@@ -7,7 +7,9 @@
 #include <string>    
 #include <vector>
 #include <map>
+#include <memory_resource>
 #include <list>
+#include <set>
 #include <functional>
 #include <array>
 #include <mutex>
@@ -16,6 +18,7 @@
 
 #include <utility>            //Needed for std::pair.
 #include <algorithm>
+#include <cassert>
 
 #ifdef DCMA_USE_CGAL
 #else
@@ -61,6 +64,7 @@
 #include "YgorImages.h"
 
 #include "Thread_Pool.h"
+#include "Thread_Arena.h"
 #include "Structs.h"
 
 #include "YgorImages_Functors/Grouping/Misc_Functors.h"
@@ -875,11 +879,13 @@ Marching_Cubes_Implementation(
 
     // Storage for partially-connected meshes within the plane of a single image.
     // Data is processed one image at a time and we only merge meshes and de-duplicate out-of-plane vertices afterward.
+    //
+    // Faces are always triangles, so they are stored inline rather than as individually-allocated vectors.
     struct per_img_fv_mesh_t {
         std::vector<vec3<double>> verts;
-        std::vector<std::vector<uint64_t>> faces;
+        std::vector<std::array<uint64_t, 3>> faces;
 
-        std::vector<std::vector<uint64_t>> fsrel; // which img num vert num is relative to.
+        std::vector<std::array<uint64_t, 3>> fsrel; // which img num vert num is relative to.
         std::vector<uint64_t> vscor; // lower bound index of the local verts that correspond to a given voxel.
     };
     std::map<long int, per_img_fv_mesh_t> per_img_fv_mesh;
@@ -1006,11 +1012,14 @@ Marching_Cubes_Implementation(
         }
 
         // Tailor the generic list of vertex index offset to check to the current position, discarding irrelevant items.
+        //
+        // These sets are created for every voxel the surface intersects, so they are drawn from the thread's arena.
         const auto customize_vscor_to_check = [&vscor_index]( long int row, long int col,
                                                   long int N_rows, long int N_cols,
                                                   const std::set<long int> &vscor_to_check,
                                                   const per_img_fv_mesh_t* per_img_fv_mesh_ptr ){
-            std::set<size_t> verts_to_check;
+            thread_arena_scope arena_scope;
+            std::pmr::set<size_t> verts_to_check(thread_arena());
             if(per_img_fv_mesh_ptr != nullptr){
                 // Now for each i in vscor_to_check, insert per_img_fv_mesh_ptr->vscor[i] ... per_img_fv_mesh_ptr->vscor[i+1] into verts_to_check (iff it currently exists!)
                 const auto N_vscor = static_cast<long int>(per_img_fv_mesh_ptr->vscor.size());
@@ -1026,6 +1035,7 @@ Marching_Cubes_Implementation(
                     }
                 }
             }
+            assert(arena_scope.bypassing_allocations() == 0);
             return verts_to_check;
         };
 
@@ -1135,8 +1145,8 @@ Marching_Cubes_Implementation(
                     // extract everything in parallel and then de-duplicate afterward.
                     }else{
                         std::vector<vec3<double>> new_verts;
-                        std::vector<uint64_t> new_indices;
-                        std::vector<uint64_t> new_fsrel;
+                        std::array<uint64_t, 3> new_indices {};
+                        std::array<uint64_t, 3> new_fsrel {};
 
                         for(int32_t tri_corner = 0; tri_corner < 3; ++tri_corner){
                             // Option 1: *always* create new vertices.
@@ -1145,8 +1155,8 @@ Marching_Cubes_Implementation(
                             // anything with the resulting mesh. (The mesh is in a form called 'polygon soup.')
                             if(false){
                                 new_verts.emplace_back( tri_verts[tri_corner] );
-                                new_indices.emplace_back(m_mini_mesh_ptr->verts.size() + new_verts.size() - 1);
-                                new_fsrel.emplace_back(shifted_img_num);
+                                new_indices[tri_corner] = m_mini_mesh_ptr->verts.size() + new_verts.size() - 1;
+                                new_fsrel[tri_corner] = shifted_img_num;
                             }
 
 
@@ -1171,8 +1181,8 @@ Marching_Cubes_Implementation(
                             for(const auto &v_i : m_verts_to_check){
                                 const bool duplicate = tri_verts[tri_corner].sq_dist( m_mini_mesh_ptr->verts.at(v_i) ) < (dvec3_tol*dvec3_tol);
                                 if(duplicate){
-                                    new_indices.emplace_back(v_i);
-                                    new_fsrel.emplace_back(shifted_img_num);
+                                    new_indices[tri_corner] = v_i;
+                                    new_fsrel[tri_corner] = shifted_img_num;
                                     located = true;
                                     break;
                                 }
@@ -1183,8 +1193,8 @@ Marching_Cubes_Implementation(
                                 for(const auto &v_i : l_verts_to_check){
                                     const bool duplicate = tri_verts[tri_corner].sq_dist( l_mini_mesh_ptr->verts.at(v_i) ) < (dvec3_tol*dvec3_tol);
                                     if(duplicate){
-                                        new_indices.emplace_back(v_i);
-                                        new_fsrel.emplace_back(shifted_img_num - 1);
+                                        new_indices[tri_corner] = v_i;
+                                        new_fsrel[tri_corner] = shifted_img_num - 1;
                                         located = true;
                                         break;
                                     }
@@ -1194,8 +1204,8 @@ Marching_Cubes_Implementation(
                                 for(const auto &v_i : u_verts_to_check){
                                     const bool duplicate = tri_verts[tri_corner].sq_dist( u_mini_mesh_ptr->verts.at(v_i) ) < (dvec3_tol*dvec3_tol);
                                     if(duplicate){
-                                        new_indices.emplace_back(v_i);
-                                        new_fsrel.emplace_back(shifted_img_num + 1);
+                                        new_indices[tri_corner] = v_i;
+                                        new_fsrel[tri_corner] = shifted_img_num + 1;
                                         located = true;
                                         break;
                                     }
@@ -1207,14 +1217,14 @@ Marching_Cubes_Implementation(
                                 const auto N_verts_prev = m_mini_mesh_ptr->verts.size();
 
                                 m_verts_to_check.insert(N_verts_prev);
-                                new_indices.emplace_back(N_verts_prev);
+                                new_indices[tri_corner] = N_verts_prev;
                                 m_mini_mesh_ptr->verts.emplace_back( tri_verts[tri_corner] );
-                                new_fsrel.emplace_back(shifted_img_num);
+                                new_fsrel[tri_corner] = shifted_img_num;
                             }
                         }
 
-                        m_mini_mesh_ptr->fsrel.emplace_back(new_fsrel);
-                        m_mini_mesh_ptr->faces.emplace_back(new_indices);
+                        m_mini_mesh_ptr->fsrel.push_back(new_fsrel);
+                        m_mini_mesh_ptr->faces.push_back(new_indices);
                     }
                 } // Loop over triangles.
 
@@ -1281,8 +1291,9 @@ Marching_Cubes_Implementation(
         fv_mesh.vertices.insert( std::end(fv_mesh.vertices),
                                  std::begin(l_mini_mesh.verts), std::end(l_mini_mesh.verts) );
 
-        fv_mesh.faces.insert( std::end(fv_mesh.faces),
-                              std::begin(l_mini_mesh.faces), std::end(l_mini_mesh.faces) );
+        for(const auto &f : l_mini_mesh.faces){
+            fv_mesh.faces.emplace_back( std::begin(f), std::end(f) );
+        }
     }
 
     FUNCINFO("Deduplicating vertices..");
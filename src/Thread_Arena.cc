@@ -0,0 +1,122 @@
+//Thread_Arena.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+#include "Thread_Arena.h"
+
+
+namespace {
+
+#ifndef NDEBUG
+// Global allocations made by the thread. Allocations made while servicing the pool are not counted.
+thread_local long int bypassing_count = 0;
+thread_local bool servicing_pool = false;
+#endif // NDEBUG
+
+// Forwards to the global allocator, counting requests in debug builds.
+class counting_resource : public std::pmr::memory_resource {
+    public:
+        thread_arena_statistics stats;
+
+    private:
+        void * do_allocate(size_t bytes, size_t alignment) override {
+#ifndef NDEBUG
+            ++(this->stats.upstream_allocations);
+            this->stats.upstream_bytes += bytes;
+
+            servicing_pool = true;
+            try{
+                auto p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+                servicing_pool = false;
+                return p;
+            }catch(...){
+                servicing_pool = false;
+                throw;
+            }
+#else
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+#endif // NDEBUG
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+#ifndef NDEBUG
+            ++(this->stats.upstream_deallocations);
+#endif // NDEBUG
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return (this == &other);
+        }
+};
+
+// The pool is declared after the upstream resource so that it is destroyed first.
+struct arena_t {
+    counting_resource upstream;
+    std::pmr::unsynchronized_pool_resource pool;
+
+    arena_t() : pool(&upstream) {}
+};
+
+arena_t & get_arena(){
+    thread_local arena_t arena;
+    return arena;
+}
+
+} // namespace
+
+
+std::pmr::memory_resource * thread_arena(){
+    return &(get_arena().pool);
+}
+
+thread_arena_statistics get_thread_arena_statistics(){
+    auto stats = get_arena().upstream.stats;
+#ifndef NDEBUG
+    stats.bypassing_allocations = bypassing_count;
+#endif // NDEBUG
+    return stats;
+}
+
+
+thread_arena_scope::thread_arena_scope() : initial_bypassing_allocations(0) {
+#ifndef NDEBUG
+    this->initial_bypassing_allocations = bypassing_count;
+#endif // NDEBUG
+}
+
+long int thread_arena_scope::bypassing_allocations() const {
+#ifndef NDEBUG
+    return bypassing_count - this->initial_bypassing_allocations;
+#else
+    return 0;
+#endif // NDEBUG
+}
+
+
+#ifndef NDEBUG
+// Replacements for the global (non-aligned) allocation functions, which count allocations that bypass the pools. The
+// array, nothrow, and sized variants forward to these.
+void * operator new(size_t bytes){
+    if(!servicing_pool) ++bypassing_count;
+    if(bytes == 0) bytes = 1;
+    while(true){
+        if(auto p = std::malloc(bytes)) return p;
+        auto handler = std::get_new_handler();
+        if(handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+#endif // NDEBUG
+
@@ -0,0 +1,56 @@
+//Thread_Arena.h.
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+
+// A per-thread memory pool for short-lived temporaries in hot loops.
+//
+// Each thread has its own pool, so allocations never contend with other threads. Memory released to the pool is
+// retained and reused for later allocations of a similar size, so loops that repeatedly create and destroy small
+// containers stop reaching the global allocator once the pool is warm. The memory is returned when the thread exits.
+//
+// Containers using the pool must be destroyed on the thread that created them, before the thread exits.
+std::pmr::memory_resource * thread_arena();
+
+
+// Requests the calling thread's pool has made of the global allocator, and requests the thread has made of the global
+// allocator without going through the pool.
+//
+// Only tracked in debug builds (i.e., when NDEBUG is not defined); otherwise the counts are always zero. Useful for
+// confirming that the inner loops of a routine are allocation-free once the pool is warm.
+//
+// Note that bypassing allocations are counted by replacing the global operator new in debug builds. Over-aligned
+// allocations are not counted.
+struct thread_arena_statistics {
+    long int upstream_allocations = 0;
+    long int upstream_deallocations = 0;
+    size_t upstream_bytes = 0; // Total bytes requested, including bytes since deallocated.
+
+    long int bypassing_allocations = 0; // Global operator new calls not made on behalf of the pool.
+};
+
+thread_arena_statistics get_thread_arena_statistics();
+
+
+// Tracks the calling thread's allocations that bypass its pool, starting when the scope is created.
+//
+// Intended for asserting that a hot loop draws its temporaries only from the pool, e.g.,
+//
+//     thread_arena_scope arena_scope;
+//     ... loop ...
+//     assert(arena_scope.bypassing_allocations() == 0);
+//
+// The scope must be used on the thread that created it. In release builds the count is always zero.
+class thread_arena_scope {
+    private:
+        long int initial_bypassing_allocations;
+
+    public:
+        thread_arena_scope();
+
+        long int bypassing_allocations() const;
+};
+
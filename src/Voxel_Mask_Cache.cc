@@ -0,0 +1,295 @@
+//Voxel_Mask_Cache.cc - A part of DICOMautomaton 2021. Written by hal clark.
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for contour_collection class.
+
+#include "Voxel_Mask_Cache.h"
+
+
+std::shared_ptr<const Voxel_Mask_Cache::mask_t>
+Voxel_Mask_Cache::get(const key_t &k){
+    std::lock_guard<std::mutex> lock(this->m);
+    const auto it = this->lookup.find(k);
+    if(it == std::end(this->lookup)){
+        ++(this->misses);
+        return nullptr;
+    }
+    ++(this->hits);
+    this->items.splice(std::begin(this->items), this->items, it->second);
+    return it->second->second;
+}
+
+void
+Voxel_Mask_Cache::put(const key_t &k, std::shared_ptr<const mask_t> mask){
+    if(mask == nullptr) return;
+    std::lock_guard<std::mutex> lock(this->m);
+    const auto it = this->lookup.find(k);
+    if(it != std::end(this->lookup)){
+        this->bytes -= mask_bytes(*(it->second->second));
+        this->items.erase(it->second);
+        this->lookup.erase(it);
+    }
+    this->bytes += mask_bytes(*mask);
+    this->items.emplace_front(k, std::move(mask));
+    this->lookup[k] = std::begin(this->items);
+
+    // Evict the least recently used masks, but always retain the newest.
+    while( (this->byte_budget < this->bytes)
+       &&  (1 < this->items.size()) ){
+        this->bytes -= mask_bytes(*(this->items.back().second));
+        this->lookup.erase(this->items.back().first);
+        this->items.pop_back();
+    }
+    return;
+}
+
+void
+Voxel_Mask_Cache::clear(){
+    std::lock_guard<std::mutex> lock(this->m);
+    this->lookup.clear();
+    this->items.clear();
+    this->bytes = 0;
+    return;
+}
+
+size_t
+Voxel_Mask_Cache::size() const {
+    std::lock_guard<std::mutex> lock(this->m);
+    return this->items.size();
+}
+
+
+// 64-bit FNV-1a.
+static void fingerprint_mix(uint64_t &h, const void *ptr, size_t n){
+    const auto *bytes = static_cast<const unsigned char *>(ptr);
+    for(size_t i = 0; i < n; ++i){
+        h ^= static_cast<uint64_t>(bytes[i]);
+        h *= 1099511628211ULL;
+    }
+    return;
+}
+
+template <class T>
+static void fingerprint_mix(uint64_t &h, const T &x){
+    fingerprint_mix(h, static_cast<const void *>(&x), sizeof(T));
+    return;
+}
+
+static void fingerprint_mix(uint64_t &h, const vec3<double> &v){
+    fingerprint_mix(h, v.x);
+    fingerprint_mix(h, v.y);
+    fingerprint_mix(h, v.z);
+    return;
+}
+
+uint64_t
+Fingerprint_Contours(const std::list<std::reference_wrapper<contour_collection<double>>> &ccsl){
+    uint64_t h = 14695981039346656037ULL;
+    for(const auto &cc_refw : ccsl){
+        const auto &cc = cc_refw.get();
+        fingerprint_mix(h, static_cast<uint64_t>(cc.contours.size()));
+        for(const auto &c : cc.contours){
+            fingerprint_mix(h, static_cast<uint64_t>(c.points.size()));
+            fingerprint_mix(h, static_cast<uint8_t>(c.closed ? 1 : 0));
+            for(const auto &p : c.points) fingerprint_mix(h, p);
+        }
+    }
+    return h;
+}
+
+uint64_t
+Fingerprint_Image_Geometry(const planar_image<float,double> &img){
+    uint64_t h = 14695981039346656037ULL;
+    fingerprint_mix(h, static_cast<int64_t>(img.rows));
+    fingerprint_mix(h, static_cast<int64_t>(img.columns));
+    fingerprint_mix(h, static_cast<int64_t>(img.channels));
+    fingerprint_mix(h, img.pxl_dx);
+    fingerprint_mix(h, img.pxl_dy);
+    fingerprint_mix(h, img.pxl_dz);
+    fingerprint_mix(h, img.anchor);
+    fingerprint_mix(h, img.offset);
+    fingerprint_mix(h, img.row_unit);
+    fingerprint_mix(h, img.col_unit);
+    return h;
+}
+
+
+bool
+Voxel_Mask_Cache_Applicable(const planar_image<float,double> &img_to_edit,
+                            const std::list<std::reference_wrapper<planar_image<float,double>>> &selected_imgs,
+                            const Mutate_Voxels_Opts &options){
+    return (options.editstyle == Mutate_Voxels_Opts::EditStyle::InPlace)
+        && (options.aggregate == Mutate_Voxels_Opts::Aggregate::First)
+        && (selected_imgs.size() == 1)
+        && (&(selected_imgs.front().get()) == &img_to_edit);
+}
+
+
+void
+Mutate_Voxels_Cached(std::reference_wrapper<planar_image<float,double>> img_to_edit,
+                     std::list<std::reference_wrapper<planar_image<float,double>>> selected_imgs,
+                     std::list<std::reference_wrapper<contour_collection<double>>> ccsl,
+                     Mutate_Voxels_Opts options,
+                     Mutate_Voxels_Functor<float,double> f_bounded,
+                     Mutate_Voxels_Functor<float,double> f_unbounded,
+                     Mutate_Voxels_Functor<float,double> f_visitor,
+                     const std::shared_ptr<Voxel_Mask_Cache> &cache){
+
+    auto &img = img_to_edit.get();
+    if( (cache == nullptr)
+    ||  !Voxel_Mask_Cache_Applicable(img, selected_imgs, options) ){
+        Mutate_Voxels<float,double>( img_to_edit, selected_imgs, ccsl, options, f_bounded, f_unbounded, f_visitor );
+        return;
+    }
+
+    Voxel_Mask_Cache::key_t key;
+    key.contours = Fingerprint_Contours(ccsl);
+    key.geometry = Fingerprint_Image_Geometry(img);
+    key.options  = ( ( static_cast<long int>(options.inclusivity)    * 16
+                     + static_cast<long int>(options.contouroverlap) ) * 16
+                     + static_cast<long int>(options.adjacency)      ) * 16
+                     + static_cast<long int>(options.maskmod);
+
+    const long int N_rows = img.rows;
+    const long int N_cols = img.columns;
+    const long int N_chns = img.channels;
+
+    // Replay a previously recorded partition.
+    if(auto mask = cache->get(key); mask != nullptr){
+        planar_image<float,double> empty_mask;
+        auto r_it = std::begin(mask->runs);
+        long int remaining = (r_it == std::end(mask->runs)) ? 0 : r_it->length;
+
+        for(long int row = 0; row < N_rows; ++row){
+            for(long int col = 0; col < N_cols; ++col){
+                for(long int chn = 0; chn < N_chns; ++chn){
+                    while( (remaining == 0) && (r_it != std::end(mask->runs)) ){
+                        ++r_it;
+                        remaining = (r_it == std::end(mask->runs)) ? 0 : r_it->length;
+                    }
+                    if(r_it == std::end(mask->runs)) return;
+                    --remaining;
+
+                    const auto flags = r_it->flags;
+                    if(flags == 0) continue;
+
+                    auto &voxel = img.reference(row, col, chn);
+                    float v = voxel;
+                    if( mask->visitor_first
+                    &&  (flags & Voxel_Mask_Cache::visited) && f_visitor ){
+                        f_visitor(row, col, chn, img_to_edit, std::ref(empty_mask), v);
+                    }
+                    if( (flags & Voxel_Mask_Cache::bounded) && f_bounded ){
+                        f_bounded(row, col, chn, img_to_edit, std::ref(empty_mask), v);
+                    }
+                    if( (flags & Voxel_Mask_Cache::unbounded) && f_unbounded ){
+                        f_unbounded(row, col, chn, img_to_edit, std::ref(empty_mask), v);
+                    }
+                    if( !mask->visitor_first
+                    &&  (flags & Voxel_Mask_Cache::visited) && f_visitor ){
+                        f_visitor(row, col, chn, img_to_edit, std::ref(empty_mask), v);
+                    }
+                    voxel = v;
+                }
+            }
+        }
+        return;
+    }
+
+    // Otherwise, perform the mutation while recording the partition.
+    //
+    // The recording is only retained if it can be replayed faithfully: every functor must be invoked at most once per
+    // voxel, voxels must be visited in order, and the functors must be handed the voxel's own value.
+    std::vector<uint8_t> flags(N_rows * N_cols * N_chns, 0);
+    bool replayable = true;
+    bool visitor_before = false;
+    bool visitor_after = false;
+    long int last_index = 0;
+
+    const auto record = [&](long int row, long int col, long int chn, float v, uint8_t flag) -> void {
+        if(!replayable) return;
+        if( (row < 0) || (N_rows <= row)
+        ||  (col < 0) || (N_cols <= col)
+        ||  (chn < 0) || (N_chns <= chn) ){
+            replayable = false;
+            return;
+        }
+        const long int index = (row * N_cols + col) * N_chns + chn;
+        auto &f = flags[index];
+        if( (index < last_index)
+        ||  (f & flag) ){
+            replayable = false;
+            return;
+        }
+        if(f == 0){
+            const float orig = img.value(row, col, chn);
+            if( !( (orig == v) || (std::isnan(orig) && std::isnan(v)) ) ){
+                replayable = false;
+                return;
+            }
+        }
+        if(flag == Voxel_Mask_Cache::visited){
+            if(f & (Voxel_Mask_Cache::bounded | Voxel_Mask_Cache::unbounded)) visitor_after = true;
+        }else{
+            if(f & Voxel_Mask_Cache::visited) visitor_before = true;
+        }
+        f |= flag;
+        last_index = index;
+        return;
+    };
+
+    Mutate_Voxels_Functor<float,double> r_bounded = [&](long int row, long int col, long int chn,
+                                                        std::reference_wrapper<planar_image<float,double>> img_refw,
+                                                        std::reference_wrapper<planar_image<float,double>> mask_img_refw,
+                                                        float &voxel_val){
+        record(row, col, chn, voxel_val, Voxel_Mask_Cache::bounded);
+        if(f_bounded) f_bounded(row, col, chn, img_refw, mask_img_refw, voxel_val);
+    };
+    Mutate_Voxels_Functor<float,double> r_unbounded = [&](long int row, long int col, long int chn,
+                                                          std::reference_wrapper<planar_image<float,double>> img_refw,
+                                                          std::reference_wrapper<planar_image<float,double>> mask_img_refw,
+                                                          float &voxel_val){
+        record(row, col, chn, voxel_val, Voxel_Mask_Cache::unbounded);
+        if(f_unbounded) f_unbounded(row, col, chn, img_refw, mask_img_refw, voxel_val);
+    };
+    Mutate_Voxels_Functor<float,double> r_visitor = [&](long int row, long int col, long int chn,
+                                                        std::reference_wrapper<planar_image<float,double>> img_refw,
+                                                        std::reference_wrapper<planar_image<float,double>> mask_img_refw,
+                                                        float &voxel_val){
+        record(row, col, chn, voxel_val, Voxel_Mask_Cache::visited);
+        if(f_visitor) f_visitor(row, col, chn, img_refw, mask_img_refw, voxel_val);
+    };
+
+    Mutate_Voxels<float,double>( img_to_edit, selected_imgs, ccsl, options, r_bounded, r_unbounded, r_visitor );
+
+    if( !replayable
+    ||  (visitor_before && visitor_after) ){
+        return;
+    }
+
+    auto mask = std::make_shared<Voxel_Mask_Cache::mask_t>();
+    mask->rows = N_rows;
+    mask->columns = N_cols;
+    mask->channels = N_chns;
+    mask->visitor_first = visitor_before;
+    for(const auto &f : flags){
+        if( mask->runs.empty()
+        ||  (mask->runs.back().flags != f) ){
+            mask->runs.push_back( Voxel_Mask_Cache::run_t{ f, 0 } );
+        }
+        ++(mask->runs.back().length);
+    }
+    mask->runs.shrink_to_fit();
+    cache->put(key, std::move(mask));
+    return;
+}
+
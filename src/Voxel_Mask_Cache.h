@@ -0,0 +1,117 @@
+//Voxel_Mask_Cache.h.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"         //Needed for contour_collection class.
+
+
+// Memoizes which voxels Mutate_Voxels() considers to be bounded by a set of contours.
+//
+// Determining contour-voxel containment is typically the most expensive part of ROI-restricted operations, and scripts
+// frequently apply several such operations to the same ROIs and images. This cache records the voxel partition
+// produced by Mutate_Voxels() the first time a (contours, image geometry, containment options) combination is
+// encountered and replays it thereafter.
+//
+// Keys are derived from the contour vertices and image geometry themselves rather than object addresses, so altering
+// contours or images simply results in a cache miss; stale entries can never be retrieved. Masks are stored run-length
+// encoded and evicted least-recently-used once the byte budget is exceeded.
+class Voxel_Mask_Cache {
+    public:
+        struct key_t {
+            uint64_t contours = 0;  // Fingerprint of the contour vertices.
+            uint64_t geometry = 0;  // Fingerprint of the image geometry.
+            long int options = 0;   // Packed containment options.
+
+            bool operator<(const key_t &rhs) const {
+                return std::tie(this->contours, this->geometry, this->options)
+                     < std::tie(rhs.contours, rhs.geometry, rhs.options);
+            }
+        };
+
+        // Which functors Mutate_Voxels() invoked for a voxel.
+        enum voxel_flag : uint8_t {
+            bounded   = (1 << 0),
+            unbounded = (1 << 1),
+            visited   = (1 << 2),
+        };
+
+        // A run of consecutive voxels (in row, column, channel order) sharing the same flags.
+        struct run_t {
+            uint8_t flags;
+            long int length;
+        };
+
+        struct mask_t {
+            long int rows = 0;
+            long int columns = 0;
+            long int channels = 0;
+            bool visitor_first = false; // Whether f_visitor precedes f_bounded/f_unbounded for each voxel.
+            std::vector<run_t> runs;
+        };
+
+    private:
+        using item_t = std::pair<key_t, std::shared_ptr<const mask_t>>;
+
+        mutable std::mutex m;
+        std::list<item_t> items; // Most recently used at the front.
+        std::map<key_t, std::list<item_t>::iterator> lookup;
+        size_t bytes = 0;
+        size_t byte_budget;
+
+        std::atomic<long int> hits = 0;
+        std::atomic<long int> misses = 0;
+
+        static size_t mask_bytes(const mask_t &mask){
+            return sizeof(mask_t) + mask.runs.size() * sizeof(run_t);
+        }
+
+    public:
+        explicit Voxel_Mask_Cache(size_t budget = 256UL * 1024UL * 1024UL) : byte_budget(budget) {}
+
+        std::shared_ptr<const mask_t> get(const key_t &k);
+        void put(const key_t &k, std::shared_ptr<const mask_t> mask);
+        void clear();
+
+        size_t size() const;
+        long int hit_count() const { return this->hits.load(); }
+        long int miss_count() const { return this->misses.load(); }
+};
+
+
+// Fingerprints used to form cache keys.
+uint64_t Fingerprint_Contours(const std::list<std::reference_wrapper<contour_collection<double>>> &ccsl);
+uint64_t Fingerprint_Image_Geometry(const planar_image<float,double> &img);
+
+// Returns true if the cache can be used with the given options and images.
+//
+// Only in-place edits that take voxel values from the image being edited are currently supported.
+bool Voxel_Mask_Cache_Applicable(const planar_image<float,double> &img_to_edit,
+                                 const std::list<std::reference_wrapper<planar_image<float,double>>> &selected_imgs,
+                                 const Mutate_Voxels_Opts &options);
+
+
+// Drop-in replacement for Mutate_Voxels() that consults (and populates) the provided cache.
+//
+// Falls back to Mutate_Voxels() if the cache is not provided or not applicable. Note that when a cached mask is used
+// the functors are passed an empty mask image, so functors that inspect the mask image should not use the cache.
+void Mutate_Voxels_Cached(std::reference_wrapper<planar_image<float,double>> img_to_edit,
+                          std::list<std::reference_wrapper<planar_image<float,double>>> selected_imgs,
+                          std::list<std::reference_wrapper<contour_collection<double>>> ccsl,
+                          Mutate_Voxels_Opts options,
+                          Mutate_Voxels_Functor<float,double> f_bounded,
+                          Mutate_Voxels_Functor<float,double> f_unbounded,
+                          Mutate_Voxels_Functor<float,double> f_visitor,
+                          const std::shared_ptr<Voxel_Mask_Cache> &cache);
+
@@ -3,26 +3,29 @@
 // This program loads point cloud data from XYZ files.
 //
 
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <exception>
-#include <fstream>
 #include <list>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>    
+#include <string_view>
+#include <vector>
 
 #include <filesystem>
 #include <cstdlib>            //Needed for exit() calls.
 
 #include "YgorMath.h"         //Needed for vec3 class.
-#include "YgorMathIOXYZ.h"
 #include "YgorMisc.h"         //Needed for FUNCINFO, FUNCWARN, FUNCERR macros.
 #include "YgorString.h"       //Needed for SplitStringToVector, Canonicalize_String2, SplitVector functions.
 
 #include "Structs.h"
 #include "Imebra_Shim.h"
+#include "Mapped_File.h"
+#include "Thread_Pool.h"
 
 bool Load_From_XYZ_Files( Drover &DICOM_data,
                           const std::map<std::string,std::string> & /* InvocationMetadata */,
@@ -56,6 +59,8 @@ bool Load_From_XYZ_Files( Drover &DICOM_data,
     // the file is considered to be in XYZ format. Therefore, it is best to attempt loading other, more strucured
     // formats if uncertain about the file type ahead of time.
     //
+    // Large files are split at line boundaries and parsed concurrently.
+    //
     // Note: This routine returns false only iff a file is suspected of being suited for this loader, but could not be
     //       loaded (e.g., the file seems appropriate, but a parsing failure was encountered).
     //
@@ -75,11 +80,54 @@ bool Load_From_XYZ_Files( Drover &DICOM_data,
         try{
             //////////////////////////////////////////////////////////////
             // Attempt to load the file.
-            std::ifstream FI(Filename.c_str(), std::ios::in);
-            if(!ReadPointSetFromXYZ(DICOM_data.point_data.back()->pset, FI)){
-                throw std::runtime_error("Unable to read point cloud from file.");
+            const mapped_file FI(*bfit);
+            const auto chunks = split_for_concurrent_parsing(FI.view());
+            std::vector<std::vector<vec3<double>>> parsed(chunks.size());
+
+            const auto parse_chunk = [&](size_t c) -> void {
+                const std::string_view separators = " \t\r,;";
+                std::string_view text = chunks[c];
+                std::array<double, 3> x;
+                while(!text.empty()){
+                    auto line = strip_comment(pop_line(text));
+
+                    // Every token must be a number, and there must be exactly three of them.
+                    long int N_numbers = 0;
+                    bool valid = true;
+                    while(valid){
+                        const auto pos = line.find_first_not_of(separators);
+                        if(pos == std::string_view::npos) break;
+                        line.remove_prefix(pos);
+
+                        double y;
+                        valid = (N_numbers < 3)
+                             && parse_number(line, y)
+                             && (line.empty() || (separators.find(line.front()) != std::string_view::npos));
+                        if(valid) x[N_numbers++] = y;
+                    }
+                    if( valid
+                    &&  (N_numbers == 3) ){
+                        parsed[c].emplace_back(x[0], x[1], x[2]);
+                    }
+                }
+            };
+            if(chunks.size() < 2){
+                for(size_t c = 0; c < chunks.size(); ++c) parse_chunk(c);
+            }else{
+                asio_thread_pool tp;
+                for(size_t c = 0; c < chunks.size(); ++c){
+                    tp.submit_task([&,c]() -> void { parse_chunk(c); });
+                }
+            } // Wait for the tasks to complete.
+
+            auto &points = DICOM_data.point_data.back()->pset.points;
+            size_t N_parsed = 0;
+            for(const auto &p : parsed) N_parsed += p.size();
+            points.reserve(N_parsed);
+            for(auto &p : parsed){
+                points.insert( std::end(points), std::begin(p), std::end(p) );
+                p = std::vector<vec3<double>>();
             }
-            FI.close();
             //////////////////////////////////////////////////////////////
 
             // Reject the file if the point cloud is not valid.
@@ -28,6 +28,7 @@ bool AccumulatePixelDistributions(planar_image_collection<float,double> &imageco
     //This routine accumulates pixel/voxel intensities on an individual ROI-basis. The entire distribution is collected
     // so that various quantities can be computed afterward. In particular, direct comparison of distributions. Another
     // reason for collecting the entire distribution is that the action can be performed iteratively.
+    // If only summary statistics are needed, the distribution can instead be summarized in constant memory.
     //
     // The primary need for this routine was computing dose distributions on 'SGF' data sets. This routine replaces an
     // older routine that performs a nearly identical computation, but is less flexible.
@@ -179,7 +180,24 @@ bool AccumulatePixelDistributions(planar_image_collection<float,double> &imageco
                                 }
         
                                 // --------------- Incorporate the data into the user_data struct ------------------
-                                user_data_s->accumulated_voxels[ ROIName.value() ].emplace_back(combined_voxel_intensity);
+                                if(user_data_s->retain_voxels){
+                                    user_data_s->accumulated_voxels[ ROIName.value() ].emplace_back(combined_voxel_intensity);
+                                }
+                                if(user_data_s->summarize){
+                                    auto it = user_data_s->summaries.find( ROIName.value() );
+                                    if(it == std::end(user_data_s->summaries)){
+                                        it = user_data_s->summaries.emplace( ROIName.value(),
+                                                 quantile_sketch(user_data_s->summary_relative_accuracy) ).first;
+                                    }
+                                    it->second.digest(combined_voxel_intensity);
+                                }
+                                if(!user_data_s->tally_thresholds.empty()){
+                                    auto &tally = user_data_s->tallies[ ROIName.value() ];
+                                    tally.resize(user_data_s->tally_thresholds.size(), 0);
+                                    for(size_t i = 0; i < tally.size(); ++i){
+                                        if(user_data_s->tally_thresholds[i] < combined_voxel_intensity) ++tally[i];
+                                    }
+                                }
         
                                 // ----------------------------------------------------------------------------
         
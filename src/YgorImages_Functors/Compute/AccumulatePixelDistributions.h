@@ -8,13 +8,25 @@
 #include <string>
 #include <vector>
 
+#include "../../Streaming_Statistics.h"
 
 template <class T, class R> class planar_image_collection;
 template <class T> class contour_collection;
 
 
 struct AccumulatePixelDistributionsUserData {
+    // Whether to retain every voxel value. Disable to bound memory usage when only summaries are needed.
+    bool retain_voxels = true;
     std::map<std::string, std::vector<double>> accumulated_voxels; // key: RawROIName.
+
+    // Whether to summarize the distributions using mergeable quantile sketches, which require constant memory.
+    bool summarize = false;
+    double summary_relative_accuracy = 1.0E-3;
+    std::map<std::string, quantile_sketch> summaries; // key: RawROIName.
+
+    // Thresholds for which the number of voxels strictly exceeding each threshold is tallied exactly.
+    std::vector<double> tally_thresholds;
+    std::map<std::string, std::vector<long int>> tallies; // key: RawROIName. Parallel to tally_thresholds.
 };
 
 bool AccumulatePixelDistributions(planar_image_collection<float,double> &,
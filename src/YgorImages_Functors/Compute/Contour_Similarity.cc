@@ -3,10 +3,13 @@
 #include <any>
 #include <functional>
 #include <list>
+#include <map>
 #include <ostream>
+#include <set>
 #include <stdexcept>
 
 #include "../Grouping/Misc_Functors.h"
+#include "../../Slice_Index.h"
 #include "Contour_Similarity.h"
 #include "YgorImages.h"
 #include "YgorMath.h"
@@ -68,6 +71,21 @@ bool ComputeContourSimilarity(planar_image_collection<float,double> &imagecoll,
 */
 
 
+    //Determine which images each contour could possibly be encompassed by. Only images that sandwich a contour's first
+    // vertex are candidates, so the slice index avoids testing every image against every contour.
+    std::map<const planar_image<float,double> *, std::set<const contour_of_points<double> *>> candidate_contours;
+    {
+        Slice_Index slice_lookup(imagecoll);
+        for(auto &ccs : ccsl){
+            for(const auto &contour : ccs.get().contours){
+                if(contour.points.empty()) continue;
+                for(const auto &img_it : slice_lookup.get_images_which_sandwich_point(contour.points.front())){
+                    candidate_contours[ &(*img_it) ].insert( &contour );
+                }
+            }
+        }
+    }
+
     //Generate a comprehensive list of iterators to all as-of-yet-unused images. This list will be
     // pruned after images have been successfully operated on.
     auto all_images = imagecoll.get_all_images();
@@ -113,6 +131,7 @@ bool ComputeContourSimilarity(planar_image_collection<float,double> &imagecoll,
             ++cc_number; // == 1 (L) or 2 (R).
             for(auto & contour : ccs.get().contours){
                 if(contour.points.empty()) continue;
+                if(candidate_contours[ &(*selected_imgs.front()) ].count( &contour ) == 0) continue;
                 if(! img.encompasses_contour_of_points(contour)) continue;
     
                 //const auto ROIName =  roi_it->GetMetadataValueAs<std::string>("ROIName");
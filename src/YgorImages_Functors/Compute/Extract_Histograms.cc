@@ -11,7 +11,9 @@
 #include <ostream>
 #include <stdexcept>
 
+#include "../../Streaming_Statistics.h"
 #include "../../Thread_Pool.h"
+#include "../../Voxel_Mask_Cache.h"
 #include "../Grouping/Misc_Functors.h"
 #include "../ConvenienceRoutines.h"
 #include "Extract_Histograms.h"
@@ -35,6 +37,9 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
     // Note: Non-finite voxels are excluded from analysis and do not contribute to the volume. If absolute volume is
     //       required, ensure all voxels are finite prior to invoking this routine.
     //
+    // Note: Voxels are visited once. Bins are anchored at zero (i.e., bin edges are integer multiples of the bin
+    //       width) rather than at the smallest voxel value.
+    //
     // Note: This routine will consume a lot of memory if the resolution is too fine.
     //
     // Note: The image collection and contour collections will not be altered.
@@ -61,6 +66,11 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
         FUNCWARN("Missing needed contour information. Cannot continue with computation");
         return false;
     }
+    if( !std::isfinite(user_data_s->dDose)
+    ||  (user_data_s->dDose <= 0.0) ){
+        FUNCWARN("Histogram bin width must be positive and finite. Cannot continue with computation");
+        return false;
+    }
 
     // Logically partition the contours.
     //
@@ -99,120 +109,11 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
         }
     }
 
-    // Determine voxel value extrema for each logical partition.
-    std::map<std::string,               // ROIName.
-             std::pair<double,          // Minimum voxel value (within the user's inclusive range).
-                       double>>         // Maximum voxel value (within the user's inclusive range).
-                       voxel_extrema;
-
-    { // Scope for thread pool.
-        asio_thread_pool tp;
-        std::mutex saver;
-        std::mutex printer;
-        long int completed = 0;
-        const long int img_count = imagecoll.images.size();
-
-        for(auto &img : imagecoll.images){
-            std::reference_wrapper< planar_image<float, double>> img_refw( std::ref(img) );
-            tp.submit_task([&,img_refw]() -> void {
-
-                // Cycle over all the alike-named contour collections.
-                for(auto & named_ccsl : named_ccsls){
-                    double local_minimum = std::numeric_limits<double>::infinity();
-                    double local_maximum = -local_minimum;
-
-                    auto f_bounded = [&](long int /*E_row*/, 
-                                         long int /*E_col*/,
-                                         long int channel,
-                                         std::reference_wrapper<planar_image<float,double>> /*l_img_refw*/,
-                                         std::reference_wrapper<planar_image<float,double>> /*mask_img_refw*/,
-                                         float &voxel_val) {
-                        if( ( (user_data_s->channel < 0) || (user_data_s->channel == channel))
-                        &&  std::isfinite(voxel_val)  // Ignore infinite and NaN voxels.
-                        &&  (user_data_s->lower_threshold <= voxel_val)
-                        &&  (voxel_val <= user_data_s->upper_threshold) ){
-                            if(voxel_val < local_minimum) local_minimum = voxel_val;
-                            if(local_maximum < voxel_val) local_maximum = voxel_val;
-                        }
-                        return;
-                    };
-
-                    Mutate_Voxels<float,double>( img_refw,
-                                                 { img_refw },
-                                                 named_ccsl.second, 
-                                                 user_data_s->mutation_opts, 
-                                                 f_bounded );
-
-                    // Merge the results.
-                    if( std::isfinite(local_minimum) 
-                    &&  std::isfinite(local_maximum) ){
-                        std::lock_guard<std::mutex> lock(saver);
-
-                        const auto key = named_ccsl.first;
-                        if(voxel_extrema.count(key) == 0){
-                            voxel_extrema[key] = std::make_pair(local_minimum, local_maximum);
-                        }else{
-                            if(local_minimum < voxel_extrema[key].first)  voxel_extrema[key].first  = local_minimum;
-                            if(voxel_extrema[key].second < local_maximum) voxel_extrema[key].second = local_maximum;
-                        }
-                    }
-                } // Loop over all named ccs.
-
-                //Report operation progress.
-                {
-                    std::lock_guard<std::mutex> lock(printer);
-                    ++completed;
-                    FUNCINFO("Completed " << completed << " of " << img_count
-                          << " --> " << static_cast<int>(1000.0*(completed)/img_count)/10.0 << "% done");
-                }
-
-            }); // thread pool task closure.
-        } // Loop over all images.
-    }
-
-
-    // Allocate storage for each logical partition.
-    std::map<std::string, size_t> bin_counts;
-    std::map<std::string, double> bin_widths;
-    std::map<std::string,                        // ROIName.
-             std::vector<std::array<double,4>>>  // Differential histogram with implicit bin numbering (min to max).
-                 raw_diff_histograms;
-    std::set<std::string> to_purge; // Groups to purge because they are invalid.
-    for(const auto &extrema : voxel_extrema){
-        const auto key = extrema.first;
-
-        const auto voxel_min = extrema.second.first;
-        const auto voxel_max = extrema.second.second;
-        const auto range = (voxel_max - voxel_min);
-        const auto count_f = range / user_data_s->dDose;
-        if( !std::isfinite(count_f)
-        ||  (1.0E9 < count_f) // approx 10 GB just for the bin values, actual usage would be higher.
-        ||  (count_f <= 1.0) ){
-            FUNCWARN("Excessive or invalid number of bins required for key '" << key << "'. Skipping it");
-            to_purge.insert(key);
-            continue;
-        }
-        const auto bin_count = static_cast<size_t>(std::ceil( count_f ));
-        const auto bin_width = range / static_cast<double>(bin_count);
-
-        // Prepare the histograms bins.
-        //
-        // Note: bin values are centred.
-        std::vector<std::array<double,4>> hist(bin_count, {0.0, 0.0, 0.0, 0.0} );
-        for(size_t i = 0; i < bin_count; ++i){
-            hist[i][0] = voxel_min 
-                       + (bin_width * static_cast<double>(i)) 
-                       + (bin_width * 0.5);
-        }
-
-        bin_counts.emplace(key, bin_count);
-        bin_widths.emplace(key, bin_width);
-        raw_diff_histograms.emplace(key, hist);
-    }
-    for(const auto &key : to_purge) voxel_extrema.extract(key);
-
-
-    // Visit all voxels to build the histograms.
+    // Visit all voxels once to build the histograms.
+    //
+    // Partial histograms are built for each image and then merged. Bins are anchored at zero so partial histograms
+    // can be merged without knowing the voxel extrema in advance.
+    std::map<std::string, streaming_histogram> merged_histograms; // key: ROIName.
     {
         asio_thread_pool tp;
         std::mutex saver;
@@ -229,28 +130,9 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
                 const auto pxl_dz = img_refw.get().pxl_dz;
                 const auto pxl_vol = pxl_dx * pxl_dy * pxl_dz;
 
-                std::vector<size_t> shuttle;  // Thread-specific storage buffer.
-                const size_t N_shuttle = 1000; // Size of buffer.
-                shuttle.reserve(N_shuttle);
-
+                // Cycle over all the alike-named contour collections.
                 for(auto & named_ccsl : named_ccsls){
-                    const auto key = named_ccsl.first;
-                    if(bin_counts.count(key) != 1) continue; // Group did not enclose any voxels.
-
-                    const auto bin_count = bin_counts.at(key);
-                    const auto bin_width = bin_widths.at(key);
-                    const auto voxel_min = voxel_extrema.at(key).first;
-                    //const auto voxel_max = voxel_extrema.at(key).second;
-                    std::vector<std::array<double,4>> &raw_diff_hist(raw_diff_histograms.at(key));
-
-                    // Sub-routine to add all counts from the buffer and then reset the buffer.
-                    const auto add_counts = [&]() -> void {
-                        std::lock_guard<std::mutex> lock(saver);
-                        for(const auto &bin_N : shuttle) raw_diff_hist[bin_N][2] += pxl_vol;
-                        shuttle.clear();
-                        shuttle.reserve(N_shuttle);
-                        return;
-                    };
+                    streaming_histogram local_hist(user_data_s->dDose);
 
                     auto f_bounded = [&](long int /*E_row*/, 
                                          long int /*E_col*/,
@@ -263,25 +145,30 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
                         &&  std::isfinite(voxel_val)  // Ignore infinite and NaN voxels.
                         &&  (user_data_s->lower_threshold <= voxel_val)
                         &&  (voxel_val <= user_data_s->upper_threshold) ){
-
-                            const auto d_low = voxel_val - voxel_min;
-                            const auto bin_N = std::clamp( static_cast<size_t>( std::floor(d_low/bin_width) ),
-                                                           static_cast<size_t>(0),
-                                                           static_cast<size_t>(bin_count-1) );
-                            //raw_diff_hist.at(bin_N)[2] += pxl_vol;
-                            shuttle.push_back(bin_N);
-                            if(N_shuttle == shuttle.size()) add_counts();
+                            local_hist.digest(voxel_val, pxl_vol);
                         }
                         return;
                     };
 
-                    Mutate_Voxels<float,double>( img_refw,
-                                                 { img_refw },
-                                                 named_ccsl.second, 
-                                                 user_data_s->mutation_opts, 
-                                                 f_bounded );
+                    Mutate_Voxels_Cached( img_refw,
+                                          { img_refw },
+                                          named_ccsl.second, 
+                                          user_data_s->mutation_opts, 
+                                          f_bounded, {}, {},
+                                          user_data_s->mask_cache );
 
-                    add_counts(); // Commit all remaining bins from the shuttle.
+                    // Merge the results.
+                    if(local_hist.get_moments().count != 0){
+                        std::lock_guard<std::mutex> lock(saver);
+
+                        const auto key = named_ccsl.first;
+                        auto it = merged_histograms.find(key);
+                        if(it == std::end(merged_histograms)){
+                            merged_histograms.emplace(key, std::move(local_hist));
+                        }else{
+                            it->second.merge(local_hist);
+                        }
+                    }
                 } // Loop over all named ccs.
 
                 //Report operation progress.
@@ -300,8 +187,8 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
     for(auto & named_ccsl : named_ccsls){
         const auto key = named_ccsl.first;
 
-        if( (bin_counts.count(key) != 1)
-        ||  (bin_counts[key] < 2) ){
+        auto it = merged_histograms.find(key);
+        if(it == std::end(merged_histograms)){
             FUNCWARN("Computed histogram with few enclosed voxels, or excessively coarse resolution. Skipping");
             continue;
             //Could be due to:
@@ -310,23 +197,32 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
             // -dose/contours not being present. Maybe accidentally?
             // -dDose being too large.
         }
+        const auto &hist = it->second;
+        const auto voxel_min = hist.get_moments().min;
+        const auto voxel_max = hist.get_moments().max;
+        const auto count_f = (voxel_max - voxel_min) / user_data_s->dDose;
+        if( hist.overflowed()
+        ||  !std::isfinite(count_f)
+        ||  (count_f <= 1.0) ){
+            FUNCWARN("Excessive or invalid number of bins required for key '" << key << "'. Skipping it");
+            continue;
+        }
 
-        user_data_s->differential_histograms[key].samples.swap( raw_diff_histograms.at(key) );
+        // Note: bin values are centred.
+        std::vector<std::array<double,4>> &hist_samples( user_data_s->differential_histograms[key].samples );
+        hist_samples.clear();
+        hist_samples.reserve(hist.get_bin_count());
+        for(long int bin = hist.get_first_bin(); bin < (hist.get_first_bin() + hist.get_bin_count()); ++bin){
+            hist_samples.push_back( { hist.bin_centre(bin), 0.0, hist.bin_weight(bin), 0.0 } );
+        }
 
         user_data_s->differential_histograms[key].metadata["Modality"]        = "Histogram"; 
         user_data_s->differential_histograms[key].metadata["HistogramType"]   = "Differential";
         user_data_s->differential_histograms[key].metadata["AbscissaScaling"] = "None"; // Absolute values in DICOM units, Gy.
         user_data_s->differential_histograms[key].metadata["OrdinateScaling"] = "None"; // Absolute values in DICOM units, mm^3.
 
-        const auto voxel_min = voxel_extrema.at(key).first;
-        const auto voxel_max = voxel_extrema.at(key).second;
-        //const auto range = (voxel_max - voxel_min);
-        //const auto bin_count = bin_counts.at(key);
-        //const auto bin_width = bin_widths.at(key);
-
         Stats::Running_Sum<double> x_v;
         Stats::Running_Sum<double> v;
-        std::vector<std::array<double,4>> &hist_samples( user_data_s->differential_histograms[key].samples );
         for(const auto &s : hist_samples){
             x_v.Digest(s[0]*s[2]);
             v.Digest(s[2]);
@@ -358,7 +254,7 @@ bool ComputeExtractHistograms(planar_image_collection<float,double> &imagecoll,
         user_data_s->cumulative_histograms[key] = hist.second;
         user_data_s->cumulative_histograms[key].metadata["HistogramType"] = "Cumulative";
 
-        const auto bin_width = bin_widths.at(key);
+        const auto bin_width = user_data_s->dDose;
         const auto extra_bin_x = user_data_s->cumulative_histograms[key].samples.back()[0] + bin_width;
         user_data_s->cumulative_histograms[key].push_back(extra_bin_x, 0.0);
 
@@ -6,6 +6,7 @@
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "YgorImages.h"
@@ -13,6 +14,7 @@
 
 template <class T, class R> class planar_image_collection;
 template <class T> class contour_collection;
+class Voxel_Mask_Cache;
 
 struct ComputeExtractHistogramsUserData {
 
@@ -30,7 +32,13 @@ struct ComputeExtractHistogramsUserData {
     //mutation_opts.maskmod        = Mutate_Voxels_Opts::MaskMod::Noop;
 
     // -----------------------------
-    // The width of histogram bins, in DICOM units (nominally Gy).
+    // An optional cache of contour-voxel containment. If provided, containment is only computed once per ROI and image
+    // and reused by subsequent passes (and subsequent operations sharing the cache).
+    //
+    std::shared_ptr<Voxel_Mask_Cache> mask_cache;
+
+    // -----------------------------
+    // The width of histogram bins, in DICOM units (nominally Gy). Bin edges are integer multiples of the width.
     //
     double dDose = 1.0;
 
@@ -8,6 +8,7 @@
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <set>
 
 #include "YgorImages.h"
@@ -15,6 +16,7 @@
 #include "YgorMisc.h"
 
 template <class T> class contour_collection;
+class Voxel_Mask_Cache;
 
 
 struct PartitionedImageVoxelVisitorMutatorUserData {
@@ -27,6 +29,10 @@ struct PartitionedImageVoxelVisitorMutatorUserData {
     Mutate_Voxels_Functor<float,double> f_visitor;   // Applied to all voxels.
     
     std::string description; // If non-empty, used to update image metadata.
+
+    // If provided, contour-voxel containment is memoized and shared with other users of the cache.
+    // Note: the functors will not be provided a valid mask image when a cached mask is used.
+    std::shared_ptr<Voxel_Mask_Cache> mask_cache;
 };
 
 
@@ -0,0 +1,89 @@
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Benchmark_Harness.h"
+
+
+TEST_CASE( "run_benchmark" ){
+    long int setups = 0;
+    long int runs = 0;
+    benchmark_case bc;
+    bc.name = "counter";
+    bc.setup = [&](){ ++setups; };
+    bc.run = [&](){ ++runs; };
+
+    SUBCASE("warmups are run but not recorded"){
+        const auto r = run_benchmark(bc, 4, 2);
+        REQUIRE( r.name == "counter" );
+        REQUIRE( r.timings.size() == 4 );
+        REQUIRE( setups == 6 );
+        REQUIRE( runs == 6 );
+        for(const auto &t : r.timings) REQUIRE( 0.0 <= t );
+    }
+
+    SUBCASE("invalid benchmarks are rejected"){
+        REQUIRE_THROWS( run_benchmark(bc, 0) );
+        bc.run = nullptr;
+        REQUIRE_THROWS( run_benchmark(bc, 1) );
+    }
+
+    SUBCASE("exceptions are propagated"){
+        bc.run = [](){ throw std::runtime_error("failure"); };
+        REQUIRE_THROWS( run_benchmark(bc, 1) );
+    }
+}
+
+TEST_CASE( "summarize_timings" ){
+    benchmark_result r;
+    r.timings = { 4.0, 1.0, 3.0, 2.0 };
+    summarize_timings(r);
+    REQUIRE( r.min == 1.0 );
+    REQUIRE( r.median == 2.5 );
+    REQUIRE( r.mean == 2.5 );
+    REQUIRE( std::abs(r.stddev - std::sqrt(5.0 / 3.0)) < 1.0E-12 );
+
+    r.timings = { 3.0 };
+    summarize_timings(r);
+    REQUIRE( r.median == 3.0 );
+    REQUIRE( r.stddev == 0.0 );
+
+    r.timings.clear();
+    summarize_timings(r);
+    REQUIRE( std::isnan(r.median) );
+}
+
+TEST_CASE( "write_benchmarks_json" ){
+    std::vector<benchmark_result> results(2);
+    results[0].name = "first \"quoted\"";
+    results[0].timings = { 1.5, 0.5 };
+    summarize_timings(results[0]);
+    results[1].name = "second";
+    summarize_timings(results[1]);
+
+    std::map<std::string, std::string> context;
+    context["version"] = "a\\b";
+
+    std::stringstream ss;
+    write_benchmarks_json(ss, context, results);
+    const auto json = ss.str();
+
+    REQUIRE( json.find("\"version\": \"a\\\\b\"") != std::string::npos );
+    REQUIRE( json.find("\"name\": \"first \\\"quoted\\\"\"") != std::string::npos );
+    REQUIRE( json.find("\"repetitions\": 2") != std::string::npos );
+    REQUIRE( json.find("\"median_time\": 1,") != std::string::npos );
+    REQUIRE( json.find("\"timings\": [1.5, 0.5]") != std::string::npos );
+    REQUIRE( json.find("\"real_time\": null") != std::string::npos ); // No timings for the second result.
+
+    std::stringstream empty;
+    write_benchmarks_json(empty, {}, {});
+    REQUIRE( empty.str() == "{\n  \"context\": {},\n  \"benchmarks\": []\n}\n" );
+}
+
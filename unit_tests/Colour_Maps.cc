@@ -0,0 +1,74 @@
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Colour_Maps.h"
+
+
+static ClampedColourRGB test_colour_map(double y){
+    return { y, 1.0 - y, 0.5 };
+}
+
+TEST_CASE( "Colour_Map_LUT" ){
+    Colour_Map_LUT lut(test_colour_map);
+
+    SUBCASE("lookups match the colour map at the table resolution"){
+        for(double y : { 0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 1.0 }){
+            const auto &c = lut(y);
+            REQUIRE( std::abs(static_cast<double>(c[0]) - std::floor(y * 255.0)) <= 1.0 );
+            REQUIRE( std::abs(static_cast<double>(c[1]) - std::floor((1.0 - y) * 255.0)) <= 1.0 );
+            REQUIRE( c[2] == 127 );
+        }
+    }
+
+    SUBCASE("inputs are clamped"){
+        REQUIRE( lut(-5.0) == lut(0.0) );
+        REQUIRE( lut(5.0) == lut(1.0) );
+        REQUIRE( lut(std::numeric_limits<double>::quiet_NaN()) == lut(0.0) );
+    }
+
+    SUBCASE("clamped colours round-trip to the same bytes"){
+        const auto c = lut.clamped(0.3);
+        REQUIRE( static_cast<uint8_t>(std::floor(c.R * 255.0)) == lut(0.3)[0] );
+        REQUIRE( static_cast<uint8_t>(std::floor(c.G * 255.0)) == lut(0.3)[1] );
+    }
+
+    SUBCASE("batched mapping honours the window, stride, and non-finite values"){
+        // Two interleaved channels; only the first is mapped.
+        const std::vector<float> pixels = { 10.0f, -1.0f,
+                                            15.0f, -1.0f,
+                                            20.0f, -1.0f,
+                                            std::numeric_limits<float>::quiet_NaN(), -1.0f,
+                                            std::numeric_limits<float>::infinity(), -1.0f };
+        const Colour_Map_LUT::rgb_t nan_colour = {{ 1, 2, 3 }};
+        std::vector<uint8_t> out(5 * 3, 0);
+
+        // Window [10,20].
+        lut.map_pixels(pixels.data(), 5, 2, 1.0 / 10.0, -1.0, nan_colour, out.data());
+
+        const auto check = [&](long int i, const Colour_Map_LUT::rgb_t &expected){
+            REQUIRE( out[3 * i + 0] == expected[0] );
+            REQUIRE( out[3 * i + 1] == expected[1] );
+            REQUIRE( out[3 * i + 2] == expected[2] );
+        };
+        check(0, lut(0.0));
+        check(1, lut(0.5));
+        check(2, lut(1.0));
+        check(3, nan_colour);
+        check(4, nan_colour);
+    }
+
+    SUBCASE("shared tables are only provided for plain functions"){
+        const auto a = Get_Colour_Map_LUT(test_colour_map);
+        const auto b = Get_Colour_Map_LUT(&test_colour_map);
+        REQUIRE( a != nullptr );
+        REQUIRE( a == b );
+        REQUIRE( Get_Colour_Map_LUT([](double y) -> ClampedColourRGB { return { y, y, y }; }) == nullptr );
+        REQUIRE( Get_Colour_Map_LUT(ColourMap_Linear)->operator()(1.0)[0] == 255 );
+    }
+}
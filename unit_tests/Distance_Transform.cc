@@ -0,0 +1,209 @@
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "FFT_Correlation.h"
+#include "Distance_Transform.h"
+
+
+static dense_volume random_mask(long int images, long int rows, long int columns, double density, std::mt19937 &gen){
+    std::bernoulli_distribution dist(density);
+    dense_volume v(images, rows, columns);
+    for(auto &x : v.data) x = dist(gen) ? 1.0f : 0.0f;
+    return v;
+}
+
+// Exhaustive evaluation of the distance from every voxel to the nearest voxel with the given feature state.
+static dense_volume brute_force_distance(const dense_volume &mask,
+                                         const std::array<double, 3> &spacing,
+                                         bool features_are_nonzero){
+    const auto inf = std::numeric_limits<double>::infinity();
+    dense_volume out(mask.images, mask.rows, mask.columns);
+    for(long int i = 0; i < mask.images; ++i){
+        for(long int r = 0; r < mask.rows; ++r){
+            for(long int c = 0; c < mask.columns; ++c){
+                double best = inf;
+                for(long int fi = 0; fi < mask.images; ++fi){
+                    for(long int fr = 0; fr < mask.rows; ++fr){
+                        for(long int fc = 0; fc < mask.columns; ++fc){
+                            if((mask.value(fi, fr, fc) != 0.0f) != features_are_nonzero) continue;
+
+                            // Infinite spacing forbids any displacement along the axis.
+                            double d2 = 0.0;
+                            const std::array<long int, 3> dx = {{ fi - i, fr - r, fc - c }};
+                            for(size_t a = 0; a < 3; ++a){
+                                if(dx[a] == 0) continue;
+                                const auto l = spacing[a] * static_cast<double>(dx[a]);
+                                d2 += l * l;
+                            }
+                            if(d2 < best) best = d2;
+                        }
+                    }
+                }
+                out.reference(i, r, c) = static_cast<float>(std::sqrt(best));
+            }
+        }
+    }
+    return out;
+}
+
+static void require_match(const dense_volume &A, const dense_volume &B){
+    REQUIRE(A.dimensions() == B.dimensions());
+    for(size_t n = 0; n < A.data.size(); ++n){
+        if(std::isinf(B.data[n])){
+            REQUIRE(A.data[n] == B.data[n]);
+        }else{
+            REQUIRE( std::abs(A.data[n] - B.data[n]) < 1.0e-4 );
+        }
+    }
+}
+
+
+TEST_CASE( "Euclidean_Distance_Transform matches brute force" ){
+    std::mt19937 gen(17);
+
+    SUBCASE("isotropic spacing"){
+        const auto mask = random_mask(5, 6, 7, 0.1, gen);
+        const std::array<double, 3> spacing = {{ 1.0, 1.0, 1.0 }};
+        require_match(Euclidean_Distance_Transform(mask, spacing), brute_force_distance(mask, spacing, true));
+    }
+
+    SUBCASE("anisotropic spacing"){
+        const auto mask = random_mask(4, 9, 8, 0.05, gen);
+        const std::array<double, 3> spacing = {{ 2.5, 0.7, 1.3 }};
+        require_match(Euclidean_Distance_Transform(mask, spacing), brute_force_distance(mask, spacing, true));
+    }
+
+    SUBCASE("infinite spacing confines distances to planes"){
+        const auto mask = random_mask(6, 5, 5, 0.08, gen);
+        const auto inf = std::numeric_limits<double>::infinity();
+        const std::array<double, 3> spacing = {{ inf, 1.0, 2.0 }};
+        require_match(Euclidean_Distance_Transform(mask, spacing), brute_force_distance(mask, spacing, true));
+    }
+
+    SUBCASE("single voxel wide volumes"){
+        const auto mask = random_mask(1, 1, 20, 0.2, gen);
+        const std::array<double, 3> spacing = {{ 1.0, 1.0, 0.5 }};
+        require_match(Euclidean_Distance_Transform(mask, spacing), brute_force_distance(mask, spacing, true));
+    }
+}
+
+TEST_CASE( "Euclidean_Distance_Transform edge cases" ){
+    const std::array<double, 3> spacing = {{ 1.0, 1.0, 1.0 }};
+
+    SUBCASE("empty masks are infinitely distant"){
+        const dense_volume mask(3, 3, 3);
+        const auto dt = Euclidean_Distance_Transform(mask, spacing);
+        for(const auto &x : dt.data) REQUIRE(std::isinf(x));
+    }
+
+    SUBCASE("features are zero distance"){
+        const dense_volume mask(2, 3, 4, 1.0f);
+        const auto dt = Euclidean_Distance_Transform(mask, spacing);
+        for(const auto &x : dt.data) REQUIRE(x == 0.0f);
+    }
+
+    SUBCASE("invalid spacing is rejected"){
+        const dense_volume mask(2, 2, 2);
+        REQUIRE_THROWS(Euclidean_Distance_Transform(mask, {{ 0.0, 1.0, 1.0 }}));
+        REQUIRE_THROWS(Euclidean_Distance_Transform(mask, {{ 1.0, -1.0, 1.0 }}));
+        REQUIRE_THROWS(Euclidean_Distance_Transform(mask, {{ 1.0, 1.0, std::numeric_limits<double>::quiet_NaN() }}));
+    }
+}
+
+TEST_CASE( "Signed_Distance_Transform" ){
+    std::mt19937 gen(23);
+    const auto mask = random_mask(4, 7, 6, 0.3, gen);
+    const std::array<double, 3> spacing = {{ 2.0, 1.0, 1.5 }};
+
+    const auto sdt = Signed_Distance_Transform(mask, spacing);
+    const auto outside = brute_force_distance(mask, spacing, true);
+    const auto inside = brute_force_distance(mask, spacing, false);
+
+    for(size_t n = 0; n < mask.data.size(); ++n){
+        if(mask.data[n] != 0.0f){
+            REQUIRE(sdt.data[n] < 0.0f);
+            REQUIRE( std::abs(sdt.data[n] + inside.data[n]) < 1.0e-4 );
+        }else{
+            REQUIRE(0.0f < sdt.data[n]);
+            REQUIRE( std::abs(sdt.data[n] - outside.data[n]) < 1.0e-4 );
+        }
+    }
+}
+
+
+TEST_CASE( "Margin_Scaled_Spacing realizes the requested margin" ){
+    // A box of feature voxels, which spans voxels [lo, hi] along every axis, so the box boundary lies half a voxel
+    // beyond the outermost voxel centres.
+    const long int n = 31;
+    const long int lo = 10;
+    const long int hi = 20;
+    dense_volume mask(n, n, n);
+    for(long int i = lo; i <= hi; ++i){
+        for(long int r = lo; r <= hi; ++r){
+            for(long int c = lo; c <= hi; ++c){
+                mask.reference(i, r, c) = 1.0f;
+            }
+        }
+    }
+    const std::array<double, 3> spacing = {{ 2.0, 0.8, 1.3 }};
+
+    // Finds where the grown (or shrunk) region ends along a line through the middle of the box, extending from the box
+    // centre in the positive direction of the given axis. Like contouring, the distance map is linearly interpolated
+    // between voxel centres. Returns the displacement relative to the box boundary.
+    const auto realized_margin = [&](const std::array<double, 3> &margin, size_t axis) -> double {
+        const auto sdt = Signed_Distance_Transform(mask, Margin_Scaled_Spacing(margin, spacing));
+        const double level = (margin[axis] < 0.0) ? -1.0 : 1.0;
+        const long int mid = (lo + hi) / 2;
+        std::array<long int, 3> x = {{ mid, mid, mid }};
+        const auto field = [&](long int p) -> double {
+            x[axis] = p;
+            return level - static_cast<double>(sdt.value(x[0], x[1], x[2]));
+        };
+        for(long int p = mid; (p + 1) < n; ++p){
+            const auto f0 = field(p);
+            const auto f1 = field(p + 1);
+            if((0.0 <= f0) && (f1 < 0.0)){
+                const auto crossing = static_cast<double>(p) + f0 / (f0 - f1);
+                const auto boundary = static_cast<double>(hi) + 0.5;
+                return (crossing - boundary) * spacing[axis];
+            }
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    };
+
+    SUBCASE("isotropic margins grow the boundary"){
+        const std::array<double, 3> margin = {{ 5.0, 5.0, 5.0 }};
+        for(size_t a = 0; a < 3; ++a){
+            REQUIRE( std::abs(realized_margin(margin, a) - 5.0) < 1.0e-4 );
+        }
+    }
+
+    SUBCASE("anisotropic margins grow the boundary"){
+        const std::array<double, 3> margin = {{ 7.0, 2.5, 4.0 }};
+        for(size_t a = 0; a < 3; ++a){
+            REQUIRE( std::abs(realized_margin(margin, a) - margin[a]) < 1.0e-4 );
+        }
+    }
+
+    SUBCASE("negative margins shrink the boundary"){
+        const std::array<double, 3> margin = {{ -3.0, -2.0, -2.5 }};
+        for(size_t a = 0; a < 3; ++a){
+            REQUIRE( std::abs(realized_margin(margin, a) - margin[a]) < 1.0e-4 );
+        }
+    }
+
+    SUBCASE("axes without a margin are disconnected"){
+        const auto s = Margin_Scaled_Spacing({{ 0.0, 1.0, -1.0 }}, spacing);
+        REQUIRE( std::isinf(s[0]) );
+        REQUIRE( std::isfinite(s[1]) );
+        REQUIRE( std::abs(s[1] - spacing[1] / (1.0 + 0.5 * spacing[1])) < 1.0e-12 );
+        REQUIRE( std::abs(s[2] - spacing[2] / (1.0 + 0.5 * spacing[2])) < 1.0e-12 );
+        REQUIRE_THROWS(Margin_Scaled_Spacing({{ std::numeric_limits<double>::infinity(), 1.0, 1.0 }}, spacing));
+    }
+}
@@ -0,0 +1,93 @@
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Explicator.h"
+
+#include "doctest/doctest.h"
+
+#include "Explicator_Cache.h"
+
+
+// The cache is process-wide and keyed on the filename, so each lexicon gets a distinct filename. Otherwise results
+// memoized by one subcase would be served to the next.
+static std::string write_test_lexicon(){
+    static long int count = 0;
+    const auto fname = ( std::filesystem::temp_directory_path()
+                         / ("dcma_explicator_cache_test_" + std::to_string(count++) + ".lexicon") ).string();
+    std::ofstream of(fname);
+    of << "Body : body" << std::endl
+       << "Body : external" << std::endl
+       << "Left Parotid : left parotid" << std::endl
+       << "Left Parotid : l par" << std::endl
+       << "Right Parotid : right parotid" << std::endl
+       << "Right Parotid : r par" << std::endl
+       << "Spinal Cord : spinal cord" << std::endl
+       << "Spinal Cord : cord" << std::endl;
+    return fname;
+}
+
+
+TEST_CASE( "Explicate matches a direct Explicator" ){
+    const auto lexicon = write_test_lexicon();
+    const std::vector<std::string> names = { "BODY", "l_parotid", "R Par", "cord", "External", "l_parotid", "cord" };
+
+    Explicator X(lexicon);
+    std::vector<std::string> expected;
+    for(const auto &n : names) expected.push_back( X(n) );
+
+    SUBCASE("individual translations"){
+        for(size_t i = 0; i < names.size(); ++i){
+            REQUIRE( Explicate(lexicon, names[i]) == expected[i] );
+        }
+        // Memoized results are identical.
+        for(size_t i = 0; i < names.size(); ++i){
+            REQUIRE( Explicate(lexicon, names[i]) == expected[i] );
+        }
+    }
+
+    SUBCASE("batch translations preserve input order"){
+        const auto out = Explicate(lexicon, names);
+        REQUIRE( out == expected );
+
+        // Every distinct name was translated by the batch path, and the lexicon was only parsed once.
+        const long int N_distinct = 5;
+        const auto stats = Get_Explicator_Cache_Stats(lexicon);
+        REQUIRE( stats.batch_translations == N_distinct );
+        REQUIRE( stats.translations == N_distinct );
+        REQUIRE( stats.lexicon_parses == 1 );
+
+        cached_explicator cX(lexicon);
+        REQUIRE( cX(names) == expected );
+        REQUIRE( cX(names.front()) == expected.front() );
+
+        // Repeated translations are served from the memo.
+        REQUIRE( Get_Explicator_Cache_Stats(lexicon).translations == N_distinct );
+    }
+
+    SUBCASE("large batches parse additional instances concurrently"){
+        std::vector<std::string> many;
+        for(long int i = 0; i < 5000; ++i) many.push_back( names[i % names.size()] + "_" + std::to_string(i) );
+
+        const auto out = Explicate(lexicon, many);
+        for(size_t i = 0; i < many.size(); ++i){
+            REQUIRE( out[i] == X(many[i]) );
+        }
+
+        const auto N_threads = std::max<long int>(1, std::thread::hardware_concurrency());
+        const auto stats = Get_Explicator_Cache_Stats(lexicon);
+        REQUIRE( stats.batch_translations == static_cast<long int>(many.size()) );
+        REQUIRE( stats.lexicon_parses == std::min<long int>(N_threads, many.size() / 256) );
+    }
+
+    SUBCASE("empty batches are handled"){
+        REQUIRE( Explicate(lexicon, std::vector<std::string>{}).empty() );
+    }
+
+    std::filesystem::remove(lexicon);
+}
+
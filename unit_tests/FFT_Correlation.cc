@@ -0,0 +1,167 @@
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "FFT_Correlation.h"
+
+
+static dense_volume random_volume(long int images, long int rows, long int columns, std::mt19937 &gen){
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    dense_volume v(images, rows, columns);
+    for(auto &x : v.data) x = dist(gen);
+    return v;
+}
+
+// Voxel-by-voxel evaluation, mirroring the direct neighbourhood sampler.
+static dense_volume direct_correlate(const dense_volume &vol,
+                                     const dense_volume &kernel,
+                                     const std::array<long int, 3> &centre,
+                                     Correlation_Reduction reduction){
+    dense_volume out(vol.images, vol.rows, vol.columns, std::numeric_limits<float>::quiet_NaN());
+    for(long int i = 0; i < vol.images; ++i){
+        for(long int r = 0; r < vol.rows; ++r){
+            for(long int c = 0; c < vol.columns; ++c){
+                std::vector<double> xs, ks;
+                bool valid = true;
+                for(long int ki = 0; ki < kernel.images; ++ki){
+                    for(long int kr = 0; kr < kernel.rows; ++kr){
+                        for(long int kc = 0; kc < kernel.columns; ++kc){
+                            const auto li = i - centre[0] + ki;
+                            const auto lr = r - centre[1] + kr;
+                            const auto lc = c - centre[2] + kc;
+                            if( (li < 0) || (vol.images <= li)
+                            ||  (lr < 0) || (vol.rows <= lr)
+                            ||  (lc < 0) || (vol.columns <= lc)
+                            ||  !std::isfinite(vol.value(li, lr, lc)) ){
+                                valid = false;
+                                continue;
+                            }
+                            xs.push_back(vol.value(li, lr, lc));
+                            ks.push_back(kernel.value(ki, kr, kc));
+                        }
+                    }
+                }
+                if(!valid) continue;
+
+                double v = 0.0;
+                if(reduction == Correlation_Reduction::InnerProduct){
+                    for(size_t n = 0; n < xs.size(); ++n) v += xs[n] * ks[n];
+                }else if(reduction == Correlation_Reduction::EuclideanDistance){
+                    for(size_t n = 0; n < xs.size(); ++n) v += (xs[n] - ks[n]) * (xs[n] - ks[n]);
+                    v = std::sqrt(v);
+                }else{
+                    double mx = 0.0, mk = 0.0;
+                    for(size_t n = 0; n < xs.size(); ++n){ mx += xs[n]; mk += ks[n]; }
+                    mx /= xs.size();
+                    mk /= ks.size();
+                    double sxk = 0.0, sxx = 0.0, skk = 0.0;
+                    for(size_t n = 0; n < xs.size(); ++n){
+                        sxk += (xs[n] - mx) * (ks[n] - mk);
+                        sxx += (xs[n] - mx) * (xs[n] - mx);
+                        skk += (ks[n] - mk) * (ks[n] - mk);
+                    }
+                    v = (0.0 < sxx * skk) ? sxk / std::sqrt(sxx * skk) : 0.0;
+                }
+                out.reference(i, r, c) = static_cast<float>(v);
+            }
+        }
+    }
+    return out;
+}
+
+static void require_equivalent(const dense_volume &A, const dense_volume &B){
+    REQUIRE( A.data.size() == B.data.size() );
+    for(size_t n = 0; n < A.data.size(); ++n){
+        REQUIRE( std::isnan(A.data[n]) == std::isnan(B.data[n]) );
+        if(!std::isnan(A.data[n])) REQUIRE( std::abs(A.data[n] - B.data[n]) < 1.0e-3 );
+    }
+}
+
+TEST_CASE( "fft_plan" ){
+    const long int n = 16;
+    fft_plan plan(n);
+    std::vector<std::complex<double>> x(n);
+    for(long int i = 0; i < n; ++i) x[i] = std::complex<double>(std::sin(0.3 * i), std::cos(1.7 * i));
+    auto y = x;
+    plan.execute(y.data(), false);
+
+    // Compare with a naive DFT.
+    for(long int k = 0; k < n; ++k){
+        std::complex<double> s(0.0, 0.0);
+        for(long int j = 0; j < n; ++j){
+            s += x[j] * std::polar(1.0, -2.0 * 3.14159265358979323846 * k * j / n);
+        }
+        REQUIRE( std::abs(s - y[k]) < 1.0e-9 );
+    }
+
+    plan.execute(y.data(), true);
+    for(long int i = 0; i < n; ++i) REQUIRE( std::abs(y[i] / static_cast<double>(n) - x[i]) < 1.0e-12 );
+
+    REQUIRE_THROWS( fft_plan(12) );
+}
+
+TEST_CASE( "FFT_Correlate" ){
+    std::mt19937 gen(12345);
+    auto vol = random_volume(7, 13, 11, gen);
+    const auto kernel = random_volume(3, 4, 5, gen);
+    const std::array<long int, 3> centre = {{ 1, 2, 2 }};
+
+    SUBCASE("matches direct evaluation with a single tile"){
+        for(auto red : { Correlation_Reduction::InnerProduct,
+                         Correlation_Reduction::EuclideanDistance,
+                         Correlation_Reduction::NormalizedCrossCorrelation }){
+            require_equivalent( FFT_Correlate(vol, kernel, centre, red),
+                                direct_correlate(vol, kernel, centre, red) );
+        }
+    }
+
+    SUBCASE("matches direct evaluation with many tiles"){
+        for(auto red : { Correlation_Reduction::InnerProduct,
+                         Correlation_Reduction::EuclideanDistance,
+                         Correlation_Reduction::NormalizedCrossCorrelation }){
+            require_equivalent( FFT_Correlate(vol, kernel, centre, red, 8),
+                                direct_correlate(vol, kernel, centre, red) );
+        }
+    }
+
+    SUBCASE("non-finite samples only affect overlapping neighbourhoods"){
+        vol.reference(3, 6, 5) = std::numeric_limits<float>::quiet_NaN();
+        require_equivalent( FFT_Correlate(vol, kernel, centre, Correlation_Reduction::InnerProduct, 8),
+                            direct_correlate(vol, kernel, centre, Correlation_Reduction::InnerProduct) );
+    }
+
+    SUBCASE("a pattern is located exactly"){
+        dense_volume pattern(3, 4, 5);
+        for(long int i = 0; i < 3; ++i){
+            for(long int r = 0; r < 4; ++r){
+                for(long int c = 0; c < 5; ++c){
+                    pattern.reference(i, r, c) = vol.value(2 + i, 5 + r, 3 + c);
+                }
+            }
+        }
+        const auto d = FFT_Correlate(vol, pattern, centre, Correlation_Reduction::EuclideanDistance);
+        REQUIRE( d.value(2 + centre[0], 5 + centre[1], 3 + centre[2]) < 1.0e-3 );
+        const auto ncc = FFT_Correlate(vol, pattern, centre, Correlation_Reduction::NormalizedCrossCorrelation);
+        REQUIRE( std::abs(ncc.value(2 + centre[0], 5 + centre[1], 3 + centre[2]) - 1.0f) < 1.0e-4 );
+    }
+
+    SUBCASE("single-image volumes are supported"){
+        auto flat = random_volume(1, 20, 20, gen);
+        const auto k2d = random_volume(1, 5, 5, gen);
+        const std::array<long int, 3> c2d = {{ 0, 2, 2 }};
+        require_equivalent( FFT_Correlate(flat, k2d, c2d, Correlation_Reduction::InnerProduct),
+                            direct_correlate(flat, k2d, c2d, Correlation_Reduction::InnerProduct) );
+    }
+
+    SUBCASE("the method is chosen based on kernel size"){
+        REQUIRE( !FFT_Correlation_Is_Favourable({{ 100, 256, 256 }}, {{ 1, 1, 1 }}) );
+        REQUIRE( !FFT_Correlation_Is_Favourable({{ 100, 256, 256 }}, {{ 3, 3, 3 }}) );
+        REQUIRE( FFT_Correlation_Is_Favourable({{ 100, 256, 256 }}, {{ 30, 30, 30 }}) );
+    }
+}
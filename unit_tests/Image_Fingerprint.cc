@@ -0,0 +1,80 @@
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"
+
+#include "doctest/doctest.h"
+
+#include "Image_Fingerprint.h"
+
+
+static planar_image<float,double> make_test_image(){
+    planar_image<float,double> img;
+    img.init_buffer(8, 6, 1);
+    img.init_spatial(1.0, 1.0, 2.0, vec3<double>(0.0, 0.0, 0.0), vec3<double>(0.0, 0.0, 0.0));
+    img.init_orientation(vec3<double>(0.0, 1.0, 0.0), vec3<double>(1.0, 0.0, 0.0));
+    long int i = 0;
+    for(auto &v : img.data) v = static_cast<float>(i++);
+    img.metadata["SOPInstanceUID"] = "1.2.3.4";
+    img.metadata["Filename"] = "/tmp/a.dcm";
+    return img;
+}
+
+
+TEST_CASE( "XXH64_Hash matches reference values" ){
+    const std::string empty;
+    const std::string abc = "abc";
+    const std::string longer = "Nobody inspects the spammish repetition";
+
+    REQUIRE( XXH64_Hash(empty.data(), empty.size()) == 0xEF46DB3751D8E999ULL );
+    REQUIRE( XXH64_Hash(abc.data(), abc.size()) == 0x44BC2CF5AD770999ULL );
+    REQUIRE( XXH64_Hash(longer.data(), longer.size()) == 0xFBCEA83C8A378BF1ULL );
+
+    SUBCASE("the seed alters the hash"){
+        REQUIRE( XXH64_Hash(abc.data(), abc.size(), 1) != XXH64_Hash(abc.data(), abc.size(), 0) );
+    }
+}
+
+TEST_CASE( "Fingerprint_Image distinguishes geometry, voxels, and metadata" ){
+    const auto A = make_test_image();
+    const auto fA = Fingerprint_Image(A);
+
+    SUBCASE("identical images have identical fingerprints"){
+        auto B = make_test_image();
+        B.metadata["Filename"] = "/tmp/b.dcm"; // The originating file is disregarded.
+        const auto fB = Fingerprint_Image(B);
+        REQUIRE( fA.geometry == fB.geometry );
+        REQUIRE( fA.voxels == fB.voxels );
+        REQUIRE( fA.metadata == fB.metadata );
+    }
+
+    SUBCASE("altering a single voxel only alters the voxel fingerprint"){
+        auto B = make_test_image();
+        B.reference(3, 2, 0) += 1.0f;
+        const auto fB = Fingerprint_Image(B);
+        REQUIRE( fA.geometry == fB.geometry );
+        REQUIRE( fA.voxels != fB.voxels );
+        REQUIRE( fA.metadata == fB.metadata );
+    }
+
+    SUBCASE("altering the position only alters the geometry fingerprint"){
+        auto B = make_test_image();
+        B.offset = vec3<double>(0.0, 0.0, 2.0);
+        const auto fB = Fingerprint_Image(B);
+        REQUIRE( fA.geometry != fB.geometry );
+        REQUIRE( fA.voxels == fB.voxels );
+    }
+
+    SUBCASE("altering metadata only alters the metadata fingerprint"){
+        auto B = make_test_image();
+        B.metadata["SOPInstanceUID"] = "1.2.3.5";
+        const auto fB = Fingerprint_Image(B);
+        REQUIRE( fA.geometry == fB.geometry );
+        REQUIRE( fA.voxels == fB.voxels );
+        REQUIRE( fA.metadata != fB.metadata );
+    }
+}
+
@@ -0,0 +1,86 @@
+
+#include <filesystem>
+#include <list>
+#include <memory>
+
+#include "YgorImages.h"
+
+#include "doctest/doctest.h"
+
+#include "Image_Spill_Store.h"
+
+
+static planar_image<float,double> make_test_image(float offset){
+    planar_image<float,double> img;
+    img.init_buffer(10, 10, 1);
+    long int i = 0;
+    for(auto &v : img.data) v = offset + static_cast<float>(i++);
+    return img;
+}
+
+TEST_CASE( "Image_Spill_Store" ){
+    const size_t img_bytes = 10 * 10 * sizeof(float);
+    std::list<planar_image<float,double>> imgs;
+    for(long int i = 0; i < 4; ++i) imgs.emplace_back( make_test_image(100.0f * i) );
+
+    SUBCASE("images are evicted least-recently-used to honour the budget"){
+        Image_Spill_Store store(std::filesystem::path(), 2 * img_bytes);
+        for(auto &img : imgs) store.manage(img);
+
+        REQUIRE( store.get_resident_bytes() <= 2 * img_bytes );
+        REQUIRE( !store.is_resident(imgs.front()) );
+        REQUIRE( imgs.front().data.empty() );
+        REQUIRE( store.is_resident(imgs.back()) );
+    }
+
+    SUBCASE("pinned images are paged in and never evicted"){
+        Image_Spill_Store store(std::filesystem::path(), 1 * img_bytes);
+        for(auto &img : imgs) store.manage(img);
+
+        auto &first = imgs.front();
+        auto &second = *std::next(std::begin(imgs));
+        {
+            pinned_images pinned(&store, { &first, &second });
+            REQUIRE( first.data.size() == 100 );
+            REQUIRE( second.data.size() == 100 );
+            REQUIRE( first.data[5] == 5.0f );
+            REQUIRE( second.data[5] == 105.0f );
+            REQUIRE( store.get_resident_bytes() == 2 * img_bytes ); // The budget is temporarily exceeded.
+        }
+        REQUIRE( store.get_resident_bytes() <= 1 * img_bytes );
+    }
+
+    SUBCASE("modifications made while pinned are preserved"){
+        Image_Spill_Store store(std::filesystem::path(), 0);
+        auto &img = imgs.front();
+        store.manage(img);
+        REQUIRE( !store.is_resident(img) );
+
+        {
+            pinned_images pinned(&store, { &img }, true);
+            img.data[3] = -1.0f;
+        }
+        REQUIRE( !store.is_resident(img) );
+        REQUIRE( store.copy_voxels(img)[3] == -1.0f );
+
+        store.restore_all();
+        REQUIRE( !store.is_managed(img) );
+        REQUIRE( img.data[3] == -1.0f );
+        REQUIRE( img.data[4] == 4.0f );
+    }
+
+    SUBCASE("destroying the store does not restore evicted images"){
+        {
+            Image_Spill_Store store(std::filesystem::path(), 0);
+            for(auto &img : imgs) store.manage(img);
+            REQUIRE( store.get_page_out_count() == 4 );
+            REQUIRE( store.get_page_in_count() == 0 );
+        }
+        for(auto &img : imgs) REQUIRE( img.data.empty() );
+    }
+
+    SUBCASE("a null store is ignored"){
+        pinned_images pinned(nullptr, { &imgs.front() });
+        REQUIRE( imgs.front().data.size() == 100 );
+    }
+}
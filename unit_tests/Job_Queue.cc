@@ -0,0 +1,154 @@
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Job_Queue.h"
+
+
+TEST_CASE( "job_queue runs jobs and reports their outcome" ){
+    job_queue jq(2);
+
+    auto ok = jq.submit([](job_status &js){
+        js.set_progress(0.5, "Halfway");
+    });
+    auto bad = jq.submit([](job_status &){
+        throw std::runtime_error("Deliberate failure");
+    });
+    ok->wait();
+    bad->wait();
+
+    REQUIRE( ok->get_state() == job_status::state::succeeded );
+    REQUIRE( ok->get_progress() == 1.0 );
+    REQUIRE( bad->get_state() == job_status::state::failed );
+    REQUIRE( bad->get_message() == "Deliberate failure" );
+}
+
+TEST_CASE( "job_queue bounds the number of concurrently running jobs" ){
+    std::atomic<long int> running = 0;
+    std::atomic<long int> max_running = 0;
+    const auto job = [&](job_status &){
+        const auto n = ++running;
+        long int prev = max_running.load();
+        while(prev < n && !max_running.compare_exchange_weak(prev, n)){}
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --running;
+    };
+
+    job_queue jq(3);
+    std::vector<std::shared_ptr<job_status>> jobs;
+    for(long int i = 0; i < 12; ++i) jobs.emplace_back( jq.submit(job) );
+    for(auto &j : jobs) j->wait();
+
+    REQUIRE( max_running.load() <= 3 );
+    REQUIRE( 1 <= max_running.load() );
+}
+
+TEST_CASE( "job_queue admits jobs within the memory budget" ){
+    std::atomic<long int> running = 0;
+    std::atomic<long int> max_running = 0;
+    const auto job = [&](job_status &){
+        const auto n = ++running;
+        long int prev = max_running.load();
+        while(prev < n && !max_running.compare_exchange_weak(prev, n)){}
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --running;
+    };
+
+    SUBCASE("only one job fits at a time"){
+        job_queue jq(4, 100);
+        std::vector<std::shared_ptr<job_status>> jobs;
+        for(long int i = 0; i < 6; ++i) jobs.emplace_back( jq.submit(job, 60) );
+        for(auto &j : jobs) j->wait();
+        REQUIRE( max_running.load() == 1 );
+    }
+
+    SUBCASE("jobs exceeding the budget still run"){
+        job_queue jq(4, 100);
+        auto j = jq.submit(job, 1000);
+        j->wait();
+        REQUIRE( j->get_state() == job_status::state::succeeded );
+    }
+}
+
+TEST_CASE( "job_queue supports cancellation" ){
+    job_queue jq(1);
+
+    std::mutex gate;
+    std::unique_lock<std::mutex> hold(gate);
+
+    // Occupy the only worker until released.
+    auto blocker = jq.submit([&](job_status &js){
+        std::lock_guard<std::mutex> lock(gate);
+        js.set_progress(0.5, "Released");
+    });
+    std::atomic<bool> ran = false;
+    auto queued = jq.submit([&](job_status &){ ran = true; });
+    auto cooperative = jq.submit([&](job_status &js){
+        while(!js.is_cancel_requested()){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        throw job_cancelled("Stopped early");
+    });
+    std::atomic<bool> finishing = false;
+    auto oblivious = jq.submit([&](job_status &js){
+        while(!js.is_cancel_requested()){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        finishing = true;
+    });
+
+    // The blocker only stops counting as queued once the worker has dequeued it.
+    while(blocker->get_state() != job_status::state::running){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE( jq.jobs_ahead_of(cooperative) == 1 );
+    queued->request_cancellation();
+    REQUIRE( queued->get_state() == job_status::state::cancelled );
+    REQUIRE( jq.jobs_ahead_of(cooperative) == 0 );
+
+    hold.unlock();
+    blocker->wait();
+    REQUIRE( blocker->get_state() == job_status::state::succeeded );
+
+    while(cooperative->get_state() != job_status::state::running){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    cooperative->request_cancellation();
+    cooperative->wait();
+    REQUIRE( cooperative->get_state() == job_status::state::cancelled );
+    REQUIRE( cooperative->get_message() == "Stopped early" );
+    REQUIRE( !ran.load() );
+
+    // Jobs that run to completion despite a cancellation request are not reported as cancelled.
+    while(oblivious->get_state() != job_status::state::running){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    oblivious->request_cancellation();
+    oblivious->wait();
+    REQUIRE( finishing.load() );
+    REQUIRE( oblivious->get_state() == job_status::state::succeeded );
+}
+
+TEST_CASE( "job_queue notifies on updates" ){
+    std::mutex m;
+    std::vector<job_status::state> states;
+    {
+        job_queue jq(1);
+        auto j = jq.submit([](job_status &js){ js.set_progress(0.25, "Quarter"); }, 0,
+                           [&](const job_status &js){
+                               std::lock_guard<std::mutex> lock(m);
+                               states.push_back(js.get_state());
+                           });
+        j->wait();
+    }
+    REQUIRE( states.size() == 3 );
+    REQUIRE( states.front() == job_status::state::running );
+    REQUIRE( states.back() == job_status::state::succeeded );
+}
+
@@ -0,0 +1,110 @@
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "KineticModel_1Compartment_ClosedForm.h"
+
+
+namespace {
+
+// Synthesizes tissue curves obeying dC/dt = k1A AIF(t) + k1V VIF(t) - k2 C(t), C(0) = 0, using the trapezoidal rule
+// (which the closed-form model also assumes). A single bolus is used for each input so the curves return to baseline.
+struct synthetic_study {
+    KineticModel_1Compartment_ClosedForm_Inputs inputs;
+    KineticModel_1Compartment_ClosedForm_Batch batch;
+
+    struct params {
+        double k1A;
+        double k1V;
+        double k2;
+    };
+    std::vector<params> truth;
+
+    synthetic_study(KineticModel_1Compartment_ClosedForm_Variant variant, const std::vector<params> &p, long int N)
+      : truth(p) {
+        const bool dual = (variant == KineticModel_1Compartment_ClosedForm_Variant::DualInput);
+        inputs.variant = variant;
+        inputs.dt = 0.1;
+        inputs.slope_window = 100;
+        for(long int i = 0; i < N; ++i){
+            const double t = inputs.dt * static_cast<double>(i);
+            const double tv = std::max(0.0, t - 5.0);
+            inputs.aif.push_back(static_cast<float>(t * t * std::exp(-t / 4.0)));
+            inputs.vif.push_back(static_cast<float>(tv * tv * std::exp(-tv / 6.0)));
+        }
+
+        const auto N_curves = static_cast<long int>(truth.size());
+        batch.resize(N_curves, N);
+        for(long int j = 0; j < N_curves; ++j){
+            const auto &q = truth[j];
+            double c = 0.0;
+            for(long int i = 0; (i + 1) < N; ++i){
+                const double a = static_cast<double>(inputs.aif[i]) + static_cast<double>(inputs.aif[i + 1]);
+                const double v = static_cast<double>(inputs.vif[i]) + static_cast<double>(inputs.vif[i + 1]);
+                const double in = q.k1A * a + (dual ? q.k1V * v : 0.0);
+                c = (c + 0.5 * inputs.dt * (in - q.k2 * c)) / (1.0 + 0.5 * inputs.dt * q.k2);
+                batch.sample(j, i + 1) = static_cast<float>(c);
+            }
+        }
+    }
+};
+
+bool within(double x, double expected, double rel_tol){
+    return std::abs(x - expected) <= rel_tol * std::abs(expected);
+}
+
+} // namespace
+
+
+TEST_CASE( "Fit_1Compartment_ClosedForm" ){
+    const std::vector<synthetic_study::params> truth = { { 0.30, 0.20, 0.50 },
+                                                         { 0.05, 0.40, 0.10 },
+                                                         { 0.12, 0.08, 0.25 } };
+
+    SUBCASE("single-input parameters are recovered"){
+        synthetic_study s(KineticModel_1Compartment_ClosedForm_Variant::SingleInput, truth, 1200);
+        Fit_1Compartment_ClosedForm(s.inputs, s.batch);
+        for(size_t j = 0; j < truth.size(); ++j){
+            REQUIRE( within(s.batch.k1A[j], truth[j].k1A, 1.0E-3) );
+            REQUIRE( within(s.batch.k2[j], truth[j].k2, 1.0E-3) );
+            REQUIRE( std::isnan(s.batch.k1V[j]) );
+        }
+    }
+
+    SUBCASE("dual-input parameters are estimated"){
+        // The dual-input model relies on late-time linear extrapolation of the inputs, so it is only approximate.
+        synthetic_study s(KineticModel_1Compartment_ClosedForm_Variant::DualInput, truth, 1200);
+        Fit_1Compartment_ClosedForm(s.inputs, s.batch);
+        for(size_t j = 0; j < truth.size(); ++j){
+            REQUIRE( within(s.batch.k1A[j], truth[j].k1A, 0.1) );
+            REQUIRE( within(s.batch.k1V[j], truth[j].k1V, 0.1) );
+            REQUIRE( within(s.batch.k2[j], truth[j].k2, 0.1) );
+        }
+    }
+
+    SUBCASE("results do not depend on how curves are partitioned into blocks"){
+        // Enough curves to span several blocks, with the same parameters cycled throughout.
+        std::vector<synthetic_study::params> many;
+        for(long int j = 0; j < 2500; ++j) many.push_back(truth[j % truth.size()]);
+        synthetic_study s(KineticModel_1Compartment_ClosedForm_Variant::DualInput, many, 300);
+        Fit_1Compartment_ClosedForm(s.inputs, s.batch);
+        for(size_t j = truth.size(); j < many.size(); ++j){
+            REQUIRE( s.batch.k1A[j] == s.batch.k1A[j % truth.size()] );
+            REQUIRE( s.batch.k1V[j] == s.batch.k1V[j % truth.size()] );
+            REQUIRE( s.batch.k2[j] == s.batch.k2[j % truth.size()] );
+        }
+    }
+
+    SUBCASE("inconsistent inputs are rejected"){
+        synthetic_study s(KineticModel_1Compartment_ClosedForm_Variant::DualInput, truth, 300);
+        s.inputs.vif.pop_back();
+        REQUIRE_THROWS( Fit_1Compartment_ClosedForm(s.inputs, s.batch) );
+
+        synthetic_study w(KineticModel_1Compartment_ClosedForm_Variant::DualInput, truth, 50);
+        REQUIRE_THROWS( Fit_1Compartment_ClosedForm(w.inputs, w.batch) ); // Slope window exceeds the time course.
+    }
+}
+
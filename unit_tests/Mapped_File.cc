@@ -0,0 +1,159 @@
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Mapped_File.h"
+
+
+TEST_CASE( "mapped_file" ){
+    const auto fname = std::filesystem::temp_directory_path() / "dcma_mapped_file_test.txt";
+    const std::string contents = "1.0 2.0\r\n3.0 4.0\n";
+
+    SUBCASE("contents are visible"){
+        {
+            std::ofstream FO(fname, std::ios::out | std::ios::binary);
+            FO.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        }
+        mapped_file mf(fname);
+        REQUIRE( mf.size() == contents.size() );
+        REQUIRE( mf.view() == contents );
+
+        mapped_file moved(std::move(mf));
+        REQUIRE( moved.view() == contents );
+        REQUIRE( mf.size() == 0 );
+        std::filesystem::remove(fname);
+    }
+
+    SUBCASE("empty files are supported"){
+        {
+            std::ofstream FO(fname, std::ios::out | std::ios::binary);
+        }
+        mapped_file mf(fname);
+        REQUIRE( mf.size() == 0 );
+        REQUIRE( mf.view().empty() );
+        std::filesystem::remove(fname);
+    }
+
+    SUBCASE("missing files are rejected"){
+        std::filesystem::remove(fname);
+        REQUIRE_THROWS( mapped_file(fname) );
+    }
+}
+
+TEST_CASE( "split_at_line_boundaries" ){
+    const std::string_view text = "a\nbb\nccc\ndddd\neeeee";
+
+    for(long int N = 1; N < 10; ++N){
+        const auto chunks = split_at_line_boundaries(text, N);
+        REQUIRE( !chunks.empty() );
+        REQUIRE( static_cast<long int>(chunks.size()) <= N );
+
+        std::string rejoined;
+        for(size_t i = 0; i < chunks.size(); ++i){
+            REQUIRE( !chunks[i].empty() );
+            if(i + 1 < chunks.size()) REQUIRE( chunks[i].back() == '\n' );
+            rejoined += std::string(chunks[i]);
+        }
+        REQUIRE( rejoined == text );
+    }
+    REQUIRE( split_at_line_boundaries("", 4).empty() );
+}
+
+TEST_CASE( "pop_line and strip_comment" ){
+    std::string_view text = "first\r\nsecond # comment\n\nlast";
+    REQUIRE( pop_line(text) == "first" );
+    REQUIRE( strip_comment(pop_line(text)) == "second " );
+    REQUIRE( pop_line(text) == "" );
+    REQUIRE( pop_line(text) == "last" );
+    REQUIRE( text.empty() );
+}
+
+TEST_CASE( "parse_number" ){
+    const auto parse = [](std::string_view sv, double &x) -> bool {
+        return parse_number(sv, x) && sv.empty();
+    };
+    double x = 0.0;
+
+    REQUIRE( parse("1.25", x) );
+    REQUIRE( x == 1.25 );
+    REQUIRE( parse("-2.5E-3", x) );
+    REQUIRE( x == -2.5E-3 );
+    REQUIRE( parse("+7", x) );
+    REQUIRE( x == 7.0 );
+    REQUIRE( parse(".5", x) );
+    REQUIRE( x == 0.5 );
+    REQUIRE( parse("nan", x) );
+    REQUIRE( std::isnan(x) );
+    REQUIRE( parse("-inf", x) );
+    REQUIRE( std::isinf(x) );
+    REQUIRE( x < 0.0 );
+
+    x = 3.0;
+    std::string_view sv = "abc";
+    REQUIRE( !parse_number(sv, x) );
+    REQUIRE( sv == "abc" );
+    REQUIRE( x == 3.0 );
+
+    sv = "+-1";
+    REQUIRE( !parse_number(sv, x) );
+    sv = "";
+    REQUIRE( !parse_number(sv, x) );
+
+    sv = "12.5cm";
+    REQUIRE( parse_number(sv, x) );
+    REQUIRE( x == 12.5 );
+    REQUIRE( sv == "cm" );
+}
+
+TEST_CASE( "extract_numbers" ){
+    SUBCASE("whitespace-separated with comments"){
+        std::vector<double> out;
+        extract_numbers("# header 1 2 3\n 1.0\t2.0  3.0\r\n\nfoo 4.0 # 5.0\n6.0", out);
+        const std::vector<double> expected = { 1.0, 2.0, 3.0, 4.0, 6.0 };
+        REQUIRE( out == expected );
+    }
+
+    SUBCASE("custom separators"){
+        std::vector<double> out;
+        extract_numbers("1,2;3 4", out, " ,;");
+        const std::vector<double> expected = { 1.0, 2.0, 3.0, 4.0 };
+        REQUIRE( out == expected );
+    }
+
+    SUBCASE("parallel extraction matches sequential extraction"){
+        std::string text;
+        std::vector<double> expected;
+        for(long int i = 0; i < 2'000'000; ++i){
+            const auto x = static_cast<double>(i) * 0.25 - 1000.0;
+            expected.push_back(x);
+            text += std::to_string(x);
+            text += ((i % 7) == 6) ? "\n" : " ";
+        }
+        const auto out = extract_numbers_parallel(text);
+        REQUIRE( out.size() == expected.size() );
+        for(size_t i = 0; i < out.size(); ++i){
+            REQUIRE( std::abs(out[i] - expected[i]) < 1.0E-6 );
+        }
+    }
+}
+
+TEST_CASE( "read_little_endian" ){
+    const unsigned char bytes[] = { 0x00, 0x01, 0x02, 0x03, 0x04 };
+    REQUIRE( read_little_endian<uint16_t>(reinterpret_cast<const char *>(bytes) + 1) == 0x0201 );
+    REQUIRE( read_little_endian<uint32_t>(reinterpret_cast<const char *>(bytes) + 1) == 0x04030201 );
+
+    const float f = 1.5f;
+    unsigned char fb[4];
+    std::memcpy(fb, &f, 4);
+    REQUIRE( read_little_endian<float>(reinterpret_cast<const char *>(fb)) == 1.5f );
+}
+
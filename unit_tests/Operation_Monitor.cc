@@ -0,0 +1,52 @@
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "doctest/doctest.h"
+
+#include "Operation_Monitor.h"
+
+
+TEST_CASE( "operation_monitor_scope" ){
+    std::atomic<bool> cancel = false;
+    operation_monitor outer;
+    outer.is_cancel_requested = [&](){ return cancel.load(); };
+    operation_monitor inner;
+
+    REQUIRE( Current_Operation_Monitor() == nullptr );
+    REQUIRE( !Operation_Cancellation_Requested() );
+    REQUIRE_NOTHROW( Check_For_Operation_Cancellation() );
+
+    SUBCASE("monitors are installed for the calling thread and restored afterward"){
+        {
+            operation_monitor_scope s1(&outer);
+            REQUIRE( Current_Operation_Monitor() == &outer );
+            {
+                operation_monitor_scope s2(&inner);
+                REQUIRE( Current_Operation_Monitor() == &inner );
+            }
+            REQUIRE( Current_Operation_Monitor() == &outer );
+
+            const operation_monitor *seen = &outer;
+            std::thread t([&](){ seen = Current_Operation_Monitor(); });
+            t.join();
+            REQUIRE( seen == nullptr );
+        }
+        REQUIRE( Current_Operation_Monitor() == nullptr );
+    }
+
+    SUBCASE("cancellation is reported once requested"){
+        operation_monitor_scope s(&outer);
+        REQUIRE_NOTHROW( Check_For_Operation_Cancellation() );
+        cancel = true;
+        REQUIRE( Operation_Cancellation_Requested() );
+        REQUIRE_THROWS_AS( Check_For_Operation_Cancellation(), operation_cancelled );
+
+        // Monitors without a cancellation callback are never cancelled.
+        operation_monitor_scope s2(&inner);
+        REQUIRE_NOTHROW( Check_For_Operation_Cancellation() );
+        REQUIRE_THROWS_AS( Check_For_Operation_Cancellation(&outer), operation_cancelled );
+    }
+}
+
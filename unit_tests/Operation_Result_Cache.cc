@@ -0,0 +1,89 @@
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "doctest/doctest.h"
+
+#include "Operation_Result_Cache.h"
+
+
+static bool write_bytes(const std::filesystem::path &p, long int n){
+    std::ofstream of(p, std::ios::binary | std::ios::trunc);
+    of << std::string(static_cast<size_t>(n), 'x');
+    of.flush();
+    return static_cast<bool>(of);
+}
+
+static void set_age(const std::filesystem::path &p, long int seconds){
+    std::filesystem::last_write_time(p, std::filesystem::file_time_type::clock::now() - std::chrono::seconds(seconds));
+}
+
+TEST_CASE( "Operation_Result_Cache" ){
+    const auto dir = std::filesystem::temp_directory_path() / "dcma_unit_test_result_cache";
+    std::filesystem::remove_all(dir);
+
+    SUBCASE("entries are stored and found"){
+        Operation_Result_Cache cache(dir, 1000);
+        REQUIRE( !cache.find(1) );
+        REQUIRE( cache.store(1, [](const std::filesystem::path &p){ return write_bytes(p, 10); }) );
+
+        const auto p = cache.find(1);
+        REQUIRE( p );
+        REQUIRE( p.value() == cache.entry_path(1) );
+        REQUIRE( std::filesystem::file_size(p.value()) == 10 );
+        REQUIRE( cache.total_bytes() == 10 );
+
+        // Entries persist between instances.
+        Operation_Result_Cache other(dir, 1000);
+        REQUIRE( other.find(1) );
+
+        cache.remove(1);
+        REQUIRE( !cache.find(1) );
+    }
+
+    SUBCASE("failed writes do not create entries or leave temporary files"){
+        Operation_Result_Cache cache(dir, 1000);
+        REQUIRE( !cache.store(2, [](const std::filesystem::path &p){ write_bytes(p, 10); return false; }) );
+        REQUIRE( !cache.store(3, [](const std::filesystem::path &p) -> bool { write_bytes(p, 10); throw std::runtime_error("failure"); }) );
+        REQUIRE( !cache.find(2) );
+        REQUIRE( !cache.find(3) );
+        REQUIRE( std::filesystem::is_empty(dir) );
+    }
+
+    SUBCASE("least-recently-used entries are evicted"){
+        Operation_Result_Cache cache(dir, 25);
+        REQUIRE( cache.store(1, [](const std::filesystem::path &p){ return write_bytes(p, 10); }) );
+        REQUIRE( cache.store(2, [](const std::filesystem::path &p){ return write_bytes(p, 10); }) );
+        set_age(cache.entry_path(1), 20);
+        set_age(cache.entry_path(2), 10);
+
+        // Using the older entry makes the other entry the least-recently used.
+        REQUIRE( cache.find(1) );
+        REQUIRE( cache.store(3, [](const std::filesystem::path &p){ return write_bytes(p, 10); }) );
+        REQUIRE( cache.find(1) );
+        REQUIRE( !cache.find(2) );
+        REQUIRE( cache.find(3) );
+        REQUIRE( cache.total_bytes() == 20 );
+    }
+
+    SUBCASE("entries exceeding the limit are not retained"){
+        Operation_Result_Cache cache(dir, 5);
+        REQUIRE( !cache.store(1, [](const std::filesystem::path &p){ return write_bytes(p, 10); }) );
+        REQUIRE( cache.total_bytes() == 0 );
+    }
+
+    SUBCASE("unrelated files are ignored"){
+        Operation_Result_Cache cache(dir, 5);
+        REQUIRE( write_bytes(dir / "unrelated.txt", 10) );
+        REQUIRE( cache.total_bytes() == 0 );
+        REQUIRE( cache.evict() == 0 );
+        REQUIRE( std::filesystem::exists(dir / "unrelated.txt") );
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
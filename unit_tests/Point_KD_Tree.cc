@@ -0,0 +1,146 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "YgorMath.h"
+
+#include "doctest/doctest.h"
+
+#include "Point_KD_Tree.h"
+
+
+static std::vector<vec3<double>> make_random_points(long int N, unsigned int seed){
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> rd(-10.0, 10.0);
+    std::vector<vec3<double>> out;
+    for(long int i = 0; i < N; ++i){
+        out.emplace_back( rd(re), rd(re), rd(re) );
+    }
+    return out;
+}
+
+// Brute-force reference implementations that retain the first (i.e., lowest index) point for ties.
+static kd_neighbour brute_nearest(const std::vector<vec3<double>> &pts, const vec3<double> &p){
+    kd_neighbour best;
+    for(size_t i = 0; i < pts.size(); ++i){
+        const auto sq_dist = p.sq_dist(pts[i]);
+        if(sq_dist < best.sq_dist) best = { static_cast<long int>(i), sq_dist };
+    }
+    return best;
+}
+
+static kd_neighbour brute_farthest(const std::vector<vec3<double>> &pts, const vec3<double> &p){
+    kd_neighbour best;
+    best.sq_dist = -1.0;
+    for(size_t i = 0; i < pts.size(); ++i){
+        const auto sq_dist = p.sq_dist(pts[i]);
+        if(best.sq_dist < sq_dist) best = { static_cast<long int>(i), sq_dist };
+    }
+    return best;
+}
+
+
+TEST_CASE( "point_kd_tree nearest and farthest queries match brute force" ){
+    const auto pts = make_random_points(2000, 1);
+    const auto queries = make_random_points(300, 2);
+    point_kd_tree tree(pts);
+    REQUIRE( tree.size() == 2000 );
+
+    for(const auto &q : queries){
+        const auto n = tree.nearest(q);
+        const auto n_ref = brute_nearest(pts, q);
+        REQUIRE( n.index == n_ref.index );
+        REQUIRE( n.sq_dist == n_ref.sq_dist );
+
+        const auto f = tree.farthest(q);
+        const auto f_ref = brute_farthest(pts, q);
+        REQUIRE( f.index == f_ref.index );
+        REQUIRE( f.sq_dist == f_ref.sq_dist );
+    }
+
+    SUBCASE("batched queries match individual queries"){
+        const auto ns = tree.nearest(queries);
+        const auto fs = tree.farthest(queries);
+        REQUIRE( ns.size() == queries.size() );
+        for(size_t i = 0; i < queries.size(); ++i){
+            REQUIRE( ns[i].index == brute_nearest(pts, queries[i]).index );
+            REQUIRE( fs[i].index == brute_farthest(pts, queries[i]).index );
+        }
+    }
+}
+
+TEST_CASE( "point_kd_tree k-nearest and radius queries match brute force" ){
+    const auto pts = make_random_points(1500, 3);
+    const auto queries = make_random_points(100, 4);
+    point_kd_tree tree(pts);
+
+    for(const auto &q : queries){
+        std::vector<kd_neighbour> ref;
+        for(size_t i = 0; i < pts.size(); ++i){
+            ref.push_back( kd_neighbour{ static_cast<long int>(i), q.sq_dist(pts[i]) } );
+        }
+        std::sort(std::begin(ref), std::end(ref), [](const kd_neighbour &a, const kd_neighbour &b){
+            return (a.sq_dist < b.sq_dist) || ((a.sq_dist == b.sq_dist) && (a.index < b.index));
+        });
+
+        const auto knn = tree.k_nearest(q, 7);
+        REQUIRE( knn.size() == 7 );
+        for(size_t i = 0; i < knn.size(); ++i){
+            REQUIRE( knn[i].index == ref[i].index );
+        }
+
+        const double radius = 3.0;
+        std::vector<long int> in_radius;
+        for(size_t i = 0; i < pts.size(); ++i){
+            if(q.distance(pts[i]) <= radius) in_radius.push_back(static_cast<long int>(i));
+        }
+        const auto r = tree.within_radius(q, radius);
+        REQUIRE( r.size() == in_radius.size() );
+        for(size_t i = 0; i < r.size(); ++i){
+            REQUIRE( r[i].index == in_radius[i] );
+        }
+    }
+
+    SUBCASE("k larger than the tree returns every point"){
+        point_kd_tree small(make_random_points(5, 5));
+        REQUIRE( small.k_nearest(vec3<double>(0.0, 0.0, 0.0), 10).size() == 5 );
+    }
+}
+
+TEST_CASE( "point_kd_tree handles degenerate inputs" ){
+    SUBCASE("empty trees return no results"){
+        point_kd_tree tree(std::vector<vec3<double>>{});
+        REQUIRE( tree.empty() );
+        REQUIRE( tree.nearest(vec3<double>(0.0, 0.0, 0.0)).index == -1 );
+        REQUIRE( tree.farthest(vec3<double>(0.0, 0.0, 0.0)).index == -1 );
+        REQUIRE( tree.k_nearest(vec3<double>(0.0, 0.0, 0.0), 3).empty() );
+        REQUIRE( tree.within_radius(vec3<double>(0.0, 0.0, 0.0), 1.0).empty() );
+    }
+
+    SUBCASE("non-finite points are omitted and indices refer to the original container"){
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        std::vector<vec3<double>> pts = { vec3<double>(nan, 0.0, 0.0),
+                                          vec3<double>(1.0, 0.0, 0.0),
+                                          vec3<double>(5.0, 0.0, 0.0) };
+        point_kd_tree tree(pts);
+        REQUIRE( tree.size() == 2 );
+        REQUIRE( tree.nearest(vec3<double>(0.0, 0.0, 0.0)).index == 1 );
+        REQUIRE( tree.farthest(vec3<double>(0.0, 0.0, 0.0)).index == 2 );
+        REQUIRE( tree.nearest(vec3<double>(nan, 0.0, 0.0)).index == -1 );
+    }
+
+    SUBCASE("duplicate points are resolved in favour of the lowest index"){
+        std::vector<vec3<double>> pts(100, vec3<double>(1.0, 2.0, 3.0));
+        point_kd_tree tree(pts);
+        REQUIRE( tree.nearest(vec3<double>(0.0, 0.0, 0.0)).index == 0 );
+        REQUIRE( tree.farthest(vec3<double>(0.0, 0.0, 0.0)).index == 0 );
+        const auto knn = tree.k_nearest(vec3<double>(0.0, 0.0, 0.0), 3);
+        REQUIRE( knn.size() == 3 );
+        REQUIRE( knn[0].index == 0 );
+        REQUIRE( knn[2].index == 2 );
+    }
+}
+
@@ -0,0 +1,189 @@
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Pointwise_Fusion.h"
+
+
+namespace {
+
+// Applies each stage to the whole image in turn, without blocking. The per-voxel formulas are restated here, so this
+// only checks that blocking and fusion do not alter the results. Agreement with the operations themselves is checked
+// by the FusedPointwiseOperations integration test.
+struct reference_image {
+    std::vector<float> data;
+    long int channels = 1;
+    std::optional<float> min;
+    std::optional<float> max;
+
+    void digest(float v){
+        if(!min || (v < min.value())) min = v;
+        if(!max || (max.value() < v)) max = v;
+    }
+
+    void apply(const pointwise_stage &s){
+        using kind = pointwise_stage::kind;
+        min.reset();
+        max.reset();
+        for(size_t i = 0; i < data.size(); ++i){
+            const auto chan = static_cast<long int>(i) % channels;
+            const auto val = data[i];
+            if(s.type == kind::negate){
+                data[i] = -val;
+                digest(data[i]);
+            }else if(s.type == kind::log_scale){
+                data[i] = std::numeric_limits<float>::quiet_NaN();
+                if(val > static_cast<float>(0)){
+                    data[i] = std::log(val);
+                    digest(data[i]);
+                }
+            }else if(s.type == kind::replace_nonfinite){
+                data[i] = std::isfinite(val) ? val : s.replacement;
+                digest(data[i]);
+            }else if(s.type == kind::filter_enormous){
+                data[i] = (val < static_cast<float>(2E4)) ? val : std::numeric_limits<float>::quiet_NaN();
+                if(std::isfinite(data[i])) digest(data[i]);
+            }else if(s.type == kind::threshold){
+                if(chan != s.channel) continue;
+                if(!(s.lower < val)) data[i] = s.low;
+                if(!(val < s.upper)) data[i] = s.high;
+                digest(data[i]);
+            }
+        }
+    }
+};
+
+std::optional<pointwise_stage> make_stage(const std::string &name,
+                                          const std::map<std::string, std::string> &args = {}){
+    return make_pointwise_stage(name, [&](const std::string &key) -> std::optional<std::string> {
+        const auto it = args.find(key);
+        if(it == std::end(args)) return std::nullopt;
+        return it->second;
+    });
+}
+
+bool bitwise_equal(float a, float b){
+    return (std::memcmp(&a, &b, sizeof(float)) == 0)
+        || (std::isnan(a) && std::isnan(b));
+}
+
+} // namespace
+
+
+TEST_CASE( "make_pointwise_stage" ){
+    const std::map<std::string, std::string> threshold_args = { { "Lower", "-100.0" },
+                                                                { "Low", "-100.0" },
+                                                                { "Upper", "100.0" },
+                                                                { "High", "100.0" },
+                                                                { "Channel", "0" },
+                                                                { "ImageSelection", "last" } };
+
+    REQUIRE( make_stage("NegatePixels", { { "ImageSelection", "all" } }) );
+    REQUIRE( make_stage("ConvertNaNsToAir") );
+    REQUIRE( make_stage("ConvertNaNsToAir")->replacement == -1024.0f );
+    REQUIRE( make_stage("ThresholdImages", threshold_args) );
+    REQUIRE( make_stage("ThresholdImages", threshold_args)->selection == "last" );
+
+    SUBCASE("non-pointwise operations are rejected"){
+        REQUIRE( !make_stage("ScalePixels") );
+        REQUIRE( !make_stage("GaussianBlur") );
+
+        auto args = threshold_args;
+        args["Upper"] = "90%";
+        REQUIRE( !make_stage("ThresholdImages", args) );
+
+        args = threshold_args;
+        args["Lower"] = "10tile";
+        REQUIRE( !make_stage("ThresholdImages", args) );
+
+        args = threshold_args;
+        args["Channel"] = "-1";
+        REQUIRE( !make_stage("ThresholdImages", args) );
+    }
+
+    SUBCASE("fusion requires identical, metadata-independent selections"){
+        const auto all = make_stage("NegatePixels", { { "ImageSelection", "all" } }).value();
+        const auto last = make_stage("NegatePixels", { { "ImageSelection", "last" } }).value();
+        const auto meta = make_stage("NegatePixels", { { "ImageSelection", "Modality@CT" } }).value();
+        REQUIRE( can_fuse(all, make_stage("ConvertNaNsToZeros").value()) );
+        REQUIRE( can_fuse(last, last) );
+        REQUIRE( !can_fuse(all, last) );
+        REQUIRE( !can_fuse(meta, meta) );
+    }
+}
+
+TEST_CASE( "pointwise_kernel" ){
+    std::mt19937 re(12345);
+    std::uniform_real_distribution<float> rd(-3.0E4f, 3.0E4f);
+
+    const std::map<std::string, std::string> threshold_args = { { "Lower", "-100.5" },
+                                                                { "Low", "-1000.0" },
+                                                                { "Upper", "150.25" },
+                                                                { "High", "0.1" },
+                                                                { "Channel", "1" },
+                                                                { "ImageSelection", "all" } };
+    const std::vector<std::vector<pointwise_stage>> pipelines = {
+        { make_stage("PreFilterEnormousCTValues").value(),
+          make_stage("ConvertNaNsToAir").value(),
+          make_stage("NegatePixels", { { "ImageSelection", "all" } }).value(),
+          make_stage("LogScale", { { "ImageSelection", "all" } }).value(),
+          make_stage("ConvertNaNsToZeros").value() },
+
+        { make_stage("NegatePixels", { { "ImageSelection", "all" } }).value(),
+          make_stage("ThresholdImages", threshold_args).value() },
+
+        { make_stage("ThresholdImages", threshold_args).value(),
+          make_stage("LogScale", { { "ImageSelection", "all" } }).value() },
+
+        { make_stage("LogScale", { { "ImageSelection", "all" } }).value(),
+          make_stage("PreFilterEnormousCTValues").value() },
+    };
+
+    for(const long int channels : { 1L, 3L }){
+        // Large enough to span several blocks, and not a multiple of the block size.
+        std::vector<float> original(static_cast<size_t>(channels) * 5003UL);
+        for(auto &v : original) v = rd(re);
+        original[0] = std::numeric_limits<float>::quiet_NaN();
+        original[1] = std::numeric_limits<float>::infinity();
+        original[2] = -std::numeric_limits<float>::infinity();
+        original[3] = 0.0f;
+
+        for(const auto &stages : pipelines){
+            reference_image ref;
+            ref.data = original;
+            ref.channels = channels;
+
+            pointwise_kernel kernel;
+            for(const auto &s : stages){
+                ref.apply(s);
+                kernel.append(s);
+            }
+            REQUIRE( kernel.size() == stages.size() );
+
+            auto fused = original;
+            std::optional<float> min;
+            std::optional<float> max;
+            kernel.apply(fused.data(), fused.size(), channels, [&](float v){
+                if(!min || (v < min.value())) min = v;
+                if(!max || (max.value() < v)) max = v;
+            });
+
+            for(size_t i = 0; i < fused.size(); ++i){
+                REQUIRE( bitwise_equal(fused[i], ref.data[i]) );
+            }
+            REQUIRE( min.has_value() == ref.min.has_value() );
+            REQUIRE( max.has_value() == ref.max.has_value() );
+            if(min) REQUIRE( bitwise_equal(min.value(), ref.min.value()) );
+            if(max) REQUIRE( bitwise_equal(max.value(), ref.max.value()) );
+        }
+    }
+}
+
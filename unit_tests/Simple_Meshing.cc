@@ -0,0 +1,250 @@
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "YgorMath.h"
+
+#include "Simple_Meshing.h"
+
+
+namespace {
+
+// Exhaustive reference for Minimally_Amalgamate_Contours, following the original list-based implementation. Every
+// amal edge is compared with every edge of every remaining contour, and the first shortest bridge encountered wins.
+//
+// Note: the original only checked the wrap-around amal edge for fictitious vertices (and discarded all remaining
+// contours when it touched one). Here every amal edge touching a fictitious vertex is skipped, as is now intended.
+contour_of_points<double>
+reference_amalgamate(const vec3<double> &pseudo_vert_offset, std::list<contour_of_points<double>> B){
+    contour_of_points<double> amal = B.front();
+    B.pop_front();
+
+    std::list< decltype(std::begin(amal.points)) > pseudo_verts;
+    const auto is_a_pseudo_vert = [&]( decltype(std::begin(amal.points)) it ) -> bool {
+        for(const auto &pv : pseudo_verts){
+            if( it == pv ) return true;
+        }
+        return false;
+    };
+
+    const auto machine_eps = std::sqrt(10.0 * std::numeric_limits<double>::epsilon() );
+    while(true){
+        double shortest_criteria = std::numeric_limits<double>::infinity();
+        auto closest_cop = std::begin(B);
+        decltype(std::begin(amal.points)) closest_a_v2_it;
+        decltype(std::begin(B.front().points)) closest_b_v2_it;
+        vec3<double> closest_edge_1_midpoint;
+        vec3<double> closest_edge_2_midpoint;
+
+        for(auto b_it = std::begin(B); b_it != std::end(B); ++b_it){
+            auto a_v1_it = std::prev(std::end(amal.points));
+            auto a_v2_it = std::begin(amal.points);
+            for( ; a_v2_it != std::end(amal.points); a_v1_it = a_v2_it, ++a_v2_it){
+                if( is_a_pseudo_vert(a_v1_it)
+                ||  is_a_pseudo_vert(a_v2_it) ) continue;
+
+                auto b_v1_it = std::prev(std::end(b_it->points));
+                auto b_v2_it = std::begin(b_it->points);
+                for( ; b_v2_it != std::end(b_it->points); b_v1_it = b_v2_it, ++b_v2_it){
+                    if( (a_v1_it->distance(*a_v2_it) < machine_eps)
+                    ||  (b_v1_it->distance(*b_v2_it) < machine_eps) ) continue;
+
+                    const auto total_criteria = a_v1_it->distance(*b_v2_it) + a_v2_it->distance(*b_v1_it);
+                    if(total_criteria < shortest_criteria){
+                        shortest_criteria = total_criteria;
+                        closest_cop = b_it;
+                        closest_a_v2_it = a_v2_it;
+                        closest_b_v2_it = b_v2_it;
+                        closest_edge_1_midpoint = (*a_v1_it + *b_v2_it) * 0.5;
+                        closest_edge_2_midpoint = (*a_v2_it + *b_v1_it) * 0.5;
+                    }
+                }
+            }
+        }
+        if(!std::isfinite(shortest_criteria)) break;
+
+        contour_of_points<double> cop_copy;
+        cop_copy.points.insert( std::end(cop_copy.points), closest_b_v2_it, std::end(closest_cop->points) );
+        cop_copy.points.insert( std::end(cop_copy.points), std::begin(closest_cop->points), closest_b_v2_it );
+        cop_copy.points.emplace_front(closest_edge_1_midpoint + pseudo_vert_offset);
+        cop_copy.points.emplace_back(closest_edge_2_midpoint + pseudo_vert_offset);
+        pseudo_verts.emplace_back( std::begin(cop_copy.points) );
+        pseudo_verts.emplace_back( std::prev( std::end(cop_copy.points) ) );
+
+        amal.points.splice( closest_a_v2_it, cop_copy.points );
+        B.erase(closest_cop);
+    }
+    return amal;
+}
+
+// A counter-clockwise (when viewed from +z) regular polygon.
+contour_of_points<double> make_polygon(const vec3<double> &centre, double radius, long int N, double phase = 0.0){
+    contour_of_points<double> cop;
+    cop.closed = true;
+    for(long int i = 0; i < N; ++i){
+        const auto theta = phase + 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(N);
+        cop.points.emplace_back( centre + vec3<double>(radius * std::cos(theta), radius * std::sin(theta), 0.0) );
+    }
+    return cop;
+}
+
+void require_same_amalgamation(std::list<contour_of_points<double>> cops){
+    const vec3<double> ortho_unit(0.0, 0.0, 1.0);
+    const vec3<double> offset(0.0, 0.0, 0.25);
+
+    std::list<std::reference_wrapper<contour_of_points<double>>> B;
+    for(auto &cop : cops) B.emplace_back(std::ref(cop));
+
+    const auto amal = Minimally_Amalgamate_Contours(ortho_unit, offset, B);
+    const auto expected = reference_amalgamate(offset, cops);
+
+    size_t N_input = 0;
+    for(const auto &cop : cops) N_input += cop.points.size();
+    REQUIRE( amal.points.size() == (N_input + 2 * (cops.size() - 1)) );
+    REQUIRE( amal.points.size() == expected.points.size() );
+    REQUIRE( std::equal( std::begin(amal.points), std::end(amal.points), std::begin(expected.points) ) );
+}
+
+// Exhaustive reference for Join_Meshes: each vertex is merged with the earliest retained vertex within the distance.
+fv_surface_mesh<double, uint64_t>
+reference_join(const std::vector<fv_surface_mesh<double, uint64_t>> &meshes, double eps){
+    fv_surface_mesh<double, uint64_t> out;
+    for(const auto &m : meshes){
+        std::vector<uint64_t> index_map;
+        for(const auto &p : m.vertices){
+            uint64_t i = 0;
+            while( (i < out.vertices.size())
+               &&  !(out.vertices[i].sq_dist(p) <= eps * eps) ) ++i;
+            if(i == out.vertices.size()) out.vertices.emplace_back(p);
+            index_map.push_back(i);
+        }
+        for(const auto &f : m.faces){
+            out.faces.emplace_back();
+            for(const auto &i : f) out.faces.back().push_back(index_map.at(i));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+
+TEST_CASE( "Minimally_Amalgamate_Contours" ){
+    SUBCASE("a pair of contours with equal vertex counts"){
+        require_same_amalgamation({ make_polygon(vec3<double>(0.0, 0.0, 0.0), 1.0, 8),
+                                    make_polygon(vec3<double>(3.0, 0.5, 0.0), 1.0, 8) });
+    }
+
+    SUBCASE("contours with differing vertex counts"){
+        require_same_amalgamation({ make_polygon(vec3<double>(0.0, 0.0, 0.0), 2.0, 12),
+                                    make_polygon(vec3<double>(5.0, 0.0, 0.0), 1.0, 7, 0.3),
+                                    make_polygon(vec3<double>(-1.0, 6.0, 0.0), 1.5, 20, 0.1),
+                                    make_polygon(vec3<double>(-6.0, -2.0, 0.0), 0.5, 3) });
+    }
+
+    SUBCASE("contours with coincident vertices"){
+        // Two squares sharing a corner, and a third sharing an edge with the second.
+        contour_of_points<double> a;
+        a.points = { vec3<double>(0.0, 0.0, 0.0), vec3<double>(1.0, 0.0, 0.0),
+                     vec3<double>(1.0, 1.0, 0.0), vec3<double>(0.0, 1.0, 0.0) };
+        contour_of_points<double> b;
+        b.points = { vec3<double>(1.0, 1.0, 0.0), vec3<double>(2.0, 1.0, 0.0),
+                     vec3<double>(2.0, 2.0, 0.0), vec3<double>(1.0, 2.0, 0.0) };
+        contour_of_points<double> c;
+        c.points = { vec3<double>(2.0, 1.0, 0.0), vec3<double>(3.0, 1.0, 0.0),
+                     vec3<double>(3.0, 2.0, 0.0), vec3<double>(2.0, 2.0, 0.0) };
+        require_same_amalgamation({ a, b, c });
+    }
+
+    SUBCASE("contours with repeated vertices"){
+        auto a = make_polygon(vec3<double>(0.0, 0.0, 0.0), 1.0, 6);
+        a.points.insert( std::next(std::begin(a.points), 2), *std::next(std::begin(a.points), 2) );
+        auto b = make_polygon(vec3<double>(2.5, 0.0, 0.0), 1.0, 5);
+        b.points.push_back( b.points.front() );
+        require_same_amalgamation({ a, b, make_polygon(vec3<double>(0.0, 2.5, 0.0), 1.0, 9) });
+    }
+
+    SUBCASE("symmetric arrangements with tied bridges"){
+        require_same_amalgamation({ make_polygon(vec3<double>(0.0, 0.0, 0.0), 1.0, 4, M_PI * 0.25),
+                                    make_polygon(vec3<double>(3.0, 0.0, 0.0), 1.0, 4, M_PI * 0.25),
+                                    make_polygon(vec3<double>(-3.0, 0.0, 0.0), 1.0, 4, M_PI * 0.25),
+                                    make_polygon(vec3<double>(0.0, 3.0, 0.0), 1.0, 4, M_PI * 0.25) });
+    }
+
+    SUBCASE("randomly placed contours"){
+        std::mt19937 gen(17);
+        std::uniform_real_distribution<double> pos(-10.0, 10.0);
+        std::uniform_int_distribution<long int> count(3, 25);
+        std::list<contour_of_points<double>> cops;
+        for(long int i = 0; i < 8; ++i){
+            cops.emplace_back( make_polygon(vec3<double>(pos(gen), pos(gen), 0.0), 0.75, count(gen), pos(gen)) );
+        }
+        require_same_amalgamation(cops);
+    }
+}
+
+TEST_CASE( "Join_Meshes" ){
+    const auto require_same_join = [](const std::vector<fv_surface_mesh<double, uint64_t>> &meshes, double eps){
+        const auto joined = Join_Meshes(meshes, eps);
+        const auto expected = reference_join(meshes, eps);
+        REQUIRE( joined.vertices == expected.vertices );
+        REQUIRE( joined.faces == expected.faces );
+    };
+
+    // Two triangles sharing an edge, split across meshes.
+    fv_surface_mesh<double, uint64_t> m1;
+    m1.vertices = { vec3<double>(0.0, 0.0, 0.0), vec3<double>(1.0, 0.0, 0.0), vec3<double>(0.0, 1.0, 0.0) };
+    m1.faces = { { 0, 1, 2 } };
+    fv_surface_mesh<double, uint64_t> m2;
+    m2.vertices = { vec3<double>(1.0, 0.0, 0.0), vec3<double>(1.0, 1.0, 0.0), vec3<double>(0.0, 1.0, 0.0) };
+    m2.faces = { { 0, 1, 2 } };
+
+    SUBCASE("coincident vertices are merged"){
+        const auto joined = Join_Meshes({ m1, m2 }, 1.0E-6);
+        REQUIRE( joined.vertices.size() == 4 );
+        REQUIRE( joined.faces.size() == 2 );
+        require_same_join({ m1, m2 }, 1.0E-6);
+    }
+
+    SUBCASE("nearby vertices straddling grid cells are merged"){
+        // Each vertex of the second mesh is perturbed across a cell boundary of the merge grid.
+        const double eps = 0.1;
+        auto m3 = m2;
+        for(auto &v : m3.vertices) v += vec3<double>(-0.06, 0.04, -0.05);
+        require_same_join({ m1, m3 }, eps);
+        require_same_join({ m1, m3 }, 0.01); // Too far apart to merge.
+    }
+
+    SUBCASE("randomly generated meshes"){
+        std::mt19937 gen(23);
+        std::uniform_real_distribution<double> pos(-2.0, 2.0);
+        std::uniform_int_distribution<uint64_t> pick(0, 29);
+        std::vector<fv_surface_mesh<double, uint64_t>> meshes(4);
+        for(auto &m : meshes){
+            for(long int i = 0; i < 30; ++i){
+                // Snap to a coarse lattice so that many vertices coincide or nearly coincide.
+                m.vertices.emplace_back( std::round(pos(gen) * 4.0) / 4.0 + pos(gen) * 1.0E-3,
+                                         std::round(pos(gen) * 4.0) / 4.0,
+                                         std::round(pos(gen) * 4.0) / 4.0 - pos(gen) * 1.0E-3 );
+            }
+            for(long int i = 0; i < 20; ++i) m.faces.push_back({ pick(gen), pick(gen), pick(gen) });
+        }
+        require_same_join(meshes, 5.0E-3);
+        require_same_join(meshes, 0.3);
+    }
+
+    SUBCASE("invalid merge distances are rejected"){
+        REQUIRE_THROWS( Join_Meshes({ m1 }, 0.0) );
+        REQUIRE_THROWS( Join_Meshes({ m1 }, std::numeric_limits<double>::quiet_NaN()) );
+    }
+}
+
@@ -0,0 +1,111 @@
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"
+
+#include "doctest/doctest.h"
+
+#include "Colour_Maps.h"
+#include "Slice_Cache.h"
+
+
+TEST_CASE( "lru_cache class" ){
+    lru_cache<long int, std::string> c(2);
+
+    SUBCASE("retrieval"){
+        REQUIRE( !c.get(1) );
+        c.put(1, "one");
+        REQUIRE( c.get(1).value() == "one" );
+        REQUIRE( c.size() == 1 );
+
+        c.put(1, "uno");
+        REQUIRE( c.get(1).value() == "uno" );
+        REQUIRE( c.size() == 1 );
+    }
+
+    SUBCASE("least recently used items are evicted"){
+        c.put(1, "one");
+        c.put(2, "two");
+        REQUIRE( c.get(1) ); // 2 is now the least recently used.
+        c.put(3, "three");
+        REQUIRE( c.contains(1) );
+        REQUIRE( !c.contains(2) );
+        REQUIRE( c.contains(3) );
+        REQUIRE( c.size() == 2 );
+    }
+
+    SUBCASE("capacity can be reduced"){
+        c.put(1, "one");
+        c.put(2, "two");
+        c.set_capacity(1);
+        REQUIRE( c.size() == 1 );
+        REQUIRE( c.contains(2) );
+
+        c.clear();
+        REQUIRE( c.size() == 0 );
+        REQUIRE( c.capacity() == 1 );
+    }
+}
+
+TEST_CASE( "slice keys" ){
+    const slice_key A{ 0, 0, 5 };
+    const slice_key B{ 1, 0, 5 };
+    REQUIRE( A < B );
+    REQUIRE( !(B < A) );
+
+    windowed_slice_key wA;
+    wA.slice = A;
+    windowed_slice_key wB = wA;
+    REQUIRE( !(wA < wB) );
+    REQUIRE( !(wB < wA) );
+
+    wB.colour_map = 1;
+    REQUIRE( wA < wB );
+}
+
+TEST_CASE( "Neighbouring_Slices" ){
+    REQUIRE( Neighbouring_Slices(5, 10, 2) == std::vector<long int>({ 6, 4, 7, 3 }) );
+    REQUIRE( Neighbouring_Slices(0, 10, 2) == std::vector<long int>({ 1, 2 }) );
+    REQUIRE( Neighbouring_Slices(9, 10, 1) == std::vector<long int>({ 8 }) );
+    REQUIRE( Neighbouring_Slices(0, 1, 3).empty() );
+    REQUIRE( Neighbouring_Slices(10, 10, 3).empty() );
+}
+
+TEST_CASE( "Window_Slice" ){
+    planar_image<float,double> img;
+    img.init_buffer(2, 3, 1);
+    img.init_spatial(1.0, 1.0, 1.0, vec3<double>(0.0, 0.0, 0.0), vec3<double>(0.0, 0.0, 0.0));
+    img.init_orientation(vec3<double>(0.0, 1.0, 0.0), vec3<double>(1.0, 0.0, 0.0));
+    img.fill_pixels(0.0f);
+    img.reference(0, 1, 0) = 100.0f;
+    img.reference(1, 2, 0) = std::numeric_limits<float>::quiet_NaN();
+
+    const auto nan_colour = std::array<std::byte, 3>{ std::byte{60}, std::byte{0}, std::byte{0} };
+
+    SUBCASE("full range"){
+        const auto ws = Window_Slice(img, 0, {}, {}, ColourMap_Linear, nan_colour);
+        REQUIRE( ws->rows == 2 );
+        REQUIRE( ws->columns == 3 );
+        REQUIRE( ws->rgb.size() == 2 * 3 * 3 );
+        REQUIRE( ws->rgb[0] == std::byte{0} );
+        REQUIRE( ws->rgb[3] == std::byte{255} );
+        REQUIRE( ws->rgb[(1 * 3 + 2) * 3] == nan_colour[0] );
+    }
+
+    SUBCASE("custom window"){
+        const auto ws = Window_Slice(img, 0, 25.0, 50.0, ColourMap_Linear, nan_colour);
+        REQUIRE( ws->rgb[0] == std::byte{0} );
+        REQUIRE( ws->rgb[3] == std::byte{255} );
+    }
+
+    SUBCASE("missing channel"){
+        REQUIRE_THROWS( Window_Slice(img, 1, {}, {}, ColourMap_Linear, nan_colour) );
+    }
+}
+
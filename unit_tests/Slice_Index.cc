@@ -0,0 +1,131 @@
+
+#include <iterator>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "YgorImages.h"
+#include "YgorMath.h"
+
+#include "doctest/doctest.h"
+
+#include "Slice_Index.h"
+
+
+static void add_image(planar_image_collection<float,double> &imagecoll,
+                      const vec3<double> &offset,
+                      double pxl_dz,
+                      const vec3<double> &row_unit = vec3<double>(1.0, 0.0, 0.0),
+                      const vec3<double> &col_unit = vec3<double>(0.0, 1.0, 0.0)){
+    imagecoll.images.emplace_back();
+    auto &img = imagecoll.images.back();
+    img.init_orientation(row_unit, col_unit);
+    img.init_buffer(4, 4, 1);
+    img.init_spatial(1.0, 1.0, pxl_dz, vec3<double>(0.0, 0.0, 0.0), offset);
+    return;
+}
+
+// Brute-force reference implementations.
+static std::list<Slice_Index::img_it_t> brute_sandwich(planar_image_collection<float,double> &imagecoll, const vec3<double> &p){
+    std::list<Slice_Index::img_it_t> out;
+    for(auto it = std::begin(imagecoll.images); it != std::end(imagecoll.images); ++it){
+        if(it->sandwiches_point_within_top_bottom_planes(p)) out.push_back(it);
+    }
+    return out;
+}
+
+static std::vector<vec3<double>> make_random_points(long int N, unsigned int seed){
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> rd_xy(-1.0, 5.0);
+    std::uniform_real_distribution<double> rd_z(-5.0, 55.0);
+    std::vector<vec3<double>> out;
+    for(long int i = 0; i < N; ++i){
+        out.emplace_back( rd_xy(re), rd_xy(re), rd_z(re) );
+    }
+    return out;
+}
+
+
+TEST_CASE( "Slice_Index matches exhaustive scans for a regular stack" ){
+    planar_image_collection<float,double> imagecoll;
+    for(long int i = 0; i < 50; ++i){
+        add_image(imagecoll, vec3<double>(0.0, 0.0, 1.0 * static_cast<double>(i)), 1.0);
+    }
+    Slice_Index index(imagecoll);
+    REQUIRE( index.is_indexed() );
+
+    for(const auto &p : make_random_points(500, 1)){
+        REQUIRE( index.get_images_which_sandwich_point(p) == brute_sandwich(imagecoll, p) );
+        REQUIRE( index.get_images_which_encompass_point(p) == imagecoll.get_images_which_encompass_point(p) );
+    }
+
+    const auto on_z = index.get_images_at_offset(10.2);
+    REQUIRE( on_z.size() == 1 );
+    REQUIRE( on_z.front()->offset.z == 10.0 );
+    REQUIRE( index.get_images_at_offset(-10.0).empty() );
+    REQUIRE( index.get_images_at_offset(100.0).empty() );
+}
+
+TEST_CASE( "Slice_Index matches exhaustive scans for irregular and overlapping stacks" ){
+    planar_image_collection<float,double> imagecoll;
+    std::mt19937 re(2);
+    std::uniform_real_distribution<double> rd_z(0.0, 50.0);
+    std::uniform_real_distribution<double> rd_dz(0.1, 3.0);
+    for(long int i = 0; i < 80; ++i){
+        add_image(imagecoll, vec3<double>(0.0, 0.0, rd_z(re)), rd_dz(re));
+    }
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 25.0), 40.0); // Overlaps most others.
+
+    // Flipped orientation, but still parallel.
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 12.0), 2.0, vec3<double>(0.0, 1.0, 0.0), vec3<double>(1.0, 0.0, 0.0));
+
+    Slice_Index index(imagecoll);
+    REQUIRE( index.is_indexed() );
+    for(const auto &p : make_random_points(500, 3)){
+        REQUIRE( index.get_images_which_sandwich_point(p) == brute_sandwich(imagecoll, p) );
+        REQUIRE( index.get_images_which_encompass_point(p) == imagecoll.get_images_which_encompass_point(p) );
+    }
+}
+
+TEST_CASE( "Slice_Index falls back to scanning non-parallel images" ){
+    planar_image_collection<float,double> imagecoll;
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 0.0), 1.0);
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 0.0), 1.0, vec3<double>(1.0, 0.0, 0.0), vec3<double>(0.0, 0.0, 1.0));
+
+    Slice_Index index(imagecoll);
+    REQUIRE( !index.is_indexed() );
+    REQUIRE( !index.stack_normal() );
+    for(const auto &p : make_random_points(100, 4)){
+        REQUIRE( index.get_images_which_sandwich_point(p) == brute_sandwich(imagecoll, p) );
+    }
+}
+
+TEST_CASE( "Slice_Index is rebuilt when the collection changes" ){
+    planar_image_collection<float,double> imagecoll;
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 0.0), 1.0);
+    add_image(imagecoll, vec3<double>(0.0, 0.0, 1.0), 1.0);
+
+    Slice_Index index(imagecoll);
+    REQUIRE( index.get_images_at_offset(5.0).empty() );
+
+    SUBCASE("adding images is detected"){
+        add_image(imagecoll, vec3<double>(0.0, 0.0, 5.0), 1.0);
+        REQUIRE( index.get_images_at_offset(5.0).size() == 1 );
+    }
+
+    SUBCASE("moving the last image is detected"){
+        imagecoll.images.back().offset = vec3<double>(0.0, 0.0, 5.0);
+        REQUIRE( index.get_images_at_offset(5.0).size() == 1 );
+    }
+
+    SUBCASE("other geometry changes require explicit invalidation"){
+        add_image(imagecoll, vec3<double>(0.0, 0.0, 2.0), 1.0);
+        REQUIRE( index.get_images_at_offset(1.5).size() == 2 );
+
+        std::next(std::begin(imagecoll.images))->offset = vec3<double>(0.0, 0.0, 5.0);
+        index.invalidate();
+        REQUIRE( index.get_images_at_offset(1.5).size() == 1 );
+        REQUIRE( index.get_images_at_offset(5.0).size() == 1 );
+    }
+}
+
@@ -0,0 +1,121 @@
+
+#include <cmath>
+#include <limits>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Slice_Sort.h"
+
+
+TEST_CASE( "stable_sort_by_extracted_key" ){
+    SUBCASE("sorting is stable and keys are extracted once"){
+        std::list<std::pair<long int, long int>> l; // (key, original position).
+        for(long int i = 0; i < 100; ++i) l.emplace_back( (i * 37) % 7, i );
+        const auto *first_elem = &(l.front());
+
+        long int extractions = 0;
+        stable_sort_by_extracted_key(l, [&](const std::pair<long int, long int> &p){ ++extractions; return p.first; });
+        REQUIRE( extractions == 100 );
+        REQUIRE( l.size() == 100 );
+
+        for(auto it = std::begin(l), next = std::next(it); next != std::end(l); ++it, ++next){
+            REQUIRE( it->first <= next->first );
+            if(it->first == next->first) REQUIRE( it->second < next->second );
+        }
+
+        // Elements are relinked, not copied.
+        bool found = false;
+        for(const auto &p : l) found = found || (&p == first_elem);
+        REQUIRE( found );
+    }
+
+    SUBCASE("short lists"){
+        std::list<long int> l;
+        stable_sort_by_extracted_key(l, [](long int x){ return x; });
+        REQUIRE( l.empty() );
+        l.push_back(3);
+        stable_sort_by_extracted_key(l, [](long int x){ return x; });
+        REQUIRE( l.front() == 3 );
+    }
+}
+
+TEST_CASE( "slice_sort_key" ){
+    const auto make_key = [](std::optional<std::string> p,
+                             std::optional<std::string> m,
+                             std::optional<double> s,
+                             std::optional<long int> n){
+        slice_sort_key k;
+        k.patient_id = p;
+        k.modality = m;
+        k.slice_location = s;
+        k.instance_number = n;
+        return k;
+    };
+
+    SUBCASE("components are compared in priority order"){
+        REQUIRE( make_key("A", "MR", 5.0, 9) < make_key("B", "CT", 1.0, 1) );
+        REQUIRE( make_key("A", "CT", 5.0, 9) < make_key("A", "MR", 1.0, 1) );
+        REQUIRE( make_key("A", "CT", 1.0, 9) < make_key("A", "CT", 5.0, 1) );
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key("A", "CT", 1.0, 9) );
+        REQUIRE( !(make_key("A", "CT", 1.0, 1) < make_key("A", "CT", 1.0, 1)) );
+    }
+
+    SUBCASE("slice locations are compared numerically"){
+        REQUIRE( make_key("A", "CT", -10.0, 1) < make_key("A", "CT", 2.0, 1) );
+        REQUIRE( make_key("A", "CT", 2.0, 1) < make_key("A", "CT", 10.0, 1) );
+    }
+
+    SUBCASE("absent values order last"){
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key({}, "CT", 1.0, 1) );
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key("A", {}, 1.0, 1) );
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key("A", "CT", {}, 1) );
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key("A", "CT", 1.0, {}) );
+
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        REQUIRE( make_key("A", "CT", 1.0, 1) < make_key("A", "CT", nan, 1) );
+        REQUIRE( !(make_key("A", "CT", nan, 1) < make_key("A", "CT", {}, 1)) );
+        REQUIRE( !(make_key("A", "CT", {}, 1) < make_key("A", "CT", nan, 1)) );
+    }
+
+    SUBCASE("a single sort matches consecutive stable sorts"){
+        std::vector<slice_sort_key> keys;
+        for(long int i = 0; i < 200; ++i){
+            keys.push_back( make_key( (i % 3 == 0) ? std::optional<std::string>() : std::optional<std::string>("P" + std::to_string(i % 2)),
+                                      (i % 5 == 0) ? "MR" : "CT",
+                                      static_cast<double>((i * 13) % 11) - 5.0,
+                                      (i % 7 == 0) ? std::optional<long int>() : std::optional<long int>((i * 17) % 23) ) );
+        }
+
+        std::list<std::pair<slice_sort_key, long int>> single;
+        for(size_t i = 0; i < keys.size(); ++i) single.emplace_back( keys[i], static_cast<long int>(i) );
+        auto multi = single;
+
+        stable_sort_by_extracted_key(single, [](const std::pair<slice_sort_key, long int> &p){ return p.first; });
+
+        // Consecutive stable sorts, from least to most significant component.
+        const auto by = [](auto member){
+            return [member](const std::pair<slice_sort_key, long int> &a,
+                            const std::pair<slice_sort_key, long int> &b){
+                const auto &A = a.first.*member;
+                const auto &B = b.first.*member;
+                return (A && !B) || (A && B && (A.value() < B.value()));
+            };
+        };
+        multi.sort( by(&slice_sort_key::instance_number) );
+        multi.sort( by(&slice_sort_key::slice_location) );
+        multi.sort( by(&slice_sort_key::modality) );
+        multi.sort( by(&slice_sort_key::patient_id) );
+
+        std::vector<long int> single_order;
+        std::vector<long int> multi_order;
+        for(const auto &p : single) single_order.push_back(p.second);
+        for(const auto &p : multi) multi_order.push_back(p.second);
+        REQUIRE( single_order == multi_order );
+    }
+}
+
@@ -0,0 +1,170 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Streaming_Statistics.h"
+
+
+TEST_CASE( "stream_moments" ){
+    std::mt19937 gen(11);
+    std::normal_distribution<double> dist(3.0, 2.0);
+
+    std::vector<double> xs;
+    for(long int i = 0; i < 1000; ++i) xs.push_back(dist(gen));
+
+    double sum = 0.0;
+    for(const auto &x : xs) sum += x;
+    const auto mean = sum / static_cast<double>(xs.size());
+    double ss = 0.0;
+    for(const auto &x : xs) ss += (x - mean) * (x - mean);
+    const auto var = ss / static_cast<double>(xs.size() - 1);
+
+    SUBCASE("sequential digestion"){
+        stream_moments m;
+        for(const auto &x : xs) m.digest(x);
+        REQUIRE( m.count == static_cast<long int>(xs.size()) );
+        REQUIRE( m.min == *std::min_element(std::begin(xs), std::end(xs)) );
+        REQUIRE( m.max == *std::max_element(std::begin(xs), std::end(xs)) );
+        REQUIRE( std::abs(m.mean - mean) < 1.0E-10 );
+        REQUIRE( std::abs(m.variance() - var) < 1.0E-9 );
+    }
+
+    SUBCASE("merged partial results"){
+        stream_moments a, b, c;
+        for(size_t i = 0; i < xs.size(); ++i){
+            if(i < 100){
+                a.digest(xs[i]);
+            }else{
+                b.digest(xs[i]);
+            }
+        }
+        c.merge(a);
+        c.merge(b);
+        c.merge(stream_moments());
+        REQUIRE( c.count == static_cast<long int>(xs.size()) );
+        REQUIRE( std::abs(c.mean - mean) < 1.0E-10 );
+        REQUIRE( std::abs(c.variance() - var) < 1.0E-9 );
+    }
+
+    SUBCASE("variance requires two values"){
+        stream_moments m;
+        m.digest(1.0);
+        REQUIRE( std::isnan(m.variance()) );
+    }
+}
+
+TEST_CASE( "streaming_histogram" ){
+    SUBCASE("bins are anchored at zero"){
+        streaming_histogram h(0.5);
+        for(const auto &x : { 1.2, 1.3, -0.2, 2.0, 2.49 }) h.digest(x);
+        h.digest(std::numeric_limits<double>::quiet_NaN());
+
+        REQUIRE( h.get_first_bin() == -1 );
+        REQUIRE( h.get_bin_count() == 6 );
+        REQUIRE( h.bin_weight(-1) == 1.0 );
+        REQUIRE( h.bin_weight(0) == 0.0 );
+        REQUIRE( h.bin_weight(2) == 2.0 );
+        REQUIRE( h.bin_weight(4) == 2.0 );
+        REQUIRE( h.bin_weight(100) == 0.0 );
+        REQUIRE( h.bin_lower(2) == 1.0 );
+        REQUIRE( h.bin_centre(2) == 1.25 );
+        REQUIRE( h.get_moments().count == 5 );
+    }
+
+    SUBCASE("merging matches sequential binning"){
+        std::mt19937 gen(5);
+        std::uniform_real_distribution<double> dist(-10.0, 40.0);
+        streaming_histogram all(0.3), a(0.3), b(0.3);
+        for(long int i = 0; i < 5000; ++i){
+            const auto x = dist(gen);
+            all.digest(x, 2.0);
+            ((i % 3 == 0) ? a : b).digest(x, 2.0);
+        }
+        a.merge(b);
+        REQUIRE( a.get_first_bin() == all.get_first_bin() );
+        REQUIRE( a.get_bin_count() == all.get_bin_count() );
+        for(long int bin = all.get_first_bin(); bin < all.get_first_bin() + all.get_bin_count(); ++bin){
+            REQUIRE( a.bin_weight(bin) == all.bin_weight(bin) );
+        }
+        REQUIRE( a.get_moments().count == 5000 );
+
+        streaming_histogram other(0.4);
+        REQUIRE_THROWS( a.merge(other) );
+    }
+
+    SUBCASE("excessive ranges overflow"){
+        streaming_histogram h(1.0, 100);
+        h.digest(0.0);
+        h.digest(50.0);
+        REQUIRE( !h.overflowed() );
+        h.digest(500.0);
+        REQUIRE( h.overflowed() );
+        REQUIRE( h.get_bin_count() == 0 );
+        REQUIRE( h.get_moments().max == 500.0 );
+    }
+
+    SUBCASE("invalid bin widths are rejected"){
+        REQUIRE_THROWS( streaming_histogram(0.0) );
+        REQUIRE_THROWS( streaming_histogram(-1.0) );
+    }
+}
+
+TEST_CASE( "quantile_sketch" ){
+    const double alpha = 1.0E-3;
+
+    // Compare against the exact order statistic at the documented rank.
+    const auto check = [&](std::vector<double> xs, const quantile_sketch &s){
+        std::sort(std::begin(xs), std::end(xs));
+        for(const auto &q : { 0.0, 0.02, 0.25, 0.5, 0.75, 0.98, 1.0 }){
+            const auto rank = static_cast<size_t>(std::floor(q * static_cast<double>(xs.size() - 1)));
+            const auto exact = xs.at(rank);
+            REQUIRE( std::abs(s.quantile(q) - exact) <= alpha * std::abs(exact) * (1.0 + 1.0E-9) );
+        }
+    };
+
+    SUBCASE("positive values"){
+        std::mt19937 gen(7);
+        std::lognormal_distribution<double> dist(1.0, 1.5);
+        std::vector<double> xs;
+        quantile_sketch s(alpha);
+        for(long int i = 0; i < 20000; ++i){
+            xs.push_back(dist(gen));
+            s.digest(xs.back());
+        }
+        check(xs, s);
+    }
+
+    SUBCASE("mixed signs and zeros, merged"){
+        std::mt19937 gen(9);
+        std::normal_distribution<double> dist(0.0, 50.0);
+        std::vector<double> xs;
+        quantile_sketch a(alpha), b(alpha);
+        for(long int i = 0; i < 20000; ++i){
+            const auto x = (i % 10 == 0) ? 0.0 : dist(gen);
+            xs.push_back(x);
+            ((i % 2 == 0) ? a : b).digest(x);
+        }
+        a.merge(b);
+        REQUIRE( a.get_moments().count == 20000 );
+        check(xs, a);
+
+        quantile_sketch other(1.0E-2);
+        REQUIRE_THROWS( a.merge(other) );
+    }
+
+    SUBCASE("invalid usage is rejected"){
+        quantile_sketch s;
+        REQUIRE_THROWS( s.quantile(0.5) );
+        s.digest(1.0);
+        REQUIRE( s.quantile(0.5) == 1.0 );
+        REQUIRE_THROWS( s.quantile(1.5) );
+        REQUIRE_THROWS( quantile_sketch(0.0) );
+        REQUIRE_THROWS( quantile_sketch(1.0) );
+    }
+}
+
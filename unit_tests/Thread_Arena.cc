@@ -0,0 +1,88 @@
+
+#include <cstddef>
+#include <memory_resource>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+#include "Thread_Arena.h"
+
+
+static size_t churn(){
+    size_t sum = 0;
+    for(size_t i = 0; i < 100; ++i){
+        std::pmr::set<size_t> s(thread_arena());
+        std::pmr::vector<size_t> v(thread_arena());
+        for(size_t j = 0; j < 50; ++j){
+            s.insert((i * 7 + j) % 31);
+            v.push_back(j);
+        }
+        sum += s.size() + v.size();
+    }
+    return sum;
+}
+
+TEST_CASE( "thread_arena" ){
+    SUBCASE("each thread has a distinct arena"){
+        const auto here = thread_arena();
+        REQUIRE( here != nullptr );
+        REQUIRE( here == thread_arena() );
+
+        std::pmr::memory_resource *there = nullptr;
+        std::thread t([&](){ there = thread_arena(); });
+        t.join();
+        REQUIRE( there != nullptr );
+        REQUIRE( there != here );
+    }
+
+    SUBCASE("a warm arena does not reach the global allocator"){
+        // Run on a fresh thread so the arena starts cold.
+        thread_arena_statistics warm;
+        thread_arena_statistics after;
+        size_t sum_warm = 0;
+        size_t sum_after = 0;
+        std::thread t([&](){
+            sum_warm = churn();
+            warm = get_thread_arena_statistics();
+            sum_after = churn();
+            after = get_thread_arena_statistics();
+        });
+        t.join();
+
+        REQUIRE( sum_warm == sum_after );
+        REQUIRE( after.upstream_allocations == warm.upstream_allocations );
+        REQUIRE( after.upstream_deallocations == warm.upstream_deallocations );
+        REQUIRE( after.bypassing_allocations == warm.bypassing_allocations );
+#ifndef NDEBUG
+        REQUIRE( 0 < warm.upstream_allocations );
+        REQUIRE( 0 < warm.upstream_bytes );
+#endif // NDEBUG
+    }
+
+    SUBCASE("allocations that bypass the arena are counted"){
+        long int pooled = -1;
+        long int bypassed = -1;
+        std::thread t([&](){
+            thread_arena_scope arena_scope;
+            {
+                std::pmr::vector<size_t> v(thread_arena());
+                v.resize(100);
+            }
+            pooled = arena_scope.bypassing_allocations();
+            {
+                std::vector<size_t> v(100);
+            }
+            bypassed = arena_scope.bypassing_allocations();
+        });
+        t.join();
+
+        REQUIRE( pooled == 0 );
+#ifndef NDEBUG
+        REQUIRE( bypassed == 1 );
+#else
+        REQUIRE( bypassed == 0 );
+#endif // NDEBUG
+    }
+}
@@ -0,0 +1,99 @@
+
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "YgorImages.h"
+#include "YgorMath.h"
+
+#include "doctest/doctest.h"
+
+#include "Voxel_Mask_Cache.h"
+
+
+static planar_image<float,double> make_test_image(){
+    planar_image<float,double> img;
+    img.init_buffer(10, 10, 1);
+    img.init_spatial(1.0, 1.0, 1.0, vec3<double>(0.0, 0.0, 0.0), vec3<double>(0.0, 0.0, 0.0));
+    img.init_orientation(vec3<double>(0.0, 1.0, 0.0), vec3<double>(1.0, 0.0, 0.0));
+    long int i = 0;
+    for(auto &v : img.data) v = static_cast<float>(i++);
+    return img;
+}
+
+static contour_collection<double> make_test_contours(double width){
+    contour_collection<double> cc;
+    cc.contours.emplace_back();
+    auto &c = cc.contours.back();
+    c.closed = true;
+    c.points.emplace_back( vec3<double>(2.0,   2.0,   0.0) );
+    c.points.emplace_back( vec3<double>(width, 2.0,   0.0) );
+    c.points.emplace_back( vec3<double>(width, width, 0.0) );
+    c.points.emplace_back( vec3<double>(2.0,   width, 0.0) );
+    return cc;
+}
+
+TEST_CASE( "Mutate_Voxels_Cached" ){
+    Mutate_Voxels_Opts opts;
+    opts.editstyle      = Mutate_Voxels_Opts::EditStyle::InPlace;
+    opts.inclusivity    = Mutate_Voxels_Opts::Inclusivity::Centre;
+    opts.contouroverlap = Mutate_Voxels_Opts::ContourOverlap::Ignore;
+    opts.aggregate      = Mutate_Voxels_Opts::Aggregate::First;
+    opts.adjacency      = Mutate_Voxels_Opts::Adjacency::SingleVoxel;
+    opts.maskmod        = Mutate_Voxels_Opts::MaskMod::Noop;
+
+    Mutate_Voxels_Functor<float,double> f_bounded = [](long int, long int, long int,
+                                                       std::reference_wrapper<planar_image<float,double>>,
+                                                       std::reference_wrapper<planar_image<float,double>>,
+                                                       float &v){ v = 2.0f * v; };
+    Mutate_Voxels_Functor<float,double> f_unbounded = [](long int, long int, long int,
+                                                         std::reference_wrapper<planar_image<float,double>>,
+                                                         std::reference_wrapper<planar_image<float,double>>,
+                                                         float &v){ v = -1.0f; };
+
+    auto cc = make_test_contours(6.0);
+    auto cache = std::make_shared<Voxel_Mask_Cache>();
+
+    auto expected = make_test_image();
+    Mutate_Voxels<float,double>( std::ref(expected), { std::ref(expected) }, { std::ref(cc) }, opts,
+                                 f_bounded, f_unbounded );
+
+    SUBCASE("cached results match uncached results"){
+        for(long int i = 0; i < 3; ++i){
+            auto img = make_test_image();
+            Mutate_Voxels_Cached( std::ref(img), { std::ref(img) }, { std::ref(cc) }, opts,
+                                  f_bounded, f_unbounded, {}, cache );
+            REQUIRE( img.data == expected.data );
+        }
+        REQUIRE( cache->size() == 1 );
+        REQUIRE( cache->miss_count() == 1 );
+        REQUIRE( cache->hit_count() == 2 );
+    }
+
+    SUBCASE("altered contours are not confused with the original contours"){
+        auto img = make_test_image();
+        Mutate_Voxels_Cached( std::ref(img), { std::ref(img) }, { std::ref(cc) }, opts,
+                              f_bounded, f_unbounded, {}, cache );
+
+        auto cc2 = make_test_contours(8.0);
+        auto img2 = make_test_image();
+        Mutate_Voxels_Cached( std::ref(img2), { std::ref(img2) }, { std::ref(cc2) }, opts,
+                              f_bounded, f_unbounded, {}, cache );
+        REQUIRE( cache->size() == 2 );
+        REQUIRE( img2.data != expected.data );
+    }
+
+    SUBCASE("fingerprints"){
+        REQUIRE( Fingerprint_Contours({ std::ref(cc) }) == Fingerprint_Contours({ std::ref(cc) }) );
+        auto cc2 = make_test_contours(8.0);
+        REQUIRE( Fingerprint_Contours({ std::ref(cc) }) != Fingerprint_Contours({ std::ref(cc2) }) );
+
+        auto img = make_test_image();
+        const auto h = Fingerprint_Image_Geometry(img);
+        img.data.front() = 1234.0f;
+        REQUIRE( Fingerprint_Image_Geometry(img) == h ); // Voxel values are irrelevant.
+        img.init_spatial(2.0, 1.0, 1.0, vec3<double>(0.0, 0.0, 0.0), vec3<double>(0.0, 0.0, 0.0));
+        REQUIRE( Fingerprint_Image_Geometry(img) != h );
+    }
+}
+
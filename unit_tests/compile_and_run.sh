@@ -26,9 +26,31 @@ fi
 g++ -std=c++17 -Wall -I. -I"${REPOROOT}/src" \
   Main.cc \
   {,"${REPOROOT}/src/"}Alignment_TPSRPM.cc \
+  {,"${REPOROOT}/src/"}KineticModel_1Compartment_ClosedForm.cc \
+  {,"${REPOROOT}/src/"}Slice_Cache.cc \
+  {,"${REPOROOT}/src/"}Voxel_Mask_Cache.cc \
+  {,"${REPOROOT}/src/"}Image_Spill_Store.cc \
+  {,"${REPOROOT}/src/"}Colour_Maps.cc \
+  {,"${REPOROOT}/src/"}FFT_Correlation.cc \
+  {,"${REPOROOT}/src/"}Point_KD_Tree.cc \
+  {,"${REPOROOT}/src/"}Image_Fingerprint.cc \
+  {,"${REPOROOT}/src/"}Explicator_Cache.cc \
+  {,"${REPOROOT}/src/"}Job_Queue.cc \
+  {,"${REPOROOT}/src/"}Slice_Index.cc \
+  {,"${REPOROOT}/src/"}Simple_Meshing.cc \
+  {,"${REPOROOT}/src/"}Distance_Transform.cc \
+  {,"${REPOROOT}/src/"}Streaming_Statistics.cc \
+  {,"${REPOROOT}/src/"}Mapped_File.cc \
+  {,"${REPOROOT}/src/"}Slice_Sort.cc \
+  {,"${REPOROOT}/src/"}Pointwise_Fusion.cc \
+  {,"${REPOROOT}/src/"}Benchmark_Harness.cc \
+  {,"${REPOROOT}/src/"}Operation_Result_Cache.cc \
+  {,"${REPOROOT}/src/"}Operation_Monitor.cc \
+  {,"${REPOROOT}/src/"}Thread_Arena.cc \
   -o run_tests \
   -pthread \
   -lboost_system \
+  -lexplicator \
   -lygor
 
 ./run_tests #--success